@@ -949,6 +949,128 @@ inline size_t AdvancedProcessBlocks128_4x1_SSE(F1 func1, F4 func4,
     return length;
 }
 
+/// \brief AdvancedProcessBlocks for 1 and 8 blocks
+/// \tparam F1 function to process 1 128-bit block
+/// \tparam F8 function to process 8 128-bit blocks
+/// \tparam W word type of the subkey table
+/// \details AdvancedProcessBlocks128_8x1_SSE processes 8 and 1 SSE SIMD words
+///  at a time. It is intended for ciphers with a wide AVX2 kernel, like bitsliced
+///  Serpent, where F8 transposes the eight blocks into 256-bit words. The
+///  template itself only uses SSE2.
+/// \details The subkey type is usually word32 or word64. F1 and F8 must use the
+///  same word type.
+/// \since Crypto++ 8.5
+template <typename F1, typename F8, typename W>
+inline size_t AdvancedProcessBlocks128_8x1_SSE(F1 func1, F8 func8,
+        MAYBE_CONST W *subKeys, size_t rounds, const byte *inBlocks,
+        const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(subKeys);
+    CRYPTOPP_ASSERT(inBlocks);
+    CRYPTOPP_ASSERT(outBlocks);
+    CRYPTOPP_ASSERT(length >= 16);
+
+    const size_t blockSize = 16;
+    // const size_t xmmBlockSize = 16;
+
+    size_t inIncrement = (flags & (BT_InBlockIsCounter|BT_DontIncrementInOutPointers)) ? 0 : blockSize;
+    size_t xorIncrement = (xorBlocks != NULLPTR) ? blockSize : 0;
+    size_t outIncrement = (flags & BT_DontIncrementInOutPointers) ? 0 : blockSize;
+
+    // Clang and Coverity are generating findings using xorBlocks as a flag.
+    const bool xorInput = (xorBlocks != NULLPTR) && (flags & BT_XorInput);
+    const bool xorOutput = (xorBlocks != NULLPTR) && !(flags & BT_XorInput);
+
+    if (flags & BT_ReverseDirection)
+    {
+        inBlocks = PtrAdd(inBlocks, length - blockSize);
+        xorBlocks = PtrAdd(xorBlocks, length - blockSize);
+        outBlocks = PtrAdd(outBlocks, length - blockSize);
+        inIncrement = 0-inIncrement;
+        xorIncrement = 0-xorIncrement;
+        outIncrement = 0-outIncrement;
+    }
+
+    if (flags & BT_AllowParallel)
+    {
+        while (length >= 8*blockSize)
+        {
+            __m128i block[8];
+            if (flags & BT_InBlockIsCounter)
+            {
+                // Increment of 1 in big-endian compatible with the ctr byte array.
+                const __m128i s_one = _mm_set_epi32(1<<24, 0, 0, 0);
+                block[0] = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+                for (unsigned int i=1; i<8; ++i)
+                    block[i] = _mm_add_epi32(block[i-1], s_one);
+                _mm_storeu_si128(M128_CAST(inBlocks), _mm_add_epi32(block[7], s_one));
+            }
+            else
+            {
+                for (unsigned int i=0; i<8; ++i)
+                {
+                    block[i] = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+                    inBlocks = PtrAdd(inBlocks, inIncrement);
+                }
+            }
+
+            if (xorInput)
+            {
+                for (unsigned int i=0; i<8; ++i)
+                {
+                    block[i] = _mm_xor_si128(block[i], _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+                    xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+                }
+            }
+
+            func8(block[0], block[1], block[2], block[3], block[4], block[5], block[6], block[7],
+                subKeys, static_cast<unsigned int>(rounds));
+
+            if (xorOutput)
+            {
+                for (unsigned int i=0; i<8; ++i)
+                {
+                    block[i] = _mm_xor_si128(block[i], _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+                    xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+                }
+            }
+
+            for (unsigned int i=0; i<8; ++i)
+            {
+                _mm_storeu_si128(M128_CAST(outBlocks), block[i]);
+                outBlocks = PtrAdd(outBlocks, outIncrement);
+            }
+
+            length -= 8*blockSize;
+        }
+    }
+
+    while (length >= blockSize)
+    {
+        __m128i block = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+
+        if (xorInput)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+
+        if (flags & BT_InBlockIsCounter)
+            const_cast<byte *>(inBlocks)[15]++;
+
+        func1(block, subKeys, static_cast<unsigned int>(rounds));
+
+        if (xorOutput)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+
+        _mm_storeu_si128(M128_CAST(outBlocks), block);
+
+        inBlocks = PtrAdd(inBlocks, inIncrement);
+        outBlocks = PtrAdd(outBlocks, outIncrement);
+        xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+        length -= blockSize;
+    }
+
+    return length;
+}
+
 NAMESPACE_END  // CryptoPP
 
 #endif  // CRYPTOPP_SSSE3_AVAILABLE
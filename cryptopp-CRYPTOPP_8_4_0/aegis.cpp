@@ -0,0 +1,513 @@
+// aegis.cpp - written and placed in the public domain by the Crypto++ project
+
+#include "pch.h"
+#include "config.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "aegis.h"
+#include "argnames.h"
+#include "misc.h"
+#include "cpu.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AESNI_AVAILABLE)
+extern void AEGIS128L_Absorb_AESNI(byte *state, const byte *in, size_t blocks);
+extern void AEGIS128L_Encrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks);
+extern void AEGIS128L_Decrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks);
+extern void AEGIS256_Absorb_AESNI(byte *state, const byte *in, size_t blocks);
+extern void AEGIS256_Encrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks);
+extern void AEGIS256_Decrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks);
+#endif
+
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+extern void AEGIS128L_Absorb_ARMV8(byte *state, const byte *in, size_t blocks);
+extern void AEGIS128L_Encrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks);
+extern void AEGIS128L_Decrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks);
+extern void AEGIS256_Absorb_ARMV8(byte *state, const byte *in, size_t blocks);
+extern void AEGIS256_Encrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks);
+extern void AEGIS256_Decrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks);
+#endif
+
+NAMESPACE_END
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word32;
+using CryptoPP::word64;
+using CryptoPP::rotrConstant;
+using CryptoPP::xorbuf;
+
+const byte sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+// The constants C0 and C1 are the Fibonacci sequence modulo 256
+const byte C0[16] = {
+	0x00, 0x01, 0x01, 0x02, 0x03, 0x05, 0x08, 0x0d, 0x15, 0x22, 0x37, 0x59, 0x90, 0xe9, 0x79, 0x62
+};
+const byte C1[16] = {
+	0xdb, 0x3d, 0x18, 0x55, 0x6d, 0xc2, 0x2f, 0xf1, 0x20, 0x11, 0x31, 0x42, 0x73, 0xb5, 0x28, 0xdd
+};
+
+inline word32 GetColumn(const byte *in, unsigned int c)
+{
+	// SubBytes and ShiftRows. Row r of column c comes from column c+r.
+	return word32(sbox[in[4*c]]) |
+		(word32(sbox[in[4*((c+1)%4)+1]]) << 8) |
+		(word32(sbox[in[4*((c+2)%4)+2]]) << 16) |
+		(word32(sbox[in[4*((c+3)%4)+3]]) << 24);
+}
+
+// One AES encryption round, out = MixColumns(ShiftRows(SubBytes(in))) xor key.
+// This is the AESENC instruction. out may not overlap in.
+inline void AESRound(byte *out, const byte *in, const byte *key)
+{
+	for (unsigned int c=0; c<4; ++c)
+	{
+		const word32 w = GetColumn(in, c);
+		const word32 d = ((w & 0x7f7f7f7f) << 1) ^ (((w >> 7) & 0x01010101) * 0x1b);
+		const word32 m = d ^ rotrConstant<8>(d ^ w) ^ rotrConstant<16>(w) ^ rotrConstant<24>(w);
+
+		out[4*c+0] = byte(m ^ key[4*c+0]);
+		out[4*c+1] = byte((m >> 8) ^ key[4*c+1]);
+		out[4*c+2] = byte((m >> 16) ^ key[4*c+2]);
+		out[4*c+3] = byte((m >> 24) ^ key[4*c+3]);
+	}
+}
+
+// S'(i) = AESRound(S(i-1), S(i)), and the message words are mixed into
+// S(0) and, for AEGIS-128L, S(4).
+void Update128L_CXX(byte *state, const byte *m0, const byte *m1)
+{
+	byte t[8*16], k[16];
+	xorbuf(k, state+0*16, m0, 16);
+	AESRound(t+0*16, state+7*16, k);
+	xorbuf(k, state+4*16, m1, 16);
+	AESRound(t+4*16, state+3*16, k);
+	for (unsigned int i=1; i<8; ++i)
+	{
+		if (i != 4)
+			AESRound(t+i*16, state+(i-1)*16, state+i*16);
+	}
+	std::memcpy(state, t, sizeof(t));
+}
+
+void Update256_CXX(byte *state, const byte *m)
+{
+	byte t[6*16], k[16];
+	xorbuf(k, state+0*16, m, 16);
+	AESRound(t+0*16, state+5*16, k);
+	for (unsigned int i=1; i<6; ++i)
+		AESRound(t+i*16, state+(i-1)*16, state+i*16);
+	std::memcpy(state, t, sizeof(t));
+}
+
+// z = a xor b xor (c and d)
+inline void KeystreamWord(byte *z, const byte *a, const byte *b, const byte *c, const byte *d)
+{
+	for (unsigned int i=0; i<16; ++i)
+		z[i] = byte(a[i] ^ b[i] ^ (c[i] & d[i]));
+}
+
+inline void LengthBlock(byte *block, word64 headerBits, word64 messageBits)
+{
+	CryptoPP::PutWord(false, CryptoPP::LITTLE_ENDIAN_ORDER, block+0, headerBits);
+	CryptoPP::PutWord(false, CryptoPP::LITTLE_ENDIAN_ORDER, block+8, messageBits);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+////////////////////////////// AEGIS_Base //////////////////////////////
+
+std::string AEGIS_Base::AlgorithmProvider() const
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return "AESNI";
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return "ARMv8";
+#endif
+	return "C++";
+}
+
+void AEGIS_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+{
+	CRYPTOPP_ASSERT(keylength == KeySize());
+	CRYPTOPP_UNUSED(keylength);
+
+	m_digestSize = params.GetIntValueWithDefault(Name::DigestSize(), 16);
+	if (m_digestSize != 16 && m_digestSize != 32)
+		throw InvalidArgument(AlgorithmName() + ": DigestSize must be 16 or 32");
+
+	std::memcpy(m_key, userKey, KeySize());
+	m_buffer.New(3*RateSize());
+	m_partialLength = 0;
+}
+
+void AEGIS_Base::Resync(const byte *iv, size_t len)
+{
+	CRYPTOPP_ASSERT(len == KeySize());
+	CRYPTOPP_UNUSED(len);
+
+	InitializeState(m_key, iv);
+	m_partialLength = 0;
+}
+
+size_t AEGIS_Base::AuthenticateBlocks(const byte *data, size_t len)
+{
+	const size_t rate = RateSize();
+	AbsorbBlocks(data, len/rate);
+	return len % rate;
+}
+
+void AEGIS_Base::AuthenticateLastHeaderBlock()
+{
+	if (m_bufferedDataLength > 0)
+	{
+		std::memset(m_buffer+m_bufferedDataLength, 0, RateSize()-m_bufferedDataLength);
+		AbsorbBlocks(m_buffer, 1);
+		m_bufferedDataLength = 0;
+	}
+}
+
+size_t AEGIS_Base::ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len)
+{
+	const bool encrypt = IsForwardTransformation();
+	const size_t rate = RateSize();
+	byte *plaintext = PartialPlaintext(), *keystream = PartialKeystream();
+
+	// The partial block is kept here rather than in m_bufferedDataLength,
+	// so every call of ProcessData() comes back to this function.
+	while (len)
+	{
+		if (m_partialLength == 0 && len >= rate)
+		{
+			const size_t blocks = len/rate, length = blocks*rate;
+			if (encrypt)
+				EncryptBlocks(outString, inString, blocks);
+			else
+				DecryptBlocks(outString, inString, blocks);
+
+			inString += length;
+			outString += length;
+			len -= length;
+			continue;
+		}
+
+		if (m_partialLength == 0)
+			Keystream(keystream);
+
+		const size_t length = STDMIN(len, rate-m_partialLength);
+		if (encrypt)
+		{
+			std::memcpy(plaintext+m_partialLength, inString, length);
+			xorbuf(outString, inString, keystream+m_partialLength, length);
+		}
+		else
+		{
+			xorbuf(outString, inString, keystream+m_partialLength, length);
+			std::memcpy(plaintext+m_partialLength, outString, length);
+		}
+
+		m_partialLength += static_cast<unsigned int>(length);
+		if (m_partialLength == rate)
+		{
+			AbsorbBlocks(plaintext, 1);
+			m_partialLength = 0;
+		}
+
+		inString += length;
+		outString += length;
+		len -= length;
+	}
+
+	return 0;
+}
+
+void AEGIS_Base::AuthenticateLastConfidentialBlock()
+{
+	if (m_partialLength > 0)
+	{
+		byte *plaintext = PartialPlaintext();
+		std::memset(plaintext+m_partialLength, 0, RateSize()-m_partialLength);
+		AbsorbBlocks(plaintext, 1);
+		m_partialLength = 0;
+	}
+}
+
+void AEGIS_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
+{
+	CRYPTOPP_ASSERT(macSize <= m_digestSize);
+
+	FixedSizeSecBlock<byte, 32> tag;
+	FinalizeState(tag, m_totalHeaderLength*8, m_totalMessageLength*8);
+	std::memcpy(mac, tag, macSize);
+}
+
+SymmetricCipher & AEGIS_Base::AccessSymmetricCipher()
+{
+	// ProcessAndAuthenticateBlocks() consumes all of the message, so the
+	// separate cipher pass of AuthenticatedSymmetricCipherBase is not used.
+	CRYPTOPP_ASSERT(false);
+	throw NotImplemented(AlgorithmName() + ": AEGIS has no separate cipher pass");
+}
+
+////////////////////////////// AEGIS-128L //////////////////////////////
+
+void AEGIS128L_Base::InitializeState(const byte *key, const byte *iv)
+{
+	byte *s = m_state;
+	xorbuf(s+0*16, key, iv, 16);
+	std::memcpy(s+1*16, C1, 16);
+	std::memcpy(s+2*16, C0, 16);
+	std::memcpy(s+3*16, C1, 16);
+	xorbuf(s+4*16, key, iv, 16);
+	xorbuf(s+5*16, key, C0, 16);
+	xorbuf(s+6*16, key, C1, 16);
+	xorbuf(s+7*16, key, C0, 16);
+
+	// Ten updates with M0 = N and M1 = K
+	FixedSizeSecBlock<byte, 10*32> blocks;
+	for (unsigned int i=0; i<10; ++i)
+	{
+		std::memcpy(blocks+i*32, iv, 16);
+		std::memcpy(blocks+i*32+16, key, 16);
+	}
+	AbsorbBlocks(blocks, 10);
+}
+
+void AEGIS128L_Base::AbsorbBlocks(const byte *in, size_t blocks)
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return AEGIS128L_Absorb_AESNI(m_state, in, blocks);
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return AEGIS128L_Absorb_ARMV8(m_state, in, blocks);
+#endif
+
+	for (size_t i=0; i<blocks; ++i, in+=32)
+		Update128L_CXX(m_state, in, in+16);
+}
+
+void AEGIS128L_Base::EncryptBlocks(byte *out, const byte *in, size_t blocks)
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return AEGIS128L_Encrypt_AESNI(m_state, out, in, blocks);
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return AEGIS128L_Encrypt_ARMV8(m_state, out, in, blocks);
+#endif
+
+	byte z[32], m[32];
+	for (size_t i=0; i<blocks; ++i, in+=32, out+=32)
+	{
+		Keystream(z);
+		std::memcpy(m, in, 32);
+		xorbuf(out, m, z, 32);
+		Update128L_CXX(m_state, m, m+16);
+	}
+}
+
+void AEGIS128L_Base::DecryptBlocks(byte *out, const byte *in, size_t blocks)
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return AEGIS128L_Decrypt_AESNI(m_state, out, in, blocks);
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return AEGIS128L_Decrypt_ARMV8(m_state, out, in, blocks);
+#endif
+
+	byte z[32];
+	for (size_t i=0; i<blocks; ++i, in+=32, out+=32)
+	{
+		Keystream(z);
+		xorbuf(out, in, z, 32);
+		Update128L_CXX(m_state, out, out+16);
+	}
+}
+
+void AEGIS128L_Base::Keystream(byte *z) const
+{
+	// z0 = S6 ^ S1 ^ (S2 & S3), z1 = S2 ^ S5 ^ (S6 & S7)
+	const byte *s = m_state;
+	KeystreamWord(z+0, s+6*16, s+1*16, s+2*16, s+3*16);
+	KeystreamWord(z+16, s+2*16, s+5*16, s+6*16, s+7*16);
+}
+
+void AEGIS128L_Base::FinalizeState(byte *tag, word64 headerBits, word64 messageBits)
+{
+	// Seven updates with M0 = M1 = S2 ^ (LE64(adlen) || LE64(msglen))
+	byte t[16];
+	LengthBlock(t, headerBits, messageBits);
+	xorbuf(t, m_state+2*16, 16);
+
+	byte blocks[7*32];
+	for (unsigned int i=0; i<14; ++i)
+		std::memcpy(blocks+i*16, t, 16);
+	AbsorbBlocks(blocks, 7);
+
+	const byte *s = m_state;
+	if (m_digestSize == 16)
+	{
+		std::memcpy(tag, s, 16);
+		for (unsigned int i=1; i<7; ++i)
+			xorbuf(tag, s+i*16, 16);
+	}
+	else
+	{
+		xorbuf(tag, s+0*16, s+1*16, 16);
+		xorbuf(tag, s+2*16, 16);
+		xorbuf(tag, s+3*16, 16);
+		xorbuf(tag+16, s+4*16, s+5*16, 16);
+		xorbuf(tag+16, s+6*16, 16);
+		xorbuf(tag+16, s+7*16, 16);
+	}
+}
+
+////////////////////////////// AEGIS-256 //////////////////////////////
+
+void AEGIS256_Base::InitializeState(const byte *key, const byte *iv)
+{
+	byte *s = m_state;
+	xorbuf(s+0*16, key, iv, 16);
+	xorbuf(s+1*16, key+16, iv+16, 16);
+	std::memcpy(s+2*16, C1, 16);
+	std::memcpy(s+3*16, C0, 16);
+	xorbuf(s+4*16, key, C0, 16);
+	xorbuf(s+5*16, key+16, C1, 16);
+
+	// Four rounds of updates with K0, K1, K0 ^ N0 and K1 ^ N1
+	FixedSizeSecBlock<byte, 16*16> blocks;
+	for (unsigned int i=0; i<4; ++i)
+	{
+		std::memcpy(blocks+i*64+0, key, 16);
+		std::memcpy(blocks+i*64+16, key+16, 16);
+		xorbuf(blocks+i*64+32, key, iv, 16);
+		xorbuf(blocks+i*64+48, key+16, iv+16, 16);
+	}
+	AbsorbBlocks(blocks, 16);
+}
+
+void AEGIS256_Base::AbsorbBlocks(const byte *in, size_t blocks)
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return AEGIS256_Absorb_AESNI(m_state, in, blocks);
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return AEGIS256_Absorb_ARMV8(m_state, in, blocks);
+#endif
+
+	for (size_t i=0; i<blocks; ++i, in+=16)
+		Update256_CXX(m_state, in);
+}
+
+void AEGIS256_Base::EncryptBlocks(byte *out, const byte *in, size_t blocks)
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return AEGIS256_Encrypt_AESNI(m_state, out, in, blocks);
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return AEGIS256_Encrypt_ARMV8(m_state, out, in, blocks);
+#endif
+
+	byte z[16], m[16];
+	for (size_t i=0; i<blocks; ++i, in+=16, out+=16)
+	{
+		Keystream(z);
+		std::memcpy(m, in, 16);
+		xorbuf(out, m, z, 16);
+		Update256_CXX(m_state, m);
+	}
+}
+
+void AEGIS256_Base::DecryptBlocks(byte *out, const byte *in, size_t blocks)
+{
+#if (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAESNI())
+		return AEGIS256_Decrypt_AESNI(m_state, out, in, blocks);
+#endif
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+		return AEGIS256_Decrypt_ARMV8(m_state, out, in, blocks);
+#endif
+
+	byte z[16];
+	for (size_t i=0; i<blocks; ++i, in+=16, out+=16)
+	{
+		Keystream(z);
+		xorbuf(out, in, z, 16);
+		Update256_CXX(m_state, out);
+	}
+}
+
+void AEGIS256_Base::Keystream(byte *z) const
+{
+	// z = S1 ^ S4 ^ S5 ^ (S2 & S3)
+	const byte *s = m_state;
+	KeystreamWord(z, s+1*16, s+4*16, s+2*16, s+3*16);
+	xorbuf(z, s+5*16, 16);
+}
+
+void AEGIS256_Base::FinalizeState(byte *tag, word64 headerBits, word64 messageBits)
+{
+	// Seven updates with M = S3 ^ (LE64(adlen) || LE64(msglen))
+	byte t[16];
+	LengthBlock(t, headerBits, messageBits);
+	xorbuf(t, m_state+3*16, 16);
+
+	byte blocks[7*16];
+	for (unsigned int i=0; i<7; ++i)
+		std::memcpy(blocks+i*16, t, 16);
+	AbsorbBlocks(blocks, 7);
+
+	const byte *s = m_state;
+	if (m_digestSize == 16)
+	{
+		std::memcpy(tag, s, 16);
+		for (unsigned int i=1; i<6; ++i)
+			xorbuf(tag, s+i*16, 16);
+	}
+	else
+	{
+		xorbuf(tag, s+0*16, s+1*16, 16);
+		xorbuf(tag, s+2*16, 16);
+		xorbuf(tag+16, s+3*16, s+4*16, 16);
+		xorbuf(tag+16, s+5*16, 16);
+	}
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_IMPORTS
@@ -0,0 +1,229 @@
+// aegis.h - written and placed in the public domain by the Crypto++ project
+
+/// \file aegis.h
+/// \brief AEGIS-128L and AEGIS-256 authenticated encryption
+/// \details AEGIS is a family of authenticated encryption schemes built on the
+///   AES round function. The state is updated with one AES round per state
+///   word for each block of input, so AEGIS runs at several times the speed of
+///   AES-GCM on processors with AES instructions.
+/// \details The library provides AES-NI and ARMv8 Crypto implementations, and a
+///   portable implementation for other processors. The portable implementation
+///   uses table lookups and is not constant time.
+/// \sa <A HREF="https://datatracker.ietf.org/doc/draft-irtf-cfrg-aegis-aead/">The
+///   AEGIS Family of Authenticated Encryption Algorithms</A>
+/// \since Crypto++ 8.5
+
+#ifndef CRYPTOPP_AEGIS_H
+#define CRYPTOPP_AEGIS_H
+
+#include "authenc.h"
+#include "seckey.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/// \brief AEGIS cipher base implementation
+/// \details Base implementation of the AuthenticatedSymmetricCipher interface.
+///   AEGIS_Base handles the header and message streams, and the derived classes
+///   provide the state update of AEGIS-128L and AEGIS-256.
+/// \details ProcessData() may be called with any length. A partial block is
+///   encrypted or decrypted with the keystream of the block, and the block is
+///   absorbed into the state once it is complete or the message ends.
+/// \since Crypto++ 8.5
+class CRYPTOPP_NO_VTABLE AEGIS_Base : public AuthenticatedSymmetricCipherBase
+{
+public:
+	AEGIS_Base() : m_digestSize(0), m_partialLength(0) {}
+	virtual ~AEGIS_Base() {}
+
+	// AuthenticatedSymmetricCipher
+	std::string AlgorithmProvider() const;
+	size_t MinKeyLength() const
+		{return KeySize();}
+	size_t MaxKeyLength() const
+		{return KeySize();}
+	size_t DefaultKeyLength() const
+		{return KeySize();}
+	size_t GetValidKeyLength(size_t n) const
+		{CRYPTOPP_UNUSED(n); return KeySize();}
+	bool IsValidKeyLength(size_t n) const
+		{return n==KeySize();}
+	unsigned int OptimalDataAlignment() const
+		{return 1;}
+	IV_Requirement IVRequirement() const
+		{return UNIQUE_IV;}
+	unsigned int IVSize() const
+		{return KeySize();}
+	unsigned int MinIVLength() const
+		{return KeySize();}
+	unsigned int MaxIVLength() const
+		{return KeySize();}
+	unsigned int DigestSize() const
+		{return m_digestSize;}
+	lword MaxHeaderLength() const
+		{return W64LIT(0x1fffffffffffffff);}  // 2^61-1 bytes
+	lword MaxMessageLength() const
+		{return W64LIT(0x1fffffffffffffff);}  // 2^61-1 bytes
+	lword MaxFooterLength() const
+		{return 0;}
+
+	// StreamTransformation
+	unsigned int OptimalBlockSize() const
+		{return 8*RateSize();}
+
+protected:
+	// AuthenticatedSymmetricCipherBase
+	bool AuthenticationIsOnPlaintext() const
+		{return true;}
+	unsigned int AuthenticationBlockSize() const
+		{return RateSize();}
+	void SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params);
+	void Resync(const byte *iv, size_t len);
+	size_t AuthenticateBlocks(const byte *data, size_t len);
+	void AuthenticateLastHeaderBlock();
+	void AuthenticateLastConfidentialBlock();
+	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	size_t ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len);
+	SymmetricCipher & AccessSymmetricCipher();
+
+	/// \brief Key and nonce size, in bytes
+	virtual unsigned int KeySize() const =0;
+	/// \brief Bytes absorbed by one state update
+	virtual unsigned int RateSize() const =0;
+
+	// State initialization from the key and nonce
+	virtual void InitializeState(const byte *key, const byte *iv) =0;
+	// Absorbs blocks of RateSize() bytes
+	virtual void AbsorbBlocks(const byte *in, size_t blocks) =0;
+	// Encrypts or decrypts blocks of RateSize() bytes, and absorbs the plaintext
+	virtual void EncryptBlocks(byte *out, const byte *in, size_t blocks) =0;
+	virtual void DecryptBlocks(byte *out, const byte *in, size_t blocks) =0;
+	// Keystream of the next block, without updating the state
+	virtual void Keystream(byte *z) const =0;
+	// Runs the finalization and produces a tag of DigestSize() bytes
+	virtual void FinalizeState(byte *tag, word64 headerBits, word64 messageBits) =0;
+
+	// Plaintext and keystream of a partial message block. The header buffer
+	// of AuthenticatedSymmetricCipherBase is at the front of m_buffer.
+	byte *PartialPlaintext() {return m_buffer+RateSize();}
+	byte *PartialKeystream() {return m_buffer+2*RateSize();}
+
+	FixedSizeAlignedSecBlock<byte, 8*16> m_state;
+	FixedSizeSecBlock<byte, 32> m_key;
+	unsigned int m_digestSize, m_partialLength;
+};
+
+/// \brief AEGIS-128L base implementation
+/// \details AEGIS-128L uses a 128-bit key and nonce, and eight 128-bit state words.
+///   It absorbs 32 bytes per update.
+/// \since Crypto++ 8.5
+class CRYPTOPP_NO_VTABLE AEGIS128L_Base : public AEGIS_Base
+{
+public:
+	CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName()
+		{return "AEGIS-128L";}
+
+	virtual ~AEGIS128L_Base() {}
+
+	std::string AlgorithmName() const
+		{return std::string("AEGIS-128L");}
+
+protected:
+	unsigned int KeySize() const {return 16;}
+	unsigned int RateSize() const {return 32;}
+
+	void InitializeState(const byte *key, const byte *iv);
+	void AbsorbBlocks(const byte *in, size_t blocks);
+	void EncryptBlocks(byte *out, const byte *in, size_t blocks);
+	void DecryptBlocks(byte *out, const byte *in, size_t blocks);
+	void Keystream(byte *z) const;
+	void FinalizeState(byte *tag, word64 headerBits, word64 messageBits);
+};
+
+/// \brief AEGIS-256 base implementation
+/// \details AEGIS-256 uses a 256-bit key and nonce, and six 128-bit state words.
+///   It absorbs 16 bytes per update.
+/// \since Crypto++ 8.5
+class CRYPTOPP_NO_VTABLE AEGIS256_Base : public AEGIS_Base
+{
+public:
+	CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName()
+		{return "AEGIS-256";}
+
+	virtual ~AEGIS256_Base() {}
+
+	std::string AlgorithmName() const
+		{return std::string("AEGIS-256");}
+
+protected:
+	unsigned int KeySize() const {return 32;}
+	unsigned int RateSize() const {return 16;}
+
+	void InitializeState(const byte *key, const byte *iv);
+	void AbsorbBlocks(const byte *in, size_t blocks);
+	void EncryptBlocks(byte *out, const byte *in, size_t blocks);
+	void DecryptBlocks(byte *out, const byte *in, size_t blocks);
+	void Keystream(byte *z) const;
+	void FinalizeState(byte *tag, word64 headerBits, word64 messageBits);
+};
+
+/// \brief AEGIS-128L final implementation
+/// \tparam T_IsEncryption flag indicating cipher direction
+/// \since Crypto++ 8.5
+template <bool T_IsEncryption>
+class AEGIS128L_Final : public AEGIS128L_Base
+{
+public:
+	virtual ~AEGIS128L_Final() {}
+
+protected:
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+};
+
+/// \brief AEGIS-256 final implementation
+/// \tparam T_IsEncryption flag indicating cipher direction
+/// \since Crypto++ 8.5
+template <bool T_IsEncryption>
+class AEGIS256_Final : public AEGIS256_Base
+{
+public:
+	virtual ~AEGIS256_Final() {}
+
+protected:
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+};
+
+/// \brief AEGIS-128L authenticated encryption
+/// \details AEGIS-128L takes a 16-byte key and a 16-byte nonce. The tag is 16 bytes
+///   by default, and a 32-byte tag is selected with the Name::DigestSize() parameter.
+///   The two tag sizes are computed differently, so a 16-byte tag is not a
+///   truncated 32-byte tag.
+/// \sa <A HREF="https://datatracker.ietf.org/doc/draft-irtf-cfrg-aegis-aead/">The
+///   AEGIS Family of Authenticated Encryption Algorithms</A>
+/// \since Crypto++ 8.5
+struct AEGIS128L : public AuthenticatedSymmetricCipherDocumentation
+{
+	/// \brief AEGIS-128L encryption
+	typedef AEGIS128L_Final<true> Encryption;
+	/// \brief AEGIS-128L decryption
+	typedef AEGIS128L_Final<false> Decryption;
+};
+
+/// \brief AEGIS-256 authenticated encryption
+/// \details AEGIS-256 takes a 32-byte key and a 32-byte nonce. The tag is 16 bytes
+///   by default, and a 32-byte tag is selected with the Name::DigestSize() parameter.
+/// \sa <A HREF="https://datatracker.ietf.org/doc/draft-irtf-cfrg-aegis-aead/">The
+///   AEGIS Family of Authenticated Encryption Algorithms</A>
+/// \since Crypto++ 8.5
+struct AEGIS256 : public AuthenticatedSymmetricCipherDocumentation
+{
+	/// \brief AEGIS-256 encryption
+	typedef AEGIS256_Final<true> Encryption;
+	/// \brief AEGIS-256 decryption
+	typedef AEGIS256_Final<false> Decryption;
+};
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_AEGIS_H
@@ -0,0 +1,309 @@
+// aegis_simd.cpp - written and placed in the public domain by
+//                  the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AES-NI and
+//    ARMv8a AES instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    AEGIS updates each state word with a single AES round, which is
+//    the AESENC instruction on x86. ARMv8 splits the round differently.
+//    AESE adds the round key before SubBytes and ShiftRows, so the round
+//    is AESE with a zero key, then AESMC, then the xor of the key. The
+//    state stays in registers for the length of each call.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AESNI_AVAILABLE)
+# include <emmintrin.h>
+# include <smmintrin.h>
+# include <wmmintrin.h>
+#endif
+
+#if (CRYPTOPP_ARM_NEON_HEADER)
+# include <arm_neon.h>
+#endif
+
+#if (CRYPTOPP_ARM_ACLE_HEADER)
+# include <stdint.h>
+# include <arm_acle.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char AEGIS_SIMD_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+// ***************************** AES-NI ***************************** //
+
+#if (CRYPTOPP_AESNI_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+enum {AEGIS_ABSORB, AEGIS_ENCRYPT, AEGIS_DECRYPT};
+
+inline __m128i LoadBlock(const byte *p)
+{
+    return _mm_loadu_si128(CONST_M128_CAST(p));
+}
+
+inline void StoreBlock(byte *p, const __m128i &x)
+{
+    _mm_storeu_si128(M128_CAST(p), x);
+}
+
+inline void Update128L(__m128i s[8], const __m128i &m0, const __m128i &m1)
+{
+    const __m128i t = s[7];
+    s[7] = _mm_aesenc_si128(s[6], s[7]);
+    s[6] = _mm_aesenc_si128(s[5], s[6]);
+    s[5] = _mm_aesenc_si128(s[4], s[5]);
+    s[4] = _mm_aesenc_si128(s[3], _mm_xor_si128(s[4], m1));
+    s[3] = _mm_aesenc_si128(s[2], s[3]);
+    s[2] = _mm_aesenc_si128(s[1], s[2]);
+    s[1] = _mm_aesenc_si128(s[0], s[1]);
+    s[0] = _mm_aesenc_si128(t, _mm_xor_si128(s[0], m0));
+}
+
+inline void Update256(__m128i s[6], const __m128i &m)
+{
+    const __m128i t = s[5];
+    s[5] = _mm_aesenc_si128(s[4], s[5]);
+    s[4] = _mm_aesenc_si128(s[3], s[4]);
+    s[3] = _mm_aesenc_si128(s[2], s[3]);
+    s[2] = _mm_aesenc_si128(s[1], s[2]);
+    s[1] = _mm_aesenc_si128(s[0], s[1]);
+    s[0] = _mm_aesenc_si128(t, _mm_xor_si128(s[0], m));
+}
+
+template <unsigned int OP>
+inline void AEGIS128L_Process(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    __m128i s[8];
+    for (unsigned int i=0; i<8; ++i)
+        s[i] = LoadBlock(state+i*16);
+
+    for (size_t i=0; i<blocks; ++i, in+=32)
+    {
+        __m128i m0 = LoadBlock(in), m1 = LoadBlock(in+16);
+        if (OP != AEGIS_ABSORB)
+        {
+            // z0 = S6 ^ S1 ^ (S2 & S3), z1 = S2 ^ S5 ^ (S6 & S7)
+            const __m128i z0 = _mm_xor_si128(_mm_xor_si128(s[6], s[1]), _mm_and_si128(s[2], s[3]));
+            const __m128i z1 = _mm_xor_si128(_mm_xor_si128(s[2], s[5]), _mm_and_si128(s[6], s[7]));
+            const __m128i c0 = _mm_xor_si128(m0, z0), c1 = _mm_xor_si128(m1, z1);
+            StoreBlock(out, c0);
+            StoreBlock(out+16, c1);
+            out += 32;
+
+            if (OP == AEGIS_DECRYPT)
+                m0 = c0, m1 = c1;
+        }
+        Update128L(s, m0, m1);
+    }
+
+    for (unsigned int i=0; i<8; ++i)
+        StoreBlock(state+i*16, s[i]);
+}
+
+template <unsigned int OP>
+inline void AEGIS256_Process(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    __m128i s[6];
+    for (unsigned int i=0; i<6; ++i)
+        s[i] = LoadBlock(state+i*16);
+
+    for (size_t i=0; i<blocks; ++i, in+=16)
+    {
+        __m128i m = LoadBlock(in);
+        if (OP != AEGIS_ABSORB)
+        {
+            // z = S1 ^ S4 ^ S5 ^ (S2 & S3)
+            const __m128i z = _mm_xor_si128(_mm_xor_si128(s[1], s[4]),
+                _mm_xor_si128(s[5], _mm_and_si128(s[2], s[3])));
+            const __m128i c = _mm_xor_si128(m, z);
+            StoreBlock(out, c);
+            out += 16;
+
+            if (OP == AEGIS_DECRYPT)
+                m = c;
+        }
+        Update256(s, m);
+    }
+
+    for (unsigned int i=0; i<6; ++i)
+        StoreBlock(state+i*16, s[i]);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void AEGIS128L_Absorb_AESNI(byte *state, const byte *in, size_t blocks)
+{
+    AEGIS128L_Process<AEGIS_ABSORB>(state, NULLPTR, in, blocks);
+}
+
+void AEGIS128L_Encrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS128L_Process<AEGIS_ENCRYPT>(state, out, in, blocks);
+}
+
+void AEGIS128L_Decrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS128L_Process<AEGIS_DECRYPT>(state, out, in, blocks);
+}
+
+void AEGIS256_Absorb_AESNI(byte *state, const byte *in, size_t blocks)
+{
+    AEGIS256_Process<AEGIS_ABSORB>(state, NULLPTR, in, blocks);
+}
+
+void AEGIS256_Encrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS256_Process<AEGIS_ENCRYPT>(state, out, in, blocks);
+}
+
+void AEGIS256_Decrypt_AESNI(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS256_Process<AEGIS_DECRYPT>(state, out, in, blocks);
+}
+
+#endif  // CRYPTOPP_AESNI_AVAILABLE
+
+// ***************************** ARMv8 ***************************** //
+
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+enum {AEGIS_ABSORB, AEGIS_ENCRYPT, AEGIS_DECRYPT};
+
+// AESENC equivalent, MixColumns(ShiftRows(SubBytes(x))) ^ k
+inline uint8x16_t AESRound(const uint8x16_t &x, const uint8x16_t &k)
+{
+    return veorq_u8(vaesmcq_u8(vaeseq_u8(x, vdupq_n_u8(0))), k);
+}
+
+inline void Update128L(uint8x16_t s[8], const uint8x16_t &m0, const uint8x16_t &m1)
+{
+    const uint8x16_t t = s[7];
+    s[7] = AESRound(s[6], s[7]);
+    s[6] = AESRound(s[5], s[6]);
+    s[5] = AESRound(s[4], s[5]);
+    s[4] = AESRound(s[3], veorq_u8(s[4], m1));
+    s[3] = AESRound(s[2], s[3]);
+    s[2] = AESRound(s[1], s[2]);
+    s[1] = AESRound(s[0], s[1]);
+    s[0] = AESRound(t, veorq_u8(s[0], m0));
+}
+
+inline void Update256(uint8x16_t s[6], const uint8x16_t &m)
+{
+    const uint8x16_t t = s[5];
+    s[5] = AESRound(s[4], s[5]);
+    s[4] = AESRound(s[3], s[4]);
+    s[3] = AESRound(s[2], s[3]);
+    s[2] = AESRound(s[1], s[2]);
+    s[1] = AESRound(s[0], s[1]);
+    s[0] = AESRound(t, veorq_u8(s[0], m));
+}
+
+template <unsigned int OP>
+inline void AEGIS128L_Process(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    uint8x16_t s[8];
+    for (unsigned int i=0; i<8; ++i)
+        s[i] = vld1q_u8(state+i*16);
+
+    for (size_t i=0; i<blocks; ++i, in+=32)
+    {
+        uint8x16_t m0 = vld1q_u8(in), m1 = vld1q_u8(in+16);
+        if (OP != AEGIS_ABSORB)
+        {
+            // z0 = S6 ^ S1 ^ (S2 & S3), z1 = S2 ^ S5 ^ (S6 & S7)
+            const uint8x16_t z0 = veorq_u8(veorq_u8(s[6], s[1]), vandq_u8(s[2], s[3]));
+            const uint8x16_t z1 = veorq_u8(veorq_u8(s[2], s[5]), vandq_u8(s[6], s[7]));
+            const uint8x16_t c0 = veorq_u8(m0, z0), c1 = veorq_u8(m1, z1);
+            vst1q_u8(out, c0);
+            vst1q_u8(out+16, c1);
+            out += 32;
+
+            if (OP == AEGIS_DECRYPT)
+                m0 = c0, m1 = c1;
+        }
+        Update128L(s, m0, m1);
+    }
+
+    for (unsigned int i=0; i<8; ++i)
+        vst1q_u8(state+i*16, s[i]);
+}
+
+template <unsigned int OP>
+inline void AEGIS256_Process(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    uint8x16_t s[6];
+    for (unsigned int i=0; i<6; ++i)
+        s[i] = vld1q_u8(state+i*16);
+
+    for (size_t i=0; i<blocks; ++i, in+=16)
+    {
+        uint8x16_t m = vld1q_u8(in);
+        if (OP != AEGIS_ABSORB)
+        {
+            // z = S1 ^ S4 ^ S5 ^ (S2 & S3)
+            const uint8x16_t z = veorq_u8(veorq_u8(s[1], s[4]),
+                veorq_u8(s[5], vandq_u8(s[2], s[3])));
+            const uint8x16_t c = veorq_u8(m, z);
+            vst1q_u8(out, c);
+            out += 16;
+
+            if (OP == AEGIS_DECRYPT)
+                m = c;
+        }
+        Update256(s, m);
+    }
+
+    for (unsigned int i=0; i<6; ++i)
+        vst1q_u8(state+i*16, s[i]);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void AEGIS128L_Absorb_ARMV8(byte *state, const byte *in, size_t blocks)
+{
+    AEGIS128L_Process<AEGIS_ABSORB>(state, NULLPTR, in, blocks);
+}
+
+void AEGIS128L_Encrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS128L_Process<AEGIS_ENCRYPT>(state, out, in, blocks);
+}
+
+void AEGIS128L_Decrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS128L_Process<AEGIS_DECRYPT>(state, out, in, blocks);
+}
+
+void AEGIS256_Absorb_ARMV8(byte *state, const byte *in, size_t blocks)
+{
+    AEGIS256_Process<AEGIS_ABSORB>(state, NULLPTR, in, blocks);
+}
+
+void AEGIS256_Encrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS256_Process<AEGIS_ENCRYPT>(state, out, in, blocks);
+}
+
+void AEGIS256_Decrypt_ARMV8(byte *state, byte *out, const byte *in, size_t blocks)
+{
+    AEGIS256_Process<AEGIS_DECRYPT>(state, out, in, blocks);
+}
+
+#endif  // CRYPTOPP_ARM_AES_AVAILABLE
+
+NAMESPACE_END
@@ -47,6 +47,8 @@ CRYPTOPP_DEFINE_NAME_STRING(ModPrime2PrivateExponent)	///< Integer
 CRYPTOPP_DEFINE_NAME_STRING(MultiplicativeInverseOfPrime2ModPrime1)	///< Integer
 CRYPTOPP_DEFINE_NAME_STRING(QuadraticResidueModPrime1)	///< Integer
 CRYPTOPP_DEFINE_NAME_STRING(QuadraticResidueModPrime2)	///< Integer
+CRYPTOPP_DEFINE_NAME_STRING(PrimeCount)			///< int, number of prime factors of an RSA modulus
+CRYPTOPP_DEFINE_NAME_STRING(ThreadCount)			///< int, number of worker threads, 0 for one per processor
 CRYPTOPP_DEFINE_NAME_STRING(PutMessage)			///< bool
 CRYPTOPP_DEFINE_NAME_STRING(TruncatedDigestSize)	///< int
 CRYPTOPP_DEFINE_NAME_STRING(BlockPaddingScheme)	///< StreamTransformationFilter::BlockPaddingScheme
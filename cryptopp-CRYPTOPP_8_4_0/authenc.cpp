@@ -126,12 +126,26 @@ reswitch:
 		m_state = AuthenticationIsOnPlaintext()==IsForwardTransformation() ? State_AuthUntransformed : State_AuthTransformed;
 		goto reswitch;
 	case State_AuthUntransformed:
-		AuthenticateData(inString, length);
-		AccessSymmetricCipher().ProcessData(outString, inString, length);
-		break;
 	case State_AuthTransformed:
-		AccessSymmetricCipher().ProcessData(outString, inString, length);
-		AuthenticateData(outString, length);
+		if (m_bufferedDataLength == 0)
+		{
+			const size_t leftOver = ProcessAndAuthenticateBlocks(outString, inString, length);
+			outString = PtrAdd(outString, length - leftOver);
+			inString = PtrAdd(inString, length - leftOver);
+			length = leftOver;
+			if (!length) {break;}
+		}
+
+		if (m_state == State_AuthUntransformed)
+		{
+			AuthenticateData(inString, length);
+			AccessSymmetricCipher().ProcessData(outString, inString, length);
+		}
+		else
+		{
+			AccessSymmetricCipher().ProcessData(outString, inString, length);
+			AuthenticateData(outString, length);
+		}
 		break;
 	default:
 		CRYPTOPP_ASSERT(false);
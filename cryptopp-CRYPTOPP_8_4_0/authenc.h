@@ -72,6 +72,19 @@ protected:
 	virtual void AuthenticateLastConfidentialBlock() {}
 	virtual void AuthenticateLastFooterBlock(byte *mac, size_t macSize) =0;
 
+	/// \brief Transform and authenticate data in a single pass
+	/// \param outString the output buffer
+	/// \param inString the input buffer
+	/// \param len the size of the buffers, in bytes
+	/// \returns the number of bytes that were not processed
+	/// \details ProcessAndAuthenticateBlocks() allows a mode to combine encryption
+	///   or decryption with authentication when no partial authentication block is
+	///   buffered. Processed bytes are consumed from the front of the buffers, and the
+	///   remainder goes through the separate cipher and authentication passes. The
+	///   default implementation processes nothing.
+	virtual size_t ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len)
+		{CRYPTOPP_UNUSED(outString), CRYPTOPP_UNUSED(inString); return len;}
+
 	// State_AuthUntransformed: authentication is applied to plain text (Authenticate-then-Encrypt)
 	// State_AuthTransformed: authentication is applied to cipher text (Encrypt-then-Authenticate)
 	enum State {State_Start, State_KeySet, State_IVSet, State_AuthUntransformed, State_AuthTransformed, State_AuthFooter};
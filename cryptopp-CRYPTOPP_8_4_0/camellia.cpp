@@ -25,6 +25,14 @@ See comments at top of rijndael.cpp for more details.
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if CRYPTOPP_CAMELLIA_ADVANCED_PROCESS_BLOCKS
+# if (CRYPTOPP_AVX2_AVAILABLE) && (CRYPTOPP_AESNI_AVAILABLE)
+extern size_t Camellia_AdvancedProcessBlocks_AVX2(const word32 *subKeys, const word32 *sp,
+    unsigned int rounds, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks,
+    size_t length, word32 flags);
+# endif
+#endif  // CRYPTOPP_CAMELLIA_ADVANCED_PROCESS_BLOCKS
+
 // round implementation that uses a small table for protection against timing attacks
 #define SLOW_ROUND(lh, ll, rh, rl, kh, kl)	{							\
 	word32 zr = ll ^ kl;												\
@@ -247,6 +255,19 @@ void Camellia::Base::ProcessAndXorBlock(const byte *inBlock, const byte *xorBloc
 	Block::Put(xorBlock, outBlock)(rh)(rl)(lh)(ll);
 }
 
+#if CRYPTOPP_CAMELLIA_ADVANCED_PROCESS_BLOCKS
+size_t Camellia::Base::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+		byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE) && (CRYPTOPP_AESNI_AVAILABLE)
+	if (HasAVX2() && HasAESNI())
+		return Camellia_AdvancedProcessBlocks_AVX2(m_key, SP[0], m_rounds,
+			inBlocks, xorBlocks, outBlocks, length, flags);
+# endif
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_CAMELLIA_ADVANCED_PROCESS_BLOCKS
+
 // The Camellia s-boxes
 
 CRYPTOPP_ALIGN_DATA(4)
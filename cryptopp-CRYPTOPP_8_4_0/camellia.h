@@ -10,6 +10,10 @@
 #include "seckey.h"
 #include "secblock.h"
 
+#if (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86)
+# define CRYPTOPP_CAMELLIA_ADVANCED_PROCESS_BLOCKS 1
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 /// \brief Camellia block cipher information
@@ -20,6 +24,9 @@ struct Camellia_Info : public FixedBlockSize<16>, public VariableKeyLength<16, 1
 
 /// \brief Camellia block cipher
 /// \sa <a href="http://www.cryptopp.com/wiki/Camellia">Camellia</a>
+/// \details Since Crypto++ 8.5 AdvancedProcessBlocks() processes eight blocks
+///  at a time with AVX2 and AES-NI when the processor supports it. The
+///  S-boxes are computed with AESENCLAST instead of table lookups.
 class Camellia : public Camellia_Info, public BlockCipherDocumentation
 {
 	class CRYPTOPP_NO_VTABLE Base : public BlockCipherImpl<Camellia_Info>
@@ -27,6 +34,9 @@ class Camellia : public Camellia_Info, public BlockCipherDocumentation
 	public:
 		void UncheckedSetKey(const byte *key, unsigned int keylen, const NameValuePairs &params);
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_CAMELLIA_ADVANCED_PROCESS_BLOCKS
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
 
 	protected:
 		CRYPTOPP_ALIGN_DATA(4) static const byte s1[256];
@@ -0,0 +1,341 @@
+// camellia_avx.cpp - written and placed in the public domain by
+//                    the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2 and
+//    AES-NI instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernel transposes eight blocks so that each ymm register holds
+//    one big-endian word of every block. The Camellia S-box s1 is affine
+//    equivalent to the AES S-box, s1(x) = B(SubBytes(A(x))), so the
+//    S-boxes are computed with AESENCLAST and a pair of 4-bit PSHUFB
+//    lookups for each affine map. s2, s3 and s4 are rotations of the
+//    input or output of s1 and get their own lookup tables. The byte
+//    dependent tables are selected with a blend. The P-function is a
+//    few byte shuffles. The eight block path does not use memory
+//    lookups, so it runs in constant time. The single block path uses
+//    the ordinary SP tables.
+
+#include "pch.h"
+#include "config.h"
+
+#include "camellia.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX2_AVAILABLE) && (CRYPTOPP_AESNI_AVAILABLE)
+# include "adv_simd.h"
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <wmmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char CAMELLIA_AVX_FNAME[] = __FILE__;
+
+#if (CRYPTOPP_AVX2_AVAILABLE) && (CRYPTOPP_AESNI_AVAILABLE)
+
+NAMESPACE_BEGIN(CryptoPP)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::rotlConstant;
+using CryptoPP::rotrConstant;
+
+// Word i of eight blocks
+struct Word8
+{
+    Word8() {}
+    Word8(const __m256i &x) : v(x) {}
+
+    __m256i v;
+};
+
+inline Word8 operator^(const Word8 &x, const Word8 &y)
+{
+    return _mm256_xor_si256(x.v, y.v);
+}
+
+// Subkey words are the same for all blocks
+inline Word8 operator^(const Word8 &x, word32 k)
+{
+    return _mm256_xor_si256(x.v, _mm256_set1_epi32(static_cast<int>(k)));
+}
+
+inline Word8 operator&(const Word8 &x, word32 k)
+{
+    return _mm256_and_si256(x.v, _mm256_set1_epi32(static_cast<int>(k)));
+}
+
+inline Word8 operator|(const Word8 &x, word32 k)
+{
+    return _mm256_or_si256(x.v, _mm256_set1_epi32(static_cast<int>(k)));
+}
+
+template <unsigned int R>
+inline Word8 rotlConstant(const Word8 &x)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(x.v, R), _mm256_srli_epi32(x.v, 32-R));
+}
+
+// Byte rotations of each 32-bit word
+inline __m256i RotL8(const __m256i &x)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        3,0,1,2, 7,4,5,6, 11,8,9,10, 15,12,13,14,
+        3,0,1,2, 7,4,5,6, 11,8,9,10, 15,12,13,14);
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+inline __m256i RotR8(const __m256i &x)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12,
+        1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12);
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+inline __m256i RotL16(const __m256i &x)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        2,3,0,1, 6,7,4,5, 10,11,8,9, 14,15,12,13,
+        2,3,0,1, 6,7,4,5, 10,11,8,9, 14,15,12,13);
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+// Applies the affine map given by a pair of 4-bit tables to each byte
+#define CAMELLIA_AFFINE(lo, hi, tlo, thi) \
+    _mm256_xor_si256( \
+        _mm256_shuffle_epi8(_mm256_setr_epi8 tlo, lo), \
+        _mm256_shuffle_epi8(_mm256_setr_epi8 thi, hi))
+
+#define CAMELLIA_TABLE(t0,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10,t11,t12,t13,t14,t15) \
+    (t0,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10,t11,t12,t13,t14,t15, \
+     t0,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10,t11,t12,t13,t14,t15)
+
+// Applies s1 to byte 3, s2 to byte 2, s3 to byte 1 and s4 to byte 0
+// of each 32-bit word. s2(x) = s1(x) <<< 1, s3(x) = s1(x) >>> 1 and
+// s4(x) = s1(x <<< 1).
+inline __m256i Camellia_SBox(const __m256i &x)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i byte0 = _mm256_set1_epi32(0x000000ff);
+    const __m256i byte1 = _mm256_set1_epi32(0x0000ff00);
+    const __m256i byte2 = _mm256_set1_epi32(0x00ff0000);
+
+    __m256i lo = _mm256_and_si256(x, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+
+    // A(x) and A(x <<< 1)
+    const __m256i a1 = CAMELLIA_AFFINE(lo, hi,
+        CAMELLIA_TABLE(0x08,0x09,0x11,0x10,0xb9,0xb8,0xa0,0xa1,0xa3,0xa2,0xba,0xbb,0x12,0x13,0x0b,0x0a),
+        CAMELLIA_TABLE(0x00,0xa7,0x93,0x34,0x61,0xc6,0xf2,0x55,0xd9,0x7e,0x4a,0xed,0xb8,0x1f,0x2b,0x8c));
+    const __m256i a4 = CAMELLIA_AFFINE(lo, hi,
+        CAMELLIA_TABLE(0x08,0x11,0xb9,0xa0,0xa3,0xba,0x12,0x0b,0xaf,0xb6,0x1e,0x07,0x04,0x1d,0xb5,0xac),
+        CAMELLIA_TABLE(0x00,0x93,0x61,0xf2,0xd9,0x4a,0xb8,0x2b,0x01,0x92,0x60,0xf3,0xd8,0x4b,0xb9,0x2a));
+    __m256i t = _mm256_blendv_epi8(a1, a4, byte0);
+
+    // AESENCLAST applies ShiftRows after SubBytes, so undo it beforehand
+    const __m256i invShiftRows = _mm256_setr_epi8(
+        0,13,10,7, 4,1,14,11, 8,5,2,15, 12,9,6,3,
+        0,13,10,7, 4,1,14,11, 8,5,2,15, 12,9,6,3);
+    t = _mm256_shuffle_epi8(t, invShiftRows);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i t0 = _mm_aesenclast_si128(_mm256_castsi256_si128(t), zero);
+    const __m128i t1 = _mm_aesenclast_si128(_mm256_extracti128_si256(t, 1), zero);
+    t = _mm256_inserti128_si256(_mm256_castsi128_si256(t0), t1, 1);
+
+    lo = _mm256_and_si256(t, nibble);
+    hi = _mm256_and_si256(_mm256_srli_epi16(t, 4), nibble);
+
+    // B(y), B(y) <<< 1 and B(y) >>> 1
+    const __m256i b1 = CAMELLIA_AFFINE(lo, hi,
+        CAMELLIA_TABLE(0x11,0x82,0x84,0x17,0x3e,0xad,0xab,0x38,0x71,0xe2,0xe4,0x77,0x5e,0xcd,0xcb,0x58),
+        CAMELLIA_TABLE(0x00,0xb8,0xd9,0x61,0xa0,0x18,0x79,0xc1,0xa8,0x10,0x71,0xc9,0x08,0xb0,0xd1,0x69));
+    const __m256i b2 = CAMELLIA_AFFINE(lo, hi,
+        CAMELLIA_TABLE(0x22,0x05,0x09,0x2e,0x7c,0x5b,0x57,0x70,0xe2,0xc5,0xc9,0xee,0xbc,0x9b,0x97,0xb0),
+        CAMELLIA_TABLE(0x00,0x71,0xb3,0xc2,0x41,0x30,0xf2,0x83,0x51,0x20,0xe2,0x93,0x10,0x61,0xa3,0xd2));
+    const __m256i b3 = CAMELLIA_AFFINE(lo, hi,
+        CAMELLIA_TABLE(0x88,0x41,0x42,0x8b,0x1f,0xd6,0xd5,0x1c,0xb8,0x71,0x72,0xbb,0x2f,0xe6,0xe5,0x2c),
+        CAMELLIA_TABLE(0x00,0x5c,0xec,0xb0,0x50,0x0c,0xbc,0xe0,0x54,0x08,0xb8,0xe4,0x04,0x58,0xe8,0xb4));
+
+    return _mm256_blendv_epi8(_mm256_blendv_epi8(b1, b2, byte2), b3, byte1);
+}
+
+#undef CAMELLIA_AFFINE
+#undef CAMELLIA_TABLE
+
+// The P-function for S-box output in the layout of Camellia_SBox. Each
+// output byte is the xor of all four bytes except the one rotated in.
+inline __m256i Camellia_P(const __m256i &y)
+{
+    __m256i t = _mm256_xor_si256(y, RotL16(y));
+    t = _mm256_xor_si256(t, RotL8(t));
+    return _mm256_xor_si256(t, RotL8(y));
+}
+
+// Same result as ROUND in camellia.cpp. The S-box selection for the
+// low word is a byte rotation of the one for the high word.
+inline void Camellia_Round(Word8 &lh, Word8 &ll, Word8 &rh, Word8 &rl,
+    word32 kh, word32 kl, const word32 * /*sp*/)
+{
+    const __m256i th = (lh ^ kh).v;
+    const __m256i tl = RotR8((ll ^ kl).v);
+
+    const __m256i u = Camellia_P(Camellia_SBox(th));
+    const __m256i d = _mm256_xor_si256(Camellia_P(Camellia_SBox(tl)), u);
+
+    rh = rh ^ Word8(d);
+    rl = rl ^ Word8(_mm256_xor_si256(d, RotR8(u)));
+}
+
+// ROUND in camellia.cpp. sp is Camellia::Base::SP.
+inline void Camellia_Round(word32 &lh, word32 &ll, word32 &rh, word32 &rl,
+    word32 kh, word32 kl, const word32 *sp)
+{
+    const word32 th = lh ^ kh;
+    const word32 tl = ll ^ kl;
+    word32 d = sp[0*256+GETBYTE(tl,0)] ^ sp[1*256+GETBYTE(tl,3)] ^
+               sp[2*256+GETBYTE(tl,2)] ^ sp[3*256+GETBYTE(tl,1)];
+    const word32 u = sp[0*256+GETBYTE(th,3)] ^ sp[1*256+GETBYTE(th,2)] ^
+                     sp[2*256+GETBYTE(th,1)] ^ sp[3*256+GETBYTE(th,0)];
+    d ^= u;
+    rh ^= d;
+    rl ^= d;
+    rl ^= rotrConstant<8>(u);
+}
+
+// Subkey j of group i, see KS in camellia.cpp. x86 is little-endian.
+inline word32 KS(const word32 *ks, unsigned int i, unsigned int j)
+{
+    return ks[i*4 + (1-j/2)*2 + (1-j%2)];
+}
+
+template <class W>
+inline void Camellia_DoubleRound(W &lh, W &ll, W &rh, W &rl,
+    const word32 *ks, unsigned int i, const word32 *sp)
+{
+    Camellia_Round(lh, ll, rh, rl, KS(ks,i,0), KS(ks,i,1), sp);
+    Camellia_Round(rh, rl, lh, ll, KS(ks,i,2), KS(ks,i,3), sp);
+}
+
+// The round structure follows Camellia::Base::ProcessAndXorBlock. The
+// key schedule for decryption is stored reversed, so this is used in
+// both directions. The result is in rh, rl, lh, ll.
+template <class W>
+inline void Camellia_Process(W &lh, W &ll, W &rh, W &rl,
+    const word32 *ks, unsigned int rounds, const word32 *sp)
+{
+    lh = lh ^ KS(ks,0,0); ll = ll ^ KS(ks,0,1);
+    rh = rh ^ KS(ks,0,2); rl = rl ^ KS(ks,0,3);
+
+    Camellia_DoubleRound(lh, ll, rh, rl, ks, 1, sp);
+    for (unsigned int i = rounds-1; i > 0; --i)
+    {
+        Camellia_DoubleRound(lh, ll, rh, rl, ks, 2, sp);
+        Camellia_DoubleRound(lh, ll, rh, rl, ks, 3, sp);
+
+        // FL and FL^-1
+        ll = ll ^ rotlConstant<1>(lh & KS(ks,4,0));
+        lh = lh ^ (ll | KS(ks,4,1));
+        rh = rh ^ (rl | KS(ks,4,3));
+        rl = rl ^ rotlConstant<1>(rh & KS(ks,4,2));
+
+        Camellia_DoubleRound(lh, ll, rh, rl, ks, 5, sp);
+        ks += 16;
+    }
+    Camellia_DoubleRound(lh, ll, rh, rl, ks, 2, sp);
+    Camellia_DoubleRound(lh, ll, rh, rl, ks, 3, sp);
+
+    lh = lh ^ KS(ks,4,0); ll = ll ^ KS(ks,4,1);
+    rh = rh ^ KS(ks,4,2); rl = rl ^ KS(ks,4,3);
+}
+
+// Camellia words are big-endian
+inline __m128i ByteSwap(const __m128i &x)
+{
+    const __m128i mask = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+inline __m256i ByteSwap(const __m256i &x)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12,
+        3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+// Transposes the 4x4 word matrix in each lane. The transpose is its
+// own inverse, so it also turns the words back into blocks.
+inline void Transpose(__m256i &x0, __m256i &x1, __m256i &x2, __m256i &x3)
+{
+    const __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    const __m256i t1 = _mm256_unpackhi_epi32(x0, x1);
+    const __m256i t2 = _mm256_unpacklo_epi32(x2, x3);
+    const __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+
+    x0 = _mm256_unpacklo_epi64(t0, t2);
+    x1 = _mm256_unpackhi_epi64(t0, t2);
+    x2 = _mm256_unpacklo_epi64(t1, t3);
+    x3 = _mm256_unpackhi_epi64(t1, t3);
+}
+
+// Blocks i and i+4 share a register, one in each lane
+inline __m256i Combine(const __m128i &lo, const __m128i &hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+inline void Split(const __m256i &x, __m128i &lo, __m128i &hi)
+{
+    lo = _mm256_castsi256_si128(x);
+    hi = _mm256_extracti128_si256(x, 1);
+}
+
+// subkeys[0] is the key schedule and subkeys[1] the SP table
+inline void Camellia_Block(__m128i &block, const word32 *const *subkeys, unsigned int rounds)
+{
+    CRYPTOPP_ALIGN_DATA(16) word32 w[4];
+    _mm_store_si128(M128_CAST(w), ByteSwap(block));
+
+    word32 lh=w[0], ll=w[1], rh=w[2], rl=w[3];
+    Camellia_Process(lh, ll, rh, rl, subkeys[0], rounds, subkeys[1]);
+
+    block = ByteSwap(_mm_set_epi32(static_cast<int>(ll), static_cast<int>(lh),
+                                   static_cast<int>(rl), static_cast<int>(rh)));
+}
+
+inline void Camellia_8_Blocks(__m128i &block0, __m128i &block1, __m128i &block2,
+    __m128i &block3, __m128i &block4, __m128i &block5, __m128i &block6,
+    __m128i &block7, const word32 *const *subkeys, unsigned int rounds)
+{
+    __m256i x0 = ByteSwap(Combine(block0, block4)), x1 = ByteSwap(Combine(block1, block5));
+    __m256i x2 = ByteSwap(Combine(block2, block6)), x3 = ByteSwap(Combine(block3, block7));
+    Transpose(x0, x1, x2, x3);
+
+    Word8 lh(x0), ll(x1), rh(x2), rl(x3);
+    Camellia_Process(lh, ll, rh, rl, subkeys[0], rounds, subkeys[1]);
+
+    x0 = rh.v; x1 = rl.v; x2 = lh.v; x3 = ll.v;
+    Transpose(x0, x1, x2, x3);
+    Split(ByteSwap(x0), block0, block4); Split(ByteSwap(x1), block1, block5);
+    Split(ByteSwap(x2), block2, block6); Split(ByteSwap(x3), block3, block7);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Camellia_AdvancedProcessBlocks_AVX2(const word32 *subKeys, const word32 *sp,
+    unsigned int rounds, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks,
+    size_t length, word32 flags)
+{
+    const word32 *tables[2] = {subKeys, sp};
+    return AdvancedProcessBlocks128_8x1_SSE(Camellia_Block, Camellia_8_Blocks,
+        tables, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE && CRYPTOPP_AESNI_AVAILABLE
@@ -6,6 +6,49 @@
 
 #include "ccm.h"
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word16;
+using CryptoPP::word32;
+using CryptoPP::word64;
+using CryptoPP::lword;
+
+// Counter blocks for a group of short messages in the batch interfaces.
+// The CBC-MAC blocks of a group may use twice as many. The group should
+// hold enough messages of a few hundred bytes to fill the block cipher's
+// parallel path in each CBC-MAC round.
+const unsigned int s_batchBlocks = 512;
+
+// Encodes the length of the associated data, RFC 3610 Section 2.2.
+// Returns the size of the encoding.
+unsigned int CCM_EncodeHeaderLength(byte *output, lword headerLength)
+{
+	using namespace CryptoPP;
+
+	if (headerLength < ((1<<16) - (1<<8)))
+	{
+		PutWord<word16>(true, BIG_ENDIAN_ORDER, output, (word16)headerLength);
+		return 2;
+	}
+	else if (headerLength < (W64LIT(1)<<32))
+	{
+		output[0] = 0xff;
+		output[1] = 0xfe;
+		PutWord<word32>(false, BIG_ENDIAN_ORDER, output+2, (word32)headerLength);
+		return 6;
+	}
+	else
+	{
+		output[0] = 0xff;
+		output[1] = 0xff;
+		PutWord<word64>(false, BIG_ENDIAN_ORDER, output+2, headerLength);
+		return 10;
+	}
+}
+
+ANONYMOUS_NAMESPACE_END
+
 NAMESPACE_BEGIN(CryptoPP)
 
 void CCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
@@ -66,26 +109,7 @@ void CCM_Base::UncheckedSpecifyDataLengths(lword headerLength, lword messageLeng
 	if (headerLength>0)
 	{
 		CRYPTOPP_ASSERT(m_bufferedDataLength == 0);
-
-		if (headerLength < ((1<<16) - (1<<8)))
-		{
-			PutWord<word16>(true, BIG_ENDIAN_ORDER, m_buffer, (word16)headerLength);
-			m_bufferedDataLength = 2;
-		}
-		else if (headerLength < (W64LIT(1)<<32))
-		{
-			m_buffer[0] = 0xff;
-			m_buffer[1] = 0xfe;
-			PutWord<word32>(false, BIG_ENDIAN_ORDER, m_buffer+2, (word32)headerLength);
-			m_bufferedDataLength = 6;
-		}
-		else
-		{
-			m_buffer[0] = 0xff;
-			m_buffer[1] = 0xff;
-			PutWord<word64>(false, BIG_ENDIAN_ORDER, m_buffer+2, headerLength);
-			m_bufferedDataLength = 10;
-		}
+		m_bufferedDataLength = CCM_EncodeHeaderLength(m_buffer, headerLength);
 	}
 }
 
@@ -134,6 +158,184 @@ void CCM_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
 	m_ctr.ProcessData(mac, CBC_Buffer(), macSize);
 }
 
+void CCM_Base::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+	ProcessBatch(messages, count, true);
+}
+
+bool CCM_Base::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+	return ProcessBatch(messages, count, false);
+}
+
+bool CCM_Base::ProcessBatch(BatchMessage *messages, size_t count, bool encrypt)
+{
+	if (m_state < State_KeySet)
+		throw BadState(AlgorithmName(), encrypt ? "EncryptAndAuthenticateBatch" : "DecryptAndVerifyBatch", "setting key");
+
+	// MaxMessageLength() depends on the IV, so each message is checked
+	// against the length its own IV allows
+	for (size_t i=0; i<count; ++i)
+	{
+		const BatchMessage &m = messages[i];
+		const int L = REQUIRED_BLOCKSIZE-1-(int)ThrowIfInvalidIVLength(m.ivLength);
+		ThrowIfInvalidTruncatedSize(m.macSize);
+
+		const lword maxLength = L<8 ? (W64LIT(1)<<(8*L))-1 : W64LIT(0)-1;
+		if (m.length > maxLength)
+			throw InvalidArgument(AlgorithmName() + ": message length " + IntToString(m.length) + " exceeds the maximum of " + IntToString(maxLength));
+	}
+
+	const BlockCipher &cipher = GetBlockCipher();
+	AlignedSecByteBlock counters(s_batchBlocks*REQUIRED_BLOCKSIZE), keystream(s_batchBlocks*REQUIRED_BLOCKSIZE);
+	AlignedSecByteBlock macs(s_batchBlocks*REQUIRED_BLOCKSIZE);
+	AlignedSecByteBlock auth(2*s_batchBlocks*REQUIRED_BLOCKSIZE), scratch(2*s_batchBlocks*REQUIRED_BLOCKSIZE);
+	SecBlock<size_t> authBlocks(s_batchBlocks), counterStart(s_batchBlocks), order(s_batchBlocks);
+	SecBlock<size_t> roundStart(2*s_batchBlocks+1);
+	FixedSizeSecBlock<byte, REQUIRED_BLOCKSIZE> computed;
+	bool pass = true;
+	size_t i = 0;
+
+	while (i < count)
+	{
+		// Gather messages while their counter and CBC-MAC blocks fit
+		const size_t first = i;
+		size_t used = 0, authUsed = 0, rounds = 0;
+		while (i < count && i-first < s_batchBlocks)
+		{
+			const BatchMessage &m = messages[i];
+			const size_t ivLength = m.ivLength < 0 ? IVSize() : static_cast<size_t>(m.ivLength);
+			const int L = REQUIRED_BLOCKSIZE-1-(int)ivLength;
+
+			byte encoded[10];
+			const size_t blocks = 1 + (m.length+REQUIRED_BLOCKSIZE-1) / REQUIRED_BLOCKSIZE;
+			const size_t headerBytes = m.headerLength ? CCM_EncodeHeaderLength(encoded, m.headerLength) + m.headerLength : 0;
+			const size_t macBlocks = 1 + (headerBytes+REQUIRED_BLOCKSIZE-1) / REQUIRED_BLOCKSIZE + blocks-1;
+			if (used + blocks > s_batchBlocks || authUsed + macBlocks > 2*s_batchBlocks)
+				break;
+
+			// A_j, RFC 3610 Section 2.3. L is at least 2, so j fits in the last two bytes.
+			byte *ctr = counters + used*REQUIRED_BLOCKSIZE;
+			for (size_t j=0; j<blocks; ++j, ctr += REQUIRED_BLOCKSIZE)
+			{
+				ctr[0] = byte(L-1);
+				memcpy(ctr+1, m.iv, ivLength);
+				memset(ctr+1+ivLength, 0, L);
+				PutWord<word16>(false, BIG_ENDIAN_ORDER, ctr+REQUIRED_BLOCKSIZE-2, word16(j));
+			}
+
+			counterStart[i-first] = used;
+			authBlocks[i-first] = macBlocks;
+			used += blocks;
+			authUsed += macBlocks;
+			rounds = STDMAX(rounds, macBlocks);
+			++i;
+		}
+
+		if (used == 0)
+		{
+			BatchMessage &m = messages[i];
+			if (encrypt)
+				EncryptAndAuthenticate(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+			else
+			{
+				m.verified = DecryptAndVerify(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+				pass = pass && m.verified;
+			}
+
+			++i;
+			continue;
+		}
+
+		cipher.AdvancedProcessBlocks(counters, NULLPTR, keystream, used*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+
+		// The CBC-MAC blocks are stored by round, and within a round by
+		// decreasing message length. The messages still in progress in a
+		// round are then a prefix of the previous round, and each round is
+		// one call with the blocks xor'ed into the running MACs.
+		const size_t messagesInGroup = i - first;
+		for (size_t k=0; k<messagesInGroup; ++k)
+		{
+			size_t p = k;
+			for (; p>0 && authBlocks[order[p-1]] < authBlocks[k]; --p)
+				order[p] = order[p-1];
+			order[p] = k;
+		}
+
+		roundStart[0] = 0;
+		for (size_t r=0, n=messagesInGroup; r<rounds; ++r)
+		{
+			while (authBlocks[order[n-1]] <= r)
+				--n;
+			roundStart[r+1] = roundStart[r] + n;
+		}
+
+		for (size_t p=0; p<messagesInGroup; ++p)
+		{
+			const size_t k = order[p];
+			BatchMessage &m = messages[first+k];
+			const size_t ivLength = m.ivLength < 0 ? IVSize() : static_cast<size_t>(m.ivLength);
+			const int L = REQUIRED_BLOCKSIZE-1-(int)ivLength;
+			const byte *block = keystream + counterStart[k]*REQUIRED_BLOCKSIZE;
+
+			// B_0, the encoded header, and the plaintext, which is copied
+			// before an in-place encryption overwrites it
+			byte *b = scratch;
+			memset(b, 0, authBlocks[k]*REQUIRED_BLOCKSIZE);
+			PutWord<word64>(true, BIG_ENDIAN_ORDER, b+REQUIRED_BLOCKSIZE-8, m.length);
+			b[0] = byte(64*(m.headerLength>0) + 8*((m_digestSize-2)/2) + (L-1));
+			memcpy(b+1, m.iv, ivLength);
+			b += REQUIRED_BLOCKSIZE;
+
+			if (m.headerLength)
+			{
+				const unsigned int encodedLength = CCM_EncodeHeaderLength(b, m.headerLength);
+				memcpy(b+encodedLength, m.header, m.headerLength);
+			}
+
+			byte *plain = scratch + (authBlocks[k]*REQUIRED_BLOCKSIZE - RoundUpToMultipleOf(m.length, (size_t)REQUIRED_BLOCKSIZE));
+			if (encrypt)
+				memcpy(plain, m.input, m.length);
+			xorbuf(m.output, m.input, block+REQUIRED_BLOCKSIZE, m.length);
+			if (!encrypt)
+				memcpy(plain, m.output, m.length);
+
+			for (size_t r=0; r<authBlocks[k]; ++r)
+				memcpy(auth+(roundStart[r]+p)*REQUIRED_BLOCKSIZE, scratch+r*REQUIRED_BLOCKSIZE, REQUIRED_BLOCKSIZE);
+		}
+
+		memset(macs, 0, messagesInGroup*REQUIRED_BLOCKSIZE);
+		for (size_t r=0; r<rounds; ++r)
+		{
+			const size_t n = roundStart[r+1] - roundStart[r];
+			cipher.AdvancedProcessBlocks(macs, auth+roundStart[r]*REQUIRED_BLOCKSIZE, macs, n*REQUIRED_BLOCKSIZE,
+				BlockTransformation::BT_XorInput|BlockTransformation::BT_AllowParallel);
+		}
+
+		// The MAC is encrypted with A_0
+		for (size_t p=0; p<messagesInGroup; ++p)
+		{
+			const size_t k = order[p];
+			BatchMessage &m = messages[first+k];
+			const byte *mac = macs + p*REQUIRED_BLOCKSIZE;
+			const byte *block = keystream + counterStart[k]*REQUIRED_BLOCKSIZE;
+
+			if (encrypt)
+				xorbuf(m.mac, mac, block, m.macSize);
+			else
+			{
+				xorbuf(computed, mac, block, m.macSize);
+				m.verified = VerifyBufsEqual(computed, m.mac, m.macSize);
+				pass = pass && m.verified;
+			}
+		}
+	}
+
+	// The CBC-MAC buffer no longer belongs to a message in progress
+	Restart();
+	return pass;
+}
+
 NAMESPACE_END
 
 #endif
@@ -56,6 +56,24 @@ public:
 		{return true;}
 	void UncheckedSpecifyDataLengths(lword headerLength, lword messageLength, lword footerLength);
 
+	/// \brief Encrypts and calculates a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \details Short messages are gathered into groups. The counter blocks of a
+	///   group are encrypted in one call to the block cipher, and the CBC-MACs of
+	///   the messages advance together, one block of each message per call. Long
+	///   messages use EncryptAndAuthenticate().
+	/// \since Crypto++ 8.5
+	void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+
+	/// \brief Decrypts and verifies a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \return true if every MAC is valid, false otherwise
+	/// \sa EncryptAndAuthenticateBatch()
+	/// \since Crypto++ 8.5
+	bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
@@ -70,6 +88,9 @@ protected:
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 
+	// EncryptAndAuthenticateBatch and DecryptAndVerifyBatch
+	bool ProcessBatch(BatchMessage *messages, size_t count, bool encrypt);
+
 	virtual BlockCipher & AccessBlockCipher() =0;
 	virtual int DefaultDigestSize() const =0;
 
@@ -21,8 +21,14 @@ NAMESPACE_BEGIN(CryptoPP)
 extern void ChaCha_OperateKeystream_NEON(const word32 *state, const byte* input, byte *output, unsigned int rounds);
 #endif
 
+#if (CRYPTOPP_AVX512_AVAILABLE)
+extern void ChaCha_OperateKeystream_AVX512(const word32 *state, const byte* input, byte *output, unsigned int rounds);
+extern void ChaCha_OperateKeystreamStates_AVX512(const word32 *states, byte *output, unsigned int rounds);
+#endif
+
 #if (CRYPTOPP_AVX2_AVAILABLE)
 extern void ChaCha_OperateKeystream_AVX2(const word32 *state, const byte* input, byte *output, unsigned int rounds);
+extern void ChaCha_OperateKeystreamStates_AVX2(const word32 *states, byte *output, unsigned int rounds);
 #endif
 #if (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
 extern void ChaCha_OperateKeystream_SSE2(const word32 *state, const byte* input, byte *output, unsigned int rounds);
@@ -88,15 +94,39 @@ inline bool MultiBlockSafe(unsigned int ctrLow, unsigned int blocks)
     return 0xffffffff - ctrLow > blocks;
 }
 
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
 // OperateKeystream always produces a key stream. The key stream is written
 // to output. Optionally a message may be supplied to xor with the key stream.
-// The message is input, and output = output ^ input.
+// The message is input, and output = output ^ input. ChaCha_OperateKeystream
+// and HChaCha_OperateKeystream are also used by the one-pass ChaCha20Poly1305
+// and XChaCha20Poly1305 in chachapoly.cpp.
 void ChaCha_OperateKeystream(KeystreamOperation operation,
         word32 state[16], word32& ctrLow, word32& ctrHigh, word32 rounds,
         byte *output, const byte *input, size_t iterationCount)
 {
     do
     {
+#if (CRYPTOPP_AVX512_AVAILABLE)
+        if (HasAVX512F())
+        {
+            while (iterationCount >= 16 && MultiBlockSafe(state[12], 16))
+            {
+                const bool xorInput = (operation & INPUT_NULL) != INPUT_NULL;
+                ChaCha_OperateKeystream_AVX512(state, xorInput ? input : NULLPTR, output, rounds);
+
+                // MultiBlockSafe avoids overflow on the counter words
+                state[12] += 16;
+
+                input += (!!xorInput) * 16 * BYTES_PER_ITERATION;
+                output += 16 * BYTES_PER_ITERATION;
+                iterationCount -= 16;
+            }
+        }
+#endif
+
 #if (CRYPTOPP_AVX2_AVAILABLE)
         if (HasAVX2())
         {
@@ -232,8 +262,89 @@ void HChaCha_OperateKeystream(const word32 state[16], word32 output[8])
     output[6] = x14; output[7] = x15;
 }
 
+// The number of independent states ChaCha_OperateKeystreamStates
+// runs in one SIMD call, or 0 if there is no kernel for them
+unsigned int ChaCha_GetStatesParallelism()
+{
+#if (CRYPTOPP_AVX512_AVAILABLE)
+    if (HasAVX512F())
+        return 16;
+#endif
+#if (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+        return 8;
+#endif
+    return 0;
+}
+
+// Writes one keystream block for each of count independent states. The
+// states are consecutive, 16 words each, and are not advanced. A short
+// group is padded with copies of the first state.
+void ChaCha_OperateKeystreamStates(const word32 *states, byte *output, size_t count, word32 rounds)
+{
+    FixedSizeAlignedSecBlock<word32, 16*16> padded;
+    FixedSizeAlignedSecBlock<byte, 16*BYTES_PER_ITERATION> block;
+
+    while (count)
+    {
+#if (CRYPTOPP_AVX512_AVAILABLE)
+        if (HasAVX512F() && count > 8)
+        {
+            if (count >= 16)
+            {
+                ChaCha_OperateKeystreamStates_AVX512(states, output, rounds);
+                states += 16*16; output += 16*BYTES_PER_ITERATION; count -= 16;
+                continue;
+            }
+
+            std::memcpy(padded, states, count*BYTES_PER_ITERATION);
+            for (size_t i=count; i<16; ++i)
+                std::memcpy(padded+i*16, states, BYTES_PER_ITERATION);
+
+            ChaCha_OperateKeystreamStates_AVX512(padded, block, rounds);
+            std::memcpy(output, block, count*BYTES_PER_ITERATION);
+            return;
+        }
+#endif
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+        if (HasAVX2())
+        {
+            if (count >= 8)
+            {
+                ChaCha_OperateKeystreamStates_AVX2(states, output, rounds);
+                states += 8*16; output += 8*BYTES_PER_ITERATION; count -= 8;
+                continue;
+            }
+
+            std::memcpy(padded, states, count*BYTES_PER_ITERATION);
+            for (size_t i=count; i<8; ++i)
+                std::memcpy(padded+i*16, states, BYTES_PER_ITERATION);
+
+            ChaCha_OperateKeystreamStates_AVX2(padded, block, rounds);
+            std::memcpy(output, block, count*BYTES_PER_ITERATION);
+            return;
+        }
+#endif
+
+        word32 discard = 0;
+        std::memcpy(padded, states, BYTES_PER_ITERATION);
+        ChaCha_OperateKeystream(WRITE_KEYSTREAM, padded, padded[12], discard, rounds, output, NULLPTR, 1);
+        states += 16; output += BYTES_PER_ITERATION; count--;
+    }
+}
+
+NAMESPACE_END
+
+ANONYMOUS_NAMESPACE_BEGIN
+
 std::string ChaCha_AlgorithmProvider()
 {
+#if (CRYPTOPP_AVX512_AVAILABLE)
+    if (HasAVX512F())
+        return "AVX512";
+    else
+#endif
 #if (CRYPTOPP_AVX2_AVAILABLE)
     if (HasAVX2())
         return "AVX2";
@@ -279,6 +390,11 @@ unsigned int ChaCha_GetAlignment()
 
 unsigned int ChaCha_GetOptimalBlockSize()
 {
+#if (CRYPTOPP_AVX512_AVAILABLE)
+    if (HasAVX512F())
+        return 16 * BYTES_PER_ITERATION;
+    else
+#endif
 #if (CRYPTOPP_AVX2_AVAILABLE)
     if (HasAVX2())
         return 8 * BYTES_PER_ITERATION;
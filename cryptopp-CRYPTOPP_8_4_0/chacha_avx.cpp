@@ -81,6 +81,47 @@ inline __m256i RotateLeft<16>(const __m256i val)
     return _mm256_shuffle_epi8(val, mask);
 }
 
+// Quarter round on 8 blocks. Each register holds one state word from
+// each block, so the rounds need no shuffles.
+#define CHACHA_QUARTER_ROUND_8(a,b,c,d) \
+    a = _mm256_add_epi32(a, b); d = RotateLeft<16>(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi32(c, d); b = RotateLeft<12>(_mm256_xor_si256(b, c)); \
+    a = _mm256_add_epi32(a, b); d = RotateLeft< 8>(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi32(c, d); b = RotateLeft< 7>(_mm256_xor_si256(b, c));
+
+// Transposes eight words of 8 blocks. On return x[i] holds the eight
+// words of block i.
+inline void Transpose8(__m256i x[8])
+{
+    const __m256i a0 = _mm256_unpacklo_epi32(x[0], x[1]);
+    const __m256i a1 = _mm256_unpackhi_epi32(x[0], x[1]);
+    const __m256i a2 = _mm256_unpacklo_epi32(x[2], x[3]);
+    const __m256i a3 = _mm256_unpackhi_epi32(x[2], x[3]);
+    const __m256i a4 = _mm256_unpacklo_epi32(x[4], x[5]);
+    const __m256i a5 = _mm256_unpackhi_epi32(x[4], x[5]);
+    const __m256i a6 = _mm256_unpacklo_epi32(x[6], x[7]);
+    const __m256i a7 = _mm256_unpackhi_epi32(x[6], x[7]);
+
+    // Blocks i and i+4 in the low and high lanes
+    const __m256i b0 = _mm256_unpacklo_epi64(a0, a2);
+    const __m256i b1 = _mm256_unpackhi_epi64(a0, a2);
+    const __m256i b2 = _mm256_unpacklo_epi64(a1, a3);
+    const __m256i b3 = _mm256_unpackhi_epi64(a1, a3);
+    const __m256i b4 = _mm256_unpacklo_epi64(a4, a6);
+    const __m256i b5 = _mm256_unpackhi_epi64(a4, a6);
+    const __m256i b6 = _mm256_unpacklo_epi64(a5, a7);
+    const __m256i b7 = _mm256_unpackhi_epi64(a5, a7);
+
+    x[0] = _mm256_permute2x128_si256(b0, b4, 0x20);
+    x[1] = _mm256_permute2x128_si256(b1, b5, 0x20);
+    x[2] = _mm256_permute2x128_si256(b2, b6, 0x20);
+    x[3] = _mm256_permute2x128_si256(b3, b7, 0x20);
+    x[4] = _mm256_permute2x128_si256(b0, b4, 0x31);
+    x[5] = _mm256_permute2x128_si256(b1, b5, 0x31);
+    x[6] = _mm256_permute2x128_si256(b2, b6, 0x31);
+    x[7] = _mm256_permute2x128_si256(b3, b7, 0x31);
+}
+
 #endif  // CRYPTOPP_AVX2_AVAILABLE
 
 ANONYMOUS_NAMESPACE_END
@@ -416,6 +457,48 @@ void ChaCha_OperateKeystream_AVX2(const word32 *state, const byte* input, byte *
     _mm256_zeroupper();
 }
 
+// Produces one block from each of 8 independent states. The states are
+// consecutive, 16 words each, and block i comes from state i. Unlike
+// ChaCha_OperateKeystream_AVX2, each register holds one word from all
+// 8 states, so the lanes can start from unrelated counters and nonces.
+void ChaCha_OperateKeystreamStates_AVX2(const word32 *states, byte *output, unsigned int rounds)
+{
+    const __m256i index = _mm256_set_epi32(112,96,80,64, 48,32,16,0);
+    const int* base = reinterpret_cast<const int*>(states);
+
+    __m256i s[16], x[16];
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = s[i] = _mm256_i32gather_epi32(base+i, index, 4);
+
+    for (int i = static_cast<int>(rounds); i > 0; i -= 2)
+    {
+        CHACHA_QUARTER_ROUND_8(x[0], x[4],  x[8], x[12]);
+        CHACHA_QUARTER_ROUND_8(x[1], x[5],  x[9], x[13]);
+        CHACHA_QUARTER_ROUND_8(x[2], x[6], x[10], x[14]);
+        CHACHA_QUARTER_ROUND_8(x[3], x[7], x[11], x[15]);
+
+        CHACHA_QUARTER_ROUND_8(x[0], x[5], x[10], x[15]);
+        CHACHA_QUARTER_ROUND_8(x[1], x[6], x[11], x[12]);
+        CHACHA_QUARTER_ROUND_8(x[2], x[7],  x[8], x[13]);
+        CHACHA_QUARTER_ROUND_8(x[3], x[4],  x[9], x[14]);
+    }
+
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = _mm256_add_epi32(x[i], s[i]);
+
+    Transpose8(x+0);
+    Transpose8(x+8);
+
+    for (unsigned int i=0; i<8; ++i)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*64+ 0), x[i]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*64+32), x[8+i]);
+    }
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+}
+
 #endif  // CRYPTOPP_AVX2_AVAILABLE
 
 NAMESPACE_END
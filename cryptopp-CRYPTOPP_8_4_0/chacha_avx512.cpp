@@ -0,0 +1,168 @@
+// chacha_avx512.cpp - written and placed in the public domain by
+//                     the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX-512F
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernel produces 16 blocks per call. Unlike the AVX2 kernel,
+//    which keeps rows of two blocks in each register, each zmm register
+//    holds one state word from all 16 blocks. The quarter rounds need no
+//    shuffles, and the native rotate vprold replaces the shift and or.
+//    The words are transposed back into blocks at the end. The same
+//    layout lets each lane start from its own state, which the batch
+//    AEAD interfaces use for keystream of several messages at once.
+
+#include "pch.h"
+#include "config.h"
+
+#include "chacha.h"
+#include "misc.h"
+
+#if defined(CRYPTOPP_AVX512_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char CHACHA_AVX512_FNAME[] = __FILE__;
+
+// GCC 12 warns about the undefined pass-through operand __Y in unmasked
+// AVX-512 intrinsics like _mm512_rol_epi32 and the unpacks in
+// ChaCha_Finish16. The operand is ignored by the instruction.
+#if CRYPTOPP_GCC_DIAGNOSTIC_AVAILABLE && !defined(__clang__)
+# pragma GCC diagnostic ignored "-Wuninitialized"
+# pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M512_CAST(x) ((__m512i *)(void *)(x))
+#define CONST_M512_CAST(x) ((const __m512i *)(const void *)(x))
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX512_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+#define CHACHA_QUARTER_ROUND_16(a,b,c,d) \
+    a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 16); \
+    c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 12); \
+    a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d,  8); \
+    c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b,  7);
+
+// Transposes four words of 16 blocks. On return each 128-bit lane k of
+// x[m] holds the four words of block 4k+m.
+inline void Transpose4(__m512i x[4])
+{
+    const __m512i t0 = _mm512_unpacklo_epi32(x[0], x[1]);
+    const __m512i t1 = _mm512_unpackhi_epi32(x[0], x[1]);
+    const __m512i t2 = _mm512_unpacklo_epi32(x[2], x[3]);
+    const __m512i t3 = _mm512_unpackhi_epi32(x[2], x[3]);
+
+    x[0] = _mm512_unpacklo_epi64(t0, t2);
+    x[1] = _mm512_unpackhi_epi64(t0, t2);
+    x[2] = _mm512_unpacklo_epi64(t1, t3);
+    x[3] = _mm512_unpackhi_epi64(t1, t3);
+}
+
+// Gathers lane k of a, b, c and d into block 4k+m, and writes the
+// blocks m, 4+m, 8+m and 12+m.
+inline void StoreBlocks(const __m512i &a, const __m512i &b, const __m512i &c, const __m512i &d,
+    const byte *input, byte *output, unsigned int m)
+{
+    const __m512i u0 = _mm512_shuffle_i32x4(a, b, _MM_SHUFFLE(1,0,1,0));
+    const __m512i u1 = _mm512_shuffle_i32x4(a, b, _MM_SHUFFLE(3,2,3,2));
+    const __m512i u2 = _mm512_shuffle_i32x4(c, d, _MM_SHUFFLE(1,0,1,0));
+    const __m512i u3 = _mm512_shuffle_i32x4(c, d, _MM_SHUFFLE(3,2,3,2));
+
+    __m512i o[4];
+    o[0] = _mm512_shuffle_i32x4(u0, u2, _MM_SHUFFLE(2,0,2,0));
+    o[1] = _mm512_shuffle_i32x4(u0, u2, _MM_SHUFFLE(3,1,3,1));
+    o[2] = _mm512_shuffle_i32x4(u1, u3, _MM_SHUFFLE(2,0,2,0));
+    o[3] = _mm512_shuffle_i32x4(u1, u3, _MM_SHUFFLE(3,1,3,1));
+
+    for (unsigned int k=0; k<4; ++k)
+    {
+        const size_t offset = (4*k+m)*64;
+        if (input)
+            o[k] = _mm512_xor_si512(o[k], _mm512_loadu_si512(CONST_M512_CAST(input+offset)));
+        _mm512_storeu_si512(M512_CAST(output+offset), o[k]);
+    }
+}
+
+// Runs the rounds and the feed-forward on 16 blocks, and writes them
+inline void ChaCha_Finish16(const __m512i s[16], const byte *input, byte *output, unsigned int rounds)
+{
+    __m512i x[16];
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = s[i];
+
+    for (int i = static_cast<int>(rounds); i > 0; i -= 2)
+    {
+        CHACHA_QUARTER_ROUND_16(x[0], x[4],  x[8], x[12]);
+        CHACHA_QUARTER_ROUND_16(x[1], x[5],  x[9], x[13]);
+        CHACHA_QUARTER_ROUND_16(x[2], x[6], x[10], x[14]);
+        CHACHA_QUARTER_ROUND_16(x[3], x[7], x[11], x[15]);
+
+        CHACHA_QUARTER_ROUND_16(x[0], x[5], x[10], x[15]);
+        CHACHA_QUARTER_ROUND_16(x[1], x[6], x[11], x[12]);
+        CHACHA_QUARTER_ROUND_16(x[2], x[7],  x[8], x[13]);
+        CHACHA_QUARTER_ROUND_16(x[3], x[4],  x[9], x[14]);
+    }
+
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = _mm512_add_epi32(x[i], s[i]);
+
+    Transpose4(x+0);
+    Transpose4(x+4);
+    Transpose4(x+8);
+    Transpose4(x+12);
+
+    for (unsigned int m=0; m<4; ++m)
+        StoreBlocks(x[m], x[4+m], x[8+m], x[12+m], input, output, m);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void ChaCha_OperateKeystream_AVX512(const word32 *state, const byte* input, byte *output, unsigned int rounds)
+{
+    __m512i s[16];
+    for (unsigned int i=0; i<16; ++i)
+        s[i] = _mm512_set1_epi32(static_cast<int>(state[i]));
+
+    // The block counter is the 64-bit word state[13]:state[12]. ChaChaTLS
+    // uses state[13] for the nonce, and the caller avoids the carry.
+    const __m512i offsets = _mm512_set_epi32(15,14,13,12, 11,10,9,8, 7,6,5,4, 3,2,1,0);
+    const __m512i low = _mm512_add_epi32(s[12], offsets);
+    const __mmask16 carry = _mm512_cmplt_epu32_mask(low, s[12]);
+    s[13] = _mm512_mask_add_epi32(s[13], carry, s[13], _mm512_set1_epi32(1));
+    s[12] = low;
+
+    ChaCha_Finish16(s, input, output, rounds);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+}
+
+// Produces one block from each of 16 independent states. The states
+// are consecutive, 16 words each, and block i comes from state i.
+void ChaCha_OperateKeystreamStates_AVX512(const word32 *states, byte *output, unsigned int rounds)
+{
+    const __m512i index = _mm512_set_epi32(240,224,208,192, 176,160,144,128, 112,96,80,64, 48,32,16,0);
+
+    __m512i s[16];
+    for (unsigned int i=0; i<16; ++i)
+        s[i] = _mm512_i32gather_epi32(index, states+i, 4);
+
+    ChaCha_Finish16(s, NULLPTR, output, rounds);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+}
+
+#endif  // CRYPTOPP_AVX512_AVAILABLE
+
+NAMESPACE_END
@@ -12,6 +12,246 @@
 
 NAMESPACE_BEGIN(CryptoPP)
 
+extern void ChaCha_OperateKeystream(KeystreamOperation operation, word32 state[16], word32& ctrLow, word32& ctrHigh, word32 rounds, byte *output, const byte *input, size_t iterationCount);
+extern void HChaCha_OperateKeystream(const word32 state[16], word32 output[8]);
+extern unsigned int ChaCha_GetStatesParallelism();
+extern void ChaCha_OperateKeystreamStates(const word32 *states, byte *output, size_t count, word32 rounds);
+
+extern void Poly1305_HashBlocks(word32 h[5], word32 r[4], const byte *input, size_t length, word32 padbit);
+extern void Poly1305_HashFinal(word32 h[5], word32 n[4], byte *mac, size_t size);
+extern size_t ChaCha20Poly1305_ProcessBlocks(word32 h[5], word32 r[4], word32 state[16], byte *output, const byte *input, size_t length, bool encrypt);
+
+NAMESPACE_END
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using namespace CryptoPP;
+
+// Chunks for the one-pass loop when the stitched kernel is not available.
+// The keystream and hash of a chunk run while the chunk is in L1.
+const size_t CHUNK_SIZE = 4096;
+
+// Keystream blocks for a group of short messages in the batch interfaces
+const size_t GROUP_BLOCKS = 64;
+
+typedef AuthenticatedSymmetricCipher::BatchMessage BatchMessage;
+
+// Hashes data padded with zeros to a multiple of 16 bytes
+void ChaCha20Poly1305_HashPadded(word32 h[5], word32 r[4], const byte *data, size_t length)
+{
+	const size_t full = RoundDownToMultipleOf(length, static_cast<size_t>(16));
+	if (full)
+		Poly1305_HashBlocks(h, r, data, full, 1);
+
+	if (length > full)
+	{
+		FixedSizeAlignedSecBlock<byte, 16> block;
+		std::memset(block, 0x00, 16);
+		std::memcpy(block, data+full, length-full);
+		Poly1305_HashBlocks(h, r, block, 16, 1);
+	}
+}
+
+// Keys Poly1305 from keystream block 0, RFC 8439 Section 2.6
+void ChaCha20Poly1305_KeyMac(word32 h[5], word32 r[4], word32 n[4], const byte *block)
+{
+	r[0] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block +  0) & 0x0fffffff;
+	r[1] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block +  4) & 0x0ffffffc;
+	r[2] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block +  8) & 0x0ffffffc;
+	r[3] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block + 12) & 0x0ffffffc;
+	n[0] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block + 16);
+	n[1] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block + 20);
+	n[2] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block + 24);
+	n[3] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, block + 28);
+	h[0] = h[1] = h[2] = h[3] = h[4] = 0;
+}
+
+// Encrypts or decrypts with keystream that covers the whole message,
+// and hashes the ciphertext
+void ChaCha20Poly1305_XorAndHash(word32 h[5], word32 r[4], const byte *keystream,
+	byte *output, const byte *input, size_t length, bool encrypt)
+{
+	if (!encrypt)
+		ChaCha20Poly1305_HashPadded(h, r, input, length);
+
+	xorbuf(output, input, keystream, length);
+
+	if (encrypt)
+		ChaCha20Poly1305_HashPadded(h, r, output, length);
+}
+
+// Hashes the lengths block and writes the MAC
+void ChaCha20Poly1305_FinishMac(word32 h[5], word32 r[4], word32 n[4], size_t aadLength,
+	size_t messageLength, byte *mac, size_t macSize)
+{
+	FixedSizeAlignedSecBlock<byte, 16> block;
+	PutWord(true, LITTLE_ENDIAN_ORDER, block+0, static_cast<word64>(aadLength));
+	PutWord(true, LITTLE_ENDIAN_ORDER, block+8, static_cast<word64>(messageLength));
+	Poly1305_HashBlocks(h, r, block, 16, 1);
+	Poly1305_HashFinal(h, n, mac, macSize);
+}
+
+// One-pass AEAD construction, RFC 8439 Section 2.8. state is the ChaCha20
+// state at block 0. ctrHigh receives the carry out of the block counter,
+// which is state[13] for XChaCha20 and a discard value for ChaCha20.
+// optimal is the cipher's OptimalBlockSize(). The ciphertext is hashed
+// as it is produced, or before it is consumed.
+void ChaCha20Poly1305_Process(word32 state[16], word32 &ctrHigh, size_t optimal, byte *mac, size_t macSize,
+	const byte *aad, size_t aadLength, byte *output, const byte *input, size_t length, bool encrypt)
+{
+	FixedSizeAlignedSecBlock<word32, 5> h;
+	FixedSizeAlignedSecBlock<word32, 4> r, n;
+	FixedSizeAlignedSecBlock<byte, 512> block;
+	const size_t messageLength = length;
+
+	// Block 0 keys Poly1305. When the rest of the message fits, its
+	// keystream comes from the same SIMD call instead of separate
+	// scalar blocks.
+	const size_t batch = STDMIN(optimal, block.size());
+	size_t blocks = 1;
+	if (length > 64 && length+64 <= batch)
+		blocks = batch / 64;
+
+	ChaCha_OperateKeystream(WRITE_KEYSTREAM, state, state[12], ctrHigh, 20, block, NULLPTR, blocks);
+	ChaCha20Poly1305_KeyMac(h, r, n, block);
+	ChaCha20Poly1305_HashPadded(h, r, aad, aadLength);
+
+	if (blocks > 1)
+	{
+		ChaCha20Poly1305_XorAndHash(h, r, block+64, output, input, length, encrypt);
+		length = 0;
+	}
+
+	if (length)
+	{
+		const size_t processed = length - ChaCha20Poly1305_ProcessBlocks(h, r, state, output, input, length, encrypt);
+		input += processed;
+		output += processed;
+		length -= processed;
+	}
+
+	while (length)
+	{
+		const size_t chunk = STDMIN(length, CHUNK_SIZE);
+		const size_t blocks = chunk / 64, tail = chunk % 64;
+
+		if (!encrypt)
+			ChaCha20Poly1305_HashPadded(h, r, input, chunk);
+
+		if (blocks)
+			ChaCha_OperateKeystream(XOR_KEYSTREAM, state, state[12], ctrHigh, 20, output, input, blocks);
+
+		if (tail)
+		{
+			ChaCha_OperateKeystream(WRITE_KEYSTREAM, state, state[12], ctrHigh, 20, block, NULLPTR, 1);
+			xorbuf(output+blocks*64, input+blocks*64, block, tail);
+		}
+
+		if (encrypt)
+			ChaCha20Poly1305_HashPadded(h, r, output, chunk);
+
+		input += chunk;
+		output += chunk;
+		length -= chunk;
+	}
+
+	ChaCha20Poly1305_FinishMac(h, r, n, aadLength, messageLength, mac, macSize);
+}
+
+// One-pass construction on several messages. states holds the block 0
+// state of each message. Short messages are gathered into groups, and
+// each block of a group's keystream gets a lane of its own in
+// ChaCha_OperateKeystreamStates, so one SIMD call serves several
+// messages. Poly1305 then runs on each message in turn. Messages too
+// long for a group, and all messages when there is no kernel for
+// independent states, take the single message path. Returns true if
+// every MAC is valid.
+bool ChaCha20Poly1305_ProcessBatch(word32 *states, bool xchacha, size_t optimal,
+	BatchMessage *messages, size_t count, bool encrypt)
+{
+	FixedSizeAlignedSecBlock<word32, 5> h;
+	FixedSizeAlignedSecBlock<word32, 4> r, n;
+	FixedSizeAlignedSecBlock<word32, GROUP_BLOCKS*16> lanes;
+	FixedSizeAlignedSecBlock<byte, GROUP_BLOCKS*64> keystream;
+	FixedSizeAlignedSecBlock<byte, 16> computed;
+
+	const bool interleave = ChaCha_GetStatesParallelism() > 0;
+	bool pass = true;
+	size_t i = 0;
+
+	while (i < count)
+	{
+		// Gather messages while their keystream fits. The counter starts
+		// at 0 and stays below GROUP_BLOCKS, so state[13] never carries.
+		const size_t first = i;
+		size_t used = 0;
+		while (interleave && i < count)
+		{
+			const size_t blocks = 1 + (messages[i].length+63) / 64;
+			if (used + blocks > GROUP_BLOCKS)
+				break;
+
+			for (size_t j=0; j<blocks; ++j)
+			{
+				word32 *lane = lanes + (used+j)*16;
+				std::memcpy(lane, states+i*16, 64);
+				lane[12] += static_cast<word32>(j);
+			}
+
+			used += blocks;
+			++i;
+		}
+
+		if (used == 0)
+		{
+			BatchMessage &m = messages[i];
+			word32 *state = states+i*16;
+			word32 discard = 0;
+
+			byte *mac = encrypt ? m.mac : computed.begin();
+			ChaCha20Poly1305_Process(state, xchacha ? state[13] : discard, optimal, mac, m.macSize,
+				m.header, m.headerLength, m.output, m.input, m.length, encrypt);
+
+			if (!encrypt)
+			{
+				m.verified = VerifyBufsEqual(computed, m.mac, m.macSize);
+				pass = pass && m.verified;
+			}
+
+			++i;
+			continue;
+		}
+
+		ChaCha_OperateKeystreamStates(lanes, keystream, used, 20);
+
+		const byte *block = keystream;
+		for (size_t k=first; k<i; ++k)
+		{
+			BatchMessage &m = messages[k];
+			byte *mac = encrypt ? m.mac : computed.begin();
+
+			ChaCha20Poly1305_KeyMac(h, r, n, block);
+			ChaCha20Poly1305_HashPadded(h, r, m.header, m.headerLength);
+			ChaCha20Poly1305_XorAndHash(h, r, block+64, m.output, m.input, m.length, encrypt);
+			ChaCha20Poly1305_FinishMac(h, r, n, m.headerLength, m.length, mac, m.macSize);
+
+			if (!encrypt)
+			{
+				m.verified = VerifyBufsEqual(computed, m.mac, m.macSize);
+				pass = pass && m.verified;
+			}
+
+			block += 64 * (1 + (m.length+63) / 64);
+		}
+	}
+
+	return pass;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
 ////////////////////////////// IETF ChaChaTLS //////////////////////////////
 
 // RekeyCipherAndMac is heavier-weight than we like. The Authenc framework was
@@ -94,20 +334,68 @@ void ChaCha20Poly1305_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSiz
 	m_state = State_KeySet;
 }
 
+// The one-call interfaces bypass the ChaChaTLS and Poly1305TLS objects. They
+// build the ChaCha20 state directly from the key and IV, and encrypt and
+// authenticate the message in a single pass.
+void ChaCha20Poly1305_Base::SetupState(word32 state[16], const byte *iv, int ivLength, size_t macSize, size_t messageLength)
+{
+	if (m_state < State_KeySet)
+		throw BadState(AlgorithmName(), "Resynchronize", "key is set");
+	ThrowIfInvalidIVLength(ivLength);
+	ThrowIfInvalidTruncatedSize(macSize);
+	if (messageLength > MaxMessageLength())
+		throw InvalidArgument(AlgorithmName() + ": message length exceeds maximum");
+
+	// State words are defined in RFC 8439, Section 2.3
+	state[0] = 0x61707865; state[1] = 0x3320646e;
+	state[2] = 0x79622d32; state[3] = 0x6b206574;
+
+	GetBlock<word32, LittleEndian> get1(m_userKey);
+	get1(state[4])(state[5])(state[6])(state[7])(state[8])(state[9])(state[10])(state[11]);
+
+	GetBlock<word32, LittleEndian> get2(iv);
+	state[12] = 0;
+	get2(state[13])(state[14])(state[15]);
+
+	m_state = State_KeySet;
+}
+
 void ChaCha20Poly1305_Base::EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *message, size_t messageLength)
 {
-	Resynchronize(iv, ivLength);
-	Update(aad, aadLength);
-	ProcessString(ciphertext, message, messageLength);
-	TruncatedFinal(mac, macSize);
+	FixedSizeAlignedSecBlock<word32, 16> state;
+	word32 discard = 0;
+
+	SetupState(state, iv, ivLength, macSize, messageLength);
+	ChaCha20Poly1305_Process(state, discard, AccessSymmetricCipher().OptimalBlockSize(), mac, macSize, aad, aadLength, ciphertext, message, messageLength, true);
 }
 
 bool ChaCha20Poly1305_Base::DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *ciphertext, size_t ciphertextLength)
 {
-	Resynchronize(iv, ivLength);
-	Update(aad, aadLength);
-	ProcessString(message, ciphertext, ciphertextLength);
-	return TruncatedVerify(mac, macLength);
+	FixedSizeAlignedSecBlock<word32, 16> state;
+	FixedSizeAlignedSecBlock<byte, 16> computed;
+	word32 discard = 0;
+
+	SetupState(state, iv, ivLength, macLength, ciphertextLength);
+	ChaCha20Poly1305_Process(state, discard, AccessSymmetricCipher().OptimalBlockSize(), computed, macLength, aad, aadLength, message, ciphertext, ciphertextLength, false);
+	return VerifyBufsEqual(computed, mac, macLength);
+}
+
+void ChaCha20Poly1305_Base::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+	SecBlock<word32, AllocatorWithCleanup<word32, true> > states(count*16);
+	for (size_t i=0; i<count; ++i)
+		SetupState(states+i*16, messages[i].iv, messages[i].ivLength, messages[i].macSize, messages[i].length);
+
+	ChaCha20Poly1305_ProcessBatch(states, false, AccessSymmetricCipher().OptimalBlockSize(), messages, count, true);
+}
+
+bool ChaCha20Poly1305_Base::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+	SecBlock<word32, AllocatorWithCleanup<word32, true> > states(count*16);
+	for (size_t i=0; i<count; ++i)
+		SetupState(states+i*16, messages[i].iv, messages[i].ivLength, messages[i].macSize, messages[i].length);
+
+	return ChaCha20Poly1305_ProcessBatch(states, false, AccessSymmetricCipher().OptimalBlockSize(), messages, count, false);
 }
 
 ////////////////////////////// IETF XChaCha20 draft //////////////////////////////
@@ -192,20 +480,76 @@ void XChaCha20Poly1305_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSi
 	m_state = State_KeySet;
 }
 
+// The one-call interfaces bypass the XChaCha20 and Poly1305TLS objects. They
+// derive the XChaCha20 state directly from the key and IV, and encrypt and
+// authenticate the message in a single pass.
+void XChaCha20Poly1305_Base::SetupState(word32 state[16], const byte *iv, int ivLength, size_t macSize, size_t messageLength)
+{
+	if (m_state < State_KeySet)
+		throw BadState(AlgorithmName(), "Resynchronize", "key is set");
+	ThrowIfInvalidIVLength(ivLength);
+	ThrowIfInvalidTruncatedSize(macSize);
+	if (messageLength > MaxMessageLength())
+		throw InvalidArgument(AlgorithmName() + ": message length exceeds maximum");
+
+	// HChaCha derivation
+	state[0] = 0x61707865; state[1] = 0x3320646e;
+	state[2] = 0x79622d32; state[3] = 0x6b206574;
+
+	GetBlock<word32, LittleEndian> get1(m_userKey);
+	get1(state[4])(state[5])(state[6])(state[7])(state[8])(state[9])(state[10])(state[11]);
+
+	GetBlock<word32, LittleEndian> get2(iv);
+	get2(state[12])(state[13])(state[14])(state[15]);
+
+	HChaCha_OperateKeystream(state, state+4);
+
+	// XChaCha state
+	state[0] = 0x61707865; state[1] = 0x3320646e;
+	state[2] = 0x79622d32; state[3] = 0x6b206574;
+
+	state[12] = 0;
+	state[13] = 0;
+	state[14] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, iv+16);
+	state[15] = GetWord<word32>(false, LITTLE_ENDIAN_ORDER, iv+20);
+
+	m_state = State_KeySet;
+}
+
 void XChaCha20Poly1305_Base::EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *message, size_t messageLength)
 {
-	Resynchronize(iv, ivLength);
-	Update(aad, aadLength);
-	ProcessString(ciphertext, message, messageLength);
-	TruncatedFinal(mac, macSize);
+	FixedSizeAlignedSecBlock<word32, 16> state;
+
+	SetupState(state, iv, ivLength, macSize, messageLength);
+	ChaCha20Poly1305_Process(state, state[13], AccessSymmetricCipher().OptimalBlockSize(), mac, macSize, aad, aadLength, ciphertext, message, messageLength, true);
 }
 
 bool XChaCha20Poly1305_Base::DecryptAndVerify(byte *message, const byte *mac, size_t macLength, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *ciphertext, size_t ciphertextLength)
 {
-	Resynchronize(iv, ivLength);
-	Update(aad, aadLength);
-	ProcessString(message, ciphertext, ciphertextLength);
-	return TruncatedVerify(mac, macLength);
+	FixedSizeAlignedSecBlock<word32, 16> state;
+	FixedSizeAlignedSecBlock<byte, 16> computed;
+
+	SetupState(state, iv, ivLength, macLength, ciphertextLength);
+	ChaCha20Poly1305_Process(state, state[13], AccessSymmetricCipher().OptimalBlockSize(), computed, macLength, aad, aadLength, message, ciphertext, ciphertextLength, false);
+	return VerifyBufsEqual(computed, mac, macLength);
+}
+
+void XChaCha20Poly1305_Base::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+	SecBlock<word32, AllocatorWithCleanup<word32, true> > states(count*16);
+	for (size_t i=0; i<count; ++i)
+		SetupState(states+i*16, messages[i].iv, messages[i].ivLength, messages[i].macSize, messages[i].length);
+
+	ChaCha20Poly1305_ProcessBatch(states, true, AccessSymmetricCipher().OptimalBlockSize(), messages, count, true);
+}
+
+bool XChaCha20Poly1305_Base::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+	SecBlock<word32, AllocatorWithCleanup<word32, true> > states(count*16);
+	for (size_t i=0; i<count; ++i)
+		SetupState(states+i*16, messages[i].iv, messages[i].ivLength, messages[i].macSize, messages[i].length);
+
+	return ChaCha20Poly1305_ProcessBatch(states, true, AccessSymmetricCipher().OptimalBlockSize(), messages, count, false);
 }
 
 NAMESPACE_END
@@ -80,6 +80,8 @@ public:
 	/// \param messageLength the size of the messagetext buffer, in bytes
 	/// \details EncryptAndAuthenticate() encrypts and generates the MAC in one call. The function
 	///   truncates the MAC if <tt>macSize < TagSize()</tt>.
+	/// \details Since Crypto++ 8.5 the message is encrypted and authenticated in one
+	///   pass, and the stitched AVX2 kernel is used when available.
 	virtual void EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *message, size_t messageLength);
 
 	/// \brief Decrypts and verifies a MAC in one call
@@ -97,8 +99,27 @@ public:
 	/// <tt>message</tt> is a decryption buffer and should be at least as large as the ciphertext buffer.
 	/// \details The function returns true iff MAC is valid. DecryptAndVerify() assumes the MAC
 	///  is truncated if <tt>macLength < TagSize()</tt>.
+	/// \details Since Crypto++ 8.5 the ciphertext is authenticated and decrypted in one
+	///   pass, and the stitched AVX2 kernel is used when available.
 	virtual bool DecryptAndVerify(byte *message, const byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *ciphertext, size_t ciphertextLength);
 
+	/// \brief Encrypts and calculates a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \details Short messages are gathered into groups, and the keystream for a
+	///   group comes from AVX2 or AVX-512 calls that give each block its own state.
+	///   Longer messages use the one-pass EncryptAndAuthenticate() path.
+	/// \since Crypto++ 8.5
+	void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+
+	/// \brief Decrypts and verifies a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \return true if every MAC is valid, false otherwise
+	/// \sa EncryptAndAuthenticateBatch()
+	/// \since Crypto++ 8.5
+	bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const {return false;}
@@ -113,6 +134,10 @@ protected:
 	// See comments in chachapoly.cpp
 	void RekeyCipherAndMac(const byte *userKey, size_t userKeyLength, const NameValuePairs &params);
 
+	// Key, IV and length checks, and the cipher state for the one-pass
+	// EncryptAndAuthenticate and DecryptAndVerify
+	void SetupState(word32 state[16], const byte *iv, int ivLength, size_t macSize, size_t messageLength);
+
 	virtual const MessageAuthenticationCode & GetMAC() const = 0;
 	virtual MessageAuthenticationCode & AccessMAC() = 0;
 
@@ -228,6 +253,8 @@ public:
 	/// \param messageLength the size of the messagetext buffer, in bytes
 	/// \details EncryptAndAuthenticate() encrypts and generates the MAC in one call. The function
 	///   truncates the MAC if <tt>macSize < TagSize()</tt>.
+	/// \details Since Crypto++ 8.5 the message is encrypted and authenticated in one
+	///   pass, and the stitched AVX2 kernel is used when available.
 	virtual void EncryptAndAuthenticate(byte *ciphertext, byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *message, size_t messageLength);
 
 	/// \brief Decrypts and verifies a MAC in one call
@@ -245,8 +272,27 @@ public:
 	/// <tt>message</tt> is a decryption buffer and should be at least as large as the ciphertext buffer.
 	/// \details The function returns true iff MAC is valid. DecryptAndVerify() assumes the MAC
 	///  is truncated if <tt>macLength < TagSize()</tt>.
+	/// \details Since Crypto++ 8.5 the ciphertext is authenticated and decrypted in one
+	///   pass, and the stitched AVX2 kernel is used when available.
 	virtual bool DecryptAndVerify(byte *message, const byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *ciphertext, size_t ciphertextLength);
 
+	/// \brief Encrypts and calculates a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \details Short messages are gathered into groups, and the keystream for a
+	///   group comes from AVX2 or AVX-512 calls that give each block its own state.
+	///   Longer messages use the one-pass EncryptAndAuthenticate() path.
+	/// \since Crypto++ 8.5
+	void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+
+	/// \brief Decrypts and verifies a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \return true if every MAC is valid, false otherwise
+	/// \sa EncryptAndAuthenticateBatch()
+	/// \since Crypto++ 8.5
+	bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const {return false;}
@@ -261,6 +307,10 @@ protected:
 	// See comments in chachapoly.cpp
 	void RekeyCipherAndMac(const byte *userKey, size_t userKeyLength, const NameValuePairs &params);
 
+	// Key, IV and length checks, and the cipher state for the one-pass
+	// EncryptAndAuthenticate and DecryptAndVerify
+	void SetupState(word32 state[16], const byte *iv, int ivLength, size_t macSize, size_t messageLength);
+
 	virtual const MessageAuthenticationCode & GetMAC() const = 0;
 	virtual MessageAuthenticationCode & AccessMAC() = 0;
 
@@ -163,6 +163,23 @@
 #define CRYPTOPP_AVX2_AVAILABLE 1
 #endif
 
+// VAES and VPCLMULQDQ on 256-bit registers. Requires Binutils 2.30
+#if !defined(CRYPTOPP_DISABLE_VAES) && defined(CRYPTOPP_AVX2_AVAILABLE) && \
+	defined(CRYPTOPP_AESNI_AVAILABLE) && defined(CRYPTOPP_CLMUL_AVAILABLE) && \
+	(defined(__VAES__) || (CRYPTOPP_MSC_VERSION >= 1920) || \
+	(CRYPTOPP_GCC_VERSION >= 80000) || (__INTEL_COMPILER >= 1800) || \
+	(CRYPTOPP_LLVM_CLANG_VERSION >= 60000) || (CRYPTOPP_APPLE_CLANG_VERSION >= 100000))
+#define CRYPTOPP_VAES_AVAILABLE 1
+#endif
+
+// VAES and VPCLMULQDQ on 512-bit registers. Requires Binutils 2.30
+#if !defined(CRYPTOPP_DISABLE_AVX512) && defined(CRYPTOPP_VAES_AVAILABLE) && \
+	(defined(__AVX512F__) || (CRYPTOPP_MSC_VERSION >= 1920) || \
+	(CRYPTOPP_GCC_VERSION >= 80000) || (__INTEL_COMPILER >= 1800) || \
+	(CRYPTOPP_LLVM_CLANG_VERSION >= 60000) || (CRYPTOPP_APPLE_CLANG_VERSION >= 100000))
+#define CRYPTOPP_AVX512_AVAILABLE 1
+#endif
+
 // Guessing at SHA for SunCC. Its not in Sun Studio 12.6. Also see
 // http://stackoverflow.com/questions/45872180/which-xarch-for-sha-extensions-on-solaris
 #if !defined(CRYPTOPP_DISABLE_SHANI) && defined(CRYPTOPP_SSE42_AVAILABLE) && \
@@ -209,6 +226,8 @@
 #  undef CRYPTOPP_RDSEED_AVAILABLE
 #  undef CRYPTOPP_AVX_AVAILABLE
 #  undef CRYPTOPP_AVX2_AVAILABLE
+#  undef CRYPTOPP_VAES_AVAILABLE
+#  undef CRYPTOPP_AVX512_AVAILABLE
 # endif
 # if (CRYPTOPP_BOOL_X64)
 #  undef CRYPTOPP_CLMUL_AVAILABLE
@@ -218,6 +237,8 @@
 #  undef CRYPTOPP_RDSEED_AVAILABLE
 #  undef CRYPTOPP_AVX_AVAILABLE
 #  undef CRYPTOPP_AVX2_AVAILABLE
+#  undef CRYPTOPP_VAES_AVAILABLE
+#  undef CRYPTOPP_AVX512_AVAILABLE
 # endif
 #endif
 
@@ -294,6 +294,9 @@ bool CRYPTOPP_SECTION_INIT g_hasCLMUL = false;
 bool CRYPTOPP_SECTION_INIT g_hasMOVBE = false;
 bool CRYPTOPP_SECTION_INIT g_hasAVX = false;
 bool CRYPTOPP_SECTION_INIT g_hasAVX2 = false;
+bool CRYPTOPP_SECTION_INIT g_hasAVX512F = false;
+bool CRYPTOPP_SECTION_INIT g_hasVAES = false;
+bool CRYPTOPP_SECTION_INIT g_hasVPCLMULQDQ = false;
 bool CRYPTOPP_SECTION_INIT g_hasADX = false;
 bool CRYPTOPP_SECTION_INIT g_hasSHA = false;
 bool CRYPTOPP_SECTION_INIT g_hasRDRAND = false;
@@ -556,6 +559,9 @@ void DetectX86Features()
 		CRYPTOPP_CONSTANT(   ADX_FLAG = (1 << 19));
 		CRYPTOPP_CONSTANT(   SHA_FLAG = (1 << 29));
 		CRYPTOPP_CONSTANT(  AVX2_FLAG = (1 <<  5));
+		CRYPTOPP_CONSTANT(AVX512F_FLAG = (1 << 16));
+		CRYPTOPP_CONSTANT(   VAES_FLAG = (1 <<  9));
+		CRYPTOPP_CONSTANT(VPCLMULQDQ_FLAG = (1 << 10));
 
 		g_isP4 = ((cpuid1[0] >> 8) & 0xf) == 0xf;
 		g_cacheLineSize = 8 * GETBYTE(cpuid1[1], 1);
@@ -569,6 +575,9 @@ void DetectX86Features()
 				g_hasADX    = (cpuid2[EBX_REG] & ADX_FLAG) != 0;
 				g_hasSHA    = (cpuid2[EBX_REG] & SHA_FLAG) != 0;
 				g_hasAVX2   = (cpuid2[EBX_REG] & AVX2_FLAG) != 0;
+				g_hasAVX512F = (cpuid2[EBX_REG] & AVX512F_FLAG) != 0;
+				g_hasVAES   = (cpuid2[ECX_REG] & VAES_FLAG) != 0;
+				g_hasVPCLMULQDQ = (cpuid2[ECX_REG] & VPCLMULQDQ_FLAG) != 0;
 			}
 		}
 	}
@@ -579,6 +588,9 @@ void DetectX86Features()
 		CRYPTOPP_CONSTANT(   ADX_FLAG = (1 << 19));
 		CRYPTOPP_CONSTANT(   SHA_FLAG = (1 << 29));
 		CRYPTOPP_CONSTANT(  AVX2_FLAG = (1 <<  5));
+		CRYPTOPP_CONSTANT(AVX512F_FLAG = (1 << 16));
+		CRYPTOPP_CONSTANT(   VAES_FLAG = (1 <<  9));
+		CRYPTOPP_CONSTANT(VPCLMULQDQ_FLAG = (1 << 10));
 
 		CpuId(0x80000005, 0, cpuid2);
 		g_cacheLineSize = GETBYTE(cpuid2[ECX_REG], 0);
@@ -592,6 +604,9 @@ void DetectX86Features()
 				g_hasADX    = (cpuid2[EBX_REG] & ADX_FLAG) != 0;
 				g_hasSHA    = (cpuid2[EBX_REG] & SHA_FLAG) != 0;
 				g_hasAVX2   = (cpuid2[EBX_REG] & AVX2_FLAG) != 0;
+				g_hasAVX512F = (cpuid2[EBX_REG] & AVX512F_FLAG) != 0;
+				g_hasVAES   = (cpuid2[ECX_REG] & VAES_FLAG) != 0;
+				g_hasVPCLMULQDQ = (cpuid2[ECX_REG] & VPCLMULQDQ_FLAG) != 0;
 			}
 		}
 
@@ -646,6 +661,20 @@ void DetectX86Features()
 	// cpu support and OS support, while AVX2 only tests cpu support.
 	g_hasAVX2 &= g_hasAVX;
 
+	// AVX-512 also needs the OS to save the opmask and ZMM state.
+	// VAES and VPCLMULQDQ are only used with AVX2 or AVX-512 code.
+	if (g_hasAVX2 && g_hasAVX512F)
+	{
+		CRYPTOPP_CONSTANT(ZMM_FLAG = (7 << 5));  // CR0
+		word64 xcr0 = XGetBV(0);
+		g_hasAVX512F = (xcr0 & ZMM_FLAG) == ZMM_FLAG;
+	}
+	else
+		g_hasAVX512F = false;
+
+	g_hasVAES &= g_hasAVX2 && g_hasAESNI;
+	g_hasVPCLMULQDQ &= g_hasAVX2 && g_hasCLMUL;
+
 done:
 
 #if defined(_SC_LEVEL1_DCACHE_LINESIZE)
@@ -90,6 +90,9 @@ extern CRYPTOPP_DLL bool g_hasAESNI;
 extern CRYPTOPP_DLL bool g_hasCLMUL;
 extern CRYPTOPP_DLL bool g_hasAVX;
 extern CRYPTOPP_DLL bool g_hasAVX2;
+extern CRYPTOPP_DLL bool g_hasAVX512F;
+extern CRYPTOPP_DLL bool g_hasVAES;
+extern CRYPTOPP_DLL bool g_hasVPCLMULQDQ;
 extern CRYPTOPP_DLL bool g_hasSHA;
 extern CRYPTOPP_DLL bool g_hasADX;
 extern CRYPTOPP_DLL bool g_isP4;
@@ -283,6 +286,59 @@ inline bool HasAVX2()
 #endif
 }
 
+/// \brief Determine AVX-512 Foundation availability
+/// \return true if AVX512F is determined to be available, false otherwise
+/// \details HasAVX512F() is a runtime check performed using CPUID. The
+///  check includes OS support for the opmask and ZMM register state.
+/// \since Crypto++ 8.5
+/// \note This function is only available on Intel IA-32 platforms
+inline bool HasAVX512F()
+{
+#if CRYPTOPP_AVX512_AVAILABLE
+	if (!g_x86DetectionDone)
+		DetectX86Features();
+	return g_hasAVX512F;
+#else
+	return false;
+#endif
+}
+
+/// \brief Determine VAES availability
+/// \return true if VAES is determined to be available, false otherwise
+/// \details HasVAES() is a runtime check performed using CPUID. VAES
+///  provides AES round instructions on 256-bit and 512-bit registers.
+///  HasVAES() also requires AVX2.
+/// \since Crypto++ 8.5
+/// \note This function is only available on Intel IA-32 platforms
+inline bool HasVAES()
+{
+#if CRYPTOPP_VAES_AVAILABLE
+	if (!g_x86DetectionDone)
+		DetectX86Features();
+	return g_hasVAES;
+#else
+	return false;
+#endif
+}
+
+/// \brief Determine VPCLMULQDQ availability
+/// \return true if VPCLMULQDQ is determined to be available, false otherwise
+/// \details HasVPCLMULQDQ() is a runtime check performed using CPUID.
+///  VPCLMULQDQ provides carryless multiplies on 256-bit and 512-bit
+///  registers. HasVPCLMULQDQ() also requires AVX2.
+/// \since Crypto++ 8.5
+/// \note This function is only available on Intel IA-32 platforms
+inline bool HasVPCLMULQDQ()
+{
+#if CRYPTOPP_VAES_AVAILABLE
+	if (!g_x86DetectionDone)
+		DetectX86Features();
+	return g_hasVPCLMULQDQ;
+#else
+	return false;
+#endif
+}
+
 /// \brief Determine RDRAND availability
 /// \return true if RDRAND is determined to be available, false otherwise
 /// \details HasRDRAND() is a runtime check performed using CPUID
@@ -262,6 +262,46 @@ bool AuthenticatedSymmetricCipher::DecryptAndVerify(byte *message, const byte *m
 	return TruncatedVerify(mac, macLength);
 }
 
+void AuthenticatedSymmetricCipher::ThrowIfInvalidBatch(const BatchMessage *messages, size_t count)
+{
+	for (size_t i=0; i<count; ++i)
+	{
+		const BatchMessage &m = messages[i];
+		ThrowIfInvalidIVLength(m.ivLength);
+		ThrowIfInvalidTruncatedSize(m.macSize);
+
+		if (m.headerLength > MaxHeaderLength())
+			throw InvalidArgument(GetAlgorithm().AlgorithmName() + ": header length " + IntToString(m.headerLength) + " exceeds the maximum of " + IntToString(MaxHeaderLength()));
+
+		if (m.length > MaxMessageLength())
+			throw InvalidArgument(GetAlgorithm().AlgorithmName() + ": message length " + IntToString(m.length) + " exceeds the maximum of " + IntToString(MaxMessageLength()));
+	}
+}
+
+void AuthenticatedSymmetricCipher::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+	ThrowIfInvalidBatch(messages, count);
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		EncryptAndAuthenticate(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+	}
+}
+
+bool AuthenticatedSymmetricCipher::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+	ThrowIfInvalidBatch(messages, count);
+
+	bool pass = true;
+	for (size_t i=0; i<count; ++i)
+	{
+		BatchMessage &m = messages[i];
+		m.verified = DecryptAndVerify(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+		pass = pass && m.verified;
+	}
+	return pass;
+}
+
 std::string AuthenticatedSymmetricCipher::AlgorithmName() const
 {
 	// Squash C4505 on Visual Studio 2008 and friends
@@ -1393,6 +1393,63 @@ public:
 	///  is truncated if <tt>macLength < TagSize()</tt>.
 	virtual bool DecryptAndVerify(byte *message, const byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength);
 
+	/// \brief A message for the batch interfaces
+	/// \details BatchMessage describes one message for EncryptAndAuthenticateBatch()
+	///  and DecryptAndVerifyBatch(). The members have the same meaning as the
+	///  parameters of EncryptAndAuthenticate() and DecryptAndVerify(). When encrypting
+	///  <tt>mac</tt> receives the MAC, and when decrypting it supplies the MAC.
+	/// \since Crypto++ 8.5
+	struct BatchMessage
+	{
+		BatchMessage() : output(NULLPTR), mac(NULLPTR), macSize(0), iv(NULLPTR), ivLength(-1),
+			header(NULLPTR), headerLength(0), input(NULLPTR), length(0), verified(false) {}
+
+		/// \brief the ciphertext or recovered message buffer
+		byte *output;
+		/// \brief the MAC buffer
+		byte *mac;
+		/// \brief the size of the MAC buffer, in bytes
+		size_t macSize;
+		/// \brief the iv buffer
+		const byte *iv;
+		/// \brief the size of the IV buffer, in bytes, or -1 to use IVSize()
+		int ivLength;
+		/// \brief the AAD buffer
+		const byte *header;
+		/// \brief the size of the AAD buffer, in bytes
+		size_t headerLength;
+		/// \brief the message or ciphertext buffer
+		const byte *input;
+		/// \brief the size of the input and output buffers, in bytes
+		size_t length;
+		/// \brief set by DecryptAndVerifyBatch() if the MAC is valid
+		bool verified;
+	};
+
+	/// \brief Encrypts and calculates a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \details EncryptAndAuthenticateBatch() produces the same ciphertexts and MACs
+	///  as calling EncryptAndAuthenticate() for each message. GCM, CCM and the
+	///  ChaCha20Poly1305 family interleave short messages through the cipher's
+	///  SIMD kernels. Other schemes call EncryptAndAuthenticate() for each message.
+	/// \details Each message needs its own IV. The IV, MAC, header and message
+	///  sizes are checked for all messages before any message is processed.
+	/// \since Crypto++ 8.5
+	virtual void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+
+	/// \brief Decrypts and verifies a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \return true if every MAC is valid, false otherwise
+	/// \details DecryptAndVerifyBatch() produces the same results as calling
+	///  DecryptAndVerify() for each message, and sets <tt>verified</tt> in each
+	///  message. As with DecryptAndVerify(), the output buffer holds the decrypted
+	///  data even if the MAC is not valid.
+	/// \sa EncryptAndAuthenticateBatch()
+	/// \since Crypto++ 8.5
+	virtual bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
 	/// \brief Provides the name of this algorithm
 	/// \return the standard algorithm name
 	/// \details The standard algorithm name can be a name like \a AES or \a AES/GCM. Some algorithms
@@ -1405,6 +1462,13 @@ protected:
 		{return *static_cast<const MessageAuthenticationCode *>(this);}
 	virtual void UncheckedSpecifyDataLengths(lword headerLength, lword messageLength, lword footerLength)
 		{CRYPTOPP_UNUSED(headerLength); CRYPTOPP_UNUSED(messageLength); CRYPTOPP_UNUSED(footerLength);}
+
+	/// \brief Validates the messages of a batch
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \throw InvalidArgument if an IV, MAC, header or message size is not valid
+	/// \since Crypto++ 8.5
+	void ThrowIfInvalidBatch(const BatchMessage *messages, size_t count);
 };
 
 /// \brief Interface for random number generators
@@ -18,8 +18,11 @@
 /// \details This header provides the entry points into Andrew Moon's
 ///   curve25519 and ed25519 curve functions. The Crypto++ classes x25519
 ///   and ed25519 use the functions. The functions are in the <tt>Donna</tt>
-///   namespace and are curve25519_mult(), ed25519_publickey(),
-///   ed25519_sign() and ed25519_sign_open().
+///   namespace and are curve25519_mult(), curve25519_mult_batch(),
+///   ed25519_publickey(), ed25519_expand_secret(), ed25519_sign(),
+///   ed25519_sign_expanded(), ed25519_sign_batch(), ed25519_sign_open(),
+///   ed25519_sign_dom2(), ed25519_sign_open_dom2() and
+///   ed25519_sign_open_batch().
 /// \details At the moment the hash function for signing is fixed at
 ///   SHA512.
 
@@ -55,6 +58,21 @@ int curve25519_mult(byte publicKey[32], const byte secretKey[32]);
 ///   and writes the result to <tt>sharedKey</tt>.
 int curve25519_mult(byte sharedKey[32], const byte secretKey[32], const byte othersKey[32]);
 
+/// \brief Generate a batch of shared keys
+/// \param sharedKeys byte array for count shared secrets
+/// \param secretKeys byte array with count private keys
+/// \param othersKeys byte array with count peer public keys
+/// \param count the number of key agreements
+/// \return 0 on success, non-0 otherwise
+/// \details curve25519_mult_batch() performs count independent key
+///   agreements. The arrays hold consecutive 32-byte keys, and entry
+///   <tt>i</tt> of <tt>sharedKeys</tt> is the same as curve25519_mult()
+///   with entry <tt>i</tt> of <tt>secretKeys</tt> and <tt>othersKeys</tt>.
+/// \details On machines with AVX2 four Montgomery ladders run at once, one
+///   in each 64-bit lane. Entries left over are computed one at a time.
+/// \since Crypto++ 8.5
+int curve25519_mult_batch(byte sharedKeys[], const byte secretKeys[], const byte othersKeys[], size_t count);
+
 //******************************* ed25519 *******************************//
 
 /// \brief Creates a public key from a secret key
@@ -98,6 +116,49 @@ int ed25519_sign(const byte* message, size_t messageLength, const byte secretKey
 ///   SHA512.
 int ed25519_sign(std::istream& stream, const byte secretKey[32], const byte publicKey[32], byte signature[64]);
 
+/// \brief Expands a secret key
+/// \param expandedKey byte array for the expanded key
+/// \param secretKey byte array with the private key
+/// \return 0 on success, non-0 otherwise
+/// \details ed25519_expand_secret() hashes the secret key with SHA-512 and
+///   clamps the result. The first 32 bytes are the secret scalar and the last
+///   32 bytes are the nonce prefix. ed25519_sign() does the same work on each
+///   call, so a signer that signs many messages can expand the key once and
+///   call ed25519_sign_expanded() or ed25519_sign_batch().
+/// \details The expanded key is as sensitive as the secret key.
+/// \since Crypto++ 8.5
+int ed25519_expand_secret(byte expandedKey[64], const byte secretKey[32]);
+
+/// \brief Creates a signature on a message with an expanded key
+/// \param message byte array with the message
+/// \param messageLength size of the message, in bytes
+/// \param expandedKey byte array with the expanded private key
+/// \param publicKey byte array with the public key
+/// \param signature byte array for the signature
+/// \return 0 on success, non-0 otherwise
+/// \details ed25519_sign_expanded() is ed25519_sign() without the key
+///   expansion. The <tt>expandedKey</tt> is from ed25519_expand_secret().
+/// \since Crypto++ 8.5
+int ed25519_sign_expanded(const byte* message, size_t messageLength, const byte expandedKey[64],
+                          const byte publicKey[32], byte signature[64]);
+
+/// \brief Creates signatures on a batch of messages
+/// \param messages array of pointers to the messages
+/// \param messageLengths array of message sizes, in bytes
+/// \param expandedKey byte array with the expanded private key
+/// \param publicKey byte array with the public key
+/// \param signatures array of pointers to the signatures, each 64 bytes
+/// \param count the number of messages
+/// \return 0 on success, non-0 otherwise
+/// \details ed25519_sign_batch() signs count messages with one key. The
+///   signatures are the same as ed25519_sign_expanded(). The nonce points
+///   are converted from projective to affine coordinates in groups of 32
+///   with one shared field inversion, which saves most of the cost of
+///   encoding the points.
+/// \since Crypto++ 8.5
+int ed25519_sign_batch(const byte* const messages[], const size_t messageLengths[], const byte expandedKey[64],
+                       const byte publicKey[32], byte* const signatures[], size_t count);
+
 /// \brief Verifies a signature on a message
 /// \param message byte array with the message
 /// \param messageLength size of the message, in bytes
@@ -128,6 +189,68 @@ ed25519_sign_open(const byte *message, size_t messageLength, const byte publicKe
 int
 ed25519_sign_open(std::istream& stream, const byte publicKey[32], const byte signature[64]);
 
+/// \brief Creates an Ed25519ph or Ed25519ctx signature on a message
+/// \param message byte array with the message, or the prehash for Ed25519ph
+/// \param messageLength size of the message, in bytes
+/// \param secretKey byte array with the private key
+/// \param publicKey byte array with the public key
+/// \param signature byte array for the signature
+/// \param phflag 1 for Ed25519ph, 0 for Ed25519ctx
+/// \param context byte array with the context
+/// \param contextLength size of the context, in bytes
+/// \return 0 on success, non-0 otherwise
+/// \details ed25519_sign_dom2() signs with the RFC 8032 variants that hash
+///   <tt>dom2(phflag, context)</tt> ahead of the nonce and the challenge.
+///   For Ed25519ph the message is the 64-byte SHA-512 digest of the real
+///   message, so the real message is read only once.
+/// \details The function fails if <tt>contextLength</tt> is greater
+///   than 255.
+/// \since Crypto++ 8.5
+int ed25519_sign_dom2(const byte* message, size_t messageLength, const byte secretKey[32], const byte publicKey[32],
+                      byte signature[64], int phflag, const byte* context, size_t contextLength);
+
+/// \brief Verifies an Ed25519ph or Ed25519ctx signature on a message
+/// \param message byte array with the message, or the prehash for Ed25519ph
+/// \param messageLength size of the message, in bytes
+/// \param publicKey byte array with the public key
+/// \param signature byte array with the signature
+/// \param phflag 1 for Ed25519ph, 0 for Ed25519ctx
+/// \param context byte array with the context
+/// \param contextLength size of the context, in bytes
+/// \return 0 on success, non-0 otherwise
+/// \details ed25519_sign_open_dom2() verifies a signature made with
+///   ed25519_sign_dom2(). The <tt>phflag</tt> and <tt>context</tt> must
+///   match the ones used for signing.
+/// \since Crypto++ 8.5
+int
+ed25519_sign_open_dom2(const byte *message, size_t messageLength, const byte publicKey[32], const byte signature[64],
+                       int phflag, const byte* context, size_t contextLength);
+
+/// \brief Verifies a batch of signatures
+/// \param rng a RandomNumberGenerator derived class
+/// \param messages array of pointers to the messages
+/// \param messageLengths array of message sizes, in bytes
+/// \param publicKeys array of pointers to the public keys
+/// \param signatures array of pointers to the signatures
+/// \param count the number of signatures
+/// \param valid array of count results, 1 if the signature is valid, 0 otherwise
+/// \return 0 if all signatures are valid, non-0 otherwise
+/// \details ed25519_sign_open_batch() verifies up to 128 signatures at once
+///   with a random linear combination of the verification equations and a
+///   Bos-Coster multi-scalar multiplication. If a batch does not verify then
+///   its signatures are verified one at a time to find the bad ones. Batches
+///   of fewer than 4 signatures are verified one at a time.
+/// \details The results are the same as ed25519_sign_open(), except for a
+///   signature whose only flaw is a small order component. Such a signature
+///   is rejected by ed25519_sign_open(), and it may be accepted by the batch
+///   equation. Honestly generated signatures do not have the problem.
+/// \details At the moment the hash function for signing is fixed at
+///   SHA512.
+/// \since Crypto++ 8.5
+int
+ed25519_sign_open_batch(RandomNumberGenerator& rng, const byte* const messages[], const size_t messageLengths[],
+                        const byte* const publicKeys[], const byte* const signatures[], size_t count, int valid[]);
+
 //****************************** Internal ******************************//
 
 #ifndef CRYPTOPP_DOXYGEN_PROCESSING
@@ -170,6 +293,10 @@ ed25519_sign_open(std::istream& stream, const byte publicKey[32], const byte sig
   extern int curve25519_mult_SSE2(byte sharedKey[32], const byte secretKey[32], const byte othersKey[32]);
 #endif
 
+#if (CRYPTOPP_AVX2_AVAILABLE)
+  extern int curve25519_mult_AVX2(byte sharedKeys[4*32], const byte secretKeys[4*32], const byte othersKeys[4*32]);
+#endif
+
 #endif  // CRYPTOPP_DOXYGEN_PROCESSING
 
 NAMESPACE_END  // Donna
@@ -1110,6 +1110,15 @@ ed25519_hram(hash_512bits hram, const byte RS[64], const byte pk[32], std::istre
     hash.Final(hram);
 }
 
+/* dom2(phflag, context) from RFC 8032, which separates Ed25519ph and Ed25519ctx from Ed25519 */
+void
+ed25519_dom2(HashTransformation& hash, byte phflag, const byte *ctx, size_t ctxlen) {
+    const byte flags[2] = {phflag, (byte)ctxlen};
+    hash.Update((const byte*)"SigEd25519 no Ed25519 collisions", 32);
+    hash.Update(flags, 2);
+    hash.Update(ctx, ctxlen);
+}
+
 inline bignum256modm_element_t
 lt_modm(bignum256modm_element_t a, bignum256modm_element_t b) {
     return (a - b) >> 31;
@@ -1793,6 +1802,244 @@ ge25519_scalarmult_base_niels(ge25519 *r, const byte basepoint_table[256][96], c
     }
 }
 
+/* batch verification, from ed25519-donna-batchverify.h */
+
+/* r = a - b, a >= b, not reduced */
+void
+sub256_modm_batch(bignum256modm out, const bignum256modm a, const bignum256modm b) {
+    const bignum256modm_element_t mask = ((bignum256modm_element_t)1 << bignum256modm_bits_per_limb) - 1;
+    const int topbit = (int)(sizeof(bignum256modm_element_t) * 8 - 1);
+    bignum256modm_element_t carry = 0;
+    int i;
+
+    for (i = 0; i < bignum256modm_limb_size; i++) {
+        out[i] = (a[i] - b[i]) - carry;
+        carry = out[i] >> topbit;
+        out[i] &= mask;
+    }
+}
+
+/* a < b */
+int
+lt256_modm_batch(const bignum256modm a, const bignum256modm b) {
+    int i = bignum256modm_limb_size;
+    while (i--) {
+        if (a[i] != b[i])
+            return a[i] < b[i];
+    }
+    return 0;
+}
+
+/* a == 0 */
+int
+iszero256_modm_batch(const bignum256modm a) {
+    bignum256modm_element_t bits = 0;
+    for (int i = 0; i < bignum256modm_limb_size; i++)
+        bits |= a[i];
+    return bits == 0;
+}
+
+/* a == 1 */
+int
+isone256_modm_batch(const bignum256modm a) {
+    bignum256modm_element_t bits = a[0] ^ 1;
+    for (int i = 1; i < bignum256modm_limb_size; i++)
+        bits |= a[i];
+    return bits == 0;
+}
+
+/* a < 2^128 */
+int
+isatmost128bits256_modm_batch(const bignum256modm a) {
+    const int limb = 128 / bignum256modm_bits_per_limb;
+    bignum256modm_element_t bits = a[limb] >> (128 % bignum256modm_bits_per_limb);
+    for (int i = limb + 1; i < bignum256modm_limb_size; i++)
+        bits |= a[i];
+    return bits == 0;
+}
+
+/* like ge25519_unpack_negative_vartime, but also rejects the encodings
+   ge25519_pack never produces, a non-reduced y or a negative zero x.
+   ed25519_sign_open compares R with a packed point, so it rejects them. */
+int
+ge25519_unpack_negative_strict_vartime(ge25519 *r, const byte p[32]) {
+    const byte zero[32] = {0};
+    byte check[32];
+
+    if (!ge25519_unpack_negative_vartime(r, p))
+        return 0;
+
+    curve25519_contract(check, r->y);
+    check[31] |= p[31] & 0x80;
+    if (!ed25519_verify(check, p, 32))
+        return 0;
+
+    curve25519_contract(check, r->x);
+    if ((p[31] & 0x80) && ed25519_verify(check, zero, 32))
+        return 0;
+
+    return 1;
+}
+
+int
+ge25519_is_neutral_vartime(const ge25519 *p) {
+    const byte zero[32] = {0};
+    byte x[32], y[32], z[32];
+
+    curve25519_contract(x, p->x);
+    curve25519_contract(y, p->y);
+    curve25519_contract(z, p->z);
+    return ed25519_verify(x, zero, 32) && ed25519_verify(y, z, 32);
+}
+
+#define MAX_BATCH_SIZE 128
+#define HEAP_BATCH_SIZE ((MAX_BATCH_SIZE * 2) + 1)
+
+/* scalars[0] is for the basepoint, scalars[1..k] are the sums of
+   r[i]*H(R,A,m) for the k distinct public keys and the next n scalars
+   are r[i] for the R points. The heap orders the indices by scalar,
+   largest first. */
+struct batch_heap {
+    ge25519 points[HEAP_BATCH_SIZE];
+    bignum256modm scalars[HEAP_BATCH_SIZE];
+    size_t heap[HEAP_BATCH_SIZE];
+    size_t size;
+};
+
+/* add the next scalar to the heap */
+void
+heap_insert_next(batch_heap *heap) {
+    size_t node = heap->size, parent;
+    size_t *pheap = heap->heap;
+    const bignum256modm *scalars = heap->scalars;
+
+    pheap[node] = node;
+    while (node) {
+        parent = (node - 1) / 2;
+        if (!lt256_modm_batch(scalars[pheap[parent]], scalars[pheap[node]]))
+            break;
+        std::swap(pheap[parent], pheap[node]);
+        node = parent;
+    }
+    heap->size++;
+}
+
+/* restore the heap after the root scalar shrinks. The root usually
+   belongs near the bottom, so move it down along the larger children
+   and then back up to its place. */
+void
+heap_updated_root(batch_heap *heap) {
+    size_t node = 0, child = 1, parent;
+    size_t *pheap = heap->heap;
+    const bignum256modm *scalars = heap->scalars;
+
+    while (child < heap->size) {
+        if (child + 1 < heap->size && lt256_modm_batch(scalars[pheap[child]], scalars[pheap[child + 1]]))
+            child++;
+        std::swap(pheap[node], pheap[child]);
+        node = child;
+        child = (node * 2) + 1;
+    }
+
+    while (node) {
+        parent = (node - 1) / 2;
+        if (!lt256_modm_batch(scalars[pheap[parent]], scalars[pheap[node]]))
+            break;
+        std::swap(pheap[parent], pheap[node]);
+        node = parent;
+    }
+}
+
+void
+heap_extend(batch_heap *heap, size_t count) {
+    while (heap->size < count)
+        heap_insert_next(heap);
+}
+
+/* the two largest scalars, heap size must be >= 3 */
+void
+heap_get_top2(const batch_heap *heap, size_t *max1, size_t *max2) {
+    size_t h1 = heap->heap[1], h2 = heap->heap[2];
+    if (lt256_modm_batch(heap->scalars[h1], heap->scalars[h2]))
+        h1 = h2;
+    *max1 = heap->heap[0];
+    *max2 = h1;
+}
+
+/* r = [scalar]point, the scalar is usually 1 after Bos-Coster */
+void
+ge25519_multi_scalarmult_vartime_final(ge25519 *r, const ge25519 *point, const bignum256modm scalar) {
+    const bignum256modm_element_t topbit = (bignum256modm_element_t)1 << (bignum256modm_bits_per_limb - 1);
+    bignum256modm_element_t flag;
+    int limb = bignum256modm_limb_size - 1;
+
+    if (isone256_modm_batch(scalar)) {
+        *r = *point;
+        return;
+    } else if (iszero256_modm_batch(scalar)) {
+        memset(r, 0, sizeof(*r));
+        r->y[0] = 1;
+        r->z[0] = 1;
+        return;
+    }
+
+    *r = *point;
+
+    /* find the first set bit, it is the point itself */
+    while (!scalar[limb])
+        limb--;
+    flag = topbit;
+    while ((scalar[limb] & flag) == 0)
+        flag >>= 1;
+
+    for (;;) {
+        flag >>= 1;
+        if (!flag) {
+            if (!limb--)
+                break;
+            flag = topbit;
+        }
+
+        ge25519_double(r, r);
+        if (scalar[limb] & flag)
+            ge25519_add(r, r, point);
+    }
+}
+
+/* r = sum [scalars[i]]points[i] using Bos-Coster, count must be >= 5.
+   The heap starts with the first large scalars. The 128-bit random
+   scalars join once the largest scalar is no longer than them. */
+void
+ge25519_multi_scalarmult_vartime(ge25519 *r, batch_heap *heap, size_t count, size_t large) {
+    size_t max1, max2;
+    bool extended = false;
+
+    heap->size = 0;
+    heap_extend(heap, (large < 3) ? 3 : large);
+
+    for (;;) {
+        heap_get_top2(heap, &max1, &max2);
+
+        if (!extended && (iszero256_modm_batch(heap->scalars[max2]) ||
+            isatmost128bits256_modm_batch(heap->scalars[max1]))) {
+            heap_extend(heap, count);
+            extended = true;
+            continue;
+        }
+
+        /* only one scalar remaining */
+        if (iszero256_modm_batch(heap->scalars[max2]))
+            break;
+
+        /* s1 P1 + s2 P2 = (s1 - s2) P1 + s2 (P1 + P2) */
+        sub256_modm_batch(heap->scalars[max1], heap->scalars[max1], heap->scalars[max2]);
+        ge25519_add(&heap->points[max2], &heap->points[max2], &heap->points[max1]);
+        heap_updated_root(heap);
+    }
+
+    ge25519_multi_scalarmult_vartime_final(r, &heap->points[max1], heap->scalars[max1]);
+}
+
 ANONYMOUS_NAMESPACE_END
 NAMESPACE_END  // Ed25519
 NAMESPACE_END  // Donna
@@ -1894,6 +2141,30 @@ int curve25519_mult(byte sharedKey[32], const byte secretKey[32], const byte oth
     return curve25519_mult_CXX(sharedKey, secretKey, othersKey);
 }
 
+int curve25519_mult_batch(byte sharedKeys[], const byte secretKeys[], const byte othersKeys[], size_t count)
+{
+    int ret = 0;
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+    {
+        for ( ; count >= 4; count -= 4)
+        {
+            ret |= curve25519_mult_AVX2(sharedKeys, secretKeys, othersKeys);
+            sharedKeys += 4*32; secretKeys += 4*32; othersKeys += 4*32;
+        }
+    }
+#endif
+
+    for ( ; count; --count)
+    {
+        ret |= curve25519_mult(sharedKeys, secretKeys, othersKeys);
+        sharedKeys += 32; secretKeys += 32; othersKeys += 32;
+    }
+
+    return ret;
+}
+
 NAMESPACE_END  // Donna
 NAMESPACE_END  // CryptoPP
 
@@ -1976,15 +2247,13 @@ ed25519_sign_CXX(std::istream& stream, const byte sk[32], const byte pk[32], byt
 }
 
 int
-ed25519_sign_CXX(const byte *m, size_t mlen, const byte sk[32], const byte pk[32], byte RS[64])
+ed25519_sign_extsk_CXX(const byte *m, size_t mlen, const byte extsk[64], const byte pk[32], byte RS[64])
 {
     using namespace CryptoPP::Donna::Ed25519;
 
     bignum256modm r, S, a;
     ALIGN(ALIGN_SPEC) ge25519 R;
-    hash_512bits extsk, hashr, hram;
-
-    ed25519_extsk(extsk, sk);
+    hash_512bits hashr, hram;
 
     /* r = H(aExt[32..64], m) */
     SHA512 hash;
@@ -2010,6 +2279,85 @@ ed25519_sign_CXX(const byte *m, size_t mlen, const byte sk[32], const byte pk[32
 
     /* S = (r + H(R,A,m)a) mod L */
     contract256_modm(RS + 32, S);
+    return 0;
+}
+
+int
+ed25519_sign_CXX(const byte *m, size_t mlen, const byte sk[32], const byte pk[32], byte RS[64])
+{
+    using namespace CryptoPP::Donna::Ed25519;
+
+    hash_512bits extsk;
+    ed25519_extsk(extsk, sk);
+    return ed25519_sign_extsk_CXX(m, mlen, extsk, pk, RS);
+}
+
+/* Signs count messages with one key. The nonce points R = rB are made in
+   groups of up to 32 and converted to affine with one shared inversion. */
+int
+ed25519_sign_batch_CXX(const byte* const m[], const size_t mlen[], const byte extsk[64], const byte pk[32],
+                       byte* const RS[], size_t count)
+{
+    using namespace CryptoPP::Donna::Ed25519;
+
+    const size_t MAX_BATCH = 32;
+    bignum256modm r[MAX_BATCH], S, a;
+    ALIGN(ALIGN_SPEC) ge25519 R[MAX_BATCH];
+    bignum25519 zprod[MAX_BATCH], zi, zj, tx, ty;
+    hash_512bits hashr, hram;
+    byte parity[32];
+
+    expand256_modm(a, extsk, 32);
+
+    for (size_t base = 0; base < count; base += MAX_BATCH)
+    {
+        const size_t n = STDMIN(count - base, MAX_BATCH);
+
+        for (size_t i = 0; i < n; i++) {
+            /* r = H(aExt[32..64], m) */
+            SHA512 hash;
+            hash.Update(extsk + 32, 32);
+            hash.Update(m[base+i], mlen[base+i]);
+            hash.Final(hashr);
+            expand256_modm(r[i], hashr, 64);
+
+            /* R = rB, and the running product of the Z coordinates */
+            ge25519_scalarmult_base_niels(&R[i], ge25519_niels_base_multiples, r[i]);
+            if (i == 0)
+                curve25519_copy(zprod[0], R[0].z);
+            else
+                curve25519_mul(zprod[i], zprod[i-1], R[i].z);
+        }
+
+        /* zi = 1/(Z_0...Z_(n-1)) */
+        curve25519_recip(zi, zprod[n-1]);
+
+        for (size_t i = n; i-- > 0; ) {
+            byte* sig = RS[base+i];
+
+            /* zj = 1/Z_i, and zi = 1/(Z_0...Z_(i-1)) */
+            if (i == 0) {
+                curve25519_copy(zj, zi);
+            } else {
+                curve25519_mul(zj, zi, zprod[i-1]);
+                curve25519_mul(zi, zi, R[i].z);
+            }
+
+            /* pack R */
+            curve25519_mul(tx, R[i].x, zj);
+            curve25519_mul(ty, R[i].y, zj);
+            curve25519_contract(sig, ty);
+            curve25519_contract(parity, tx);
+            sig[31] ^= ((parity[0] & 1) << 7);
+
+            /* S = (r + H(R,A,m)a) mod L */
+            ed25519_hram(hram, sig, pk, m[base+i], mlen[base+i]);
+            expand256_modm(S, hram, 64);
+            mul256_modm(S, S, a);
+            add256_modm(S, S, r[i]);
+            contract256_modm(sig + 32, S);
+        }
+    }
 
     return 0;
 }
@@ -2028,6 +2376,29 @@ ed25519_sign(const byte* message, size_t messageLength, const byte secretKey[32]
     return ed25519_sign_CXX(message, messageLength, secretKey, publicKey, signature);
 }
 
+int
+ed25519_expand_secret(byte expandedKey[64], const byte secretKey[32])
+{
+    using namespace CryptoPP::Donna::Ed25519;
+
+    ed25519_extsk(expandedKey, secretKey);
+    return 0;
+}
+
+int
+ed25519_sign_expanded(const byte* message, size_t messageLength, const byte expandedKey[64],
+                      const byte publicKey[32], byte signature[64])
+{
+    return ed25519_sign_extsk_CXX(message, messageLength, expandedKey, publicKey, signature);
+}
+
+int
+ed25519_sign_batch(const byte* const messages[], const size_t messageLengths[], const byte expandedKey[64],
+                   const byte publicKey[32], byte* const signatures[], size_t count)
+{
+    return ed25519_sign_batch_CXX(messages, messageLengths, expandedKey, publicKey, signatures, count);
+}
+
 int
 ed25519_sign_open_CXX(std::istream& stream, const byte pk[32], const byte RS[64]) {
 
@@ -2096,6 +2467,200 @@ ed25519_sign_open(std::istream& stream, const byte publicKey[32], const byte sig
     return ed25519_sign_open_CXX(stream, publicKey, signature);
 }
 
+int
+ed25519_sign_dom2_CXX(const byte *m, size_t mlen, const byte sk[32], const byte pk[32], byte RS[64],
+                      byte phflag, const byte *ctx, size_t ctxlen)
+{
+    using namespace CryptoPP::Donna::Ed25519;
+
+    bignum256modm r, S, a;
+    ALIGN(ALIGN_SPEC) ge25519 R;
+    hash_512bits extsk, hashr, hram;
+
+    if (ctxlen > 255)
+        return -1;
+
+    ed25519_extsk(extsk, sk);
+
+    /* r = H(dom2, aExt[32..64], m) */
+    SHA512 hash;
+    ed25519_dom2(hash, phflag, ctx, ctxlen);
+    hash.Update(extsk + 32, 32);
+    hash.Update(m, mlen);
+    hash.Final(hashr);
+    expand256_modm(r, hashr, 64);
+
+    /* R = rB */
+    ge25519_scalarmult_base_niels(&R, ge25519_niels_base_multiples, r);
+    ge25519_pack(RS, &R);
+
+    /* S = H(dom2,R,A,m).. */
+    ed25519_dom2(hash, phflag, ctx, ctxlen);
+    hash.Update(RS, 32);
+    hash.Update(pk, 32);
+    hash.Update(m, mlen);
+    hash.Final(hram);
+    expand256_modm(S, hram, 64);
+
+    /* S = H(dom2,R,A,m)a */
+    expand256_modm(a, extsk, 32);
+    mul256_modm(S, S, a);
+
+    /* S = (r + H(dom2,R,A,m)a) */
+    add256_modm(S, S, r);
+
+    /* S = (r + H(dom2,R,A,m)a) mod L */
+    contract256_modm(RS + 32, S);
+    return 0;
+}
+
+int
+ed25519_sign_dom2(const byte* message, size_t messageLength, const byte secretKey[32],
+                  const byte publicKey[32], byte signature[64], int phflag, const byte* context, size_t contextLength)
+{
+    return ed25519_sign_dom2_CXX(message, messageLength, secretKey, publicKey, signature,
+                                 (byte)(phflag ? 1 : 0), context, contextLength);
+}
+
+int
+ed25519_sign_open_dom2_CXX(const byte *m, size_t mlen, const byte pk[32], const byte RS[64],
+                           byte phflag, const byte *ctx, size_t ctxlen) {
+
+    using namespace CryptoPP::Donna::Ed25519;
+
+    ALIGN(ALIGN_SPEC) ge25519 R, A;
+    hash_512bits hash;
+    bignum256modm hram, S;
+    byte checkR[32];
+
+    if (ctxlen > 255 || (RS[63] & 224) || !ge25519_unpack_negative_vartime(&A, pk))
+        return -1;
+
+    /* hram = H(dom2,R,A,m) */
+    SHA512 sha;
+    ed25519_dom2(sha, phflag, ctx, ctxlen);
+    sha.Update(RS, 32);
+    sha.Update(pk, 32);
+    sha.Update(m, mlen);
+    sha.Final(hash);
+    expand256_modm(hram, hash, 64);
+
+    /* S */
+    expand256_modm(S, RS + 32, 32);
+
+    /* SB - H(dom2,R,A,m)A */
+    ge25519_double_scalarmult_vartime(&R, &A, hram, S);
+    ge25519_pack(checkR, &R);
+
+    /* check that R = SB - H(dom2,R,A,m)A */
+    return ed25519_verify(RS, checkR, 32) ? 0 : -1;
+}
+
+int
+ed25519_sign_open_dom2(const byte *message, size_t messageLength, const byte publicKey[32],
+                       const byte signature[64], int phflag, const byte* context, size_t contextLength)
+{
+    return ed25519_sign_open_dom2_CXX(message, messageLength, publicKey, signature,
+                                      (byte)(phflag ? 1 : 0), context, contextLength);
+}
+
+int
+ed25519_sign_open_batch_CXX(RandomNumberGenerator& rng, const byte* const m[], const size_t mlen[],
+                            const byte* const pk[], const byte* const RS[], size_t num, int valid[])
+{
+    using namespace CryptoPP::Donna::Ed25519;
+
+    // About 50 KB, too much for the stack
+    member_ptr<batch_heap> batch(new batch_heap);
+    ALIGN(ALIGN_SPEC) ge25519 p;
+    bignum256modm *r_scalars, t;
+    byte r[MAX_BATCH_SIZE][16];
+    size_t key[MAX_BATCH_SIZE], index[MAX_BATCH_SIZE];
+    hash_512bits hram;
+    size_t i, j, keys, batchsize;
+    int ret = 0;
+
+    while (num > 3) {
+        batchsize = (num > MAX_BATCH_SIZE) ? MAX_BATCH_SIZE : num;
+        keys = 0;
+        bool ok = true;
+
+        /* ed25519_sign_open rejects S >= 2^253 */
+        for (i = 0; i < batchsize && ok; i++)
+            ok = !(RS[i][63] & 224);
+
+        /* compute points, -A for each distinct public key and -R[i] */
+        batch->points[0] = ge25519_basepoint;
+        for (i = 0; i < batchsize && ok; i++) {
+            for (j = 0; j < keys; j++)
+                if (pk[i] == pk[key[j]] || std::memcmp(pk[i], pk[key[j]], 32) == 0)
+                    break;
+            index[i] = j;
+            if (j == keys) {
+                key[keys++] = i;
+                ok = ge25519_unpack_negative_vartime(&batch->points[j+1], pk[i]) != 0;
+            }
+        }
+        for (i = 0; i < batchsize && ok; i++)
+            ok = ge25519_unpack_negative_strict_vartime(&batch->points[keys+i+1], RS[i]) != 0;
+
+        if (ok) {
+            /* generate r (scalars[keys+1]..scalars[keys+batchsize] */
+            rng.GenerateBlock(r[0], batchsize * 16);
+            r_scalars = &batch->scalars[keys + 1];
+            for (i = 0; i < batchsize; i++)
+                expand256_modm(r_scalars[i], r[i], 16);
+
+            /* compute scalars[0] = ((r1s1 + r2s2 + ...)) */
+            std::memset(batch->scalars, 0, (keys + 1) * sizeof(bignum256modm));
+            for (i = 0; i < batchsize; i++) {
+                expand256_modm(t, RS[i] + 32, 32);
+                mul256_modm(t, t, r_scalars[i]);
+                add256_modm(batch->scalars[0], batch->scalars[0], t);
+            }
+
+            /* add r[i]*H(R[i],A[i],m[i]) to the scalar of A[i] */
+            for (i = 0; i < batchsize; i++) {
+                ed25519_hram(hram, RS[i], pk[i], m[i], mlen[i]);
+                expand256_modm(t, hram, 64);
+                mul256_modm(t, t, r_scalars[i]);
+                add256_modm(batch->scalars[index[i]+1], batch->scalars[index[i]+1], t);
+            }
+
+            /* check that sum(r[i]*(S[i]B - H(R[i],A[i],m[i])A[i] - R[i])) = 0 */
+            ge25519_multi_scalarmult_vartime(&p, batch.get(), keys + batchsize + 1, keys + 1);
+            ok = ge25519_is_neutral_vartime(&p) != 0;
+        }
+
+        /* verify one at a time to find the bad signatures */
+        for (i = 0; i < batchsize; i++) {
+            valid[i] = ok ? 1 : (ed25519_sign_open_CXX(m[i], mlen[i], pk[i], RS[i]) ? 0 : 1);
+            ret |= (valid[i] ^ 1);
+        }
+
+        m += batchsize;
+        mlen += batchsize;
+        pk += batchsize;
+        RS += batchsize;
+        num -= batchsize;
+        valid += batchsize;
+    }
+
+    for (i = 0; i < num; i++) {
+        valid[i] = ed25519_sign_open_CXX(m[i], mlen[i], pk[i], RS[i]) ? 0 : 1;
+        ret |= (valid[i] ^ 1);
+    }
+
+    return ret ? -1 : 0;
+}
+
+int
+ed25519_sign_open_batch(RandomNumberGenerator& rng, const byte* const messages[], const size_t messageLengths[],
+                        const byte* const publicKeys[], const byte* const signatures[], size_t count, int valid[])
+{
+    return ed25519_sign_open_batch_CXX(rng, messages, messageLengths, publicKeys, signatures, count, valid);
+}
+
 NAMESPACE_END  // Donna
 NAMESPACE_END  // CryptoPP
 
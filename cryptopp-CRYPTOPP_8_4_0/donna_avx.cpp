@@ -0,0 +1,477 @@
+// donna_avx.cpp - written and placed in the public domain by
+//                 the Crypto++ project.
+//
+//    This source file uses intrinsics and built-ins to gain access to
+//    AVX2 instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    Four x25519 Montgomery ladders run side by side, one in each 64-bit
+//    lane. Field elements use ten limbs in radix 2^25.5 like donna_32.cpp,
+//    so a limb product fits in the 64-bit result of _mm256_mul_epu32. The
+//    ladder is the one from RFC 7748, Section 5, and it is constant time.
+
+#include "pch.h"
+#include "config.h"
+
+#include "donna.h"
+#include "secblock.h"
+#include "misc.h"
+
+#if defined(CRYPTOPP_AVX2_AVAILABLE)
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char DONNA_AVX_FNAME[] = __FILE__;
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+using CryptoPP::byte;
+using CryptoPP::word32;
+using CryptoPP::word64;
+
+// The independent products of a ladder step only overlap when the
+// field operations are inlined, and GCC declines them on size alone.
+#if defined(_MSC_VER)
+# define FE4_INLINE __forceinline
+#elif defined(__GNUC__)
+# define FE4_INLINE inline __attribute__((always_inline))
+#else
+# define FE4_INLINE inline
+#endif
+
+const word32 reduce_mask_25 = (1 << 25) - 1;
+const word32 reduce_mask_26 = (1 << 26) - 1;
+
+// Limb i of the four field elements is in v[i]. Even limbs hold 26 bits
+// and odd limbs hold 25 bits. After fe4_carry() the limbs are at most a
+// few bits over their size, which leaves room for an addition or a
+// subtraction before the next multiplication.
+struct fe4
+{
+    __m256i v[10];
+};
+
+// limbs 0 to 7 are carried as pairs so the shifts overlap
+inline void fe4_carry(fe4& h, __m256i t[10])
+{
+    const __m256i m25 = _mm256_set1_epi64x(reduce_mask_25);
+    const __m256i m26 = _mm256_set1_epi64x(reduce_mask_26);
+    __m256i c0, c1;
+
+#define CARRY2(i, j, si, sj, mi, mj) \
+    c0 = _mm256_srli_epi64(t[i], si); c1 = _mm256_srli_epi64(t[j], sj); \
+    t[i] = _mm256_and_si256(t[i], mi); t[j] = _mm256_and_si256(t[j], mj); \
+    t[i+1] = _mm256_add_epi64(t[i+1], c0); t[j+1] = _mm256_add_epi64(t[j+1], c1);
+
+    CARRY2(0, 4, 26, 26, m26, m26)
+    CARRY2(1, 5, 25, 25, m25, m25)
+    CARRY2(2, 6, 26, 26, m26, m26)
+    CARRY2(3, 7, 25, 25, m25, m25)
+    CARRY2(4, 8, 26, 26, m26, m26)
+
+#undef CARRY2
+
+    // 2^255 = 19 (mod p). The carry can exceed 32 bits so it is
+    // multiplied with shifts rather than _mm256_mul_epu32.
+    c0 = _mm256_srli_epi64(t[9], 25);
+    t[9] = _mm256_and_si256(t[9], m25);
+    t[0] = _mm256_add_epi64(t[0], _mm256_add_epi64(c0,
+        _mm256_add_epi64(_mm256_slli_epi64(c0, 1), _mm256_slli_epi64(c0, 4))));
+
+    c0 = _mm256_srli_epi64(t[0], 26);
+    t[0] = _mm256_and_si256(t[0], m26);
+    t[1] = _mm256_add_epi64(t[1], c0);
+
+    h.v[0] = t[0]; h.v[1] = t[1]; h.v[2] = t[2]; h.v[3] = t[3]; h.v[4] = t[4];
+    h.v[5] = t[5]; h.v[6] = t[6]; h.v[7] = t[7]; h.v[8] = t[8]; h.v[9] = t[9];
+}
+
+inline void fe4_add(fe4& h, const fe4& f, const fe4& g)
+{
+    for (unsigned int i=0; i<10; ++i)
+        h.v[i] = _mm256_add_epi64(f.v[i], g.v[i]);
+}
+
+// f + 2p - g, which does not underflow for carried inputs
+inline void fe4_sub(fe4& h, const fe4& f, const fe4& g)
+{
+    const __m256i p0 = _mm256_set1_epi64x(0x7ffffda);
+    const __m256i p1 = _mm256_set1_epi64x(0x3fffffe);
+    const __m256i p2 = _mm256_set1_epi64x(0x7fffffe);
+
+    h.v[0] = _mm256_sub_epi64(_mm256_add_epi64(f.v[0], p0), g.v[0]);
+    for (unsigned int i=1; i<10; ++i)
+        h.v[i] = _mm256_sub_epi64(_mm256_add_epi64(f.v[i], (i & 1) ? p1 : p2), g.v[i]);
+}
+
+#define MUL(a, b) _mm256_mul_epu32(a, b)
+#define ADD(a, b) _mm256_add_epi64(a, b)
+
+// The product is written out by columns, like fe_mul in ref10. Odd limbs
+// are scaled by 2^0.5, so the product of two odd limbs is doubled. Terms
+// that wrap past 2^255 are scaled by 19.
+FE4_INLINE void fe4_mul(fe4& h, const fe4& f, const fe4& g)
+{
+    const __m256i nineteen = _mm256_set1_epi64x(19);
+    __m256i t[10];
+
+    const __m256i f0 = f.v[0], f1 = f.v[1], f2 = f.v[2], f3 = f.v[3], f4 = f.v[4];
+    const __m256i f5 = f.v[5], f6 = f.v[6], f7 = f.v[7], f8 = f.v[8], f9 = f.v[9];
+    const __m256i g0 = g.v[0], g1 = g.v[1], g2 = g.v[2], g3 = g.v[3], g4 = g.v[4];
+    const __m256i g5 = g.v[5], g6 = g.v[6], g7 = g.v[7], g8 = g.v[8], g9 = g.v[9];
+
+    const __m256i f1_2 = ADD(f1, f1), f3_2 = ADD(f3, f3), f5_2 = ADD(f5, f5);
+    const __m256i f7_2 = ADD(f7, f7), f9_2 = ADD(f9, f9);
+    const __m256i g1_19 = MUL(g1, nineteen), g2_19 = MUL(g2, nineteen), g3_19 = MUL(g3, nineteen);
+    const __m256i g4_19 = MUL(g4, nineteen), g5_19 = MUL(g5, nineteen), g6_19 = MUL(g6, nineteen);
+    const __m256i g7_19 = MUL(g7, nineteen), g8_19 = MUL(g8, nineteen), g9_19 = MUL(g9, nineteen);
+
+    t[0] = ADD(ADD(MUL(f0, g0), MUL(f1_2, g9_19)), ADD(MUL(f2, g8_19), MUL(f3_2, g7_19)));
+    t[0] = ADD(t[0], ADD(ADD(MUL(f4, g6_19), MUL(f5_2, g5_19)), ADD(MUL(f6, g4_19), MUL(f7_2, g3_19))));
+    t[0] = ADD(t[0], ADD(MUL(f8, g2_19), MUL(f9_2, g1_19)));
+    t[1] = ADD(ADD(MUL(f0, g1), MUL(f1, g0)), ADD(MUL(f2, g9_19), MUL(f3, g8_19)));
+    t[1] = ADD(t[1], ADD(ADD(MUL(f4, g7_19), MUL(f5, g6_19)), ADD(MUL(f6, g5_19), MUL(f7, g4_19))));
+    t[1] = ADD(t[1], ADD(MUL(f8, g3_19), MUL(f9, g2_19)));
+    t[2] = ADD(ADD(MUL(f0, g2), MUL(f1_2, g1)), ADD(MUL(f2, g0), MUL(f3_2, g9_19)));
+    t[2] = ADD(t[2], ADD(ADD(MUL(f4, g8_19), MUL(f5_2, g7_19)), ADD(MUL(f6, g6_19), MUL(f7_2, g5_19))));
+    t[2] = ADD(t[2], ADD(MUL(f8, g4_19), MUL(f9_2, g3_19)));
+    t[3] = ADD(ADD(MUL(f0, g3), MUL(f1, g2)), ADD(MUL(f2, g1), MUL(f3, g0)));
+    t[3] = ADD(t[3], ADD(ADD(MUL(f4, g9_19), MUL(f5, g8_19)), ADD(MUL(f6, g7_19), MUL(f7, g6_19))));
+    t[3] = ADD(t[3], ADD(MUL(f8, g5_19), MUL(f9, g4_19)));
+    t[4] = ADD(ADD(MUL(f0, g4), MUL(f1_2, g3)), ADD(MUL(f2, g2), MUL(f3_2, g1)));
+    t[4] = ADD(t[4], ADD(ADD(MUL(f4, g0), MUL(f5_2, g9_19)), ADD(MUL(f6, g8_19), MUL(f7_2, g7_19))));
+    t[4] = ADD(t[4], ADD(MUL(f8, g6_19), MUL(f9_2, g5_19)));
+    t[5] = ADD(ADD(MUL(f0, g5), MUL(f1, g4)), ADD(MUL(f2, g3), MUL(f3, g2)));
+    t[5] = ADD(t[5], ADD(ADD(MUL(f4, g1), MUL(f5, g0)), ADD(MUL(f6, g9_19), MUL(f7, g8_19))));
+    t[5] = ADD(t[5], ADD(MUL(f8, g7_19), MUL(f9, g6_19)));
+    t[6] = ADD(ADD(MUL(f0, g6), MUL(f1_2, g5)), ADD(MUL(f2, g4), MUL(f3_2, g3)));
+    t[6] = ADD(t[6], ADD(ADD(MUL(f4, g2), MUL(f5_2, g1)), ADD(MUL(f6, g0), MUL(f7_2, g9_19))));
+    t[6] = ADD(t[6], ADD(MUL(f8, g8_19), MUL(f9_2, g7_19)));
+    t[7] = ADD(ADD(MUL(f0, g7), MUL(f1, g6)), ADD(MUL(f2, g5), MUL(f3, g4)));
+    t[7] = ADD(t[7], ADD(ADD(MUL(f4, g3), MUL(f5, g2)), ADD(MUL(f6, g1), MUL(f7, g0))));
+    t[7] = ADD(t[7], ADD(MUL(f8, g9_19), MUL(f9, g8_19)));
+    t[8] = ADD(ADD(MUL(f0, g8), MUL(f1_2, g7)), ADD(MUL(f2, g6), MUL(f3_2, g5)));
+    t[8] = ADD(t[8], ADD(ADD(MUL(f4, g4), MUL(f5_2, g3)), ADD(MUL(f6, g2), MUL(f7_2, g1))));
+    t[8] = ADD(t[8], ADD(MUL(f8, g0), MUL(f9_2, g9_19)));
+    t[9] = ADD(ADD(MUL(f0, g9), MUL(f1, g8)), ADD(MUL(f2, g7), MUL(f3, g6)));
+    t[9] = ADD(t[9], ADD(ADD(MUL(f4, g5), MUL(f5, g4)), ADD(MUL(f6, g3), MUL(f7, g2))));
+    t[9] = ADD(t[9], ADD(MUL(f8, g1), MUL(f9, g0)));
+
+    fe4_carry(h, t);
+}
+
+// The square adds the products f[i]*f[j] and f[j]*f[i] once, doubled
+FE4_INLINE void fe4_sqr(fe4& h, const fe4& f)
+{
+    const __m256i nineteen = _mm256_set1_epi64x(19);
+    __m256i t[10];
+
+    const __m256i f0 = f.v[0], f1 = f.v[1], f2 = f.v[2], f3 = f.v[3], f4 = f.v[4];
+    const __m256i f5 = f.v[5], f6 = f.v[6], f7 = f.v[7], f8 = f.v[8], f9 = f.v[9];
+
+    const __m256i f0_2 = ADD(f0, f0), f1_2 = ADD(f1, f1), f2_2 = ADD(f2, f2), f3_2 = ADD(f3, f3);
+    const __m256i f4_2 = ADD(f4, f4), f5_2 = ADD(f5, f5), f6_2 = ADD(f6, f6), f7_2 = ADD(f7, f7);
+    const __m256i f8_2 = ADD(f8, f8), f9_2 = ADD(f9, f9);
+    const __m256i f1_4 = ADD(f1_2, f1_2), f3_4 = ADD(f3_2, f3_2), f5_4 = ADD(f5_2, f5_2);
+    const __m256i f7_4 = ADD(f7_2, f7_2);
+    const __m256i f5_19 = MUL(f5, nineteen), f6_19 = MUL(f6, nineteen), f7_19 = MUL(f7, nineteen);
+    const __m256i f8_19 = MUL(f8, nineteen), f9_19 = MUL(f9, nineteen);
+
+    t[0] = ADD(ADD(MUL(f0, f0), MUL(f1_4, f9_19)), ADD(MUL(f2_2, f8_19), MUL(f3_4, f7_19)));
+    t[0] = ADD(t[0], ADD(MUL(f4_2, f6_19), MUL(f5_2, f5_19)));
+    t[1] = ADD(ADD(MUL(f0_2, f1), MUL(f2_2, f9_19)), ADD(MUL(f3_2, f8_19), MUL(f4_2, f7_19)));
+    t[1] = ADD(t[1], MUL(f5_2, f6_19));
+    t[2] = ADD(ADD(MUL(f0_2, f2), MUL(f1_2, f1)), ADD(MUL(f3_4, f9_19), MUL(f4_2, f8_19)));
+    t[2] = ADD(t[2], ADD(MUL(f5_4, f7_19), MUL(f6, f6_19)));
+    t[3] = ADD(ADD(MUL(f0_2, f3), MUL(f1_2, f2)), ADD(MUL(f4_2, f9_19), MUL(f5_2, f8_19)));
+    t[3] = ADD(t[3], MUL(f6_2, f7_19));
+    t[4] = ADD(ADD(MUL(f0_2, f4), MUL(f1_4, f3)), ADD(MUL(f2, f2), MUL(f5_4, f9_19)));
+    t[4] = ADD(t[4], ADD(MUL(f6_2, f8_19), MUL(f7_2, f7_19)));
+    t[5] = ADD(ADD(MUL(f0_2, f5), MUL(f1_2, f4)), ADD(MUL(f2_2, f3), MUL(f6_2, f9_19)));
+    t[5] = ADD(t[5], MUL(f7_2, f8_19));
+    t[6] = ADD(ADD(MUL(f0_2, f6), MUL(f1_4, f5)), ADD(MUL(f2_2, f4), MUL(f3_2, f3)));
+    t[6] = ADD(t[6], ADD(MUL(f7_4, f9_19), MUL(f8, f8_19)));
+    t[7] = ADD(ADD(MUL(f0_2, f7), MUL(f1_2, f6)), ADD(MUL(f2_2, f5), MUL(f3_2, f4)));
+    t[7] = ADD(t[7], MUL(f8_2, f9_19));
+    t[8] = ADD(ADD(MUL(f0_2, f8), MUL(f1_4, f7)), ADD(MUL(f2_2, f6), MUL(f3_4, f5)));
+    t[8] = ADD(t[8], ADD(MUL(f4, f4), MUL(f9_2, f9_19)));
+    t[9] = ADD(ADD(MUL(f0_2, f9), MUL(f1_2, f8)), ADD(MUL(f2_2, f7), MUL(f3_2, f6)));
+    t[9] = ADD(t[9], MUL(f4_2, f5));
+
+    fe4_carry(h, t);
+}
+
+#undef MUL
+#undef ADD
+
+CRYPTOPP_NOINLINE void fe4_sqr_times(fe4& h, const fe4& f, unsigned int count)
+{
+    fe4_sqr(h, f);
+    while (--count)
+        fe4_sqr(h, h);
+}
+
+// h = 121665 * f + g, the a24 step of the ladder
+inline void fe4_mul121665_add(fe4& h, const fe4& f, const fe4& g)
+{
+    const __m256i a24 = _mm256_set1_epi64x(121665);
+    __m256i t[10];
+
+    for (unsigned int i=0; i<10; ++i)
+        t[i] = _mm256_add_epi64(_mm256_mul_epu32(f.v[i], a24), g.v[i]);
+
+    fe4_carry(h, t);
+}
+
+// Swaps the lanes of f and g where mask is all ones
+inline void fe4_cswap(fe4& f, fe4& g, const __m256i mask)
+{
+    for (unsigned int i=0; i<10; ++i)
+    {
+        const __m256i x = _mm256_and_si256(mask, _mm256_xor_si256(f.v[i], g.v[i]));
+        f.v[i] = _mm256_xor_si256(f.v[i], x);
+        g.v[i] = _mm256_xor_si256(g.v[i], x);
+    }
+}
+
+// The inversion is a small part of the work, so it uses out of line
+// copies of the field operations to hold down the code size.
+CRYPTOPP_NOINLINE void fe4_mul_outline(fe4& h, const fe4& f, const fe4& g)
+{
+    fe4_mul(h, f, g);
+}
+
+// z^(p - 2) = z^(2^255 - 21), the same chain as curve25519_recip
+void fe4_invert(fe4& out, const fe4& z)
+{
+    fe4 a, b, c, t0;
+
+    /* 2 */ fe4_sqr_times(a, z, 1);
+    /* 8 */ fe4_sqr_times(t0, a, 2);
+    /* 9 */ fe4_mul_outline(b, t0, z);
+    /* 11 */ fe4_mul_outline(a, b, a);
+    /* 22 */ fe4_sqr_times(t0, a, 1);
+    /* 2^5 - 2^0 = 31 */ fe4_mul_outline(b, t0, b);
+    /* 2^10 - 2^5 */ fe4_sqr_times(t0, b, 5);
+    /* 2^10 - 2^0 */ fe4_mul_outline(b, t0, b);
+    /* 2^20 - 2^10 */ fe4_sqr_times(t0, b, 10);
+    /* 2^20 - 2^0 */ fe4_mul_outline(c, t0, b);
+    /* 2^40 - 2^20 */ fe4_sqr_times(t0, c, 20);
+    /* 2^40 - 2^0 */ fe4_mul_outline(t0, t0, c);
+    /* 2^50 - 2^10 */ fe4_sqr_times(t0, t0, 10);
+    /* 2^50 - 2^0 */ fe4_mul_outline(b, t0, b);
+    /* 2^100 - 2^50 */ fe4_sqr_times(t0, b, 50);
+    /* 2^100 - 2^0 */ fe4_mul_outline(c, t0, b);
+    /* 2^200 - 2^100 */ fe4_sqr_times(t0, c, 100);
+    /* 2^200 - 2^0 */ fe4_mul_outline(t0, t0, c);
+    /* 2^250 - 2^50 */ fe4_sqr_times(t0, t0, 50);
+    /* 2^250 - 2^0 */ fe4_mul_outline(b, t0, b);
+    /* 2^255 - 2^5 */ fe4_sqr_times(b, b, 5);
+    /* 2^255 - 21 */ fe4_mul_outline(out, b, a);
+}
+
+/* Take a little-endian, 32-byte number and expand it into polynomial form */
+void expand(word32 out[10], const byte in[32])
+{
+    word32 x0,x1,x2,x3,x4,x5,x6,x7;
+    CryptoPP::GetBlock<word32, CryptoPP::LittleEndian> block(in);
+    block(x0)(x1)(x2)(x3)(x4)(x5)(x6)(x7);
+
+    out[0] = (                      x0       ) & reduce_mask_26;
+    out[1] = ((((word64)x1 << 32) | x0) >> 26) & reduce_mask_25;
+    out[2] = ((((word64)x2 << 32) | x1) >> 19) & reduce_mask_26;
+    out[3] = ((((word64)x3 << 32) | x2) >> 13) & reduce_mask_25;
+    out[4] = ((                     x3) >>  6) & reduce_mask_26;
+    out[5] = (                      x4       ) & reduce_mask_25;
+    out[6] = ((((word64)x5 << 32) | x4) >> 25) & reduce_mask_26;
+    out[7] = ((((word64)x6 << 32) | x5) >> 19) & reduce_mask_25;
+    out[8] = ((((word64)x7 << 32) | x6) >> 12) & reduce_mask_26;
+    out[9] = ((                     x7) >>  6) & reduce_mask_25; /* ignore the top bit */
+}
+
+/* Take a carried polynomial form number and contract it into a little-endian, 32-byte array */
+void contract(byte out[32], const word32 in[10])
+{
+    word32 f[10];
+    for (unsigned int i=0; i<10; ++i)
+        f[i] = in[i];
+
+    #define carry_pass() \
+        f[1] += f[0] >> 26; f[0] &= reduce_mask_26; \
+        f[2] += f[1] >> 25; f[1] &= reduce_mask_25; \
+        f[3] += f[2] >> 26; f[2] &= reduce_mask_26; \
+        f[4] += f[3] >> 25; f[3] &= reduce_mask_25; \
+        f[5] += f[4] >> 26; f[4] &= reduce_mask_26; \
+        f[6] += f[5] >> 25; f[5] &= reduce_mask_25; \
+        f[7] += f[6] >> 26; f[6] &= reduce_mask_26; \
+        f[8] += f[7] >> 25; f[7] &= reduce_mask_25; \
+        f[9] += f[8] >> 26; f[8] &= reduce_mask_26;
+
+    #define carry_pass_full() \
+        carry_pass() \
+        f[0] += 19 * (f[9] >> 25); f[9] &= reduce_mask_25;
+
+    #define carry_pass_final() \
+        carry_pass() \
+        f[9] &= reduce_mask_25;
+
+    carry_pass_full()
+    carry_pass_full()
+
+    /* now t is between 0 and 2^255-1, properly carried. */
+    /* case 1: between 0 and 2^255-20. case 2: between 2^255-19 and 2^255-1. */
+    f[0] += 19;
+    carry_pass_full()
+
+    /* now between 19 and 2^255-1 in both cases, and offset by 19. */
+    f[0] += (1 << 26) - 19;
+    f[1] += (1 << 25) - 1;
+    f[2] += (1 << 26) - 1;
+    f[3] += (1 << 25) - 1;
+    f[4] += (1 << 26) - 1;
+    f[5] += (1 << 25) - 1;
+    f[6] += (1 << 26) - 1;
+    f[7] += (1 << 25) - 1;
+    f[8] += (1 << 26) - 1;
+    f[9] += (1 << 25) - 1;
+
+    /* now between 2^255 and 2^256-20, and offset by 2^255. */
+    carry_pass_final()
+
+    #undef carry_pass
+    #undef carry_pass_full
+    #undef carry_pass_final
+
+    f[1] <<= 2;
+    f[2] <<= 3;
+    f[3] <<= 5;
+    f[4] <<= 6;
+    f[6] <<= 1;
+    f[7] <<= 3;
+    f[8] <<= 4;
+    f[9] <<= 6;
+
+    #define F(i, s) \
+        out[s+0] |= (byte)( f[i] & 0xff); \
+        out[s+1]  = (byte)((f[i] >>  8) & 0xff); \
+        out[s+2]  = (byte)((f[i] >> 16) & 0xff); \
+        out[s+3]  = (byte)((f[i] >> 24) & 0xff);
+
+    out[0] = out[16] = 0;
+    F(0,0); F(1,3);
+    F(2,6); F(3,9);
+    F(4,12); F(5,16);
+    F(6,19); F(7,22);
+    F(8,25); F(9,28);
+    #undef F
+}
+
+// Bit b of the four clamped scalars as lane masks
+inline __m256i ScalarBits(const byte e[4*32], unsigned int b)
+{
+    const unsigned int i = b/8, s = b%8;
+    return _mm256_set_epi64x(
+        -static_cast<long long>((e[3*32+i] >> s) & 1),
+        -static_cast<long long>((e[2*32+i] >> s) & 1),
+        -static_cast<long long>((e[1*32+i] >> s) & 1),
+        -static_cast<long long>((e[0*32+i] >> s) & 1));
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+NAMESPACE_BEGIN(Donna)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+// Four independent scalar multiplications. The keys are consecutive,
+// 32 bytes each, and sharedKeys receives the four 32-byte results.
+int curve25519_mult_AVX2(byte sharedKeys[4*32], const byte secretKeys[4*32], const byte othersKeys[4*32])
+{
+    FixedSizeSecBlock<byte, 4*32> e;
+    for (size_t i = 0;i < 4*32;++i)
+        e[i] = secretKeys[i];
+    for (size_t i = 0;i < 4*32;i += 32) {
+        e[i] &= 0xf8; e[i+31] &= 0x7f; e[i+31] |= 0x40;
+    }
+
+    word32 u[4][10];
+    for (unsigned int j=0; j<4; ++j)
+        expand(u[j], othersKeys+j*32);
+
+    fe4 x1, x2, z2, x3, z3;
+    for (unsigned int i=0; i<10; ++i)
+    {
+        x1.v[i] = _mm256_set_epi64x(u[3][i], u[2][i], u[1][i], u[0][i]);
+        x2.v[i] = z3.v[i] = _mm256_set1_epi64x(i == 0);
+        z2.v[i] = _mm256_setzero_si256();
+        x3.v[i] = x1.v[i];
+    }
+
+    fe4 a, aa, b, bb, c, d, da, cb, t;
+    __m256i swap = _mm256_setzero_si256();
+
+    // bit 255 is always 0 after clamping
+    for (int i = 254; i >= 0; i--)
+    {
+        const __m256i bit = ScalarBits(e, static_cast<unsigned int>(i));
+        swap = _mm256_xor_si256(swap, bit);
+        fe4_cswap(x2, x3, swap);
+        fe4_cswap(z2, z3, swap);
+        swap = bit;
+
+        fe4_add(a, x2, z2);
+        fe4_sub(b, x2, z2);
+        fe4_add(c, x3, z3);
+        fe4_sub(d, x3, z3);
+        fe4_sqr(aa, a);
+        fe4_sqr(bb, b);
+        fe4_mul(da, d, a);
+        fe4_mul(cb, c, b);
+
+        fe4_add(t, da, cb);
+        fe4_sqr(x3, t);
+        fe4_sub(t, da, cb);
+        fe4_sqr(t, t);
+        fe4_mul(z3, x1, t);
+
+        fe4_mul(x2, aa, bb);
+        fe4_sub(t, aa, bb);
+        fe4_mul121665_add(a, t, aa);
+        fe4_mul(z2, t, a);
+    }
+
+    fe4_cswap(x2, x3, swap);
+    fe4_cswap(z2, z3, swap);
+
+    fe4_invert(z2, z2);
+    fe4_mul(x2, x2, z2);
+
+    CRYPTOPP_ALIGN_DATA(32) word64 lanes[10][4];
+    for (unsigned int i=0; i<10; ++i)
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[i]), x2.v[i]);
+
+    for (unsigned int j=0; j<4; ++j)
+    {
+        for (unsigned int i=0; i<10; ++i)
+            u[j][i] = static_cast<word32>(lanes[i][j]);
+        contract(sharedKeys+j*32, u[j]);
+    }
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return 0;
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END  // Donna
+NAMESPACE_END  // CryptoPP
@@ -27,6 +27,7 @@
 #include "hex.h"
 #include "ec2n.h"
 #include "misc.h"
+#include "p256.h"
 
 #include <iostream>
 #include <sstream>
@@ -459,6 +460,181 @@ static void GetRecommendedParameters(const EcRecommendedParameters<ECP> *&begin,
 	end = rec + sizeof(rec)/sizeof(rec[0]);
 }
 
+// ******************************************************************
+
+// The P-256 backend is used when the group parameters are secp256r1 with
+// the standard generator. The helpers return false when the backend does
+// not apply or reports a failure, and the caller uses the generic code.
+
+#if (CRYPTOPP_P256_64BIT)
+struct P256Parameters
+{
+	P256Parameters()
+		: p("0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF"),
+		  a("0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFC"),
+		  b("0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B"),
+		  n("0xFFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551"),
+		  G(Integer("0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296"),
+		    Integer("0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5")) {}
+
+	Integer p, a, b, n;
+	ECP::Point G;
+};
+
+static bool IsP256(const DL_GroupParameters_EC<ECP> &params)
+{
+	const P256Parameters &c = Singleton<P256Parameters>().Ref();
+	if (params.GetSubgroupOrder() != c.n)
+		return false;
+
+	const ECP &ec = params.GetCurve();
+	if (ec.GetField().GetModulus() != c.p || ec.GetA() != c.a || ec.GetB() != c.b)
+		return false;
+
+	return params.GetSubgroupGenerator() == c.G;
+}
+
+static void P256EncodeScalar(byte k[32], const Integer &exponent, const Integer &n)
+{
+	if (exponent.IsNegative() || exponent >= n)
+		(exponent % n).Encode(k, 32);
+	else
+		exponent.Encode(k, 32);
+}
+
+static bool P256EncodePoint(byte x[32], byte y[32], const ECP::Point &P)
+{
+	if (P.identity || P.x.IsNegative() || P.y.IsNegative() ||
+		P.x.ByteCount() > 32 || P.y.ByteCount() > 32)
+		return false;
+
+	P.x.Encode(x, 32);
+	P.y.Encode(y, 32);
+	return true;
+}
+#endif
+
+static bool P256ExponentiateBase(const DL_GroupParameters_EC<EC2N> &params, const Integer &exponent, EC2N::Point &result)
+{
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(exponent); CRYPTOPP_UNUSED(result);
+	return false;
+}
+
+static bool P256ExponentiateBase(const DL_GroupParameters_EC<ECP> &params, const Integer &exponent, ECP::Point &result)
+{
+#if (CRYPTOPP_P256_64BIT)
+	if (!IsP256(params))
+		return false;
+
+	FixedSizeSecBlock<byte, 32> k;
+	byte x[32], y[32];
+	P256EncodeScalar(k, exponent, params.GetSubgroupOrder());
+	if (P256::p256_mult_base(x, y, k) != 0)
+		return false;
+
+	result = ECP::Point(Integer(x, 32), Integer(y, 32));
+	return true;
+#else
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(exponent); CRYPTOPP_UNUSED(result);
+	return false;
+#endif
+}
+
+static bool P256Exponentiate(const DL_GroupParameters_EC<EC2N> &params, const EC2N::Point &base, const Integer &exponent, EC2N::Point &result)
+{
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(base);
+	CRYPTOPP_UNUSED(exponent); CRYPTOPP_UNUSED(result);
+	return false;
+}
+
+static bool P256Exponentiate(const DL_GroupParameters_EC<ECP> &params, const ECP::Point &base, const Integer &exponent, ECP::Point &result)
+{
+#if (CRYPTOPP_P256_64BIT)
+	byte px[32], py[32], x[32], y[32];
+	if (!P256EncodePoint(px, py, base) || !IsP256(params))
+		return false;
+
+	FixedSizeSecBlock<byte, 32> k;
+	P256EncodeScalar(k, exponent, params.GetSubgroupOrder());
+	if (P256::p256_mult(x, y, px, py, k) != 0)
+		return false;
+
+	result = ECP::Point(Integer(x, 32), Integer(y, 32));
+	return true;
+#else
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(base);
+	CRYPTOPP_UNUSED(exponent); CRYPTOPP_UNUSED(result);
+	return false;
+#endif
+}
+
+static bool P256CascadeExponentiate(const DL_GroupParameters_EC<EC2N> &params, const Integer &baseExp, const EC2N::Point &element, const Integer &exponent, EC2N::Point &result)
+{
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(baseExp); CRYPTOPP_UNUSED(element);
+	CRYPTOPP_UNUSED(exponent); CRYPTOPP_UNUSED(result);
+	return false;
+}
+
+static bool P256CascadeExponentiate(const DL_GroupParameters_EC<ECP> &params, const Integer &baseExp, const ECP::Point &element, const Integer &exponent, ECP::Point &result)
+{
+#if (CRYPTOPP_P256_64BIT)
+	byte px[32], py[32], u1[32], u2[32], x[32], y[32];
+	if (!P256EncodePoint(px, py, element) || !IsP256(params))
+		return false;
+
+	// Public values only, so the variable time routine is used
+	P256EncodeScalar(u1, baseExp, params.GetSubgroupOrder());
+	P256EncodeScalar(u2, exponent, params.GetSubgroupOrder());
+	if (P256::p256_mult_double(x, y, u1, px, py, u2) != 0)
+		return false;
+
+	result = ECP::Point(Integer(x, 32), Integer(y, 32));
+	return true;
+#else
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(baseExp); CRYPTOPP_UNUSED(element);
+	CRYPTOPP_UNUSED(exponent); CRYPTOPP_UNUSED(result);
+	return false;
+#endif
+}
+
+static bool P256CascadeExponentiateBatch(const DL_GroupParameters_EC<EC2N> &params, EC2N::Point *results, const Integer *baseExps, const EC2N::Point &element, const Integer *exponents, size_t count, bool *done)
+{
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(results); CRYPTOPP_UNUSED(baseExps);
+	CRYPTOPP_UNUSED(element); CRYPTOPP_UNUSED(exponents); CRYPTOPP_UNUSED(count); CRYPTOPP_UNUSED(done);
+	return false;
+}
+
+static bool P256CascadeExponentiateBatch(const DL_GroupParameters_EC<ECP> &params, ECP::Point *results, const Integer *baseExps, const ECP::Point &element, const Integer *exponents, size_t count, bool *done)
+{
+#if (CRYPTOPP_P256_64BIT)
+	byte px[32], py[32];
+	if (!P256EncodePoint(px, py, element) || !IsP256(params))
+		return false;
+
+	SecByteBlock u1(32*count), u2(32*count), x(32*count), y(32*count), ok(count);
+	for (size_t i=0; i<count; ++i)
+	{
+		P256EncodeScalar(u1+32*i, baseExps[i], params.GetSubgroupOrder());
+		P256EncodeScalar(u2+32*i, exponents[i], params.GetSubgroupOrder());
+	}
+
+	if (P256::p256_mult_double_batch(x, y, ok, u1, px, py, u2, count) != 0)
+		return false;
+
+	for (size_t i=0; i<count; ++i)
+	{
+		done[i] = ok[i] != 0;
+		if (done[i])
+			results[i] = ECP::Point(Integer(x+32*i, 32), Integer(y+32*i, 32));
+	}
+	return true;
+#else
+	CRYPTOPP_UNUSED(params); CRYPTOPP_UNUSED(results); CRYPTOPP_UNUSED(baseExps);
+	CRYPTOPP_UNUSED(element); CRYPTOPP_UNUSED(exponents); CRYPTOPP_UNUSED(count); CRYPTOPP_UNUSED(done);
+	return false;
+#endif
+}
+
 template <class EC> OID DL_GroupParameters_EC<EC>::GetNextRecommendedParametersOID(const OID &oid)
 {
 	const EcRecommendedParameters<EllipticCurve> *begin, *end;
@@ -665,9 +841,47 @@ bool DL_GroupParameters_EC<EC>::ValidateElement(unsigned int level, const Elemen
 template <class EC>
 void DL_GroupParameters_EC<EC>::SimultaneousExponentiate(Element *results, const Element &base, const Integer *exponents, unsigned int exponentsCount) const
 {
+	if (exponentsCount == 1 && P256Exponentiate(*this, base, exponents[0], results[0]))
+		return;
+
 	GetCurve().SimultaneousMultiply(results, base, exponents, exponentsCount);
 }
 
+template <class EC>
+typename DL_GroupParameters_EC<EC>::Element DL_GroupParameters_EC<EC>::ExponentiateBase(const Integer &exponent) const
+{
+	Element result;
+	if (P256ExponentiateBase(*this, exponent, result))
+		return result;
+
+	return GetBasePrecomputation().Exponentiate(this->GetGroupPrecomputation(), exponent);
+}
+
+template <class EC>
+typename DL_GroupParameters_EC<EC>::Element DL_GroupParameters_EC<EC>::CascadeExponentiateBaseAndElement(const Integer &baseExp, const DL_FixedBasePrecomputation<Element> &precomp, const Integer &exponent) const
+{
+	Element result;
+	if (P256CascadeExponentiate(*this, baseExp, precomp.GetBase(this->GetGroupPrecomputation()), exponent, result))
+		return result;
+
+	return GetBasePrecomputation().CascadeExponentiate(this->GetGroupPrecomputation(), baseExp, precomp, exponent);
+}
+
+template <class EC>
+void DL_GroupParameters_EC<EC>::CascadeExponentiateBaseAndElements(Element *results, const Integer *baseExps, const DL_FixedBasePrecomputation<Element> &precomp, const Integer *exponents, size_t count) const
+{
+	SecBlock<bool> done(count);
+	std::fill(done.begin(), done.end(), false);
+	if (count != 0)
+		P256CascadeExponentiateBatch(*this, results, baseExps, precomp.GetBase(this->GetGroupPrecomputation()), exponents, count, done);
+
+	for (size_t i=0; i<count; ++i)
+	{
+		if (!done[i])
+			results[i] = GetBasePrecomputation().CascadeExponentiate(this->GetGroupPrecomputation(), baseExps[i], precomp, exponents[i]);
+	}
+}
+
 template <class EC>
 typename DL_GroupParameters_EC<EC>::Element DL_GroupParameters_EC<EC>::MultiplyElements(const Element &a, const Element &b) const
 {
@@ -132,6 +132,7 @@ public:
 	Integer GetMaxExponent() const {return GetSubgroupOrder()-1;}
 	bool IsIdentity(const Element &element) const {return element.identity;}
 	void SimultaneousExponentiate(Element *results, const Element &base, const Integer *exponents, unsigned int exponentsCount) const;
+	Element ExponentiateBase(const Integer &exponent) const;
 	static std::string CRYPTOPP_API StaticAlgorithmNamePrefix() {return "EC";}
 
 	// ASN1Key
@@ -141,6 +142,31 @@ public:
 	Element MultiplyElements(const Element &a, const Element &b) const;
 	Element CascadeExponentiate(const Element &element1, const Integer &exponent1, const Element &element2, const Integer &exponent2) const;
 
+	/// \brief Exponentiates the base and an element
+	/// \param baseExp the exponent for the base
+	/// \param precomp the precomputation for the element
+	/// \param exponent the exponent for the element
+	/// \return the element <tt>baseExp*G + exponent*Q</tt>
+	/// \details CascadeExponentiateBaseAndElement() is used by DL_PublicKey_EC
+	///  during signature verification. When the group is secp256r1 and the
+	///  platform provides a 128-bit word the dedicated P-256 backend is used,
+	///  otherwise the fixed base precomputations are used.
+	/// \since Crypto++ 8.5
+	Element CascadeExponentiateBaseAndElement(const Integer &baseExp, const DL_FixedBasePrecomputation<Element> &precomp, const Integer &exponent) const;
+
+	/// \brief Exponentiates the base and an element for a batch of exponents
+	/// \param results array of count elements for the results
+	/// \param baseExps array of count exponents for the base
+	/// \param precomp the precomputation for the element
+	/// \param exponents array of count exponents for the element
+	/// \param count the number of exponent pairs
+	/// \details CascadeExponentiateBaseAndElements() is the batch form of
+	///  CascadeExponentiateBaseAndElement(). The P-256 backend builds the
+	///  table for the element once and shares the inversion that converts
+	///  the results to affine coordinates.
+	/// \since Crypto++ 8.5
+	void CascadeExponentiateBaseAndElements(Element *results, const Integer *baseExps, const DL_FixedBasePrecomputation<Element> &precomp, const Integer *exponents, size_t count) const;
+
 	// non-inherited
 
 	// enumerate OIDs for recommended parameters, use OID() to get first one
@@ -198,6 +224,12 @@ public:
 	void Initialize(const EC &ec, const Element &G, const Integer &n, const Element &Q)
 		{this->AccessGroupParameters().Initialize(ec, G, n); this->SetPublicElement(Q);}
 
+	// DL_PublicKey
+	Element CascadeExponentiateBaseAndPublicElement(const Integer &baseExp, const Integer &publicExp) const
+		{return this->GetGroupParameters().CascadeExponentiateBaseAndElement(baseExp, this->GetPublicPrecomputation(), publicExp);}
+	void CascadeExponentiateBaseAndPublicElements(Element *results, const Integer *baseExps, const Integer *publicExps, size_t count) const
+		{this->GetGroupParameters().CascadeExponentiateBaseAndElements(results, baseExps, this->GetPublicPrecomputation(), publicExps, count);}
+
 	// X509PublicKey
 	void BERDecodePublicKey(BufferedTransformation &bt, bool parametersPresent, size_t size);
 	void DEREncodePublicKey(BufferedTransformation &bt) const;
@@ -19,6 +19,7 @@ template <class T> void DL_FixedBasePrecomputationImpl<T>::SetBase(const DL_Grou
 	{
 		m_bases.resize(1);
 		m_bases[0] = m_base;
+		m_table = TablePtr();
 	}
 
 	if (group.NeedConversions())
@@ -36,6 +37,7 @@ template <class T> void DL_FixedBasePrecomputationImpl<T>::Precompute(const DL_G
 		m_exponentBase = Integer::Power2(m_windowSize);
 	}
 
+	m_table = TablePtr();
 	m_bases.resize(storage);
 	for (unsigned i=1; i<storage; i++)
 		m_bases[i] = group.GetGroup().ScalarMultiply(m_bases[i-1], m_exponentBase);
@@ -48,6 +50,7 @@ template <class T> void DL_FixedBasePrecomputationImpl<T>::Load(const DL_GroupPr
 	BERDecodeUnsigned<word32>(seq, version, INTEGER, 1, 1);
 	m_exponentBase.BERDecode(seq);
 	m_windowSize = m_exponentBase.BitCount() - 1;
+	m_table = TablePtr();
 	m_bases.clear();
 	while (!seq.EndReached())
 		m_bases.push_back(group.BERDecodeElement(seq));
@@ -61,38 +64,111 @@ template <class T> void DL_FixedBasePrecomputationImpl<T>::Save(const DL_GroupPr
 	DERSequenceEncoder seq(bt);
 	DEREncodeUnsigned<word32>(seq, 1);	// version
 	m_exponentBase.DEREncode(seq);
-	for (unsigned i=0; i<m_bases.size(); i++)
-		group.DEREncodeElement(seq, m_bases[i]);
+	for (size_t i=0; i<BaseCount(); i++)
+		group.DEREncodeElement(seq, m_table.get() ? TableBase(group, m_table->m_data, i) : m_bases[i]);
 	seq.MessageEnd();
 }
 
+// The table is a 16 byte header followed by count+1 offsets and the
+// DER encoded bases. The header is the magic "DLFB", the version, the
+// window size and the number of bases. The offsets are from the start
+// of the table, and base i occupies the bytes from offset i to offset
+// i+1. All words are 32-bit big-endian.
+
+template <class T> void DL_FixedBasePrecomputationImpl<T>::SaveTable(const DL_GroupPrecomputation<Element> &group, BufferedTransformation &bt) const
+{
+	const size_t count = BaseCount();
+	const size_t header = 16 + 4*(count+1);
+	std::vector<word32> offsets(count+1);
+	ByteQueue elements;
+
+	for (size_t i=0; i<count; i++)
+	{
+		offsets[i] = static_cast<word32>(header + elements.CurrentSize());
+		group.DEREncodeElement(elements, m_table.get() ? TableBase(group, m_table->m_data, i) : m_bases[i]);
+	}
+	offsets[count] = static_cast<word32>(header + elements.CurrentSize());
+	CRYPTOPP_ASSERT(header + elements.CurrentSize() <= 0xffffffff);
+
+	bt.Put(reinterpret_cast<const byte *>("DLFB"), 4);
+	bt.PutWord32(1);	// version
+	bt.PutWord32(m_windowSize);
+	bt.PutWord32(static_cast<word32>(count));
+	for (size_t i=0; i<=count; i++)
+		bt.PutWord32(offsets[i]);
+	elements.TransferTo(bt);
+}
+
+template <class T> void DL_FixedBasePrecomputationImpl<T>::LoadTable(const DL_GroupPrecomputation<Element> &group, const byte *table, size_t size)
+{
+	if (!table || size < 16 || std::memcmp(table, "DLFB", 4) != 0 || GetWord<word32>(false, BIG_ENDIAN_ORDER, table+4) != 1)
+		throw InvalidDataFormat("DL_FixedBasePrecomputationImpl: table header is not valid");
+
+	const word32 windowSize = GetWord<word32>(false, BIG_ENDIAN_ORDER, table+8);
+	const word32 count = GetWord<word32>(false, BIG_ENDIAN_ORDER, table+12);
+	if (count == 0 || (size-16)/4 <= count || windowSize > 0xffff)
+		throw InvalidDataFormat("DL_FixedBasePrecomputationImpl: table header is not valid");
+
+	// The offsets must start after the header, increase and stay in the table
+	size_t previous = 16 + 4*(size_t(count)+1);
+	for (size_t i=0; i<=count; i++)
+	{
+		const word32 offset = GetWord<word32>(false, BIG_ENDIAN_ORDER, table+16+4*i);
+		if ((i == 0 && offset != previous) || offset < previous || offset > size)
+			throw InvalidDataFormat("DL_FixedBasePrecomputationImpl: table offsets are not valid");
+		previous = offset;
+	}
+
+	// Decode the first base before changing any state
+	const Element base = TableBase(group, table, 0);
+
+	m_table = TablePtr(new Table(table, count));
+	m_windowSize = windowSize;
+	m_exponentBase = windowSize ? Integer::Power2(windowSize) : Integer::Zero();
+	m_bases.resize(1);
+	m_bases[0] = base;
+	if (group.NeedConversions())
+		m_base = group.ConvertOut(base);
+}
+
+template <class T> T DL_FixedBasePrecomputationImpl<T>::TableBase(const DL_GroupPrecomputation<Element> &group, const byte *table, size_t i)
+{
+	const word32 begin = GetWord<word32>(false, BIG_ENDIAN_ORDER, table+16+4*i);
+	const word32 end = GetWord<word32>(false, BIG_ENDIAN_ORDER, table+20+4*i);
+	StringStore store(table+begin, end-begin);
+	return group.BERDecodeElement(store);
+}
+
 template <class T> void DL_FixedBasePrecomputationImpl<T>::PrepareCascade(const DL_GroupPrecomputation<Element> &i_group, std::vector<BaseAndExponent<Element> > &eb, const Integer &exponent) const
 {
 	const AbstractGroup<T> &group = i_group.GetGroup();
 
 	Integer r, q, e = exponent;
 	bool fastNegate = group.InversionIsFast() && m_windowSize > 1;
-	unsigned int i;
+	const size_t count = BaseCount();
+	Element temp;
+	size_t i;
 
-	for (i=0; i+1<m_bases.size(); i++)
+	for (i=0; i+1<count; i++)
 	{
+		const Element &base = m_table.get() ? (temp = TableBase(i_group, m_table->m_data, i)) : m_bases[i];
 		Integer::DivideByPowerOf2(r, q, e, m_windowSize);
 		std::swap(q, e);
 		if (fastNegate && r.GetBit(m_windowSize-1))
 		{
 			++e;
-			eb.push_back(BaseAndExponent<Element>(group.Inverse(m_bases[i]), m_exponentBase - r));
+			eb.push_back(BaseAndExponent<Element>(group.Inverse(base), m_exponentBase - r));
 		}
 		else
-			eb.push_back(BaseAndExponent<Element>(m_bases[i], r));
+			eb.push_back(BaseAndExponent<Element>(base, r));
 	}
-	eb.push_back(BaseAndExponent<Element>(m_bases[i], e));
+	eb.push_back(BaseAndExponent<Element>(m_table.get() ? (temp = TableBase(i_group, m_table->m_data, i)) : m_bases[i], e));
 }
 
 template <class T> T DL_FixedBasePrecomputationImpl<T>::Exponentiate(const DL_GroupPrecomputation<Element> &group, const Integer &exponent) const
 {
 	std::vector<BaseAndExponent<Element> > eb;	// array of segments of the exponent and precalculated bases
-	eb.reserve(m_bases.size());
+	eb.reserve(BaseCount());
 	PrepareCascade(group, eb, exponent);
 	return group.ConvertOut(GeneralCascadeMultiplication<Element>(group.GetGroup(), eb.begin(), eb.end()));
 }
@@ -103,7 +179,7 @@ template <class T> T
 {
 	std::vector<BaseAndExponent<Element> > eb;	// array of segments of the exponent and precalculated bases
 	const DL_FixedBasePrecomputationImpl<T> &pc2 = static_cast<const DL_FixedBasePrecomputationImpl<T> &>(i_pc2);
-	eb.reserve(m_bases.size() + pc2.m_bases.size());
+	eb.reserve(BaseCount() + pc2.BaseCount());
 	PrepareCascade(group, eb, exponent);
 	pc2.PrepareCascade(group, eb, exponent2);
 	return group.ConvertOut(GeneralCascadeMultiplication<Element>(group.GetGroup(), eb.begin(), eb.end()));
@@ -9,6 +9,7 @@
 #include "cryptlib.h"
 #include "integer.h"
 #include "algebra.h"
+#include "smartptr.h"
 #include "stdcpp.h"
 
 NAMESPACE_BEGIN(CryptoPP)
@@ -103,6 +104,45 @@ public:
 	/// \sa SupportsPrecomputation(), Precompute()
 	virtual void Save(const DL_GroupPrecomputation<Element> &group, BufferedTransformation &storedPrecomputation) const =0;
 
+	/// \brief Save precomputation as a table
+	/// \param group the the group
+	/// \param storedPrecomputation BufferedTransformation to write the table
+	/// \details SaveTable() writes the precomputation in a compact binary format
+	///   which LoadTable() uses in place. The table does not depend on the
+	///   process, so a service can write it once and map it read-only into
+	///   each worker.
+	/// \throw NotImplemented
+	/// \sa LoadTable(), Save()
+	/// \since Crypto++ 8.5
+	virtual void SaveTable(const DL_GroupPrecomputation<Element> &group, BufferedTransformation &storedPrecomputation) const
+	{
+		CRYPTOPP_UNUSED(group); CRYPTOPP_UNUSED(storedPrecomputation);
+		throw NotImplemented("DL_FixedBasePrecomputation: SaveTable not implemented");
+	}
+
+	/// \brief Use a table of precomputation in place
+	/// \param group the the group
+	/// \param table pointer to a table written by SaveTable()
+	/// \param size the size of the table, in bytes
+	/// \details LoadTable() checks the table header and keeps a pointer to the
+	///   table. The bases are decoded from the table when they are used, so
+	///   the table is not copied to the heap and processes which map the same
+	///   file share one copy of it. The table must stay valid and unchanged
+	///   until the object is destroyed or a new base or precomputation is set.
+	/// \details Copies of the object share the caller's table through a
+	///   reference counted handle instead of copying it. The table must
+	///   also outlive the copies, including copies of keys and group
+	///   parameters.
+	/// \throw NotImplemented
+	/// \throw InvalidDataFormat if the table is malformed
+	/// \sa SaveTable(), Load()
+	/// \since Crypto++ 8.5
+	virtual void LoadTable(const DL_GroupPrecomputation<Element> &group, const byte *table, size_t size)
+	{
+		CRYPTOPP_UNUSED(group); CRYPTOPP_UNUSED(table); CRYPTOPP_UNUSED(size);
+		throw NotImplemented("DL_FixedBasePrecomputation: LoadTable not implemented");
+	}
+
 	/// \brief Exponentiates an element
 	/// \param group the group
 	/// \param exponent the exponent
@@ -141,16 +181,37 @@ public:
 	void Precompute(const DL_GroupPrecomputation<Element> &group, unsigned int maxExpBits, unsigned int storage);
 	void Load(const DL_GroupPrecomputation<Element> &group, BufferedTransformation &storedPrecomputation);
 	void Save(const DL_GroupPrecomputation<Element> &group, BufferedTransformation &storedPrecomputation) const;
+	void SaveTable(const DL_GroupPrecomputation<Element> &group, BufferedTransformation &storedPrecomputation) const;
+	void LoadTable(const DL_GroupPrecomputation<Element> &group, const byte *table, size_t size);
 	Element Exponentiate(const DL_GroupPrecomputation<Element> &group, const Integer &exponent) const;
 	Element CascadeExponentiate(const DL_GroupPrecomputation<Element> &pc1, const Integer &exponent1, const DL_FixedBasePrecomputation<Element> &pc2, const Integer &exponent2) const;
 
 private:
+	// A table from LoadTable(). The memory belongs to the caller, and
+	// copies of the object share the handle.
+	struct Table : public NotCopyable
+	{
+		Table(const byte *data, size_t count) : m_data(data), m_count(count), m_referenceCount(0) {}
+
+		const byte *m_data;
+		size_t m_count;
+#if defined(CRYPTOPP_CXX11_ATOMIC)
+		mutable std::atomic<unsigned int> m_referenceCount;
+#else
+		mutable unsigned int m_referenceCount;
+#endif
+	};
+	typedef counted_ptr<const Table> TablePtr;
+
 	void PrepareCascade(const DL_GroupPrecomputation<Element> &group, std::vector<BaseAndExponent<Element> > &eb, const Integer &exponent) const;
+	size_t BaseCount() const {return m_table.get() ? m_table->m_count : m_bases.size();}
+	static Element TableBase(const DL_GroupPrecomputation<Element> &group, const byte *table, size_t i);
 
 	Element m_base;
 	unsigned int m_windowSize;
 	Integer m_exponentBase;			// what base to represent the exponent in
-	std::vector<Element> m_bases;	// precalculated bases
+	std::vector<Element> m_bases;	// precalculated bases, only the first when a table is used
+	TablePtr m_table;				// table from LoadTable(), if any
 };
 
 NAMESPACE_END
@@ -17,6 +17,7 @@
 #include "mqueue.h"
 #include "fltrimpl.h"
 #include "argnames.h"
+#include "modes.h"
 #include "smartptr.h"
 #include "stdcpp.h"
 #include "misc.h"
@@ -853,6 +854,110 @@ void StreamTransformationFilter::LastPut(const byte *inString, size_t length)
 
 // *************************************************************
 
+ParallelStreamTransformationFilter::ParallelStreamTransformationFilter(StreamTransformation &c, BufferedTransformation *attachment, BlockPaddingScheme padding, size_t segmentSize)
+	: StreamTransformationFilter(c, attachment, padding), m_mode(dynamic_cast<CipherModeBase *>(&c))
+	, m_segmentSize(RoundUpToMultipleOf(STDMAX<size_t>(segmentSize, m_mandatoryBlockSize), size_t(m_mandatoryBlockSize)))
+{
+	if (m_mode)
+	{
+		m_workers.reset(new SegmentWorkers);
+
+		// The base class constructor could not reach the buffer size below
+		FilterWithBufferedInput::IsolatedInitialize(MakeParameters(Name::BlockPaddingScheme(), padding));
+	}
+}
+
+ParallelStreamTransformationFilter::~ParallelStreamTransformationFilter()
+{
+}
+
+void ParallelStreamTransformationFilter::InitializeDerivedAndReturnNewSizes(const NameValuePairs &parameters, size_t &firstSize, size_t &blockSize, size_t &lastSize)
+{
+	StreamTransformationFilter::InitializeDerivedAndReturnNewSizes(parameters, firstSize, blockSize, lastSize);
+
+	// Hold SegmentsPerBuffer segments so each thread has some work
+	if (m_mode && m_segmentSize <= SIZE_MAX/SegmentsPerBuffer)
+		blockSize = SegmentsPerBuffer*m_segmentSize;
+}
+
+void ParallelStreamTransformationFilter::FirstPut(const byte* inString)
+{
+	StreamTransformationFilter::FirstPut(inString);
+	if (m_mode)
+	{
+		// A new message may use a new key
+		m_workers->Reset();
+
+		// Output space for a whole buffer
+		unsigned int size;
+		if (SafeConvert(SegmentsPerBuffer*m_segmentSize, size))
+			m_optimalBufferSize = STDMAX(m_optimalBufferSize, RoundDownToMultipleOf(size, m_optimalBufferSize));
+	}
+}
+
+void ParallelStreamTransformationFilter::NextPutMultiple(const byte *inString, size_t length)
+{
+	if (!m_mode)
+	{
+		StreamTransformationFilter::NextPutMultiple(inString, length);
+		return;
+	}
+
+	if (!length)
+		{return;}
+
+	// Same as StreamTransformationFilter, but the buffer is processed in segments
+	const size_t s = m_cipher.MandatoryBlockSize();
+	do
+	{
+		size_t len = m_optimalBufferSize;
+		byte *space = HelpCreatePutSpace(*AttachedTransformation(), DEFAULT_CHANNEL, s, length, len);
+		if (len < length)
+		{
+			if (len == m_optimalBufferSize)
+				len -= m_cipher.GetOptimalBlockSizeUsed();
+			len = RoundDownToMultipleOf(len, s);
+		}
+		else
+			len = length;
+		m_mode->ProcessSegments(space, inString, len, m_segmentSize, m_workers.get());
+		AttachedTransformation()->PutModifiable(space, len);
+		inString = PtrAdd(inString, len);
+		length -= len;
+	}
+	while (length > 0);
+}
+
+void ParallelStreamTransformationFilter::NextPutModifiable(byte *inString, size_t length)
+{
+	if (!m_mode)
+	{
+		StreamTransformationFilter::NextPutModifiable(inString, length);
+		return;
+	}
+
+	m_mode->ProcessSegments(inString, inString, length, m_segmentSize, m_workers.get());
+	AttachedTransformation()->PutModifiable(inString, length);
+}
+
+void ParallelStreamTransformationFilter::LastPut(const byte *inString, size_t length)
+{
+	// The last buffer can hold up to SegmentsPerBuffer segments. Process
+	// all but what StreamTransformationFilter::LastPut() expects.
+	const size_t lastSize = LastBlockSize(m_cipher, m_padding);
+	if (m_mode && length >= lastSize + m_mandatoryBlockSize)
+	{
+		const size_t len = RoundDownToMultipleOf(length - lastSize, size_t(m_mandatoryBlockSize));
+		NextPutMultiple(inString, len);
+		inString = PtrAdd(inString, len);
+		length -= len;
+	}
+
+	StreamTransformationFilter::LastPut(inString, length);
+}
+
+// *************************************************************
+
 HashFilter::HashFilter(HashTransformation &hm, BufferedTransformation *attachment, bool putMessage, int truncatedDigestSize, const std::string &messagePutChannel, const std::string &hashPutChannel)
 	: m_hashModule(hm), m_putMessage(putMessage), m_digestSize(0), m_space(NULLPTR)
 	, m_messagePutChannel(messagePutChannel), m_hashPutChannel(hashPutChannel)
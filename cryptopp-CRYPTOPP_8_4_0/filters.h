@@ -528,7 +528,7 @@ struct BlockPaddingSchemeDef
 ///  handle padding and unpadding when needed. If you are using an authenticated encryption mode of operation,
 ///  then use AuthenticatedEncryptionFilter() and AuthenticatedDecryptionFilter()
 /// \since Crypto++ 5.0
-class CRYPTOPP_DLL StreamTransformationFilter : public FilterWithBufferedInput, public BlockPaddingSchemeDef, private FilterPutSpaceHelper
+class CRYPTOPP_DLL StreamTransformationFilter : public FilterWithBufferedInput, public BlockPaddingSchemeDef, protected FilterPutSpaceHelper
 {
 public:
 	virtual ~StreamTransformationFilter() {}
@@ -576,6 +576,53 @@ protected:
 	bool m_isSpecial;
 };
 
+class CipherModeBase;
+class SegmentWorkers;
+
+/// \brief Filter wrapper for StreamTransformation that processes large buffers in segments
+/// \details ParallelStreamTransformationFilter() holds input until it has
+///  SegmentsPerBuffer segments, or the message ends, and passes the buffer to
+///  CipherModeBase::ProcessSegments(). ECB, CBC decryption, CTR and XTS split the
+///  buffer into segments of segmentSize bytes which do not depend on one another.
+///  If C++11 threads are available then the segments are processed on multiple
+///  threads. The filter keeps its threads and its copies of the block cipher until
+///  it is destroyed, and makes new copies at the start of each message.
+/// \details The output is the same as StreamTransformationFilter(), but it is
+///  produced in larger pieces, and a flush does not process a partial buffer. Other
+///  modes of operation and stream ciphers are processed as StreamTransformationFilter()
+///  does.
+/// \sa CipherModeBase::ProcessSegments(), SegmentWorkers
+/// \since Crypto++ 8.5
+class CRYPTOPP_DLL ParallelStreamTransformationFilter : public StreamTransformationFilter
+{
+public:
+	virtual ~ParallelStreamTransformationFilter();
+
+	/// \brief Construct a ParallelStreamTransformationFilter
+	/// \param c reference to a StreamTransformation
+	/// \param attachment an optional attached transformation
+	/// \param padding the \ref BlockPaddingSchemeDef "padding scheme"
+	/// \param segmentSize the size of each segment, in bytes
+	/// \details The filter buffers SegmentsPerBuffer segments before it
+	///  processes them.
+	ParallelStreamTransformationFilter(StreamTransformation &c, BufferedTransformation *attachment = NULLPTR,
+		BlockPaddingScheme padding = DEFAULT_PADDING, size_t segmentSize = 64*1024);
+
+	/// \brief Number of segments buffered by the filter
+	CRYPTOPP_CONSTANT(SegmentsPerBuffer = 16);
+
+protected:
+	void InitializeDerivedAndReturnNewSizes(const NameValuePairs &parameters, size_t &firstSize, size_t &blockSize, size_t &lastSize);
+	void FirstPut(const byte *inString);
+	void NextPutMultiple(const byte *inString, size_t length);
+	void NextPutModifiable(byte *inString, size_t length);
+	void LastPut(const byte *inString, size_t length);
+
+	CipherModeBase *m_mode;
+	size_t m_segmentSize;
+	member_ptr<SegmentWorkers> m_workers;
+};
+
 /// \brief Filter wrapper for HashTransformation
 /// \since Crypto++ 1.0
 class CRYPTOPP_DLL HashFilter : public Bufferless<Filter>, private FilterPutSpaceHelper
@@ -18,6 +18,7 @@
 #endif
 
 #include "gcm.h"
+#include "rijndael.h"
 #include "cpu.h"
 
 #if defined(CRYPTOPP_DISABLE_GCM_ASM)
@@ -86,6 +87,21 @@ const unsigned int s_cltableSizeInBlocks = 8;
 extern void GCM_ReverseHashBufferIfNeeded_CLMUL(byte *hashBuffer);
 #endif  // CRYPTOPP_CLMUL_AVAILABLE
 
+#if CRYPTOPP_CLMUL_AVAILABLE && CRYPTOPP_AESNI_AVAILABLE
+extern size_t GCM_ProcessBlocks_AESNI_CLMUL(const word32 *subkeys, unsigned int rounds, byte *counter,
+        const byte *inBlocks, byte *outBlocks, size_t len, const byte *mtable, byte *hbuffer, bool encrypt);
+const unsigned int s_stitchedBlocks = 8;
+#endif  // CRYPTOPP_CLMUL_AVAILABLE && CRYPTOPP_AESNI_AVAILABLE
+
+// Counter blocks for a group of short messages in the batch interfaces
+const unsigned int s_batchBlocks = 128;
+
+#if CRYPTOPP_VAES_AVAILABLE
+extern size_t GCM_AuthenticateBlocks_VPCLMULQDQ(const byte *data, size_t len, const byte *mtable, byte *hbuffer);
+extern size_t GCM_ProcessBlocks_VAES(const word32 *subkeys, unsigned int rounds, byte *counter,
+        const byte *inBlocks, byte *outBlocks, size_t len, const byte *mtable, byte *hbuffer, bool encrypt);
+#endif  // CRYPTOPP_VAES_AVAILABLE
+
 #if CRYPTOPP_ARM_PMULL_AVAILABLE
 extern void GCM_SetKeyWithoutResync_PMULL(const byte *hashKey, byte *mulTable, unsigned int tableSize);
 extern size_t GCM_AuthenticateBlocks_PMULL(const byte *data, size_t len, const byte *mtable, byte *hbuffer);
@@ -105,6 +121,42 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
     BlockCipher &blockCipher = AccessBlockCipher();
     blockCipher.SetKey(userKey, keylength, params);
 
+    m_sharedKey = SharedKeyPtr();
+    m_stitched = ExpandHashKey(blockCipher, params, m_buffer, 2*REQUIRED_BLOCKSIZE);
+}
+
+GCM_Base::SharedKeyPtr GCM_Base::NewSharedKey(const byte *userKey, size_t keylength, const NameValuePairs &params) const
+{
+    SharedKey *key = new SharedKey;
+    SharedKeyPtr result(key);
+
+    key->m_cipher.reset(static_cast<BlockCipher *>(GetBlockCipher().Clone()));
+    key->m_cipher->SetKey(userKey, keylength, params);
+    key->m_stitched = ExpandHashKey(*key->m_cipher, params, key->m_table, 0);
+    key->m_tableSize = static_cast<unsigned int>(key->m_table.size() - REQUIRED_BLOCKSIZE);
+
+    return result;
+}
+
+void GCM_Base::SetSharedKey(const SharedKeyPtr &key)
+{
+    if (key.get() == NULLPTR)
+        throw InvalidArgument(AlgorithmName() + ": shared key is NULL");
+
+    m_bufferedDataLength = 0;
+    m_state = State_Start;
+
+    // The object's own table is released and zeroized
+    AssignBlockCipher(key->GetBlockCipher());
+    m_sharedKey = key;
+    m_stitched = key->m_stitched;
+    m_buffer.New(3*REQUIRED_BLOCKSIZE);
+
+    m_state = State_KeySet;
+}
+
+bool GCM_Base::ExpandHashKey(const BlockCipher &blockCipher, const NameValuePairs &params, AlignedSecByteBlock &buffer, size_t offset) const
+{
     // GCM is only defined for 16-byte block ciphers at the moment.
     // However, variable blocksize support means we have to defer
     // blocksize checks to runtime after the key is set. Also see
@@ -115,6 +167,7 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
         throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
 
     int tableSize, i, j, k;
+    bool stitched = false;
 
 #if CRYPTOPP_CLMUL_AVAILABLE
     if (HasCLMUL())
@@ -123,6 +176,12 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
         (void)params.GetIntValue(Name::TableSize(), tableSize);
         tableSize = s_cltableSizeInBlocks * blockSize;
         CRYPTOPP_ASSERT(tableSize > static_cast<int>(blockSize));
+
+# if CRYPTOPP_AESNI_AVAILABLE
+        // AES-NI subkeys are only used when Rijndael scheduled them
+        stitched = HasAESNI() && HasSSE41() &&
+            dynamic_cast<const Rijndael::Encryption *>(&blockCipher) != NULLPTR;
+# endif
     }
     else
 #elif CRYPTOPP_ARM_PMULL_AVAILABLE
@@ -156,9 +215,9 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
         //#endif
     }
 
-    m_buffer.resize(3*blockSize + tableSize);
-    byte *mulTable = MulTable();
-    byte *hashKey = HashKey();
+    buffer.resize(offset + blockSize + tableSize);
+    byte *hashKey = buffer + offset;
+    byte *mulTable = hashKey + REQUIRED_BLOCKSIZE;
     memset(hashKey, 0, REQUIRED_BLOCKSIZE);
     blockCipher.ProcessBlock(hashKey);
 
@@ -166,19 +225,19 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
     if (HasCLMUL())
     {
         GCM_SetKeyWithoutResync_CLMUL(hashKey, mulTable, tableSize);
-        return;
+        return stitched;
     }
 #elif CRYPTOPP_ARM_PMULL_AVAILABLE
     if (HasPMULL())
     {
         GCM_SetKeyWithoutResync_PMULL(hashKey, mulTable, tableSize);
-        return;
+        return stitched;
     }
 #elif CRYPTOPP_POWER8_VMULL_AVAILABLE
     if (HasPMULL())
     {
         GCM_SetKeyWithoutResync_VMULL(hashKey, mulTable, tableSize);
-        return;
+        return stitched;
     }
 #endif
 
@@ -295,6 +354,8 @@ void GCM_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const
                     }
         }
     }
+
+    return stitched;
 }
 
 inline void GCM_Base::ReverseHashBufferIfNeeded()
@@ -395,6 +456,13 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 #if CRYPTOPP_CLMUL_AVAILABLE
     if (HasCLMUL())
     {
+# if CRYPTOPP_VAES_AVAILABLE
+        if (HasVPCLMULQDQ() && len >= 8*HASH_BLOCKSIZE)
+        {
+            const size_t rem = GCM_AuthenticateBlocks_VPCLMULQDQ(data, len, MulTable(), HashBuffer());
+            data += len - rem; len = rem;
+        }
+# endif
         return GCM_AuthenticateBlocks_CLMUL(data, len, MulTable(), HashBuffer());
     }
 #elif CRYPTOPP_ARM_PMULL_AVAILABLE
@@ -413,9 +481,11 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
     word64 *hashBuffer = (word64 *)(void *)HashBuffer();
     CRYPTOPP_ASSERT(IsAlignedOn(hashBuffer,GetAlignmentOf<word64>()));
 
-    switch (2*(m_buffer.size()>=64*1024)
+    // The SSE2 assembly finds the table next to the hash buffer, so
+    // a shared table uses the C++ code
+    switch (2*(TableSize()>=64*1024)
 #if CRYPTOPP_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)
-        + HasSSE2()
+        + (HasSSE2() && MulTable() == m_buffer+3*REQUIRED_BLOCKSIZE)
 //#elif CRYPTOPP_ARM_NEON_AVAILABLE
 //      + HasNEON()
 #endif
@@ -423,7 +493,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
     {
     case 0:        // non-SSE2 and 2K tables
         {
-        byte *mulTable = MulTable();
+        const byte *mulTable = MulTable();
         word64 x0 = hashBuffer[0], x1 = hashBuffer[1];
 
         do
@@ -491,7 +561,7 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
 
     case 2:        // non-SSE2 and 64K tables
         {
-        byte *mulTable = MulTable();
+        const byte *mulTable = MulTable();
         word64 x0 = hashBuffer[0], x1 = hashBuffer[1];
 
         do
@@ -826,6 +896,29 @@ size_t GCM_Base::AuthenticateBlocks(const byte *data, size_t len)
     return len%16;
 }
 
+size_t GCM_Base::ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len)
+{
+#if CRYPTOPP_CLMUL_AVAILABLE && CRYPTOPP_AESNI_AVAILABLE
+    // No partial block is buffered, so the counter is on a block boundary
+    if (m_stitched && len >= s_stitchedBlocks*REQUIRED_BLOCKSIZE)
+    {
+        const Rijndael::Encryption &cipher = static_cast<const Rijndael::Encryption &>(GetBlockCipher());
+# if CRYPTOPP_VAES_AVAILABLE
+        if (HasVAES() && HasVPCLMULQDQ())
+        {
+            return GCM_ProcessBlocks_VAES(cipher.m_key, cipher.m_rounds, m_ctr.CounterBlock(),
+                inString, outString, len, MulTable(), HashBuffer(), IsForwardTransformation());
+        }
+# endif
+        return GCM_ProcessBlocks_AESNI_CLMUL(cipher.m_key, cipher.m_rounds, m_ctr.CounterBlock(),
+            inString, outString, len, MulTable(), HashBuffer(), IsForwardTransformation());
+    }
+#endif
+
+    CRYPTOPP_UNUSED(outString); CRYPTOPP_UNUSED(inString);
+    return len;
+}
+
 void GCM_Base::AuthenticateLastHeaderBlock()
 {
     if (m_bufferedDataLength > 0)
@@ -850,6 +943,125 @@ void GCM_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
     m_ctr.ProcessData(mac, HashBuffer(), macSize);
 }
 
+void GCM_Base::AuthenticatePadded(const byte *data, size_t len)
+{
+    if (len >= HASH_BLOCKSIZE)
+    {
+        const size_t left = GCM_Base::AuthenticateBlocks(data, len);
+        data += len - left;
+        len = left;
+    }
+
+    if (len > 0)
+    {
+        memcpy(m_buffer, data, len);
+        memset(m_buffer+len, 0, HASH_BLOCKSIZE-len);
+        GCM_Base::AuthenticateBlocks(m_buffer, HASH_BLOCKSIZE);
+    }
+}
+
+void GCM_Base::EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count)
+{
+    ProcessBatch(messages, count, true);
+}
+
+bool GCM_Base::DecryptAndVerifyBatch(BatchMessage *messages, size_t count)
+{
+    return ProcessBatch(messages, count, false);
+}
+
+bool GCM_Base::ProcessBatch(BatchMessage *messages, size_t count, bool encrypt)
+{
+    if (m_state < State_KeySet)
+        throw BadState(AlgorithmName(), encrypt ? "EncryptAndAuthenticateBatch" : "DecryptAndVerifyBatch", "setting key");
+
+    ThrowIfInvalidBatch(messages, count);
+
+    const BlockCipher &cipher = GetBlockCipher();
+    FixedSizeAlignedSecBlock<byte, s_batchBlocks*REQUIRED_BLOCKSIZE> counters, keystream;
+    FixedSizeAlignedSecBlock<byte, REQUIRED_BLOCKSIZE> computed;
+    bool pass = true;
+    size_t i = 0;
+
+    while (i < count)
+    {
+        // Gather messages while their counter blocks fit. Block 0 of each
+        // message is J0, which encrypts the MAC.
+        const size_t first = i;
+        size_t used = 0;
+        while (i < count)
+        {
+            const BatchMessage &m = messages[i];
+            const size_t blocks = 1 + (m.length+HASH_BLOCKSIZE-1) / HASH_BLOCKSIZE;
+            const int ivLength = m.ivLength < 0 ? static_cast<int>(IVSize()) : m.ivLength;
+            if (ivLength != 12 || used + blocks > s_batchBlocks)
+                break;
+
+            byte *ctr = counters + used*REQUIRED_BLOCKSIZE;
+            for (size_t j=0; j<blocks; ++j, ctr += REQUIRED_BLOCKSIZE)
+            {
+                memcpy(ctr, m.iv, 12);
+                PutWord<word32>(false, BIG_ENDIAN_ORDER, ctr+12, static_cast<word32>(j+1));
+            }
+
+            used += blocks;
+            ++i;
+        }
+
+        if (used == 0)
+        {
+            BatchMessage &m = messages[i];
+            if (encrypt)
+                EncryptAndAuthenticate(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+            else
+            {
+                m.verified = DecryptAndVerify(m.output, m.mac, m.macSize, m.iv, m.ivLength, m.header, m.headerLength, m.input, m.length);
+                pass = pass && m.verified;
+            }
+
+            ++i;
+            continue;
+        }
+
+        cipher.AdvancedProcessBlocks(counters, NULLPTR, keystream, used*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+
+        const byte *block = keystream;
+        for (size_t k=first; k<i; ++k)
+        {
+            BatchMessage &m = messages[k];
+            byte *mac = encrypt ? m.mac : computed.begin();
+
+            memset(HashBuffer(), 0, HASH_BLOCKSIZE);
+            AuthenticatePadded(m.header, m.headerLength);
+
+            if (!encrypt)
+                AuthenticatePadded(m.input, m.length);
+
+            xorbuf(m.output, m.input, block+REQUIRED_BLOCKSIZE, m.length);
+
+            if (encrypt)
+                AuthenticatePadded(m.output, m.length);
+
+            PutBlock<word64, BigEndian, true>(NULLPTR, m_buffer)(static_cast<word64>(m.headerLength)*8)(static_cast<word64>(m.length)*8);
+            GCM_Base::AuthenticateBlocks(m_buffer, HASH_BLOCKSIZE);
+            ReverseHashBufferIfNeeded();
+            xorbuf(mac, HashBuffer(), block, m.macSize);
+
+            if (!encrypt)
+            {
+                m.verified = VerifyBufsEqual(computed, m.mac, m.macSize);
+                pass = pass && m.verified;
+            }
+
+            block += REQUIRED_BLOCKSIZE * (1 + (m.length+HASH_BLOCKSIZE-1) / HASH_BLOCKSIZE);
+        }
+    }
+
+    // The hash buffer no longer belongs to a message in progress
+    Restart();
+    return pass;
+}
+
 NAMESPACE_END
 
 #endif    // Not CRYPTOPP_GENERATE_X64_MASM
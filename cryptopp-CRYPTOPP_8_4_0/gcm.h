@@ -9,6 +9,7 @@
 
 #include "authenc.h"
 #include "modes.h"
+#include "smartptr.h"
 
 // Clang 3.3 integrated assembler crash on Linux. Clang 3.4 due to compiler
 // error with .intel_syntax, http://llvm.org/bugs/show_bug.cgi?id=24232
@@ -63,6 +64,84 @@ public:
 	lword MaxMessageLength() const
 		{return ((W64LIT(1)<<39)-256)/8;}
 
+	/// \brief Encrypts and calculates a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \details Messages with 12-byte IVs are gathered into groups. The counter
+	///   blocks of a group are encrypted in one call to the block cipher, so the
+	///   AES-NI and VAES pipelines stay full. GHASH then runs on each message.
+	///   Other IV sizes and long messages use EncryptAndAuthenticate().
+	/// \since Crypto++ 8.5
+	void EncryptAndAuthenticateBatch(BatchMessage *messages, size_t count);
+
+	/// \brief Decrypts and verifies a MAC for several messages
+	/// \param messages the array of messages
+	/// \param count the number of messages
+	/// \return true if every MAC is valid, false otherwise
+	/// \sa EncryptAndAuthenticateBatch()
+	/// \since Crypto++ 8.5
+	bool DecryptAndVerifyBatch(BatchMessage *messages, size_t count);
+
+	/// \brief Expanded key state shared by GCM objects
+	/// \details SharedKey holds the block cipher key schedule, the hash key and the
+	///   GHASH multiplication table for one key. It does not change once created, so
+	///   any number of objects on any number of threads can be keyed from it with
+	///   SetSharedKey(). Each object copies the key schedule, which is small, and
+	///   refers to the table, which is up to 64 KB.
+	/// \details SharedKey is reference counted with counted_ptr. The count is atomic
+	///   when the compiler provides C++11 atomics. The key material is zeroized when
+	///   the last reference goes away.
+	/// \sa ExpandedKeyCache
+	/// \since Crypto++ 8.5
+	class CRYPTOPP_DLL SharedKey : public NotCopyable
+	{
+	public:
+		/// \brief The block cipher keyed with the shared key
+		const BlockCipher & GetBlockCipher() const {return *m_cipher;}
+
+	private:
+		friend class GCM_Base;
+		template <class T> friend class counted_ptr;
+
+		SharedKey() : m_tableSize(0), m_stitched(false), m_referenceCount(0) {}
+
+		const byte *HashKey() const {return m_table;}
+		const byte *MulTable() const {return m_table+REQUIRED_BLOCKSIZE;}
+
+		member_ptr<BlockCipher> m_cipher;
+		AlignedSecByteBlock m_table;
+		unsigned int m_tableSize;
+		bool m_stitched;
+#if defined(CRYPTOPP_CXX11_ATOMIC)
+		mutable std::atomic<unsigned int> m_referenceCount;
+#else
+		mutable unsigned int m_referenceCount;
+#endif
+	};
+
+	/// \brief Reference to a SharedKey
+	typedef counted_ptr<const SharedKey> SharedKeyPtr;
+
+	/// \brief Expands a key for sharing
+	/// \param userKey the key
+	/// \param keylength the size of the key, in bytes
+	/// \param params additional parameters, like Name::TableSize()
+	/// \return a reference to the expanded key
+	/// \details NewSharedKey() runs the block cipher key schedule and builds the GHASH
+	///   table once. This object is not changed. The result keys any GCM object with
+	///   the same block cipher, in either direction, through SetSharedKey().
+	/// \since Crypto++ 8.5
+	SharedKeyPtr NewSharedKey(const byte *userKey, size_t keylength, const NameValuePairs &params = g_nullNameValuePairs) const;
+
+	/// \brief Sets the key from an expanded key
+	/// \param key the expanded key from NewSharedKey()
+	/// \details SetSharedKey() is the cheap equivalent of SetKey() without an IV. The
+	///   object keeps a reference to the key until it is keyed again or destroyed.
+	///   Call Resynchronize() or one of the EncryptAndAuthenticate() family next.
+	/// \throw InvalidArgument if the key is for a different block cipher
+	/// \since Crypto++ 8.5
+	void SetSharedKey(const SharedKeyPtr &key);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
@@ -75,24 +154,41 @@ protected:
 	void AuthenticateLastHeaderBlock();
 	void AuthenticateLastConfidentialBlock();
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	size_t ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 
 	virtual BlockCipher & AccessBlockCipher() =0;
 	virtual GCM_TablesOption GetTablesOption() const =0;
+	virtual void AssignBlockCipher(const BlockCipher &cipher) =0;
 
 	const BlockCipher & GetBlockCipher() const {return const_cast<GCM_Base *>(this)->AccessBlockCipher();}
 	byte *HashBuffer() {return m_buffer+REQUIRED_BLOCKSIZE;}
-	byte *HashKey() {return m_buffer+2*REQUIRED_BLOCKSIZE;}
-	byte *MulTable() {return m_buffer+3*REQUIRED_BLOCKSIZE;}
+	const byte *MulTable() const
+		{return m_sharedKey.get() ? m_sharedKey->MulTable() : m_buffer+3*REQUIRED_BLOCKSIZE;}
+	unsigned int TableSize() const
+		{return m_sharedKey.get() ? m_sharedKey->m_tableSize : static_cast<unsigned int>(m_buffer.size()-3*REQUIRED_BLOCKSIZE);}
 	inline void ReverseHashBufferIfNeeded();
 
+	// Writes the hash key and the multiplication table to buffer at offset.
+	// The cipher must be keyed. Returns true if the stitched AES kernels apply.
+	bool ExpandHashKey(const BlockCipher &cipher, const NameValuePairs &params, AlignedSecByteBlock &buffer, size_t offset) const;
+
+	// Hashes data padded with zeros to a multiple of HASH_BLOCKSIZE
+	void AuthenticatePadded(const byte *data, size_t len);
+	// EncryptAndAuthenticateBatch and DecryptAndVerifyBatch
+	bool ProcessBatch(BatchMessage *messages, size_t count, bool encrypt);
+
 	class CRYPTOPP_DLL GCTR : public CTR_Mode_ExternalCipher::Encryption
 	{
+	public:
+		byte *CounterBlock() {return m_counterArray;}
 	protected:
 		void IncrementCounterBy256();
 	};
 
 	GCTR m_ctr;
+	SharedKeyPtr m_sharedKey;
+	bool m_stitched;
 	static word16 s_reductionTable[256];
 	static volatile bool s_reductionTableInitialized;
 	enum {REQUIRED_BLOCKSIZE = 16, HASH_BLOCKSIZE = 16};
@@ -115,6 +211,13 @@ public:
 private:
 	GCM_TablesOption GetTablesOption() const {return T_TablesOption;}
 	BlockCipher & AccessBlockCipher() {return m_cipher;}
+	void AssignBlockCipher(const BlockCipher &cipher)
+	{
+		const typename T_BlockCipher::Encryption *c = dynamic_cast<const typename T_BlockCipher::Encryption *>(&cipher);
+		if (c == NULLPTR)
+			throw InvalidArgument(AlgorithmName() + ": shared key is for " + cipher.AlgorithmName());
+		m_cipher = *c;
+	}
 	typename T_BlockCipher::Encryption m_cipher;
 };
 
@@ -0,0 +1,250 @@
+// gcm_avx.cpp - written and placed in the public domain by
+//               the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to VPCLMULQDQ and
+//    VAES on 256-bit registers. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernels follow the CLMUL code in gcm_simd.cpp, but a ymm register
+//    carries two blocks. The hash of eight blocks takes sixteen carryless
+//    multiplies on ymm registers instead of twenty-four on xmm registers.
+//    The products for both lanes are summed before the one reduction.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_VAES_AVAILABLE)
+# include <emmintrin.h>
+# include <tmmintrin.h>
+# include <wmmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+#define M256_CAST(x) ((__m256i *)(void *)(x))
+#define CONST_M256_CAST(x) ((const __m256i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char GCM_AVX_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_VAES_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Same as GCM_Reduce_CLMUL in gcm_simd.cpp
+inline __m128i GCM_Reduce_VPCLMULQDQ(__m128i c0, __m128i c1, __m128i c2, const __m128i& r)
+{
+    c1 = _mm_xor_si128(c1, _mm_slli_si128(c0, 8));
+    c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(c0, r, 0x10));
+    c0 = _mm_xor_si128(c1, _mm_srli_si128(c0, 8));
+    c0 = _mm_slli_epi64(c0, 1);
+    c0 = _mm_clmulepi64_si128(c0, r, 0);
+    c2 = _mm_xor_si128(c2, c0);
+    c2 = _mm_xor_si128(c2, _mm_srli_si128(c1, 8));
+    c1 = _mm_unpacklo_epi64(c1, c2);
+    c1 = _mm_srli_epi64(c1, 63);
+    c2 = _mm_slli_epi64(c2, 1);
+    return _mm_xor_si128(c2, c1);
+}
+
+// Accumulates the unreduced products of both lanes of d and h
+inline void GCM_MultiplyAccumulate_VPCLMULQDQ(__m256i &c0, __m256i &c1, __m256i &c2,
+                                              const __m256i &d, const __m256i &h)
+{
+    c0 = _mm256_xor_si256(c0, _mm256_clmulepi64_epi128(d, h, 0x00));
+    c1 = _mm256_xor_si256(c1, _mm256_clmulepi64_epi128(d, h, 0x01));
+    c1 = _mm256_xor_si256(c1, _mm256_clmulepi64_epi128(d, h, 0x10));
+    c2 = _mm256_xor_si256(c2, _mm256_clmulepi64_epi128(d, h, 0x11));
+}
+
+// Sums the lanes of the products and reduces them
+inline __m128i GCM_FoldReduce_VPCLMULQDQ(const __m256i &c0, const __m256i &c1,
+                                         const __m256i &c2, const __m128i &r)
+{
+    return GCM_Reduce_VPCLMULQDQ(
+        _mm_xor_si128(_mm256_castsi256_si128(c0), _mm256_extracti128_si256(c0, 1)),
+        _mm_xor_si128(_mm256_castsi256_si128(c1), _mm256_extracti128_si256(c1, 1)),
+        _mm_xor_si128(_mm256_castsi256_si128(c2), _mm256_extracti128_si256(c2, 1)), r);
+}
+
+// GCM_SetKeyWithoutResync_CLMUL interleaves the halves of H^1..H^8.
+// h[k] holds the powers for blocks 2k and 2k+1 of a group of eight,
+// which are H^(8-2k) and H^(7-2k).
+inline void GCM_LoadPowers_VPCLMULQDQ(__m256i h[4], const byte *mtable)
+{
+    for (unsigned int i=0; i<4; ++i)
+    {
+        const __m128i lo = _mm_load_si128(CONST_M128_CAST(mtable+i*32));
+        const __m128i hi = _mm_load_si128(CONST_M128_CAST(mtable+i*32+16));
+        h[3-i] = _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm_unpackhi_epi64(lo, hi)), _mm_unpacklo_epi64(lo, hi), 1);
+    }
+}
+
+// Moves x into the low lane and clears the high lane
+inline __m256i GCM_LowLane(const __m128i &x)
+{
+    return _mm256_inserti128_si256(_mm256_setzero_si256(), x, 0);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+// Hashes 8 blocks per iteration. Returns the number of bytes not
+// processed, which is less than 128.
+size_t GCM_AuthenticateBlocks_VPCLMULQDQ(const byte *data, size_t len, const byte *mtable, byte *hbuffer)
+{
+    const __m128i r = _mm_set_epi32(0xc2000000, 0x00000000, 0xe1000000, 0x00000000);
+    const __m256i m1 = _mm256_broadcastsi128_si256(
+        _mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f));
+    __m128i x = _mm_load_si128(CONST_M128_CAST(hbuffer));
+
+    __m256i h[4];
+    GCM_LoadPowers_VPCLMULQDQ(h, mtable);
+
+    while (len >= 128)
+    {
+        __m256i c0 = _mm256_setzero_si256();
+        __m256i c1 = _mm256_setzero_si256();
+        __m256i c2 = _mm256_setzero_si256();
+
+        for (unsigned int i=0; i<4; ++i)
+        {
+            __m256i d = _mm256_shuffle_epi8(_mm256_loadu_si256(CONST_M256_CAST(data+i*32)), m1);
+            if (i == 0)
+                d = _mm256_xor_si256(d, GCM_LowLane(x));
+            GCM_MultiplyAccumulate_VPCLMULQDQ(c0, c1, c2, d, h[i]);
+        }
+
+        x = GCM_FoldReduce_VPCLMULQDQ(c0, c1, c2, r);
+        data += 128;
+        len -= 128;
+    }
+
+    _mm_store_si128(M128_CAST(hbuffer), x);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return len;
+}
+
+// Same as GCM_ProcessBlocks_AESNI_CLMUL in gcm_simd.cpp, with two
+// counter blocks per ymm register for the AES rounds and two ciphertext
+// blocks per ymm register for the carryless multiplies. Returns the
+// number of bytes not processed, which is less than 128.
+size_t GCM_ProcessBlocks_VAES(const word32 *subkeys, unsigned int rounds, byte *counter,
+    const byte *inBlocks, byte *outBlocks, size_t len, const byte *mtable, byte *hbuffer, bool encrypt)
+{
+    const __m128i r = _mm_set_epi32(0xc2000000, 0x00000000, 0xe1000000, 0x00000000);
+    const __m256i m1 = _mm256_broadcastsi128_si256(
+        _mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f));
+    __m128i x = _mm_load_si128(CONST_M128_CAST(hbuffer));
+
+    __m256i h[4];
+    GCM_LoadPowers_VPCLMULQDQ(h, mtable);
+
+    // AES-256 uses 15 round keys
+    __m256i rk[15];
+    for (unsigned int i=0; i<=rounds; ++i)
+        rk[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128(CONST_M128_CAST(subkeys+4*i)));
+
+    // Byte reversed counters, the 32-bit counter is in the low word of
+    // each lane. The high lane is one ahead of the low lane.
+    __m256i ctr = _mm256_add_epi32(_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(
+        _mm_loadu_si128(CONST_M128_CAST(counter))), m1), _mm256_set_epi32(0,0,0,1, 0,0,0,0));
+    const __m256i two = _mm256_set_epi32(0,0,0,2, 0,0,0,2);
+
+    __m256i d[4];
+    bool pending = false;
+
+    while (len >= 128)
+    {
+        __m256i b[4];
+        for (unsigned int i=0; i<4; ++i)
+        {
+            b[i] = _mm256_xor_si256(_mm256_shuffle_epi8(ctr, m1), rk[0]);
+            ctr = _mm256_add_epi32(ctr, two);
+        }
+
+        if (!encrypt)
+        {
+            for (unsigned int i=0; i<4; ++i)
+                d[i] = _mm256_shuffle_epi8(_mm256_loadu_si256(CONST_M256_CAST(inBlocks+i*32)), m1);
+            pending = true;
+        }
+
+        __m256i c0 = _mm256_setzero_si256();
+        __m256i c1 = _mm256_setzero_si256();
+        __m256i c2 = _mm256_setzero_si256();
+        if (pending)
+            d[0] = _mm256_xor_si256(d[0], GCM_LowLane(x));
+
+        // AES has at least 10 rounds, one multiply is issued per round
+        for (unsigned int i=1; i<rounds; ++i)
+        {
+            const __m256i k = rk[i];
+            b[0] = _mm256_aesenc_epi128(b[0], k);
+            b[1] = _mm256_aesenc_epi128(b[1], k);
+            b[2] = _mm256_aesenc_epi128(b[2], k);
+            b[3] = _mm256_aesenc_epi128(b[3], k);
+
+            if (pending && i <= 4)
+                GCM_MultiplyAccumulate_VPCLMULQDQ(c0, c1, c2, d[i-1], h[i-1]);
+        }
+
+        const __m256i k = rk[rounds];
+        for (unsigned int i=0; i<4; ++i)
+        {
+            b[i] = _mm256_aesenclast_epi128(b[i], k);
+            b[i] = _mm256_xor_si256(b[i], _mm256_loadu_si256(CONST_M256_CAST(inBlocks+i*32)));
+            _mm256_storeu_si256(M256_CAST(outBlocks+i*32), b[i]);
+        }
+
+        if (pending)
+            x = GCM_FoldReduce_VPCLMULQDQ(c0, c1, c2, r);
+
+        if (encrypt)
+        {
+            for (unsigned int i=0; i<4; ++i)
+                d[i] = _mm256_shuffle_epi8(b[i], m1);
+            pending = true;
+        }
+
+        inBlocks += 128;
+        outBlocks += 128;
+        len -= 128;
+    }
+
+    // Encryption hashes the last group after the loop
+    if (encrypt && pending)
+    {
+        __m256i c0 = _mm256_setzero_si256();
+        __m256i c1 = _mm256_setzero_si256();
+        __m256i c2 = _mm256_setzero_si256();
+
+        d[0] = _mm256_xor_si256(d[0], GCM_LowLane(x));
+        for (unsigned int i=0; i<4; ++i)
+            GCM_MultiplyAccumulate_VPCLMULQDQ(c0, c1, c2, d[i], h[i]);
+        x = GCM_FoldReduce_VPCLMULQDQ(c0, c1, c2, r);
+    }
+
+    // The low lane holds the next counter
+    _mm_storeu_si128(M128_CAST(counter), _mm_shuffle_epi8(
+        _mm256_castsi256_si128(ctr), _mm256_castsi256_si128(m1)));
+    _mm_store_si128(M128_CAST(hbuffer), x);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return len;
+}
+
+#endif  // CRYPTOPP_VAES_AVAILABLE
+
+NAMESPACE_END
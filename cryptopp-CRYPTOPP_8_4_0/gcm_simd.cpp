@@ -563,6 +563,133 @@ void GCM_ReverseHashBufferIfNeeded_CLMUL(byte *hashBuffer)
     _mm_storeu_si128(M128_CAST(hashBuffer), _mm_shuffle_epi8(
         _mm_loadu_si128(CONST_M128_CAST(hashBuffer)), mask));
 }
+
+#if CRYPTOPP_AESNI_AVAILABLE
+
+// Accumulates the unreduced product of d and h. GCM_Reduce_CLMUL
+// is linear, so eight products can share a single reduction.
+inline void GCM_MultiplyAccumulate_CLMUL(__m128i &c0, __m128i &c1, __m128i &c2,
+                                         const __m128i &d, const __m128i &h)
+{
+    c0 = _mm_xor_si128(c0, _mm_clmulepi64_si128(d, h, 0x00));
+    c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(d, h, 0x01));
+    c1 = _mm_xor_si128(c1, _mm_clmulepi64_si128(d, h, 0x10));
+    c2 = _mm_xor_si128(c2, _mm_clmulepi64_si128(d, h, 0x11));
+}
+
+// Encrypts or decrypts 8 blocks per iteration in counter mode and hashes
+// the ciphertext in the same loop. The AES rounds for one group of blocks
+// are interleaved with the carryless multiplies for a group of ciphertext
+// blocks. Decryption hashes the input of the current group, and encryption
+// hashes the output of the previous group. Each group is multiplied by
+// H^8..H^1 and reduced once. The 32-bit counter in the last four bytes of
+// counter is advanced by the number of blocks processed. Returns the number
+// of bytes not processed, which is less than 128.
+size_t GCM_ProcessBlocks_AESNI_CLMUL(const word32 *subkeys, unsigned int rounds, byte *counter,
+    const byte *inBlocks, byte *outBlocks, size_t len, const byte *mtable, byte *hbuffer, bool encrypt)
+{
+    const __m128i* skeys = reinterpret_cast<const __m128i*>(subkeys);
+    const __m128i r = _mm_set_epi32(0xc2000000, 0x00000000, 0xe1000000, 0x00000000);
+    const __m128i m1 = _mm_set_epi32(0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f);
+    __m128i x = _mm_load_si128(CONST_M128_CAST(hbuffer));
+
+    // GCM_SetKeyWithoutResync_CLMUL interleaves the halves of H^1..H^8
+    __m128i h[8];
+    for (unsigned int i=0; i<4; ++i)
+    {
+        const __m128i lo = _mm_load_si128(CONST_M128_CAST(mtable+i*32));
+        const __m128i hi = _mm_load_si128(CONST_M128_CAST(mtable+i*32+16));
+        h[2*i+0] = _mm_unpacklo_epi64(lo, hi);
+        h[2*i+1] = _mm_unpackhi_epi64(lo, hi);
+    }
+
+    // Byte reversed counter, the 32-bit counter is in the low lane
+    __m128i ctr = _mm_shuffle_epi8(_mm_loadu_si128(CONST_M128_CAST(counter)), m1);
+    const __m128i one = _mm_set_epi32(0, 0, 0, 1);
+
+    __m128i d[8];
+    bool pending = false;
+
+    while (len >= 128)
+    {
+        __m128i b[8];
+        for (unsigned int i=0; i<8; ++i)
+        {
+            b[i] = _mm_xor_si128(_mm_shuffle_epi8(ctr, m1), skeys[0]);
+            ctr = _mm_add_epi32(ctr, one);
+        }
+
+        if (!encrypt)
+        {
+            for (unsigned int i=0; i<8; ++i)
+                d[i] = _mm_shuffle_epi8(_mm_loadu_si128(CONST_M128_CAST(inBlocks+i*16)), m1);
+            pending = true;
+        }
+
+        __m128i c0 = _mm_setzero_si128();
+        __m128i c1 = _mm_setzero_si128();
+        __m128i c2 = _mm_setzero_si128();
+        if (pending)
+            d[0] = _mm_xor_si128(d[0], x);
+
+        // AES has at least 10 rounds, one multiply is issued per round
+        for (unsigned int i=1; i<rounds; ++i)
+        {
+            const __m128i rk = skeys[i];
+            b[0] = _mm_aesenc_si128(b[0], rk);
+            b[1] = _mm_aesenc_si128(b[1], rk);
+            b[2] = _mm_aesenc_si128(b[2], rk);
+            b[3] = _mm_aesenc_si128(b[3], rk);
+            b[4] = _mm_aesenc_si128(b[4], rk);
+            b[5] = _mm_aesenc_si128(b[5], rk);
+            b[6] = _mm_aesenc_si128(b[6], rk);
+            b[7] = _mm_aesenc_si128(b[7], rk);
+
+            if (pending && i <= 8)
+                GCM_MultiplyAccumulate_CLMUL(c0, c1, c2, d[i-1], h[8-i]);
+        }
+
+        const __m128i rk = skeys[rounds];
+        for (unsigned int i=0; i<8; ++i)
+        {
+            b[i] = _mm_aesenclast_si128(b[i], rk);
+            b[i] = _mm_xor_si128(b[i], _mm_loadu_si128(CONST_M128_CAST(inBlocks+i*16)));
+            _mm_storeu_si128(M128_CAST(outBlocks+i*16), b[i]);
+        }
+
+        if (pending)
+            x = GCM_Reduce_CLMUL(c0, c1, c2, r);
+
+        if (encrypt)
+        {
+            for (unsigned int i=0; i<8; ++i)
+                d[i] = _mm_shuffle_epi8(b[i], m1);
+            pending = true;
+        }
+
+        inBlocks += 128;
+        outBlocks += 128;
+        len -= 128;
+    }
+
+    // Encryption hashes the last group after the loop
+    if (encrypt && pending)
+    {
+        __m128i c0 = _mm_setzero_si128();
+        __m128i c1 = _mm_setzero_si128();
+        __m128i c2 = _mm_setzero_si128();
+
+        d[0] = _mm_xor_si128(d[0], x);
+        for (unsigned int i=0; i<8; ++i)
+            GCM_MultiplyAccumulate_CLMUL(c0, c1, c2, d[i], h[7-i]);
+        x = GCM_Reduce_CLMUL(c0, c1, c2, r);
+    }
+
+    _mm_storeu_si128(M128_CAST(counter), _mm_shuffle_epi8(ctr, m1));
+    _mm_store_si128(M128_CAST(hbuffer), x);
+    return len;
+}
+#endif  // CRYPTOPP_AESNI_AVAILABLE
 #endif  // CRYPTOPP_CLMUL_AVAILABLE
 
 // ***************************** POWER8 ***************************** //
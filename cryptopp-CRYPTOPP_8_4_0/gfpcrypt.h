@@ -313,6 +313,48 @@ public:
         // verify r == (g^u1 * y^u2 mod p) mod q
         return r == params.ConvertElementToInteger(publicKey.CascadeExponentiateBaseAndPublicElement(u1, u2)) % q;
     }
+
+    void VerifyBatch(const DL_GroupParameters<T> &params, const DL_PublicKey<T> &publicKey, const Integer *e, const Integer *r, const Integer *s, size_t count, bool *valid) const
+    {
+        const Integer &q = params.GetSubgroupOrder();
+        std::vector<size_t> index;
+        std::vector<Integer> w;
+        index.reserve(count); w.reserve(count);
+
+        // Montgomery's trick, one inversion for all s. w holds the
+        // products of the s values before each entry.
+        Integer acc = Integer::One();
+        for (size_t i=0; i<count; ++i)
+        {
+            valid[i] = false;
+            if (r[i]>=q || r[i]<1 || s[i]>=q || s[i]<1)
+                continue;
+
+            index.push_back(i);
+            w.push_back(acc);
+            acc = (acc * s[i]) % q;
+        }
+
+        const size_t n = index.size();
+        if (n == 0)
+            return;
+
+        Integer inv = acc.InverseMod(q);
+        std::vector<Integer> u1(n), u2(n);
+        for (size_t j=n; j-- > 0; )
+        {
+            const size_t i = index[j];
+            w[j] = (inv * w[j]) % q;
+            inv = (inv * s[i]) % q;
+            u1[j] = (e[i] * w[j]) % q;
+            u2[j] = (r[i] * w[j]) % q;
+        }
+
+        std::vector<T> results(n);
+        publicKey.CascadeExponentiateBaseAndPublicElements(&results[0], &u1[0], &u2[0], n);
+        for (size_t j=0; j<n; ++j)
+            valid[index[j]] = r[index[j]] == params.ConvertElementToInteger(results[j]) % q;
+    }
 };
 
 /// \brief DSA signature algorithm based on RFC 6979
@@ -3379,10 +3379,17 @@ void Integer::Decode(BufferedTransformation &bt, size_t inputLen, Signedness s)
 	}
 
 	reg.CleanNew(RoundupSize(BytesToWords(inputLen)));
-	for (size_t i=inputLen; i > 0; i--)
+
+	// Retrieve the bytes in blocks rather than one Get() per byte
+	FixedSizeSecBlock<byte, 128> buf;
+	for (size_t i=inputLen; i > 0; )
 	{
-		(void)bt.Get(b);
-		reg[(i-1)/WORD_SIZE] |= word(b) << ((i-1)%WORD_SIZE)*8;
+		const size_t n = bt.Get(buf, STDMIN(i, buf.size()));
+		CRYPTOPP_ASSERT(n > 0);
+		if (n == 0)
+			break;
+		for (size_t j=0; j<n; j++, i--)
+			reg[(i-1)/WORD_SIZE] |= word(buf[j]) << ((i-1)%WORD_SIZE)*8;
 	}
 
 	if (sign == NEGATIVE)
@@ -0,0 +1,180 @@
+// keycache.h - written and placed in the public domain by the Crypto++ project
+
+/// \file keycache.h
+/// \brief Bounded cache of expanded keys
+/// \details Servers that hold many long-term keys can expand each key once and
+///  share the result among requests. ExpandedKeyCache keeps the expanded keys
+///  under an opaque identifier, and each request keys its own cipher object
+///  from the shared state, like GCM_Base::SetSharedKey().
+/// \since Crypto++ 8.5
+
+#ifndef CRYPTOPP_KEYCACHE_H
+#define CRYPTOPP_KEYCACHE_H
+
+#include "config.h"
+#include "misc.h"
+#include "smartptr.h"
+
+#include <string>
+#include <list>
+#include <map>
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/// \brief Bounded cache of expanded keys
+/// \tparam T the expanded key type, like <tt>const GCM_Base::SharedKey</tt>
+/// \details ExpandedKeyCache maps a key identifier to an expanded key held by
+///  counted_ptr. When the cache is full, Insert() evicts the least recently used
+///  key. A key that is evicted while a request still refers to it lives until the
+///  request lets go, and is then zeroized and freed like any other SecBlock.
+/// \details The cache is thread safe when the compiler provides C++11 synchronization.
+///  The reference count in T should be a <tt>std::atomic</tt> in that case, as
+///  GCM_Base::SharedKey does. Otherwise the caller must serialize access.
+/// \details Key identifiers are stored in the clear. Use a name or a handle for
+///  the key, and not the key itself.
+/// \since Crypto++ 8.5
+template <class T>
+class ExpandedKeyCache : public NotCopyable
+{
+public:
+	/// \brief Reference to an expanded key
+	typedef counted_ptr<T> Pointer;
+
+	/// \brief Construct an ExpandedKeyCache
+	/// \param maxSize the maximum number of keys held
+	explicit ExpandedKeyCache(size_t maxSize) : m_maxSize(maxSize) {}
+
+	/// \brief Retrieves an expanded key
+	/// \param id the key identifier
+	/// \param key the expanded key, if found
+	/// \return true if the key was found, false otherwise
+	/// \details Find() marks the key as the most recently used.
+	bool Find(const std::string &id, Pointer &key);
+
+	/// \brief Adds an expanded key
+	/// \param id the key identifier
+	/// \param key the expanded key
+	/// \details Insert() replaces any key already held under id, and evicts the
+	///  least recently used keys beyond MaxSize().
+	void Insert(const std::string &id, const Pointer &key);
+
+	/// \brief Removes an expanded key
+	/// \param id the key identifier
+	/// \return true if the key was found, false otherwise
+	bool Remove(const std::string &id);
+
+	/// \brief Removes all keys
+	void Clear();
+
+	/// \brief Provides the number of keys held
+	size_t Size() const;
+
+	/// \brief Provides the maximum number of keys held
+	size_t MaxSize() const {return m_maxSize;}
+
+private:
+	// Most recently used first
+	typedef std::list<std::pair<std::string, Pointer> > List;
+	typedef std::map<std::string, typename List::iterator> Map;
+
+	List m_list;
+	Map m_map;
+	size_t m_maxSize;
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	mutable std::mutex m_mutex;
+#endif
+};
+
+// Keys leaving the cache are moved to a local list, so the last reference
+// zeroizes and frees them after the lock is released.
+
+template <class T>
+bool ExpandedKeyCache<T>::Find(const std::string &id, Pointer &key)
+{
+	Pointer found;
+	{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+		std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+		typename Map::iterator it = m_map.find(id);
+		if (it == m_map.end())
+			return false;
+
+		m_list.splice(m_list.begin(), m_list, it->second);
+		found = it->second->second;
+	}
+
+	key = found;
+	return true;
+}
+
+template <class T>
+void ExpandedKeyCache<T>::Insert(const std::string &id, const Pointer &key)
+{
+	List evicted;
+	{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+		std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+		typename Map::iterator it = m_map.find(id);
+		if (it != m_map.end())
+		{
+			evicted.splice(evicted.end(), m_list, it->second);
+			m_map.erase(it);
+		}
+
+		m_list.push_front(std::make_pair(id, key));
+		m_map[id] = m_list.begin();
+
+		while (m_map.size() > m_maxSize)
+		{
+			typename List::iterator last = --m_list.end();
+			m_map.erase(last->first);
+			evicted.splice(evicted.end(), m_list, last);
+		}
+	}
+}
+
+template <class T>
+bool ExpandedKeyCache<T>::Remove(const std::string &id)
+{
+	List evicted;
+	{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+		std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+		typename Map::iterator it = m_map.find(id);
+		if (it == m_map.end())
+			return false;
+
+		evicted.splice(evicted.end(), m_list, it->second);
+		m_map.erase(it);
+	}
+	return true;
+}
+
+template <class T>
+void ExpandedKeyCache<T>::Clear()
+{
+	List evicted;
+	{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+		std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+		evicted.swap(m_list);
+		m_map.clear();
+	}
+}
+
+template <class T>
+size_t ExpandedKeyCache<T>::Size() const
+{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+	return m_map.size();
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_KEYCACHE_H
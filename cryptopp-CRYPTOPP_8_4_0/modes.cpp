@@ -6,11 +6,46 @@
 
 #include "modes.h"
 #include "misc.h"
+#include "smartptr.h"
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+# include <thread>
+# include <condition_variable>
+# include <exception>
+# include <system_error>
+#endif
 
 #if defined(CRYPTOPP_DEBUG)
 #include "des.h"
 #endif
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::lword;
+
+// Rounds segmentSize up to the block size and returns the number of segments
+inline size_t SegmentCount(size_t length, size_t &segmentSize, unsigned int blockSize)
+{
+	segmentSize = CryptoPP::RoundUpToMultipleOf(CryptoPP::STDMAX<size_t>(segmentSize, blockSize), size_t(blockSize));
+	return (length + segmentSize - 1) / segmentSize;
+}
+
+// Adds n to the big-endian counter
+inline void AddToCounter(byte *counter, unsigned int size, lword n)
+{
+	unsigned int carry=0;
+	for (int i=size-1; i>=0; i--)
+	{
+		const unsigned int sum = counter[i] + (byte)n + carry;
+		counter[i] = byte(sum & 0xff);
+		carry = sum >> 8;
+		n >>= 8;
+	}
+}
+
+ANONYMOUS_NAMESPACE_END
+
 NAMESPACE_BEGIN(CryptoPP)
 
 #if defined(CRYPTOPP_DEBUG) && !defined(CRYPTOPP_DOXYGEN_PROCESSING)
@@ -30,6 +65,194 @@ void CipherModeBase::ResizeBuffers()
 	m_register.New(m_cipher->BlockSize());
 }
 
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+
+// Each job bumps m_generation and wakes the threads. Workers take the next
+// segment from a shared counter, and the last worker to finish wakes the
+// caller. The first exception stops the others and is rethrown by Run().
+struct SegmentWorkers::State
+{
+	State(size_t threads) : m_ciphers(threads), m_cipher(NULLPTR), m_op(NULLPTR),
+		m_count(0), m_next(0), m_generation(0), m_active(0), m_stop(false)
+	{
+		m_pool.reserve(threads);
+	}
+
+	~State()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_start.notify_all();
+		for (size_t i = 0; i < m_pool.size(); ++i)
+			m_pool[i].join();
+	}
+
+	void Work(const BlockCipher &cipher)
+	{
+		try
+		{
+			for (size_t i = m_next++; i < m_count; i = m_next++)
+				(*m_op)(cipher, i);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_error)
+				m_error = std::current_exception();
+			m_next = m_count;
+		}
+	}
+
+	void Loop(size_t thread)
+	{
+		unsigned int generation = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (!m_stop && m_generation == generation)
+					m_start.wait(lock);
+				if (m_stop)
+					return;
+				generation = m_generation;
+			}
+
+			Work(*m_ciphers[thread]);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_active == 0)
+				m_done.notify_one();
+		}
+	}
+
+	// Copies of m_cipher, one for each thread in m_pool
+	vector_member_ptrs<BlockCipher> m_ciphers;
+	std::vector<std::thread> m_pool;
+	const BlockCipher *m_cipher;
+
+	const SegmentWorkers::Operation *m_op;
+	size_t m_count;
+	std::atomic<size_t> m_next;
+	unsigned int m_generation;
+	size_t m_active;
+	bool m_stop;
+	std::exception_ptr m_error;
+
+	std::mutex m_mutex;
+	std::condition_variable m_start, m_done;
+};
+
+SegmentWorkers::SegmentWorkers(unsigned int threads)
+	: m_threads(threads ? threads : std::thread::hardware_concurrency())
+{
+}
+
+#else
+
+struct SegmentWorkers::State {};
+
+SegmentWorkers::SegmentWorkers(unsigned int threads)
+	: m_threads(1)
+{
+	CRYPTOPP_UNUSED(threads);
+}
+
+#endif
+
+SegmentWorkers::~SegmentWorkers()
+{
+}
+
+void SegmentWorkers::Reset()
+{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+	if (m_state.get())
+		m_state->m_cipher = NULLPTR;
+#endif
+}
+
+void SegmentWorkers::Run(const BlockCipher &cipher, size_t count, const Operation &op)
+{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+	if (m_threads > 1 && count > 1)
+	{
+		if (!m_state.get())
+			m_state.reset(new State(m_threads-1));
+		State &state = *m_state;
+
+		// The calling thread uses cipher and the others use copies. The
+		// threads start on first use.
+		if (state.m_cipher != &cipher)
+		{
+			state.m_cipher = NULLPTR;
+			try
+			{
+				for (size_t i = 0; i < state.m_ciphers.size(); ++i)
+					state.m_ciphers[i].reset(static_cast<BlockCipher *>(cipher.Clone()));
+				while (state.m_pool.size() < state.m_ciphers.size())
+					state.m_pool.push_back(std::thread(&State::Loop, &state, state.m_pool.size()));
+				state.m_cipher = &cipher;
+			}
+			catch (const NotImplemented&)
+			{
+				// the segments are processed on this thread
+			}
+			catch (const std::system_error&)
+			{
+				// continue with the threads that started
+				state.m_cipher = &cipher;
+			}
+		}
+
+		if (state.m_cipher && !state.m_pool.empty())
+		{
+			{
+				std::lock_guard<std::mutex> lock(state.m_mutex);
+				state.m_op = &op;
+				state.m_count = count;
+				state.m_next = 0;
+				state.m_error = std::exception_ptr();
+				state.m_active = state.m_pool.size();
+				state.m_generation++;
+			}
+			state.m_start.notify_all();
+
+			state.Work(cipher);
+
+			std::exception_ptr error;
+			{
+				std::unique_lock<std::mutex> lock(state.m_mutex);
+				while (state.m_active != 0)
+					state.m_done.wait(lock);
+				error = state.m_error;
+				state.m_error = std::exception_ptr();
+			}
+
+			if (error)
+				std::rethrow_exception(error);
+			return;
+		}
+	}
+#endif
+
+	for (size_t i=0; i<count; ++i)
+		op(cipher, i);
+}
+
+void CipherModeBase::RunSegments(const BlockCipher &cipher, size_t count, const SegmentOperation &op, SegmentWorkers *workers)
+{
+	if (workers)
+	{
+		workers->Run(cipher, count, op);
+		return;
+	}
+
+	SegmentWorkers local;
+	local.Run(cipher, count, op);
+}
+
 void CFB_ModePolicy::Iterate(byte *output, const byte *input, CipherDir dir, size_t iterationCount)
 {
 	CRYPTOPP_ASSERT(input);	CRYPTOPP_ASSERT(output);
@@ -160,6 +383,91 @@ void CTR_ModePolicy::OperateKeystream(KeystreamOperation /*operation*/, byte *ou
 	}
 }
 
+void CTR_ModePolicy::ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers)
+{
+	// Only the cipher template knows how much keystream is buffered
+	typedef AdditiveCipherTemplate<AbstractPolicyHolder<AdditiveCipherAbstractPolicy, CTR_ModePolicy> > CTR_Cipher;
+	const CTR_Cipher *stream = dynamic_cast<const CTR_Cipher *>(this);
+	if (stream == NULLPTR)
+	{
+		ProcessData(outString, inString, length);
+		return;
+	}
+
+	// Use the buffered keystream first so the counter is on a block boundary
+	const size_t leftOver = STDMIN<size_t>(length, stream->GetOptimalNextBlockSize());
+	if (leftOver)
+	{
+		ProcessData(outString, inString, leftOver);
+		outString = PtrAdd(outString, leftOver);
+		inString = PtrAdd(inString, leftOver);
+		length -= leftOver;
+	}
+
+	const unsigned int s = BlockSize();
+	const size_t blocks = length / s;
+	if (blocks)
+	{
+		const size_t count = SegmentCount(blocks*s, segmentSize, s);
+		SecByteBlock counters(count*s);
+		for (size_t i=0; i<count; ++i)
+		{
+			std::memcpy(counters+i*s, m_counterArray, s);
+			AddToCounter(counters+i*s, s, i*(segmentSize/s));
+		}
+
+		class Segment : public SegmentOperation
+		{
+		public:
+			Segment(byte *out, const byte *in, size_t length, size_t segmentSize, const byte *counters, unsigned int blockSize)
+				: m_out(out), m_in(in), m_length(length), m_segmentSize(segmentSize), m_counters(counters), m_blockSize(blockSize) {}
+
+			// Same as OperateKeystream, with a copy of the counter
+			void operator()(const BlockCipher &cipher, size_t segment) const
+			{
+				const unsigned int s = m_blockSize;
+				const size_t offset = segment*m_segmentSize;
+				size_t iterationCount = STDMIN(m_segmentSize, m_length-offset) / s;
+				SecByteBlock counter(m_counters+segment*s, s);
+				byte *output = m_out+offset;
+				const byte *input = m_in+offset;
+
+				while (iterationCount)
+				{
+					const byte lsb = counter[s-1];
+					const size_t blocks = UnsignedMin(iterationCount, 256U-lsb);
+
+					cipher.AdvancedProcessBlocks(counter, input, output, blocks*s, BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_AllowParallel);
+					if ((counter[s-1] = byte(lsb + blocks)) == 0)
+						IncrementCounterByOne(counter, s-1);
+
+					output = PtrAdd(output, blocks*s);
+					input = PtrAdd(input, blocks*s);
+					iterationCount -= blocks;
+				}
+			}
+
+		private:
+			byte *m_out;
+			const byte *m_in;
+			size_t m_length, m_segmentSize;
+			const byte *m_counters;
+			unsigned int m_blockSize;
+		};
+
+		RunSegments(*m_cipher, count, Segment(outString, inString, blocks*s, segmentSize, counters, s), workers);
+		AddToCounter(m_counterArray, s, blocks);
+
+		outString = PtrAdd(outString, blocks*s);
+		inString = PtrAdd(inString, blocks*s);
+		length -= blocks*s;
+	}
+
+	// The tail starts a new buffer of keystream
+	if (length)
+		ProcessData(outString, inString, length);
+}
+
 void CTR_ModePolicy::CipherResynchronize(byte *keystreamBuffer, const byte *iv, size_t length)
 {
 	CRYPTOPP_UNUSED(keystreamBuffer), CRYPTOPP_UNUSED(length);
@@ -194,6 +502,33 @@ void ECB_OneWay::ProcessData(byte *outString, const byte *inString, size_t lengt
 	m_cipher->AdvancedProcessBlocks(inString, NULLPTR, outString, length, BlockTransformation::BT_AllowParallel);
 }
 
+void ECB_OneWay::ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers)
+{
+	CRYPTOPP_ASSERT(length%BlockSize()==0);
+	const size_t count = SegmentCount(length, segmentSize, BlockSize());
+
+	class Segment : public SegmentOperation
+	{
+	public:
+		Segment(byte *out, const byte *in, size_t length, size_t segmentSize)
+			: m_out(out), m_in(in), m_length(length), m_segmentSize(segmentSize) {}
+
+		void operator()(const BlockCipher &cipher, size_t segment) const
+		{
+			const size_t offset = segment*m_segmentSize;
+			cipher.AdvancedProcessBlocks(m_in+offset, NULLPTR, m_out+offset,
+				STDMIN(m_segmentSize, m_length-offset), BlockTransformation::BT_AllowParallel);
+		}
+
+	private:
+		byte *m_out;
+		const byte *m_in;
+		size_t m_length, m_segmentSize;
+	};
+
+	RunSegments(*m_cipher, count, Segment(outString, inString, length, segmentSize), workers);
+}
+
 void CBC_Encryption::ProcessData(byte *outString, const byte *inString, size_t length)
 {
 	CRYPTOPP_ASSERT(length%BlockSize()==0);
@@ -260,6 +595,52 @@ void CBC_Decryption::ProcessData(byte *outString, const byte *inString, size_t l
 	m_register.swap(m_temp);
 }
 
+void CBC_Decryption::ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers)
+{
+	CRYPTOPP_ASSERT(length%BlockSize()==0);
+	if (!length) {return;}
+
+	const unsigned int blockSize = BlockSize();
+	const size_t count = SegmentCount(length, segmentSize, blockSize);
+
+	// save the chaining blocks now in case of in-place decryption
+	SecByteBlock chain(count*blockSize);
+	memcpy(chain, m_register, blockSize);
+	for (size_t i=1; i<count; ++i)
+		memcpy(chain+i*blockSize, PtrAdd(inString, i*segmentSize-blockSize), blockSize);
+	memcpy(m_temp, PtrAdd(inString,length-blockSize), blockSize);
+
+	class Segment : public SegmentOperation
+	{
+	public:
+		Segment(byte *out, const byte *in, size_t length, size_t segmentSize, const byte *chain, unsigned int blockSize)
+			: m_out(out), m_in(in), m_length(length), m_segmentSize(segmentSize), m_chain(chain), m_blockSize(blockSize) {}
+
+		// Same as ProcessData, with the chaining block of the segment
+		void operator()(const BlockCipher &cipher, size_t segment) const
+		{
+			const size_t offset = segment*m_segmentSize;
+			const size_t length = STDMIN(m_segmentSize, m_length-offset);
+			const byte *inString = m_in+offset;
+			byte *outString = m_out+offset;
+
+			if (length > m_blockSize)
+				cipher.AdvancedProcessBlocks(PtrAdd(inString,m_blockSize), inString, PtrAdd(outString,m_blockSize), length-m_blockSize, BlockTransformation::BT_ReverseDirection|BlockTransformation::BT_AllowParallel);
+			cipher.ProcessAndXorBlock(inString, m_chain+segment*m_blockSize, outString);
+		}
+
+	private:
+		byte *m_out;
+		const byte *m_in;
+		size_t m_length, m_segmentSize;
+		const byte *m_chain;
+		unsigned int m_blockSize;
+	};
+
+	RunSegments(*m_cipher, count, Segment(outString, inString, length, segmentSize, chain, blockSize), workers);
+	m_register.swap(m_temp);
+}
+
 size_t CBC_CTS_Decryption::ProcessLastBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength)
 {
 	CRYPTOPP_UNUSED(outLength);
@@ -45,6 +45,56 @@ struct CipherModeDocumentation : public SymmetricCipherDocumentation
 {
 };
 
+/// \brief Threads and block cipher copies used to process segments
+/// \details SegmentWorkers keeps its threads and its copies of the keyed block
+///  cipher between calls to CipherModeBase::ProcessSegments(), so a caller that
+///  processes many buffers starts the threads and copies the cipher once. The
+///  threads start on first use and stop when the object is destroyed. Without
+///  C++11 threads the segments are processed on the calling thread.
+/// \details The copies are made from the cipher passed on first use, and they
+///  are made again if a different cipher is passed. Call Reset() after the
+///  cipher is rekeyed. A SegmentWorkers object must not be used by two threads
+///  at the same time.
+/// \sa CipherModeBase::ProcessSegments(), ParallelStreamTransformationFilter
+/// \since Crypto++ 8.5
+class CRYPTOPP_DLL SegmentWorkers : public NotCopyable
+{
+public:
+	/// \brief Construct a SegmentWorkers
+	/// \param threads the number of threads, including the calling thread
+	/// \details If threads is 0 then one thread per processor is used.
+	SegmentWorkers(unsigned int threads = 0);
+	~SegmentWorkers();
+
+	/// \brief Discard the copies of the block cipher
+	/// \details The threads keep running. The next call makes new copies.
+	void Reset();
+
+	/// \brief Operation on one segment
+	class Operation
+	{
+	public:
+		virtual ~Operation() {}
+		virtual void operator()(const BlockCipher &cipher, size_t segment) const =0;
+	};
+
+	/// \brief Calls op for segments 0 through count-1
+	/// \param cipher the keyed block cipher
+	/// \param count the number of segments
+	/// \param op the operation
+	/// \details The calling thread uses cipher and each additional thread uses
+	///  its own copy because some ciphers keep workspace in mutable members. If
+	///  the cipher cannot be copied then the calling thread does all the work.
+	///  An exception thrown by op is rethrown on the calling thread after the
+	///  other threads stop.
+	void Run(const BlockCipher &cipher, size_t count, const Operation &op);
+
+private:
+	struct State;
+	unsigned int m_threads;
+	member_ptr<State> m_state;
+};
+
 /// \brief Block cipher mode of operation information
 class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE CipherModeBase : public SymmetricCipher
 {
@@ -124,6 +174,27 @@ public:
 			this->Resynchronize(iv);
 	}
 
+	/// \brief Encrypt or decrypt a string of bytes in segments
+	/// \param outString the output byte buffer
+	/// \param inString the input byte buffer
+	/// \param length the size of the input and output byte buffers, in bytes
+	/// \param segmentSize the size of each segment, in bytes
+	/// \details ProcessSegments() produces the same output as ProcessData() and
+	///  leaves the object in the same state. ECB, CBC decryption, CTR and XTS
+	/// \param workers an optional SegmentWorkers to run the segments
+	/// \details ProcessSegments() produces the same output as ProcessData() and
+	///  leaves the object in the same state. ECB, CBC decryption, CTR and XTS
+	///  split the string into segments which do not depend on one another, and
+	///  workers processes them. If workers is NULL then a SegmentWorkers is
+	///  created for the call, which starts threads and copies the block cipher
+	///  each time. Other modes call ProcessData().
+	/// \details length follows the same rules as ProcessData(). segmentSize is
+	///  rounded up to a multiple of the block size.
+	/// \sa SegmentWorkers, ParallelStreamTransformationFilter
+	/// \since Crypto++ 8.5
+	virtual void ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers=NULLPTR)
+		{CRYPTOPP_UNUSED(segmentSize); CRYPTOPP_UNUSED(workers); ProcessData(outString, inString, length);}
+
 protected:
 	CipherModeBase() : m_cipher(NULLPTR) {}
 	inline unsigned int BlockSize() const
@@ -139,6 +210,12 @@ protected:
 
 	virtual void ResizeBuffers();
 
+	typedef SegmentWorkers::Operation SegmentOperation;
+
+	// Calls op for segments 0 through count-1 on workers, or on a
+	// SegmentWorkers made for the call if workers is NULL
+	static void RunSegments(const BlockCipher &cipher, size_t count, const SegmentOperation &op, SegmentWorkers *workers);
+
 	BlockCipher *m_cipher;
 	SecByteBlock m_register;
 };
@@ -229,6 +306,7 @@ public:
 	virtual ~CTR_ModePolicy() {}
 	bool CipherIsRandomAccess() const {return true;}
 	IV_Requirement IVRequirement() const {return RANDOM_IV;}
+	void ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers=NULLPTR);
 
 protected:
 	virtual void IncrementCounterBy256();
@@ -278,6 +356,7 @@ public:
 	IV_Requirement IVRequirement() const {return NOT_RESYNCHRONIZABLE;}
 	unsigned int OptimalBlockSize() const {return static_cast<unsigned int>(BlockSize() * m_cipher->OptimalNumberOfParallelBlocks());}
 	void ProcessData(byte *outString, const byte *inString, size_t length);
+	void ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers=NULLPTR);
 };
 
 /// \brief CBC block cipher mode of operation default implementation
@@ -325,6 +404,7 @@ class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE CBC_Decryption : public CBC_ModeBase
 public:
 	virtual ~CBC_Decryption() {}
 	void ProcessData(byte *outString, const byte *inString, size_t length);
+	void ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers=NULLPTR);
 
 protected:
 	virtual void ResizeBuffers();
@@ -8,6 +8,7 @@
 #include "integer.h"
 #include "modarith.h"
 #include "algparam.h"
+#include "argnames.h"
 #include "smartptr.h"
 #include "misc.h"
 #include "stdcpp.h"
@@ -16,6 +17,12 @@
 # include <omp.h>
 #endif
 
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+# include <thread>
+# include <exception>
+# include <system_error>
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 const word s_lastSmallPrime = 32719;
@@ -439,6 +446,150 @@ bool FirstPrime(Integer &p, const Integer &max, const Integer &equiv, const Inte
 	return false;
 }
 
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+
+// Shared state of a threaded GenerateRandomPrimes(). Each worker draws a
+// window start from rng under the lock, then sieves and tests the window
+// the same way Integer::GenerateRandom() does with FirstPrime(). Workers
+// poll m_done between candidates and stop once all primes are found.
+class ParallelPrimeSearch
+{
+public:
+	ParallelPrimeSearch(RandomNumberGenerator &rng, Integer *primes, size_t count, const Integer &min, const Integer &max, const PrimeSelector *pSelector)
+		: m_rng(rng), m_primes(primes), m_count(count), m_found(0), m_min(min), m_max(max), m_pSelector(pSelector), m_done(false) {}
+
+	void Run(unsigned int threadCount);
+
+private:
+	void Worker();
+	bool NextWindow(Integer &first, Integer &last);
+	void Publish(const Integer &p);
+
+	RandomNumberGenerator &m_rng;
+	Integer *m_primes;
+	size_t m_count, m_found;
+	const Integer &m_min, &m_max;
+	const PrimeSelector *m_pSelector;
+	std::mutex m_mutex;
+	std::atomic<bool> m_done;
+	std::exception_ptr m_error;
+};
+
+void ParallelPrimeSearch::Run(unsigned int threadCount)
+{
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount-1);
+	try
+	{
+		for (unsigned int i=1; i<threadCount; ++i)
+			threads.push_back(std::thread(&ParallelPrimeSearch::Worker, this));
+	}
+	catch (const std::system_error&)
+	{
+		// continue with the threads that started
+	}
+
+	Worker();
+	for (size_t i=0; i<threads.size(); ++i)
+		threads[i].join();
+
+	if (m_error)
+		std::rethrow_exception(m_error);
+}
+
+void ParallelPrimeSearch::Worker()
+{
+	try
+	{
+		Integer p, last;
+		while (NextWindow(p, last))
+		{
+			PrimeSieve sieve(p, last, 2);
+			while (!m_done && sieve.NextCandidate(p))
+			{
+				if ((!m_pSelector || m_pSelector->IsAcceptable(p)) && FastProbablePrimeTest(p) && !m_done && IsPrime(p))
+				{
+					Publish(p);
+					break;
+				}
+			}
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_error)
+			m_error = std::current_exception();
+		m_done = true;
+	}
+}
+
+bool ParallelPrimeSearch::NextWindow(Integer &first, Integer &last)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (!m_done)
+	{
+		first.Randomize(m_rng, m_min, m_max);
+		last = STDMIN(first+PrimeSearchInterval(m_max), m_max);
+		if (first.IsEven())
+			++first;
+		if (first <= last)
+			return true;
+	}
+	return false;
+}
+
+void ParallelPrimeSearch::Publish(const Integer &p)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_done || std::find(m_primes, m_primes+m_found, p) != m_primes+m_found)
+		return;
+	m_primes[m_found++] = p;
+	if (m_found == m_count)
+		m_done = true;
+}
+
+#endif
+
+bool GenerateRandomPrimes(RandomNumberGenerator &rng, Integer *primes, size_t count, const NameValuePairs &params, unsigned int threadCount)
+{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_CXX11_ATOMIC)
+	if (threadCount == 0)
+		threadCount = STDMAX(std::thread::hardware_concurrency(), 1U);
+
+	// Threads search plain primes in a large range. Special forms, seeded
+	// generation and small ranges go through Integer::GenerateRandom(),
+	// which detects a range with too few primes.
+	Integer::RandomNumberType rnType = Integer::ANY;
+	Integer min, max, unused;
+	ConstByteArrayParameter seed;
+	if (threadCount > 1 && params.GetValue("RandomNumberType", rnType) && rnType == Integer::PRIME &&
+		params.GetValue("Min", min) && params.GetValue("Max", max) &&
+		!params.GetValue("EquivalentTo", unused) && !params.GetValue("Mod", unused) && !params.GetValue(Name::Seed(), seed) &&
+		min > s_lastSmallPrime && max-min >= Integer(PrimeSearchInterval(max)) << 10)
+	{
+		const PrimeSelector *pSelector = params.GetValueWithDefault(Name::PointerToPrimeSelector(), (const PrimeSelector *)NULLPTR);
+		ParallelPrimeSearch search(rng, primes, count, min, max, pSelector);
+		search.Run(threadCount);
+		return true;
+	}
+#else
+	CRYPTOPP_UNUSED(threadCount);
+#endif
+
+	unsigned int duplicates = 0;
+	for (size_t i=0; i<count; )
+	{
+		if (!primes[i].GenerateRandomNoThrow(rng, params))
+			return false;
+		if (std::find(primes, primes+i, primes[i]) == primes+i)
+			i++;
+		else if (++duplicates == 16)
+			return false;
+	}
+	return true;
+}
+
 // the following two functions are based on code and comments provided by Preda Mihailescu
 static bool ProvePrime(const Integer &p, const Integer &q)
 {
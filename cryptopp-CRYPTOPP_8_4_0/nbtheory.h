@@ -132,6 +132,25 @@ CRYPTOPP_DLL bool CRYPTOPP_API FirstPrime(Integer &p, const Integer &max, const
 
 CRYPTOPP_DLL unsigned int CRYPTOPP_API PrimeSearchInterval(const Integer &max);
 
+/// \brief Generates distinct random primes, optionally on worker threads
+/// \param rng a RandomNumberGenerator
+/// \param primes an array of count Integers to receive the primes
+/// \param count the number of primes
+/// \param params the parameters for Integer::GenerateRandom()
+/// \param threadCount the number of threads, or 0 for one per processor
+/// \return true if count distinct primes were found, false otherwise
+/// \details GenerateRandomPrimes() generates primes like Integer::GenerateRandom() with
+///   RandomNumberType PRIME. With more than one thread, each thread sieves and tests its own
+///   random window of <tt>[Min, Max]</tt>, and all threads stop once the last prime is found.
+///   The primes are returned in the order they were found, so the result depends on thread
+///   timing as well as rng.
+/// \details rng is used by one thread at a time, but the PrimeSelector may be called from
+///   several threads at once. Threads require C++11 synchronization in the library. Without it,
+///   or when threadCount is 1, the range is small, or params has EquivalentTo, Mod or Seed, the
+///   primes are generated one after another by Integer::GenerateRandom().
+/// \since Crypto++ 8.5
+CRYPTOPP_DLL bool CRYPTOPP_API GenerateRandomPrimes(RandomNumberGenerator &rng, Integer *primes, size_t count, const NameValuePairs &params, unsigned int threadCount = 0);
+
 CRYPTOPP_DLL AlgorithmParameters CRYPTOPP_API MakeParametersForTwoPrimesOfEqualSize(unsigned int productBitLength);
 
 // ********** other number theoretic functions ************
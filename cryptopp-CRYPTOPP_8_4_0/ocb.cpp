@@ -0,0 +1,260 @@
+// ocb.cpp - written and placed in the public domain by the Crypto++ project
+
+#include "pch.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "ocb.h"
+#include "argnames.h"
+#include "misc.h"
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word64;
+
+// double() of RFC 7253, multiplication by x in GF(2^128)
+inline void Double(byte *out, const byte *in)
+{
+	const byte carry = byte(in[0] >> 7);
+	for (unsigned int i=0; i<15; ++i)
+		out[i] = byte((in[i] << 1) | (in[i+1] >> 7));
+	out[15] = byte((in[15] << 1) ^ (carry * 0x87));
+}
+
+// Xors each block of data into sum. Used for the checksum of the message
+// and the sum of the header blocks.
+inline void AccumulateBlocks(byte *sum, const byte *data, size_t length)
+{
+	word64 s[2], t[2];
+	memcpy(s, sum, 16);
+	for (size_t i=0; i<length; i+=16)
+	{
+		memcpy(t, data+i, 16);
+		s[0] ^= t[0]; s[1] ^= t[1];
+	}
+	memcpy(sum, s, 16);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+void OCB_Base::SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params)
+{
+	BlockCipher &blockCipher = AccessBlockCipher();
+	blockCipher.SetKey(userKey, keylength, params);
+
+	if (blockCipher.BlockSize() != REQUIRED_BLOCKSIZE)
+		throw InvalidArgument(AlgorithmName() + ": block size of underlying block cipher is not 16");
+
+	if (!IsForwardTransformation())
+		AccessInverseCipher().SetKey(userKey, keylength, params);
+
+	m_digestSize = params.GetIntValueWithDefault(Name::DigestSize(), DefaultDigestSize());
+	if (m_digestSize < 1 || m_digestSize > 16)
+		throw InvalidArgument(AlgorithmName() + ": DigestSize must be between 1 and 16");
+
+	m_buffer.New((8+BATCH_BLOCKS+2+TABLE_ENTRIES)*REQUIRED_BLOCKSIZE);
+
+	// L_* = E(0), L_$ = double(L_*), L(0) = double(L_$), L(i) = double(L(i-1))
+	byte *table = m_buffer+(8+BATCH_BLOCKS)*REQUIRED_BLOCKSIZE;
+	memset(table, 0, REQUIRED_BLOCKSIZE);
+	blockCipher.ProcessBlock(table);
+	for (unsigned int i=1; i<2+TABLE_ENTRIES; ++i)
+		Double(table+i*REQUIRED_BLOCKSIZE, table+(i-1)*REQUIRED_BLOCKSIZE);
+
+	m_nonceCached = false;
+}
+
+void OCB_Base::Resync(const byte *iv, size_t len)
+{
+	CRYPTOPP_ASSERT(len >= 1 && len <= 15);
+
+	byte nonce[REQUIRED_BLOCKSIZE];
+	memset(nonce, 0, REQUIRED_BLOCKSIZE);
+	nonce[0] = byte(((m_digestSize*8) % 128) << 1);
+	nonce[REQUIRED_BLOCKSIZE-1-len] |= 1;
+	memcpy(nonce+REQUIRED_BLOCKSIZE-len, iv, len);
+
+	const unsigned int bottom = nonce[REQUIRED_BLOCKSIZE-1] & 0x3f;
+	nonce[REQUIRED_BLOCKSIZE-1] &= 0xc0;
+
+	// Stretch = Ktop || (Ktop[1..64] xor Ktop[9..72]). Counter nonces share
+	// Ktop for 64 messages, so the last one is kept.
+	byte *stretch = Stretch();
+	if (!m_nonceCached || memcmp(nonce, NonceTop(), REQUIRED_BLOCKSIZE) != 0)
+	{
+		memcpy(NonceTop(), nonce, REQUIRED_BLOCKSIZE);
+		GetBlockCipher().ProcessBlock(nonce, stretch);
+		xorbuf(stretch+REQUIRED_BLOCKSIZE, stretch, stretch+1, 8);
+		m_nonceCached = true;
+	}
+
+	// Offset_0 = Stretch[1+bottom..128+bottom]
+	byte *offset = Offset();
+	const unsigned int shift = bottom / 8, bits = bottom % 8;
+	if (bits)
+	{
+		for (unsigned int i=0; i<REQUIRED_BLOCKSIZE; ++i)
+			offset[i] = byte((stretch[i+shift] << bits) | (stretch[i+shift+1] >> (8-bits)));
+	}
+	else
+	{
+		memcpy(offset, stretch+shift, REQUIRED_BLOCKSIZE);
+	}
+
+	memset(Checksum(), 0, REQUIRED_BLOCKSIZE);
+	memset(HeaderOffset(), 0, REQUIRED_BLOCKSIZE);
+	memset(HeaderSum(), 0, REQUIRED_BLOCKSIZE);
+	m_blockIndex = m_headerIndex = 0;
+	m_lastBlock = false;
+}
+
+void OCB_Base::ComputeOffsets(byte *offsets, byte *offset, lword &index, size_t blocks) const
+{
+	CRYPTOPP_ASSERT(blocks > 0);
+
+	word64 o[2], t[2];
+	memcpy(o, offset, REQUIRED_BLOCKSIZE);
+	for (size_t i=0; i<blocks; ++i)
+	{
+		memcpy(t, L(TrailingZeros(++index)), REQUIRED_BLOCKSIZE);
+		o[0] ^= t[0]; o[1] ^= t[1];
+		memcpy(offsets+i*REQUIRED_BLOCKSIZE, o, REQUIRED_BLOCKSIZE);
+	}
+	memcpy(offset, o, REQUIRED_BLOCKSIZE);
+}
+
+size_t OCB_Base::AuthenticateBlocks(const byte *data, size_t len)
+{
+	const BlockCipher &cipher = GetBlockCipher();
+	byte *offsets = Workspace(), *sum = HeaderSum();
+
+	// Sum = Sum xor E(A_i xor Offset_i)
+	while (len >= REQUIRED_BLOCKSIZE)
+	{
+		const size_t blocks = STDMIN(len/REQUIRED_BLOCKSIZE, size_t(BATCH_BLOCKS));
+		const size_t length = blocks*REQUIRED_BLOCKSIZE;
+
+		ComputeOffsets(offsets, HeaderOffset(), m_headerIndex, blocks);
+		cipher.AdvancedProcessBlocks(data, offsets, offsets, length,
+			BlockTransformation::BT_XorInput|BlockTransformation::BT_AllowParallel);
+		AccumulateBlocks(sum, offsets, length);
+
+		data += length;
+		len -= length;
+	}
+
+	return len;
+}
+
+void OCB_Base::AuthenticateLastHeaderBlock()
+{
+	if (m_bufferedDataLength > 0)
+	{
+		byte *offset = HeaderOffset(), *block = m_buffer;
+		xorbuf(offset, L_Star(), REQUIRED_BLOCKSIZE);
+
+		block[m_bufferedDataLength] = 0x80;
+		memset(block+m_bufferedDataLength+1, 0, REQUIRED_BLOCKSIZE-m_bufferedDataLength-1);
+		xorbuf(block, offset, REQUIRED_BLOCKSIZE);
+		GetBlockCipher().ProcessBlock(block);
+		xorbuf(HeaderSum(), block, REQUIRED_BLOCKSIZE);
+		m_bufferedDataLength = 0;
+	}
+}
+
+size_t OCB_Base::ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len)
+{
+	if (len == 0)
+		return 0;
+
+	if (m_lastBlock)
+		throw BadState(AlgorithmName(), "ProcessData was called after a partial block");
+
+	const bool encrypt = IsForwardTransformation();
+	const BlockCipher &cipher = encrypt ? GetBlockCipher() : AccessInverseCipher();
+	byte *offsets = Workspace(), *checksum = Checksum();
+
+	const size_t tail = len % REQUIRED_BLOCKSIZE;
+	len -= tail;
+
+	// C_i = Offset_i xor E(P_i xor Offset_i), one batch of offsets at a time
+	while (len)
+	{
+		const size_t blocks = STDMIN(len/REQUIRED_BLOCKSIZE, size_t(BATCH_BLOCKS));
+		const size_t length = blocks*REQUIRED_BLOCKSIZE;
+
+		ComputeOffsets(offsets, Offset(), m_blockIndex, blocks);
+
+		if (encrypt)
+			AccumulateBlocks(checksum, inString, length);
+
+		xorbuf(outString, inString, offsets, length);
+		cipher.AdvancedProcessBlocks(outString, offsets, outString, length, BlockTransformation::BT_AllowParallel);
+
+		if (!encrypt)
+			AccumulateBlocks(checksum, outString, length);
+
+		inString += length;
+		outString += length;
+		len -= length;
+	}
+
+	if (tail)
+		ProcessFinalBlock(outString, inString, tail);
+
+	return 0;
+}
+
+void OCB_Base::ProcessFinalBlock(byte *outString, const byte *inString, size_t len)
+{
+	CRYPTOPP_ASSERT(len > 0 && len < REQUIRED_BLOCKSIZE);
+
+	// Offset_* = Offset_m xor L_*, Pad = E(Offset_*), C_* = P_* xor Pad
+	byte *offset = Offset(), *pad = Workspace(), *checksum = Checksum();
+	xorbuf(offset, L_Star(), REQUIRED_BLOCKSIZE);
+	GetBlockCipher().ProcessBlock(offset, pad);
+
+	if (IsForwardTransformation())
+		xorbuf(checksum, inString, len);
+	xorbuf(outString, inString, pad, len);
+	if (!IsForwardTransformation())
+		xorbuf(checksum, outString, len);
+	checksum[len] ^= 0x80;
+
+	m_lastBlock = true;
+}
+
+size_t OCB_Base::ProcessLastBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength)
+{
+	CRYPTOPP_UNUSED(outLength);
+	CRYPTOPP_ASSERT(outLength >= inLength);
+
+	if (inLength)
+		ProcessData(outString, inString, inLength);
+	return inLength;
+}
+
+void OCB_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
+{
+	// Tag = E(Checksum xor Offset xor L_$) xor HASH(K,A)
+	byte *checksum = Checksum();
+	xorbuf(checksum, Offset(), REQUIRED_BLOCKSIZE);
+	xorbuf(checksum, L_Dollar(), REQUIRED_BLOCKSIZE);
+	GetBlockCipher().ProcessBlock(checksum);
+	xorbuf(mac, checksum, HeaderSum(), macSize);
+}
+
+SymmetricCipher & OCB_Base::AccessSymmetricCipher()
+{
+	// ProcessAndAuthenticateBlocks() consumes all of the message, so the
+	// separate cipher pass of AuthenticatedSymmetricCipherBase is not used.
+	CRYPTOPP_ASSERT(false);
+	throw NotImplemented(AlgorithmName() + ": OCB has no separate cipher pass");
+}
+
+NAMESPACE_END
+
+#endif
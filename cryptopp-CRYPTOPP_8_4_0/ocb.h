@@ -0,0 +1,167 @@
+// ocb.h - written and placed in the public domain by the Crypto++ project
+
+/// \file ocb.h
+/// \brief OCB block cipher mode of operation
+/// \details OCB is specified in RFC 7253. This is the third revision of the
+///   mode, sometimes called OCB3. It encrypts and authenticates the message in
+///   one pass over the data, and requires one block cipher call per block.
+/// \sa <A HREF="https://tools.ietf.org/html/rfc7253">RFC 7253, The OCB
+///   Authenticated-Encryption Algorithm</A>
+/// \since Crypto++ 8.5
+
+#ifndef CRYPTOPP_OCB_H
+#define CRYPTOPP_OCB_H
+
+#include "authenc.h"
+#include "seckey.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/// \brief OCB block cipher base implementation
+/// \details Base implementation of the AuthenticatedSymmetricCipher interface
+/// \details The message is encrypted or decrypted in batches of blocks. The
+///   offsets of a batch are computed up front, and the whitened blocks go to the
+///   block cipher in one call to AdvancedProcessBlocks(), so ciphers that process
+///   several blocks in parallel, like AES with AES-NI, do so for OCB too.
+/// \details OCB cannot stream a partial block. ProcessData() must be called with
+///   multiples of the block size, except for the last call of a message, which
+///   may end with a partial block. ProcessLastBlock() and
+///   AuthenticatedEncryptionFilter take care of this.
+/// \since Crypto++ 8.5
+class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE OCB_Base : public AuthenticatedSymmetricCipherBase
+{
+public:
+	OCB_Base()
+		: m_digestSize(0), m_blockIndex(0), m_headerIndex(0), m_lastBlock(false), m_nonceCached(false) {}
+
+	// AuthenticatedSymmetricCipher
+	std::string AlgorithmName() const
+		{return GetBlockCipher().AlgorithmName() + std::string("/OCB");}
+	std::string AlgorithmProvider() const
+		{return GetBlockCipher().AlgorithmProvider();}
+	size_t MinKeyLength() const
+		{return GetBlockCipher().MinKeyLength();}
+	size_t MaxKeyLength() const
+		{return GetBlockCipher().MaxKeyLength();}
+	size_t DefaultKeyLength() const
+		{return GetBlockCipher().DefaultKeyLength();}
+	size_t GetValidKeyLength(size_t keylength) const
+		{return GetBlockCipher().GetValidKeyLength(keylength);}
+	bool IsValidKeyLength(size_t keylength) const
+		{return GetBlockCipher().IsValidKeyLength(keylength);}
+	unsigned int OptimalDataAlignment() const
+		{return GetBlockCipher().OptimalDataAlignment();}
+	IV_Requirement IVRequirement() const
+		{return UNIQUE_IV;}
+	unsigned int IVSize() const
+		{return 12;}
+	unsigned int MinIVLength() const
+		{return 1;}
+	unsigned int MaxIVLength() const
+		{return 15;}
+	unsigned int DigestSize() const
+		{return m_digestSize;}
+	lword MaxHeaderLength() const
+		{return LWORD_MAX;}
+	lword MaxMessageLength() const
+		{return LWORD_MAX;}
+
+	// StreamTransformation
+	unsigned int MandatoryBlockSize() const
+		{return REQUIRED_BLOCKSIZE;}
+	unsigned int OptimalBlockSize() const
+		{return REQUIRED_BLOCKSIZE * GetBlockCipher().OptimalNumberOfParallelBlocks();}
+	bool IsLastBlockSpecial() const
+		{return true;}
+	size_t ProcessLastBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength);
+
+protected:
+	// AuthenticatedSymmetricCipherBase
+	bool AuthenticationIsOnPlaintext() const
+		{return true;}
+	unsigned int AuthenticationBlockSize() const
+		{return REQUIRED_BLOCKSIZE;}
+	void SetKeyWithoutResync(const byte *userKey, size_t keylength, const NameValuePairs &params);
+	void Resync(const byte *iv, size_t len);
+	size_t AuthenticateBlocks(const byte *data, size_t len);
+	void AuthenticateLastHeaderBlock();
+	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
+	size_t ProcessAndAuthenticateBlocks(byte *outString, const byte *inString, size_t len);
+	SymmetricCipher & AccessSymmetricCipher();
+
+	virtual BlockCipher & AccessBlockCipher() =0;
+	virtual BlockCipher & AccessInverseCipher() =0;
+	virtual int DefaultDigestSize() const =0;
+
+	const BlockCipher & GetBlockCipher() const {return const_cast<OCB_Base *>(this)->AccessBlockCipher();}
+
+	// Offsets of batch blocks from L(0), using the ntz(i) rule of RFC 7253
+	void ComputeOffsets(byte *offsets, byte *offset, lword &index, size_t blocks) const;
+	void ProcessFinalBlock(byte *outString, const byte *inString, size_t len);
+
+	byte *Offset() {return m_buffer+REQUIRED_BLOCKSIZE;}
+	byte *Checksum() {return m_buffer+2*REQUIRED_BLOCKSIZE;}
+	byte *HeaderOffset() {return m_buffer+3*REQUIRED_BLOCKSIZE;}
+	byte *HeaderSum() {return m_buffer+4*REQUIRED_BLOCKSIZE;}
+	byte *NonceTop() {return m_buffer+5*REQUIRED_BLOCKSIZE;}
+	byte *Stretch() {return m_buffer+6*REQUIRED_BLOCKSIZE;}
+	byte *Workspace() {return m_buffer+8*REQUIRED_BLOCKSIZE;}
+	// L_*, L_$, then L(0) to L(63)
+	const byte *L_Star() const {return m_buffer+(8+BATCH_BLOCKS)*REQUIRED_BLOCKSIZE;}
+	const byte *L_Dollar() const {return L_Star()+REQUIRED_BLOCKSIZE;}
+	const byte *L(unsigned int i) const {return L_Star()+(2+i)*REQUIRED_BLOCKSIZE;}
+
+	enum {REQUIRED_BLOCKSIZE = 16, BATCH_BLOCKS = 128, TABLE_ENTRIES = 64};
+
+	int m_digestSize;
+	lword m_blockIndex, m_headerIndex;
+	bool m_lastBlock, m_nonceCached;
+};
+
+/// \brief OCB block cipher final implementation
+/// \tparam T_BlockCipher block cipher
+/// \tparam T_DefaultDigestSize default digest size, in bytes
+/// \tparam T_IsEncryption direction in which to operate the cipher
+/// \details OCB decryption runs the inverse block cipher, so the decryption
+///   object keys both directions of the cipher.
+/// \since Crypto++ 8.5
+template <class T_BlockCipher, int T_DefaultDigestSize, bool T_IsEncryption>
+class OCB_Final : public OCB_Base
+{
+public:
+	static std::string StaticAlgorithmName()
+		{return T_BlockCipher::StaticAlgorithmName() + std::string("/OCB");}
+	bool IsForwardTransformation() const
+		{return T_IsEncryption;}
+
+private:
+	BlockCipher & AccessBlockCipher() {return m_cipher;}
+	BlockCipher & AccessInverseCipher() {return m_inverse;}
+	int DefaultDigestSize() const {return T_DefaultDigestSize;}
+	typename T_BlockCipher::Encryption m_cipher;
+	typename T_BlockCipher::Decryption m_inverse;
+};
+
+/// \brief OCB block cipher mode of operation
+/// \tparam T_BlockCipher block cipher
+/// \tparam T_DefaultDigestSize default digest size, in bytes
+/// \details \p OCB provides the \p Encryption and \p Decryption typedef. See OCB_Base
+///   and OCB_Final for the AuthenticatedSymmetricCipher implementation.
+/// \details The digest size is part of the nonce, so a tag truncated after the
+///   fact does not match a tag produced with a shorter digest size. Use
+///   T_DefaultDigestSize or the Name::DigestSize() parameter to select a
+///   shorter tag.
+/// \sa <A HREF="https://tools.ietf.org/html/rfc7253">RFC 7253</A> and
+///   <A HREF="http://www.cryptopp.com/wiki/Modes_of_Operation">Modes of Operation</A>
+///   on the Crypto++ wiki.
+/// \since Crypto++ 8.5
+template <class T_BlockCipher, int T_DefaultDigestSize = 16>
+struct OCB : public AuthenticatedSymmetricCipherDocumentation
+{
+	typedef OCB_Final<T_BlockCipher, T_DefaultDigestSize, true> Encryption;
+	typedef OCB_Final<T_BlockCipher, T_DefaultDigestSize, false> Decryption;
+};
+
+NAMESPACE_END
+
+#endif
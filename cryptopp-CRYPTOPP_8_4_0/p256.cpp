@@ -0,0 +1,626 @@
+// p256.cpp - written and placed in the public domain by
+//            the Crypto++ project.
+
+// Field elements are four 64-bit limbs in Montgomery form with R = 2^256.
+// Because p = -1 mod 2^64 the Montgomery reduction multiplier is the low
+// limb itself. Points use homogeneous projective coordinates (X:Y:Z) and
+// the complete formulas for a = -3 from Renes, Costello and Batina,
+// "Complete addition formulas for prime order elliptic curves",
+// https://eprint.iacr.org/2015/1060. The identity is (0:1:0) and needs
+// no special handling.
+
+#include "pch.h"
+
+#include "config.h"
+#include "p256.h"
+#include "misc.h"
+
+#if (CRYPTOPP_P256_64BIT)
+
+#include "p256_64.h"
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word64;
+using CryptoPP::word128;
+
+using CryptoPP::GetWord;
+using CryptoPP::PutWord;
+using CryptoPP::BIG_ENDIAN_ORDER;
+
+using namespace CryptoPP::P256::Arch64;
+
+struct point { fe x, y, z; };
+
+// (c, t) = t + a*b + c
+#define MAC(c, t, a, b) { \
+    const word128 uv = (word128)(a) * (b) + (t) + (c); \
+    t = (word64)uv; c = (word64)(uv >> 64); }
+
+// (c, t) = t + c
+#define ADC(c, t) { \
+    const word128 uv = (word128)(t) + (c); \
+    t = (word64)uv; c = (word64)(uv >> 64); }
+
+// (c, t) = t + a + c
+#define ADDC(c, t, a) { \
+    const word128 uv = (word128)(t) + (a) + (c); \
+    t = (word64)uv; c = (word64)(uv >> 64); }
+
+// (b, t) = t - a - b
+#define SBB(b, t, a) { \
+    const word128 uv = (word128)(t) - (a) - (b); \
+    t = (word64)uv; b = (word64)(uv >> 64) & 1; }
+
+// r = t - p if t >= p, where t = (t4:t3:t2:t1:t0) < 2p
+inline void fe_reduce_once(fe r, word64 t0, word64 t1, word64 t2, word64 t3, word64 t4)
+{
+    word64 s0 = t0, s1 = t1, s2 = t2, s3 = t3, s4 = t4, b = 0;
+    SBB(b, s0, p256_p[0]); SBB(b, s1, p256_p[1]);
+    SBB(b, s2, p256_p[2]); SBB(b, s3, p256_p[3]);
+    SBB(b, s4, 0);
+
+    // borrow means t < p, keep t
+    const word64 mask = (word64)0 - b;
+    r[0] = (t0 & mask) | (s0 & ~mask);
+    r[1] = (t1 & mask) | (s1 & ~mask);
+    r[2] = (t2 & mask) | (s2 & ~mask);
+    r[3] = (t3 & mask) | (s3 & ~mask);
+}
+
+inline void fe_copy(fe r, const fe a)
+{
+    r[0] = a[0]; r[1] = a[1]; r[2] = a[2]; r[3] = a[3];
+}
+
+inline void fe_add(fe r, const fe a, const fe b)
+{
+    word64 t0 = a[0], t1 = a[1], t2 = a[2], t3 = a[3], t4 = 0, c = 0;
+    ADDC(c, t0, b[0]); ADDC(c, t1, b[1]);
+    ADDC(c, t2, b[2]); ADDC(c, t3, b[3]);
+    t4 = c;
+    fe_reduce_once(r, t0, t1, t2, t3, t4);
+}
+
+inline void fe_sub(fe r, const fe a, const fe b)
+{
+    word64 t0 = a[0], t1 = a[1], t2 = a[2], t3 = a[3], w = 0;
+    SBB(w, t0, b[0]); SBB(w, t1, b[1]);
+    SBB(w, t2, b[2]); SBB(w, t3, b[3]);
+
+    // add p back on borrow
+    const word64 mask = (word64)0 - w;
+    word64 c = 0;
+    ADDC(c, t0, p256_p[0] & mask); ADDC(c, t1, p256_p[1] & mask);
+    ADDC(c, t2, p256_p[2] & mask); ADDC(c, t3, p256_p[3] & mask);
+    r[0] = t0; r[1] = t1; r[2] = t2; r[3] = t3;
+}
+
+// One CIOS round: t = (t + a*bi + m*p) / 2^64 with m = low limb
+#define P256_ROUND(bi) { \
+    word64 c = 0, m, t5; \
+    MAC(c, t0, a[0], bi); MAC(c, t1, a[1], bi); \
+    MAC(c, t2, a[2], bi); MAC(c, t3, a[3], bi); \
+    ADC(c, t4); t5 = c; \
+    m = t0; c = 0; \
+    MAC(c, t0, m, p256_p[0]); MAC(c, t1, m, p256_p[1]); \
+    ADC(c, t2); MAC(c, t3, m, p256_p[3]); \
+    ADC(c, t4); t5 += c; \
+    t0 = t1; t1 = t2; t2 = t3; t3 = t4; t4 = t5; }
+
+// r = a*b/2^256 mod p
+inline void fe_mul(fe r, const fe a, const fe b)
+{
+    word64 t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+    const word64 b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3];
+
+    P256_ROUND(b0);
+    P256_ROUND(b1);
+    P256_ROUND(b2);
+    P256_ROUND(b3);
+
+    fe_reduce_once(r, t0, t1, t2, t3, t4);
+}
+
+#undef P256_ROUND
+
+inline void fe_sqr(fe r, const fe a)
+{
+    fe_mul(r, a, a);
+}
+
+CRYPTOPP_NOINLINE void fe_sqr_times(fe r, const fe a, unsigned int count)
+{
+    fe_sqr(r, a);
+    while (--count)
+        fe_sqr(r, r);
+}
+
+// r = a^(p-2), p-2 = 2^256 - 2^224 + 2^192 + 2^96 - 3
+void fe_invert(fe r, const fe a)
+{
+    fe x2, x3, x6, x12, x15, x30, x32, t;
+
+    fe_sqr(t, a); fe_mul(x2, t, a);                // 2^2 - 1
+    fe_sqr(t, x2); fe_mul(x3, t, a);               // 2^3 - 1
+    fe_sqr_times(t, x3, 3); fe_mul(x6, t, x3);     // 2^6 - 1
+    fe_sqr_times(t, x6, 6); fe_mul(x12, t, x6);    // 2^12 - 1
+    fe_sqr_times(t, x12, 3); fe_mul(x15, t, x3);   // 2^15 - 1
+    fe_sqr_times(t, x15, 15); fe_mul(x30, t, x15); // 2^30 - 1
+    fe_sqr_times(t, x30, 2); fe_mul(x32, t, x2);   // 2^32 - 1
+
+    fe_sqr_times(t, x32, 32); fe_mul(t, t, a);     // ffffffff00000001
+    fe_sqr_times(t, t, 128); fe_mul(t, t, x32);
+    fe_sqr_times(t, t, 32); fe_mul(t, t, x32);
+    fe_sqr_times(t, t, 30); fe_mul(t, t, x30);
+    fe_sqr_times(t, t, 2); fe_mul(r, t, a);
+}
+
+inline word64 fe_is_zero(const fe a)
+{
+    return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+inline word64 fe_equal(const fe a, const fe b)
+{
+    return ((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) == 0;
+}
+
+// Decode a big-endian integer, fails if it is not less than m
+int fe_decode(fe r, const byte in[32], const fe m)
+{
+    r[3] = GetWord<word64>(false, BIG_ENDIAN_ORDER, in+0);
+    r[2] = GetWord<word64>(false, BIG_ENDIAN_ORDER, in+8);
+    r[1] = GetWord<word64>(false, BIG_ENDIAN_ORDER, in+16);
+    r[0] = GetWord<word64>(false, BIG_ENDIAN_ORDER, in+24);
+
+    word64 t0 = r[0], t1 = r[1], t2 = r[2], t3 = r[3], b = 0;
+    SBB(b, t0, m[0]); SBB(b, t1, m[1]);
+    SBB(b, t2, m[2]); SBB(b, t3, m[3]);
+    return b ? 0 : -1;
+}
+
+void fe_encode(byte out[32], const fe a)
+{
+    PutWord<word64>(false, BIG_ENDIAN_ORDER, out+0, a[3]);
+    PutWord<word64>(false, BIG_ENDIAN_ORDER, out+8, a[2]);
+    PutWord<word64>(false, BIG_ENDIAN_ORDER, out+16, a[1]);
+    PutWord<word64>(false, BIG_ENDIAN_ORDER, out+24, a[0]);
+}
+
+inline void fe_to_mont(fe r, const fe a)
+{
+    fe_mul(r, a, p256_rr);
+}
+
+inline void fe_from_mont(fe r, const fe a)
+{
+    const fe one = {1, 0, 0, 0};
+    fe_mul(r, a, one);
+}
+
+// Mask of all 1's if a == b, 0 otherwise
+inline word64 ct_eq(word64 a, word64 b)
+{
+    const word64 x = a ^ b;
+    return ((x | ((word64)0 - x)) >> 63) - 1;
+}
+
+inline void fe_select(fe r, const fe a, word64 mask)
+{
+    r[0] = (r[0] & ~mask) | (a[0] & mask);
+    r[1] = (r[1] & ~mask) | (a[1] & mask);
+    r[2] = (r[2] & ~mask) | (a[2] & mask);
+    r[3] = (r[3] & ~mask) | (a[3] & mask);
+}
+
+// ******************** group ************************* //
+
+inline void point_set_identity(point &r)
+{
+    const fe zero = {0, 0, 0, 0};
+    fe_copy(r.x, zero); fe_copy(r.y, p256_one); fe_copy(r.z, zero);
+}
+
+// Algorithm 4, complete addition for a = -3
+void point_add(point &r, const point &p, const point &q)
+{
+    fe t0, t1, t2, t3, t4, x3, y3, z3;
+
+    fe_mul(t0, p.x, q.x);
+    fe_mul(t1, p.y, q.y);
+    fe_mul(t2, p.z, q.z);
+    fe_add(t3, p.x, p.y);
+    fe_add(t4, q.x, q.y);
+    fe_mul(t3, t3, t4);
+    fe_add(t4, t0, t1);
+    fe_sub(t3, t3, t4);
+    fe_add(t4, p.y, p.z);
+    fe_add(x3, q.y, q.z);
+    fe_mul(t4, t4, x3);
+    fe_add(x3, t1, t2);
+    fe_sub(t4, t4, x3);
+    fe_add(x3, p.x, p.z);
+    fe_add(y3, q.x, q.z);
+    fe_mul(x3, x3, y3);
+    fe_add(y3, t0, t2);
+    fe_sub(y3, x3, y3);
+    fe_mul(z3, p256_b, t2);
+    fe_sub(x3, y3, z3);
+    fe_add(z3, x3, x3);
+    fe_add(x3, x3, z3);
+    fe_sub(z3, t1, x3);
+    fe_add(x3, t1, x3);
+    fe_mul(y3, p256_b, y3);
+    fe_add(t1, t2, t2);
+    fe_add(t2, t1, t2);
+    fe_sub(y3, y3, t2);
+    fe_sub(y3, y3, t0);
+    fe_add(t1, y3, y3);
+    fe_add(y3, t1, y3);
+    fe_add(t1, t0, t0);
+    fe_add(t0, t1, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t1, t4, y3);
+    fe_mul(t2, t0, y3);
+    fe_mul(y3, x3, z3);
+    fe_add(y3, y3, t2);
+    fe_mul(x3, t3, x3);
+    fe_sub(x3, x3, t1);
+    fe_mul(z3, t4, z3);
+    fe_mul(t1, t3, t0);
+    fe_add(z3, z3, t1);
+
+    fe_copy(r.x, x3); fe_copy(r.y, y3); fe_copy(r.z, z3);
+}
+
+// Algorithm 6, complete doubling for a = -3
+void point_double(point &r, const point &p)
+{
+    fe t0, t1, t2, t3, x3, y3, z3;
+
+    fe_sqr(t0, p.x);
+    fe_sqr(t1, p.y);
+    fe_sqr(t2, p.z);
+    fe_mul(t3, p.x, p.y);
+    fe_add(t3, t3, t3);
+    fe_mul(z3, p.x, p.z);
+    fe_add(z3, z3, z3);
+    fe_mul(y3, p256_b, t2);
+    fe_sub(y3, y3, z3);
+    fe_add(x3, y3, y3);
+    fe_add(y3, x3, y3);
+    fe_sub(x3, t1, y3);
+    fe_add(y3, t1, y3);
+    fe_mul(y3, x3, y3);
+    fe_mul(x3, x3, t3);
+    fe_add(t3, t2, t2);
+    fe_add(t2, t2, t3);
+    fe_mul(z3, p256_b, z3);
+    fe_sub(z3, z3, t2);
+    fe_sub(z3, z3, t0);
+    fe_add(t3, z3, z3);
+    fe_add(z3, z3, t3);
+    fe_add(t3, t0, t0);
+    fe_add(t0, t3, t0);
+    fe_sub(t0, t0, t2);
+    fe_mul(t0, t0, z3);
+    fe_add(y3, y3, t0);
+    fe_mul(t0, p.y, p.z);
+    fe_add(t0, t0, t0);
+    fe_mul(z3, t0, z3);
+    fe_sub(x3, x3, z3);
+    fe_mul(z3, t0, t1);
+    fe_add(z3, z3, z3);
+    fe_add(z3, z3, z3);
+
+    fe_copy(r.x, x3); fe_copy(r.y, y3); fe_copy(r.z, z3);
+}
+
+// Decode an affine point and check y^2 = x^3 - 3x + b
+int point_decode(point &r, const byte x[32], const byte y[32])
+{
+    fe lhs, rhs, t;
+
+    if (fe_decode(r.x, x, p256_p) != 0 || fe_decode(r.y, y, p256_p) != 0)
+        return -1;
+
+    fe_to_mont(r.x, r.x);
+    fe_to_mont(r.y, r.y);
+    fe_copy(r.z, p256_one);
+
+    fe_sqr(lhs, r.y);
+    fe_sqr(rhs, r.x);
+    fe_mul(rhs, rhs, r.x);
+    fe_add(t, r.x, r.x);
+    fe_add(t, t, r.x);
+    fe_sub(rhs, rhs, t);
+    fe_add(rhs, rhs, p256_b);
+
+    return fe_equal(lhs, rhs) ? 0 : -1;
+}
+
+// Convert to affine and encode, fails for the point at infinity
+int point_encode(byte x[32], byte y[32], const point &p)
+{
+    fe zi, t;
+
+    if (fe_is_zero(p.z))
+        return -1;
+
+    fe_invert(zi, p.z);
+    fe_mul(t, p.x, zi);
+    fe_from_mont(t, t);
+    fe_encode(x, t);
+    fe_mul(t, p.y, zi);
+    fe_from_mont(t, t);
+    fe_encode(y, t);
+    return 0;
+}
+
+// Recode a 256-bit scalar into 65 signed digits in [-8,8)
+void scalar_recode(signed char d[65], const fe k)
+{
+    word64 carry = 0;
+    for (unsigned int i = 0; i < 64; i++)
+    {
+        const word64 w = ((k[i/16] >> (4*(i%16))) & 15) + carry;
+        carry = (w + 8) >> 4;
+        d[i] = (signed char)((int)w - (int)(carry << 4));
+    }
+    d[64] = (signed char)carry;
+}
+
+// Split a digit into its absolute value and a mask of its sign
+inline void digit_split(int d, word64 &abs, word64 &neg)
+{
+    neg = (word64)0 - (word64)((unsigned int)d >> 31);
+    abs = (word64)(((unsigned int)d ^ (unsigned int)neg) - (unsigned int)neg) & 15;
+}
+
+inline void point_cneg(point &r, word64 neg)
+{
+    const fe zero = {0, 0, 0, 0};
+    fe t;
+    fe_sub(t, zero, r.y);
+    fe_select(r.y, t, neg);
+}
+
+// r = d*16^i*G for row i of the table, in constant time
+void select_base(point &r, unsigned int row, int d)
+{
+    word64 abs, neg;
+    digit_split(d, abs, neg);
+
+    point_set_identity(r);
+    for (unsigned int j = 0; j < 8; j++)
+    {
+        const word64 mask = ct_eq(abs, j+1);
+        fe_select(r.x, p256_base_table[row][j][0], mask);
+        fe_select(r.y, p256_base_table[row][j][1], mask);
+        fe_select(r.z, p256_one, mask);
+    }
+    point_cneg(r, neg);
+}
+
+// r = d*P from the table of P..8P, in constant time
+void select_point(point &r, const point table[8], int d)
+{
+    word64 abs, neg;
+    digit_split(d, abs, neg);
+
+    point_set_identity(r);
+    for (unsigned int j = 0; j < 8; j++)
+    {
+        const word64 mask = ct_eq(abs, j+1);
+        fe_select(r.x, table[j].x, mask);
+        fe_select(r.y, table[j].y, mask);
+        fe_select(r.z, table[j].z, mask);
+    }
+    point_cneg(r, neg);
+}
+
+void point_table(point table[8], const point &p)
+{
+    table[0] = p;
+    point_double(table[1], p);
+    for (unsigned int j = 2; j < 8; j++)
+        point_add(table[j], table[j-1], p);
+}
+
+// Variable time lookups for public scalars
+void get_base(point &r, unsigned int row, int d)
+{
+    const unsigned int j = (unsigned int)(d < 0 ? -d : d) - 1;
+    fe_copy(r.x, p256_base_table[row][j][0]);
+    fe_copy(r.y, p256_base_table[row][j][1]);
+    fe_copy(r.z, p256_one);
+    if (d < 0)
+        point_cneg(r, ~(word64)0);
+}
+
+void get_point(point &r, const point table[8], int d)
+{
+    r = table[(d < 0 ? -d : d) - 1];
+    if (d < 0)
+        point_cneg(r, ~(word64)0);
+}
+
+// u1*G + u2*P in variable time, table holds P..8P
+void point_mult_double(point &r, const point table[8], const fe u1, const fe u2)
+{
+    point t;
+    signed char d1[65], d2[65];
+    bool started = false;
+
+    scalar_recode(d1, u1);
+    scalar_recode(d2, u2);
+
+    // u2*P, skipping the doublings of the identity
+    point_set_identity(r);
+    for (int i = 64; i >= 0; i--)
+    {
+        if (started)
+        {
+            point_double(r, r); point_double(r, r);
+            point_double(r, r); point_double(r, r);
+        }
+        if (d2[i] != 0)
+        {
+            get_point(t, table, d2[i]);
+            point_add(r, r, t);
+            started = true;
+        }
+    }
+
+    // u1*G from the table
+    for (unsigned int i = 0; i < 65; i++)
+    {
+        if (d1[i] != 0)
+        {
+            get_base(t, i, d1[i]);
+            point_add(r, r, t);
+        }
+    }
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+NAMESPACE_BEGIN(P256)
+
+int p256_mult_base(byte x[32], byte y[32], const byte k[32])
+{
+    fe e;
+    point r, t;
+    signed char d[65];
+
+    if (fe_decode(e, k, p256_n) != 0)
+        return -1;
+    scalar_recode(d, e);
+
+    point_set_identity(r);
+    for (unsigned int i = 0; i < 65; i++)
+    {
+        select_base(t, i, d[i]);
+        point_add(r, r, t);
+    }
+
+    int ret = point_encode(x, y, r);
+    SecureWipeArray(e, 4);
+    SecureWipeArray(d, 65);
+    return ret;
+}
+
+int p256_mult(byte x[32], byte y[32], const byte px[32], const byte py[32], const byte k[32])
+{
+    fe e;
+    point p, r, t, table[8];
+    signed char d[65];
+
+    if (point_decode(p, px, py) != 0 || fe_decode(e, k, p256_n) != 0)
+        return -1;
+    scalar_recode(d, e);
+    point_table(table, p);
+
+    select_point(r, table, d[64]);
+    for (int i = 63; i >= 0; i--)
+    {
+        point_double(r, r); point_double(r, r);
+        point_double(r, r); point_double(r, r);
+        select_point(t, table, d[i]);
+        point_add(r, r, t);
+    }
+
+    int ret = point_encode(x, y, r);
+    SecureWipeArray(e, 4);
+    SecureWipeArray(d, 65);
+    return ret;
+}
+
+int p256_mult_double(byte x[32], byte y[32], const byte u1[32], const byte px[32], const byte py[32], const byte u2[32])
+{
+    fe e1, e2;
+    point p, r, table[8];
+
+    if (point_decode(p, px, py) != 0 || fe_decode(e1, u1, p256_n) != 0 || fe_decode(e2, u2, p256_n) != 0)
+        return -1;
+
+    point_table(table, p);
+    point_mult_double(r, table, e1, e2);
+    return point_encode(x, y, r);
+}
+
+int p256_mult_double_batch(byte x[], byte y[], byte ok[], const byte u1[], const byte px[32], const byte py[32], const byte u2[], size_t count)
+{
+    const size_t MAX_BATCH = 32;
+    point p, table[8], r[MAX_BATCH];
+    fe e1, e2, zz[MAX_BATCH], zi, t;
+
+    if (point_decode(p, px, py) != 0)
+        return -1;
+    point_table(table, p);
+
+    for (size_t base = 0; base < count; base += MAX_BATCH)
+    {
+        const size_t n = STDMIN(count - base, MAX_BATCH);
+
+        // Each result with the running product of the Z coordinates. A
+        // result at infinity takes Z = 1 so the product stays invertible.
+        for (size_t j = 0; j < n; j++)
+        {
+            const size_t i = base + j;
+            ok[i] = fe_decode(e1, u1 + 32*i, p256_n) == 0 && fe_decode(e2, u2 + 32*i, p256_n) == 0;
+            if (ok[i])
+                point_mult_double(r[j], table, e1, e2);
+            if (!ok[i] || fe_is_zero(r[j].z))
+            {
+                ok[i] = 0;
+                point_set_identity(r[j]);
+                fe_copy(r[j].z, p256_one);
+            }
+
+            if (j == 0)
+                fe_copy(zz[0], r[0].z);
+            else
+                fe_mul(zz[j], zz[j-1], r[j].z);
+        }
+
+        // One inversion for the batch, then walk back through the products
+        fe_invert(zi, zz[n-1]);
+        for (size_t j = n; j-- > 0; )
+        {
+            const size_t i = base + j;
+            if (j > 0)
+            {
+                fe_mul(t, zi, zz[j-1]);
+                fe_mul(zi, zi, r[j].z);
+            }
+            else
+                fe_copy(t, zi);
+
+            if (ok[i])
+            {
+                fe_mul(e1, r[j].x, t);
+                fe_from_mont(e1, e1);
+                fe_encode(x + 32*i, e1);
+                fe_mul(e1, r[j].y, t);
+                fe_from_mont(e1, e1);
+                fe_encode(y + 32*i, e1);
+            }
+            else
+            {
+                std::memset(x + 32*i, 0, 32);
+                std::memset(y + 32*i, 0, 32);
+            }
+        }
+    }
+
+    return 0;
+}
+
+NAMESPACE_END  // P256
+NAMESPACE_END  // CryptoPP
+
+#endif  // CRYPTOPP_P256_64BIT
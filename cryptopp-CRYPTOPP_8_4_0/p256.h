@@ -0,0 +1,105 @@
+// p256.h - written and placed in the public domain by
+//          the Crypto++ project.
+
+/// \file p256.h
+/// \details Functions for NIST P-256 (secp256r1) operations
+/// \details This header provides the entry points into a specialized
+///   P-256 backend. The field uses four 64-bit limbs with Montgomery
+///   reduction, and the group uses the complete projective formulas of
+///   Renes, Costello and Batina, so there are no special cases for the
+///   identity or for doubling. Multiples of the generator use a
+///   precomputed table and need no doublings.
+/// \details DL_GroupParameters_EC<ECP> calls the functions when the group
+///   is secp256r1 with the standard generator, so ECDSA, ECDH and the
+///   other EC schemes use the backend without changes by the caller. The
+///   functions are in the <tt>P256</tt> namespace and are
+///   p256_mult_base(), p256_mult(), p256_mult_double() and
+///   p256_mult_double_batch().
+/// \details Coordinates and scalars are 32-byte big-endian byte arrays.
+///   Scalars must be reduced modulo the group order by the caller.
+/// \since Crypto++ 8.5
+
+#ifndef CRYPTOPP_P256_H
+#define CRYPTOPP_P256_H
+
+#include "cryptlib.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+NAMESPACE_BEGIN(P256)
+
+/// \brief Multiply the generator
+/// \param x byte array for the x-coordinate of the result
+/// \param y byte array for the y-coordinate of the result
+/// \param k byte array with the scalar
+/// \return 0 on success, non-0 otherwise
+/// \details p256_mult_base() computes <tt>k*G</tt> in constant time. The
+///   function fails if the result is the point at infinity.
+/// \since Crypto++ 8.5
+int p256_mult_base(byte x[32], byte y[32], const byte k[32]);
+
+/// \brief Multiply a point
+/// \param x byte array for the x-coordinate of the result
+/// \param y byte array for the y-coordinate of the result
+/// \param px byte array with the x-coordinate of the point
+/// \param py byte array with the y-coordinate of the point
+/// \param k byte array with the scalar
+/// \return 0 on success, non-0 otherwise
+/// \details p256_mult() computes <tt>k*P</tt> in constant time. The
+///   function fails if the point is not on the curve or if the result is
+///   the point at infinity.
+/// \since Crypto++ 8.5
+int p256_mult(byte x[32], byte y[32], const byte px[32], const byte py[32], const byte k[32]);
+
+/// \brief Multiply the generator and a point and add the results
+/// \param x byte array for the x-coordinate of the result
+/// \param y byte array for the y-coordinate of the result
+/// \param u1 byte array with the scalar for the generator
+/// \param px byte array with the x-coordinate of the point
+/// \param py byte array with the y-coordinate of the point
+/// \param u2 byte array with the scalar for the point
+/// \return 0 on success, non-0 otherwise
+/// \details p256_mult_double() computes <tt>u1*G + u2*P</tt> for signature
+///   verification. It is not constant time and must only be used with
+///   public values. The function fails if the point is not on the curve or
+///   if the result is the point at infinity.
+/// \since Crypto++ 8.5
+int p256_mult_double(byte x[32], byte y[32], const byte u1[32], const byte px[32], const byte py[32], const byte u2[32]);
+
+/// \brief Multiply the generator and a point for a batch of scalars
+/// \param x byte array for count x-coordinates of the results
+/// \param y byte array for count y-coordinates of the results
+/// \param ok byte array for count flags, 1 if the result is valid
+/// \param u1 byte array with count scalars for the generator
+/// \param px byte array with the x-coordinate of the point
+/// \param py byte array with the y-coordinate of the point
+/// \param u2 byte array with count scalars for the point
+/// \param count the number of scalar pairs
+/// \return 0 on success, non-0 otherwise
+/// \details p256_mult_double_batch() computes <tt>u1[i]*G + u2[i]*P</tt>
+///   like p256_mult_double(). The table for <tt>P</tt> is built once, and one
+///   field inversion converts each group of up to 32 results to affine
+///   coordinates. The function fails if the point is not on the curve. An
+///   entry whose scalar is out of range or whose result is the point at
+///   infinity has its <tt>ok</tt> flag cleared.
+/// \details The buffers are consecutive 32-byte values, so <tt>x</tt>,
+///   <tt>y</tt>, <tt>u1</tt> and <tt>u2</tt> are each <tt>32*count</tt> bytes.
+/// \since Crypto++ 8.5
+int p256_mult_double_batch(byte x[], byte y[], byte ok[], const byte u1[], const byte px[32], const byte py[32], const byte u2[], size_t count);
+
+//****************************** Internal ******************************//
+
+#ifndef CRYPTOPP_DOXYGEN_PROCESSING
+
+// The backend needs a 64x64 to 128-bit multiply. Other platforms keep
+// using the generic ECP code.
+
+#if defined(CRYPTOPP_WORD128_AVAILABLE)
+# define CRYPTOPP_P256_64BIT 1
+#endif
+
+#endif  // CRYPTOPP_DOXYGEN_PROCESSING
+
+NAMESPACE_END  // P256
+NAMESPACE_END  // CryptoPP
+
+#endif  // CRYPTOPP_P256_H
@@ -25,6 +25,19 @@
 #include "aes.h"
 #include "cpu.h"
 
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t Poly1305_HashBlocks_AVX2(word32 h[5], const word32 r[4][5], const byte *input, size_t length, word32 padbit);
+extern size_t ChaCha20Poly1305_ProcessBlocks_AVX2(word32 h[5], const word32 r[4][5], word32 state[16], byte *output, const byte *input, size_t length, bool encrypt);
+#endif
+
+#if (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
+extern size_t Poly1305_HashBlocks_SSE2(word32 h[5], const word32 r[4][5], const byte *input, size_t length, word32 padbit);
+#endif
+
+NAMESPACE_END
+
 ////////////////////////////// Common Poly1305 //////////////////////////////
 
 ANONYMOUS_NAMESPACE_BEGIN
@@ -36,7 +49,68 @@ inline word32 CONSTANT_TIME_CARRY(word32 a, word32 b)
 	return ((a ^ ((a ^ b) | ((a - b) ^ b))) >> (sizeof(a) * 8 - 1));
 }
 
-void Poly1305_HashBlocks(word32 h[5], word32 r[4], const byte *input, size_t length, word32 padbit)
+#if defined(CRYPTOPP_WORD128_AVAILABLE)
+inline word64 CONSTANT_TIME_CARRY(word64 a, word64 b)
+{
+	return ((a ^ ((a ^ b) | ((a - b) ^ b))) >> (sizeof(a) * 8 - 1));
+}
+
+// Same as Poly1305_HashBlocks_32, but the limbs are 64-bit and the
+// products are 128-bit. The state stays in 32-bit words between calls.
+void Poly1305_HashBlocks_64(word32 h[5], word32 r[4], const byte *input, size_t length, word32 padbit)
+{
+	word64 r0, r1, s1;
+	word64 h0, h1, h2, c;
+	word128 d0, d1;
+
+	r0 = ((word64)r[1] << 32) | r[0];
+	r1 = ((word64)r[3] << 32) | r[2];
+
+	// r1 is clamped, so r1 * 5/4 is exact
+	s1 = r1 + (r1 >> 2);
+
+	h0 = ((word64)h[1] << 32) | h[0];
+	h1 = ((word64)h[3] << 32) | h[2];
+	h2 = h[4];
+
+	while (length >= 16)
+	{
+		// h += m[i]
+		h0 = (word64)(d0 = (word128)h0 +              GetWord<word64>(false, LITTLE_ENDIAN_ORDER, input + 0));
+		h1 = (word64)(d1 = (word128)h1 + (d0 >> 64) + GetWord<word64>(false, LITTLE_ENDIAN_ORDER, input + 8));
+		h2 += (word64)(d1 >> 64) + padbit;
+
+		// h *= r "%" p
+		d0 = ((word128)h0 * r0) +
+			 ((word128)h1 * s1);
+		d1 = ((word128)h0 * r1) +
+			 ((word128)h1 * r0) +
+			 (h2 * s1);
+		h2 = (h2 * r0);
+
+		// a) h2:h0 = h2<<128 + d1<<64 + d0
+		h0 = (word64)d0;
+		h1 = (word64)(d1 += d0 >> 64);
+		h2 += (word64)(d1 >> 64);
+
+		// b) (h2:h0 += (h2:h0>>130) * 5) %= 2^130
+		c = (h2 >> 2) + (h2 & ~W64LIT(3));
+		h2 &= 3;
+		h0 += c;
+		h1 += (c = CONSTANT_TIME_CARRY(h0,c));
+		h2 +=      CONSTANT_TIME_CARRY(h1,c);
+
+		input += 16;
+		length -= 16;
+	}
+
+	h[0] = (word32)h0; h[1] = (word32)(h0 >> 32);
+	h[2] = (word32)h1; h[3] = (word32)(h1 >> 32);
+	h[4] = (word32)h2;
+}
+#endif  // CRYPTOPP_WORD128_AVAILABLE
+
+void Poly1305_HashBlocks_32(word32 h[5], word32 r[4], const byte *input, size_t length, word32 padbit)
 {
 	word32 r0, r1, r2, r3;
 	word32 s1, s2, s3;
@@ -108,6 +182,140 @@ void Poly1305_HashBlocks(word32 h[5], word32 r[4], const byte *input, size_t len
 	h[3] = h3; h[4] = h4;
 }
 
+#if (CRYPTOPP_AVX2_AVAILABLE) || (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
+
+// Converts a value from 32-bit words to 26-bit limbs. The top word is
+// separate because the clamped key r has only four words.
+inline void Poly1305_Split26(word32 l[5], const word32 h[4], word32 top)
+{
+	l[0] =   h[0]                       & 0x3ffffff;
+	l[1] = ((h[0] >> 26) | (h[1] <<  6)) & 0x3ffffff;
+	l[2] = ((h[1] >> 20) | (h[2] << 12)) & 0x3ffffff;
+	l[3] = ((h[2] >> 14) | (h[3] << 18)) & 0x3ffffff;
+	l[4] =  (h[3] >>  8) | (top  << 24);
+}
+
+// Converts 26-bit limbs to 32-bit words. The limbs may exceed 26 bits.
+inline void Poly1305_Join26(word32 h[5], const word32 l[5])
+{
+	word32 l0=l[0], l1=l[1], l2=l[2], l3=l[3], l4=l[4], c;
+	word64 t;
+
+	c = l0 >> 26; l0 &= 0x3ffffff; l1 += c;
+	c = l1 >> 26; l1 &= 0x3ffffff; l2 += c;
+	c = l2 >> 26; l2 &= 0x3ffffff; l3 += c;
+	c = l3 >> 26; l3 &= 0x3ffffff; l4 += c;
+	c = l4 >> 26; l4 &= 0x3ffffff; l0 += c * 5;
+	c = l0 >> 26; l0 &= 0x3ffffff; l1 += c;
+
+	h[0] = (word32)(t = (word64)l0 + ((word64)l1 << 26));
+	h[1] = (word32)(t = (t >> 32) + ((word64)l2 << 20));
+	h[2] = (word32)(t = (t >> 32) + ((word64)l3 << 14));
+	h[3] = (word32)(t = (t >> 32) + ((word64)l4 <<  8));
+	h[4] = (word32)(t >> 32);
+}
+
+// out = a * b mod p in radix 2^26. out may alias a or b.
+inline void Poly1305_Multiply26(word32 out[5], const word32 a[5], const word32 b[5])
+{
+	const word32 s1 = b[1]*5, s2 = b[2]*5, s3 = b[3]*5, s4 = b[4]*5;
+	word64 d0, d1, d2, d3, d4;
+	word32 c;
+
+	d0 = (word64)a[0]*b[0] + (word64)a[1]*s4 + (word64)a[2]*s3 + (word64)a[3]*s2 + (word64)a[4]*s1;
+	d1 = (word64)a[0]*b[1] + (word64)a[1]*b[0] + (word64)a[2]*s4 + (word64)a[3]*s3 + (word64)a[4]*s2;
+	d2 = (word64)a[0]*b[2] + (word64)a[1]*b[1] + (word64)a[2]*b[0] + (word64)a[3]*s4 + (word64)a[4]*s3;
+	d3 = (word64)a[0]*b[3] + (word64)a[1]*b[2] + (word64)a[2]*b[1] + (word64)a[3]*b[0] + (word64)a[4]*s4;
+	d4 = (word64)a[0]*b[4] + (word64)a[1]*b[3] + (word64)a[2]*b[2] + (word64)a[3]*b[1] + (word64)a[4]*b[0];
+
+	d1 += d0 >> 26; out[0] = (word32)d0 & 0x3ffffff;
+	d2 += d1 >> 26; out[1] = (word32)d1 & 0x3ffffff;
+	d3 += d2 >> 26; out[2] = (word32)d2 & 0x3ffffff;
+	d4 += d3 >> 26; out[3] = (word32)d3 & 0x3ffffff;
+	c = (word32)(d4 >> 26); out[4] = (word32)d4 & 0x3ffffff;
+	out[0] += c * 5;
+	out[1] += out[0] >> 26; out[0] &= 0x3ffffff;
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE || CRYPTOPP_SSE2_INTRIN_AVAILABLE
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+// Poly1305_HashBlocks, ChaCha20Poly1305_ProcessBlocks and Poly1305_HashFinal
+// are also used by the one-pass ChaCha20Poly1305 in chachapoly.cpp.
+void Poly1305_HashBlocks(word32 h[5], word32 r[4], const byte *input, size_t length, word32 padbit)
+{
+#if (CRYPTOPP_AVX2_AVAILABLE) || (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
+	// The 4-way kernels need r^1..r^4, which costs about three blocks
+	if (length >= 256)
+	{
+		size_t (*kernel)(word32 h[5], const word32 r[4][5], const byte *input, size_t length, word32 padbit) = NULLPTR;
+
+# if (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
+		if (HasSSE2())
+			kernel = Poly1305_HashBlocks_SSE2;
+# endif
+# if (CRYPTOPP_AVX2_AVAILABLE)
+		if (HasAVX2())
+			kernel = Poly1305_HashBlocks_AVX2;
+# endif
+
+		if (kernel)
+		{
+			word32 p[4][5], l[5];
+
+			Poly1305_Split26(p[0], r, 0);
+			Poly1305_Multiply26(p[1], p[0], p[0]);
+			Poly1305_Multiply26(p[2], p[1], p[0]);
+			Poly1305_Multiply26(p[3], p[2], p[0]);
+			Poly1305_Split26(l, h, h[4]);
+
+			const size_t processed = RoundDownToMultipleOf(length, static_cast<size_t>(64));
+			kernel(l, p, input, processed, padbit);
+			Poly1305_Join26(h, l);
+
+			input += processed;
+			length -= processed;
+		}
+	}
+#endif
+
+#if defined(CRYPTOPP_WORD128_AVAILABLE)
+	Poly1305_HashBlocks_64(h, r, input, length, padbit);
+#else
+	Poly1305_HashBlocks_32(h, r, input, length, padbit);
+#endif
+}
+
+// Encrypts or decrypts with the ChaCha20 state and hashes the ciphertext
+// in the same pass. The block counter in state is advanced. Returns the
+// number of bytes not processed.
+size_t ChaCha20Poly1305_ProcessBlocks(word32 h[5], word32 r[4], word32 state[16], byte *output, const byte *input, size_t length, bool encrypt)
+{
+#if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2() && length >= 512)
+	{
+		word32 p[4][5], l[5];
+
+		Poly1305_Split26(p[0], r, 0);
+		Poly1305_Multiply26(p[1], p[0], p[0]);
+		Poly1305_Multiply26(p[2], p[1], p[0]);
+		Poly1305_Multiply26(p[3], p[2], p[0]);
+		Poly1305_Split26(l, h, h[4]);
+
+		length = ChaCha20Poly1305_ProcessBlocks_AVX2(l, p, state, output, input, length, encrypt);
+		Poly1305_Join26(h, l);
+	}
+#else
+	CRYPTOPP_UNUSED(h); CRYPTOPP_UNUSED(r); CRYPTOPP_UNUSED(state);
+	CRYPTOPP_UNUSED(output); CRYPTOPP_UNUSED(input); CRYPTOPP_UNUSED(encrypt);
+#endif
+
+	return length;
+}
+
 void Poly1305_HashFinal(word32 h[5], word32 n[4], byte *mac, size_t size)
 {
 	word32 h0, h1, h2, h3, h4;
@@ -160,10 +368,6 @@ void Poly1305_HashFinal(word32 h[5], word32 n[4], byte *mac, size_t size)
 	}
 }
 
-ANONYMOUS_NAMESPACE_END
-
-NAMESPACE_BEGIN(CryptoPP)
-
 ////////////////////////////// Bernstein Poly1305 //////////////////////////////
 
 // TODO: No longer needed. Remove at next major version bump
@@ -0,0 +1,263 @@
+// poly1305_avx.cpp - written and placed in the public domain by
+//                    the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernel hashes four blocks per iteration. Each 64-bit lane
+//    carries one of four accumulators in radix 2^26, and each
+//    accumulator is multiplied by r^4 per iteration. After the last
+//    iteration the lanes are multiplied by r^4, r^3, r^2 and r^1 and
+//    summed. The caller supplies the powers of r in radix 2^26.
+//
+//    ChaCha20Poly1305_ProcessBlocks_AVX2 stitches the kernel with the
+//    8-block ChaCha AVX2 kernel. Each 512-byte chunk is encrypted and
+//    its ciphertext hashed while it is still in L1, and the Poly1305
+//    accumulators are carried across chunks.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define CONST_M256_CAST(x) ((const __m256i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char POLY1305_AVX_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+extern void ChaCha_OperateKeystream_AVX2(const word32 *state, const byte* input, byte *output, unsigned int rounds);
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Splits four blocks into 26-bit limbs. The lanes hold blocks 0, 2, 1
+// and 3 because unpack works within each 128-bit half.
+inline void Poly1305_Load4(__m256i m[5], const byte *input, const __m256i &pad)
+{
+    const __m256i mask = _mm256_set_epi32(0,0x3ffffff, 0,0x3ffffff, 0,0x3ffffff, 0,0x3ffffff);
+    const __m256i a = _mm256_loadu_si256(CONST_M256_CAST(input+ 0));
+    const __m256i b = _mm256_loadu_si256(CONST_M256_CAST(input+32));
+    const __m256i lo = _mm256_unpacklo_epi64(a, b);
+    const __m256i hi = _mm256_unpackhi_epi64(a, b);
+
+    m[0] = _mm256_and_si256(lo, mask);
+    m[1] = _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask);
+    m[2] = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(lo, 52), _mm256_slli_epi64(hi, 12)), mask);
+    m[3] = _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask);
+    m[4] = _mm256_or_si256(_mm256_srli_epi64(hi, 40), pad);
+}
+
+// h = h * r mod p in each lane. s holds 5*r. The limbs of h must be
+// less than 2^32, and the limbs of the result are about 2^26.
+inline void Poly1305_Multiply4(__m256i h[5], const __m256i r[5], const __m256i s[5])
+{
+    __m256i d0, d1, d2, d3, d4, c;
+
+    d0 = _mm256_mul_epu32(h[0], r[0]);
+    d1 = _mm256_mul_epu32(h[0], r[1]);
+    d2 = _mm256_mul_epu32(h[0], r[2]);
+    d3 = _mm256_mul_epu32(h[0], r[3]);
+    d4 = _mm256_mul_epu32(h[0], r[4]);
+
+    d0 = _mm256_add_epi64(d0, _mm256_mul_epu32(h[1], s[4]));
+    d1 = _mm256_add_epi64(d1, _mm256_mul_epu32(h[1], r[0]));
+    d2 = _mm256_add_epi64(d2, _mm256_mul_epu32(h[1], r[1]));
+    d3 = _mm256_add_epi64(d3, _mm256_mul_epu32(h[1], r[2]));
+    d4 = _mm256_add_epi64(d4, _mm256_mul_epu32(h[1], r[3]));
+
+    d0 = _mm256_add_epi64(d0, _mm256_mul_epu32(h[2], s[3]));
+    d1 = _mm256_add_epi64(d1, _mm256_mul_epu32(h[2], s[4]));
+    d2 = _mm256_add_epi64(d2, _mm256_mul_epu32(h[2], r[0]));
+    d3 = _mm256_add_epi64(d3, _mm256_mul_epu32(h[2], r[1]));
+    d4 = _mm256_add_epi64(d4, _mm256_mul_epu32(h[2], r[2]));
+
+    d0 = _mm256_add_epi64(d0, _mm256_mul_epu32(h[3], s[2]));
+    d1 = _mm256_add_epi64(d1, _mm256_mul_epu32(h[3], s[3]));
+    d2 = _mm256_add_epi64(d2, _mm256_mul_epu32(h[3], s[4]));
+    d3 = _mm256_add_epi64(d3, _mm256_mul_epu32(h[3], r[0]));
+    d4 = _mm256_add_epi64(d4, _mm256_mul_epu32(h[3], r[1]));
+
+    d0 = _mm256_add_epi64(d0, _mm256_mul_epu32(h[4], s[1]));
+    d1 = _mm256_add_epi64(d1, _mm256_mul_epu32(h[4], s[2]));
+    d2 = _mm256_add_epi64(d2, _mm256_mul_epu32(h[4], s[3]));
+    d3 = _mm256_add_epi64(d3, _mm256_mul_epu32(h[4], s[4]));
+    d4 = _mm256_add_epi64(d4, _mm256_mul_epu32(h[4], r[0]));
+
+    // Partial reduction, the carry out of d4 wraps around times 5
+    const __m256i mask = _mm256_set_epi32(0,0x3ffffff, 0,0x3ffffff, 0,0x3ffffff, 0,0x3ffffff);
+    c = _mm256_srli_epi64(d0, 26); d0 = _mm256_and_si256(d0, mask); d1 = _mm256_add_epi64(d1, c);
+    c = _mm256_srli_epi64(d1, 26); d1 = _mm256_and_si256(d1, mask); d2 = _mm256_add_epi64(d2, c);
+    c = _mm256_srli_epi64(d2, 26); d2 = _mm256_and_si256(d2, mask); d3 = _mm256_add_epi64(d3, c);
+    c = _mm256_srli_epi64(d3, 26); d3 = _mm256_and_si256(d3, mask); d4 = _mm256_add_epi64(d4, c);
+    c = _mm256_srli_epi64(d4, 26); d4 = _mm256_and_si256(d4, mask);
+    d0 = _mm256_add_epi64(d0, _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+    c = _mm256_srli_epi64(d0, 26); d0 = _mm256_and_si256(d0, mask); d1 = _mm256_add_epi64(d1, c);
+
+    h[0] = d0; h[1] = d1; h[2] = d2; h[3] = d3; h[4] = d4;
+}
+
+inline void Poly1305_Add4(__m256i h[5], const __m256i m[5])
+{
+    h[0] = _mm256_add_epi64(h[0], m[0]);
+    h[1] = _mm256_add_epi64(h[1], m[1]);
+    h[2] = _mm256_add_epi64(h[2], m[2]);
+    h[3] = _mm256_add_epi64(h[3], m[3]);
+    h[4] = _mm256_add_epi64(h[4], m[4]);
+}
+
+// Multiplies the lanes by r^4, r^2, r^3 and r^1 and sums them into h.
+// The caller finishes the carries.
+inline void Poly1305_Finish4(word32 h[5], __m256i acc[5], const word32 r[4][5])
+{
+    __m256i r4[5], s4[5];
+    for (unsigned int i=0; i<5; ++i)
+    {
+        r4[i] = _mm256_set_epi32(0,r[0][i], 0,r[2][i], 0,r[1][i], 0,r[3][i]);
+        s4[i] = _mm256_set_epi32(0,r[0][i]*5, 0,r[2][i]*5, 0,r[1][i]*5, 0,r[3][i]*5);
+    }
+    Poly1305_Multiply4(acc, r4, s4);
+
+    for (unsigned int i=0; i<5; ++i)
+    {
+        __m128i t = _mm_add_epi64(_mm256_castsi256_si128(acc[i]), _mm256_extracti128_si256(acc[i], 1));
+        t = _mm_add_epi64(t, _mm_unpackhi_epi64(t, t));
+        h[i] = static_cast<word32>(_mm_cvtsi128_si32(t));
+    }
+}
+
+// Hashes 512 bytes. The first chunk of a message starts the accumulators
+// with the hash so far instead of multiplying them.
+inline void Poly1305_Hash512(__m256i acc[5], const __m256i r4[5], const __m256i s4[5],
+    const word32 h[5], const byte *input, const __m256i &pad, bool first)
+{
+    __m256i m[5];
+    unsigned int i = 0;
+
+    if (first)
+    {
+        Poly1305_Load4(acc, input, pad);
+        for (unsigned int j=0; j<5; ++j)
+            acc[j] = _mm256_add_epi64(acc[j], _mm256_set_epi32(0,0, 0,0, 0,0, 0,h[j]));
+        i = 64;
+    }
+
+    for ( ; i<512; i+=64)
+    {
+        Poly1305_Multiply4(acc, r4, s4);
+        Poly1305_Load4(m, input+i, pad);
+        Poly1305_Add4(acc, m);
+    }
+}
+
+ANONYMOUS_NAMESPACE_END
+
+// Hashes 4 blocks per iteration. h and the powers r^1..r^4 are in
+// radix 2^26. Returns the number of bytes not processed, which is
+// less than 64.
+size_t Poly1305_HashBlocks_AVX2(word32 h[5], const word32 r[4][5], const byte *input, size_t length, word32 padbit)
+{
+    CRYPTOPP_ASSERT(length >= 64);
+
+    const __m256i pad = _mm256_set_epi32(0,padbit<<24, 0,padbit<<24, 0,padbit<<24, 0,padbit<<24);
+    __m256i r4[5], s4[5], acc[5], m[5];
+
+    for (unsigned int i=0; i<5; ++i)
+    {
+        const word32 x = r[3][i], y = r[3][i]*5;
+        r4[i] = _mm256_set_epi32(0,x, 0,x, 0,x, 0,x);
+        s4[i] = _mm256_set_epi32(0,y, 0,y, 0,y, 0,y);
+    }
+
+    // The hash so far joins block 0
+    Poly1305_Load4(acc, input, pad);
+    for (unsigned int i=0; i<5; ++i)
+        acc[i] = _mm256_add_epi64(acc[i], _mm256_set_epi32(0,0, 0,0, 0,0, 0,h[i]));
+
+    input += 64;
+    length -= 64;
+
+    while (length >= 64)
+    {
+        Poly1305_Multiply4(acc, r4, s4);
+        Poly1305_Load4(m, input, pad);
+
+        Poly1305_Add4(acc, m);
+
+        input += 64;
+        length -= 64;
+    }
+
+    // Lanes hold blocks 0, 2, 1 and 3, which need r^4, r^2, r^3 and r^1
+    Poly1305_Finish4(h, acc, r);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return length;
+}
+
+// Encrypts or decrypts 512 bytes per iteration with ChaCha20, and hashes
+// the ciphertext in the same pass. h and the powers r^1..r^4 are in radix
+// 2^26. The block counter in state is advanced. Returns the number of
+// bytes not processed.
+size_t ChaCha20Poly1305_ProcessBlocks_AVX2(word32 h[5], const word32 r[4][5], word32 state[16],
+    byte *output, const byte *input, size_t length, bool encrypt)
+{
+    CRYPTOPP_ASSERT(length >= 512);
+
+    // The kernel does not carry out of the low counter word. The caller
+    // handles the blocks near the wrap.
+    if (0xffffffff - state[12] <= 8)
+        return length;
+
+    const __m256i pad = _mm256_set_epi32(0,1<<24, 0,1<<24, 0,1<<24, 0,1<<24);
+    __m256i r4[5], s4[5], acc[5];
+    bool first = true;
+
+    for (unsigned int i=0; i<5; ++i)
+    {
+        const word32 x = r[3][i], y = r[3][i]*5;
+        r4[i] = _mm256_set_epi32(0,x, 0,x, 0,x, 0,x);
+        s4[i] = _mm256_set_epi32(0,y, 0,y, 0,y, 0,y);
+    }
+
+    while (length >= 512 && 0xffffffff - state[12] > 8)
+    {
+        // Decryption hashes the ciphertext before it is overwritten
+        if (!encrypt)
+            Poly1305_Hash512(acc, r4, s4, h, input, pad, first);
+
+        ChaCha_OperateKeystream_AVX2(state, input, output, 20);
+        state[12] += 8;
+
+        if (encrypt)
+            Poly1305_Hash512(acc, r4, s4, h, output, pad, first);
+
+        first = false;
+        input += 512;
+        output += 512;
+        length -= 512;
+    }
+
+    // Lanes hold blocks 0, 2, 1 and 3, which need r^4, r^2, r^3 and r^1
+    Poly1305_Finish4(h, acc, r);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return length;
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END
@@ -0,0 +1,184 @@
+// poly1305_simd.cpp - written and placed in the public domain by
+//                     the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to SSE2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernel is the same as poly1305_avx.cpp, but the four
+//    accumulators occupy two xmm registers per limb. Blocks 0 and 1
+//    are in the first register, and blocks 2 and 3 in the second.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+// Internal compiler error in GCC 3.3 and below
+#if defined(__GNUC__) && (__GNUC__ < 4)
+# undef CRYPTOPP_SSE2_INTRIN_AVAILABLE
+#endif
+
+#if (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char POLY1305_SIMD_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_SSE2_INTRIN_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Splits two blocks into 26-bit limbs
+inline void Poly1305_Load2(__m128i m[5], const byte *input, const __m128i &pad)
+{
+    const __m128i mask = _mm_set_epi32(0,0x3ffffff, 0,0x3ffffff);
+    const __m128i a = _mm_loadu_si128(CONST_M128_CAST(input+ 0));
+    const __m128i b = _mm_loadu_si128(CONST_M128_CAST(input+16));
+    const __m128i lo = _mm_unpacklo_epi64(a, b);
+    const __m128i hi = _mm_unpackhi_epi64(a, b);
+
+    m[0] = _mm_and_si128(lo, mask);
+    m[1] = _mm_and_si128(_mm_srli_epi64(lo, 26), mask);
+    m[2] = _mm_and_si128(_mm_or_si128(_mm_srli_epi64(lo, 52), _mm_slli_epi64(hi, 12)), mask);
+    m[3] = _mm_and_si128(_mm_srli_epi64(hi, 14), mask);
+    m[4] = _mm_or_si128(_mm_srli_epi64(hi, 40), pad);
+}
+
+// h = h * r mod p in each lane. s holds 5*r. The limbs of h must be
+// less than 2^32, and the limbs of the result are about 2^26.
+inline void Poly1305_Multiply2(__m128i h[5], const __m128i r[5], const __m128i s[5])
+{
+    __m128i d0, d1, d2, d3, d4, c;
+
+    d0 = _mm_mul_epu32(h[0], r[0]);
+    d1 = _mm_mul_epu32(h[0], r[1]);
+    d2 = _mm_mul_epu32(h[0], r[2]);
+    d3 = _mm_mul_epu32(h[0], r[3]);
+    d4 = _mm_mul_epu32(h[0], r[4]);
+
+    d0 = _mm_add_epi64(d0, _mm_mul_epu32(h[1], s[4]));
+    d1 = _mm_add_epi64(d1, _mm_mul_epu32(h[1], r[0]));
+    d2 = _mm_add_epi64(d2, _mm_mul_epu32(h[1], r[1]));
+    d3 = _mm_add_epi64(d3, _mm_mul_epu32(h[1], r[2]));
+    d4 = _mm_add_epi64(d4, _mm_mul_epu32(h[1], r[3]));
+
+    d0 = _mm_add_epi64(d0, _mm_mul_epu32(h[2], s[3]));
+    d1 = _mm_add_epi64(d1, _mm_mul_epu32(h[2], s[4]));
+    d2 = _mm_add_epi64(d2, _mm_mul_epu32(h[2], r[0]));
+    d3 = _mm_add_epi64(d3, _mm_mul_epu32(h[2], r[1]));
+    d4 = _mm_add_epi64(d4, _mm_mul_epu32(h[2], r[2]));
+
+    d0 = _mm_add_epi64(d0, _mm_mul_epu32(h[3], s[2]));
+    d1 = _mm_add_epi64(d1, _mm_mul_epu32(h[3], s[3]));
+    d2 = _mm_add_epi64(d2, _mm_mul_epu32(h[3], s[4]));
+    d3 = _mm_add_epi64(d3, _mm_mul_epu32(h[3], r[0]));
+    d4 = _mm_add_epi64(d4, _mm_mul_epu32(h[3], r[1]));
+
+    d0 = _mm_add_epi64(d0, _mm_mul_epu32(h[4], s[1]));
+    d1 = _mm_add_epi64(d1, _mm_mul_epu32(h[4], s[2]));
+    d2 = _mm_add_epi64(d2, _mm_mul_epu32(h[4], s[3]));
+    d3 = _mm_add_epi64(d3, _mm_mul_epu32(h[4], s[4]));
+    d4 = _mm_add_epi64(d4, _mm_mul_epu32(h[4], r[0]));
+
+    // Partial reduction, the carry out of d4 wraps around times 5
+    const __m128i mask = _mm_set_epi32(0,0x3ffffff, 0,0x3ffffff);
+    c = _mm_srli_epi64(d0, 26); d0 = _mm_and_si128(d0, mask); d1 = _mm_add_epi64(d1, c);
+    c = _mm_srli_epi64(d1, 26); d1 = _mm_and_si128(d1, mask); d2 = _mm_add_epi64(d2, c);
+    c = _mm_srli_epi64(d2, 26); d2 = _mm_and_si128(d2, mask); d3 = _mm_add_epi64(d3, c);
+    c = _mm_srli_epi64(d3, 26); d3 = _mm_and_si128(d3, mask); d4 = _mm_add_epi64(d4, c);
+    c = _mm_srli_epi64(d4, 26); d4 = _mm_and_si128(d4, mask);
+    d0 = _mm_add_epi64(d0, _mm_add_epi64(c, _mm_slli_epi64(c, 2)));
+    c = _mm_srli_epi64(d0, 26); d0 = _mm_and_si128(d0, mask); d1 = _mm_add_epi64(d1, c);
+
+    h[0] = d0; h[1] = d1; h[2] = d2; h[3] = d3; h[4] = d4;
+}
+
+inline void Poly1305_Add2(__m128i h[5], const __m128i m[5])
+{
+    h[0] = _mm_add_epi64(h[0], m[0]);
+    h[1] = _mm_add_epi64(h[1], m[1]);
+    h[2] = _mm_add_epi64(h[2], m[2]);
+    h[3] = _mm_add_epi64(h[3], m[3]);
+    h[4] = _mm_add_epi64(h[4], m[4]);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+// Hashes 4 blocks per iteration. h and the powers r^1..r^4 are in
+// radix 2^26. Returns the number of bytes not processed, which is
+// less than 64.
+size_t Poly1305_HashBlocks_SSE2(word32 h[5], const word32 r[4][5], const byte *input, size_t length, word32 padbit)
+{
+    CRYPTOPP_ASSERT(length >= 64);
+
+    const __m128i pad = _mm_set_epi32(0,padbit<<24, 0,padbit<<24);
+    __m128i r4[5], s4[5], a[5], b[5], m[5];
+
+    for (unsigned int i=0; i<5; ++i)
+    {
+        const word32 x = r[3][i], y = r[3][i]*5;
+        r4[i] = _mm_set_epi32(0,x, 0,x);
+        s4[i] = _mm_set_epi32(0,y, 0,y);
+    }
+
+    // The hash so far joins block 0
+    Poly1305_Load2(a, input+ 0, pad);
+    Poly1305_Load2(b, input+32, pad);
+    for (unsigned int i=0; i<5; ++i)
+        a[i] = _mm_add_epi64(a[i], _mm_set_epi32(0,0, 0,h[i]));
+
+    input += 64;
+    length -= 64;
+
+    while (length >= 64)
+    {
+        Poly1305_Multiply2(a, r4, s4);
+        Poly1305_Load2(m, input+ 0, pad);
+        Poly1305_Add2(a, m);
+
+        Poly1305_Multiply2(b, r4, s4);
+        Poly1305_Load2(m, input+32, pad);
+        Poly1305_Add2(b, m);
+
+        input += 64;
+        length -= 64;
+    }
+
+    // Blocks 0 and 1 need r^4 and r^3
+    for (unsigned int i=0; i<5; ++i)
+    {
+        r4[i] = _mm_set_epi32(0,r[2][i], 0,r[3][i]);
+        s4[i] = _mm_set_epi32(0,r[2][i]*5, 0,r[3][i]*5);
+    }
+    Poly1305_Multiply2(a, r4, s4);
+
+    // Blocks 2 and 3 need r^2 and r^1
+    for (unsigned int i=0; i<5; ++i)
+    {
+        r4[i] = _mm_set_epi32(0,r[0][i], 0,r[1][i]);
+        s4[i] = _mm_set_epi32(0,r[0][i]*5, 0,r[1][i]*5);
+    }
+    Poly1305_Multiply2(b, r4, s4);
+
+    // Sum the lanes. The caller finishes the carries.
+    Poly1305_Add2(a, b);
+    for (unsigned int i=0; i<5; ++i)
+    {
+        const __m128i t = _mm_add_epi64(a[i], _mm_unpackhi_epi64(a[i], a[i]));
+        h[i] = static_cast<word32>(_mm_cvtsi128_si32(t));
+    }
+
+    return length;
+}
+
+#endif  // CRYPTOPP_SSE2_INTRIN_AVAILABLE
+
+NAMESPACE_END
@@ -853,6 +853,32 @@ public:
 		GetBasePrecomputation().Save(GetGroupPrecomputation(), storedPrecomputation);
 	}
 
+	/// \brief Use a table of precomputation in place
+	/// \param table pointer to a table written by SavePrecomputationTable()
+	/// \param size the size of the table, in bytes
+	/// \details The table can be a read-only memory mapped file shared by
+	///   several processes. It must stay valid while this object, or a copy
+	///   of it, uses it.
+	/// \throw NotImplemented
+	/// \throw InvalidDataFormat if the table is malformed
+	/// \sa DL_FixedBasePrecomputation::LoadTable(), SavePrecomputationTable()
+	/// \since Crypto++ 8.5
+	void LoadPrecomputationTable(const byte *table, size_t size)
+	{
+		AccessBasePrecomputation().LoadTable(GetGroupPrecomputation(), table, size);
+		m_validationLevel = 0;
+	}
+
+	/// \brief Save precomputation as a table
+	/// \param storedPrecomputation BufferedTransformation to write the table
+	/// \throw NotImplemented
+	/// \sa DL_FixedBasePrecomputation::SaveTable(), LoadPrecomputationTable()
+	/// \since Crypto++ 8.5
+	void SavePrecomputationTable(BufferedTransformation &storedPrecomputation) const
+	{
+		GetBasePrecomputation().SaveTable(GetGroupPrecomputation(), storedPrecomputation);
+	}
+
 	/// \brief Retrieves the subgroup generator
 	/// \return the subgroup generator
 	/// \details The subgroup generator is retrieved from the base precomputation
@@ -1113,6 +1139,23 @@ public:
 		return params.GetBasePrecomputation().CascadeExponentiate(params.GetGroupPrecomputation(), baseExp, GetPublicPrecomputation(), publicExp);
 	}
 
+	/// \brief Exponentiates a batch of elements
+	/// \param results array of count elements for the results
+	/// \param baseExps array of count exponents for the base
+	/// \param publicExps array of count exponents for the public element
+	/// \param count the number of exponent pairs
+	/// \details CascadeExponentiateBaseAndPublicElements() performs
+	///   CascadeExponentiateBaseAndPublicElement() for each pair of exponents.
+	///   Derived classes override it when the work can be shared across the
+	///   batch, like a single inversion to convert all the results to affine
+	///   coordinates.
+	/// \since Crypto++ 8.5
+	virtual void CascadeExponentiateBaseAndPublicElements(Element *results, const Integer *baseExps, const Integer *publicExps, size_t count) const
+	{
+		for (size_t i=0; i<count; ++i)
+			results[i] = CascadeExponentiateBaseAndPublicElement(baseExps[i], publicExps[i]);
+	}
+
 	/// \brief Accesses the public precomputation
 	/// \details GetPublicPrecomputation returns a const reference, while
 	///   AccessPublicPrecomputation returns a non-const reference. Must be
@@ -1424,6 +1467,22 @@ public:
 	/// \param s s part of signature
 	virtual bool Verify(const DL_GroupParameters<T> &params, const DL_PublicKey<T> &publicKey, const Integer &e, const Integer &r, const Integer &s) const =0;
 
+	/// \brief Verify a batch of messages using a public key
+	/// \param params GroupParameters
+	/// \param publicKey public key
+	/// \param e array of count encoded messages
+	/// \param r array of count r parts of signatures
+	/// \param s array of count s parts of signatures
+	/// \param count the number of signatures
+	/// \param valid array of count results, true if the signature is valid
+	/// \details The default implementation calls Verify() for each signature.
+	/// \since Crypto++ 8.5
+	virtual void VerifyBatch(const DL_GroupParameters<T> &params, const DL_PublicKey<T> &publicKey, const Integer *e, const Integer *r, const Integer *s, size_t count, bool *valid) const
+	{
+		for (size_t i=0; i<count; ++i)
+			valid[i] = Verify(params, publicKey, e[i], r[i], s[i]);
+	}
+
 	/// \brief Recover a Presignature
 	/// \param params GroupParameters
 	/// \param publicKey public key
@@ -1753,6 +1812,62 @@ public:
 		return alg.Verify(params, key, e, r, ma.m_s);
 	}
 
+	/// \brief Check a batch of signatures made with this object's public key
+	/// \param messages array of pointers to the messages
+	/// \param messageLengths array of message sizes, in bytes
+	/// \param signatures array of pointers to the signatures
+	/// \param signatureLengths array of signature sizes, in bytes
+	/// \param count the number of messages and signatures
+	/// \param valid optional array of count results, true if the signature is valid
+	/// \return true if all signatures are valid, false otherwise
+	/// \details VerifyBatch() gives the same results as calling VerifyMessage()
+	///   for each signature. Each signature is checked exactly, there is no
+	///   random linear combination. The signature algorithm and the public key
+	///   share work across the batch where they can. DSA and ECDSA use one
+	///   modular inversion for all the <tt>s</tt> values, and ECDSA over
+	///   secp256r1 uses one field inversion for all the result points.
+	/// \throw InvalidDataFormat if a signature is too short
+	/// \since Crypto++ 8.5
+	bool VerifyBatch(const byte *const messages[], const size_t messageLengths[],
+		const byte *const signatures[], const size_t signatureLengths[], size_t count, bool valid[] = NULLPTR) const
+	{
+		this->GetMaterial().DoQuickSanityCheck();
+
+		const DL_ElgamalLikeSignatureAlgorithm<T> &alg = this->GetSignatureAlgorithm();
+		const DL_GroupParameters<T> &params = this->GetAbstractGroupParameters();
+		const DL_PublicKey<T> &key = this->GetKeyInterface();
+
+		if (count == 0)
+			return true;
+
+		std::vector<Integer> e(count), r(count), s(count);
+		SecByteBlock representative(this->MessageRepresentativeLength());
+		for (size_t i=0; i<count; ++i)
+		{
+			member_ptr<PK_MessageAccumulator> m(this->NewVerificationAccumulator());
+			PK_MessageAccumulatorBase &ma = static_cast<PK_MessageAccumulatorBase &>(*m);
+			InputSignature(ma, signatures[i], signatureLengths[i]);
+			ma.Update(messages[i], messageLengths[i]);
+
+			this->GetMessageEncodingInterface().ComputeMessageRepresentative(NullRNG(), ma.m_recoverableMessage, ma.m_recoverableMessage.size(),
+				ma.AccessHash(), this->GetHashIdentifier(), ma.m_empty,
+				representative, this->MessageRepresentativeBitLength());
+
+			e[i].Decode(representative, representative.size());
+			r[i].Decode(ma.m_semisignature, ma.m_semisignature.size());
+			s[i] = ma.m_s;
+		}
+
+		SecBlock<bool> temp(valid ? 0 : count);
+		bool *results = valid ? valid : temp.begin();
+		alg.VerifyBatch(params, key, &e[0], &r[0], &s[0], count, results);
+
+		bool pass = true;
+		for (size_t i=0; i<count; ++i)
+			pass = pass && results[i];
+		return pass;
+	}
+
 	DecodingResult RecoverAndRestart(byte *recoveredMessage, PK_MessageAccumulator &messageAccumulator) const
 	{
 		this->GetMaterial().DoQuickSanityCheck();
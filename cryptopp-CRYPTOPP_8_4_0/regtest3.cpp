@@ -20,6 +20,7 @@
 #include "tiger.h"
 #include "ccm.h"
 #include "gcm.h"
+#include "ocb.h"
 #include "eax.h"
 #include "xts.h"
 #include "twofish.h"
@@ -41,6 +42,7 @@
 #include "skipjack.h"
 #include "blowfish.h"
 #include "chachapoly.h"
+#include "aegis.h"
 
 // Aggressive stack checking with VS2005 SP1 and above.
 #if (_MSC_FULL_VER >= 140050727)
@@ -72,9 +74,12 @@ void RegisterFactories4()
 
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<CCM<AES> >();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<GCM<AES> >();
+	RegisterAuthenticatedSymmetricCipherDefaultFactories<OCB<AES> >();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<EAX<AES> >();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<ChaCha20Poly1305>();
 	RegisterAuthenticatedSymmetricCipherDefaultFactories<XChaCha20Poly1305>();
+	RegisterAuthenticatedSymmetricCipherDefaultFactories<AEGIS128L>();
+	RegisterAuthenticatedSymmetricCipherDefaultFactories<AEGIS256>();
 
 	RegisterSymmetricCipherDefaultFactories<CBC_Mode<ARIA> >();  // For test vectors
 	RegisterSymmetricCipherDefaultFactories<CTR_Mode<ARIA> >();
@@ -322,6 +322,34 @@ extern size_t Rijndael_Dec_AdvancedProcessBlocks_AESNI(const word32 *subkeys, si
         const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
 #endif
 
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+extern size_t Rijndael_Enc_AdvancedProcessBlocks_SSSE3(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+extern size_t Rijndael_Dec_AdvancedProcessBlocks_SSSE3(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+#endif
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t Rijndael_Enc_AdvancedProcessBlocks_AVX2(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+extern size_t Rijndael_Dec_AdvancedProcessBlocks_AVX2(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+#endif
+
+#if (CRYPTOPP_VAES_AVAILABLE)
+extern size_t Rijndael_Enc_AdvancedProcessBlocks_VAES(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+extern size_t Rijndael_Dec_AdvancedProcessBlocks_VAES(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+#endif
+
+#if (CRYPTOPP_AVX512_AVAILABLE)
+extern size_t Rijndael_Enc_AdvancedProcessBlocks_AVX512(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+extern size_t Rijndael_Dec_AdvancedProcessBlocks_AVX512(const word32 *subkeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+#endif
+
 #if (CRYPTOPP_ARM_AES_AVAILABLE)
 extern size_t Rijndael_Enc_AdvancedProcessBlocks_ARMV8(const word32 *subkeys, size_t rounds,
         const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
@@ -371,6 +399,14 @@ void CRYPTOGAMS_decrypt(const byte *inBlock, const byte *xorBlock, byte *outBloc
 
 std::string Rijndael::Base::AlgorithmProvider() const
 {
+#if (CRYPTOPP_AVX512_AVAILABLE)
+	if (HasAVX512F() && HasVAES())
+		return "AVX512";
+#endif
+#if (CRYPTOPP_VAES_AVAILABLE)
+	if (HasVAES())
+		return "VAES";
+#endif
 #if (CRYPTOPP_AESNI_AVAILABLE)
 	if (HasAESNI())
 		return "AESNI";
@@ -1243,6 +1279,15 @@ void Rijndael_Enc_AdvancedProcessBlocks_SSE2(void *locals, const word32 *k);
 #if CRYPTOPP_RIJNDAEL_ADVANCED_PROCESS_BLOCKS
 size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
 {
+#if CRYPTOPP_AVX512_AVAILABLE
+	// Single blocks and serial modes like CBC encryption stay on AES-NI
+	if ((flags & BT_AllowParallel) && length >= 16*BLOCKSIZE && HasAVX512F() && HasVAES())
+		return Rijndael_Enc_AdvancedProcessBlocks_AVX512(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
+#if CRYPTOPP_VAES_AVAILABLE
+	if ((flags & BT_AllowParallel) && length >= 8*BLOCKSIZE && HasVAES())
+		return Rijndael_Enc_AdvancedProcessBlocks_VAES(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
 #if CRYPTOPP_AESNI_AVAILABLE
 	if (HasAESNI())
 		return Rijndael_Enc_AdvancedProcessBlocks_AESNI(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
@@ -1255,6 +1300,16 @@ size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xo
 	if (HasAES())
 		return Rijndael_Enc_AdvancedProcessBlocks128_6x1_ALTIVEC(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
 #endif
+#if CRYPTOPP_AVX2_AVAILABLE
+	// Parallel modes without AES-NI use the constant time bitsliced code
+	if ((flags & BT_AllowParallel) && HasAVX2())
+		return Rijndael_Enc_AdvancedProcessBlocks_AVX2(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
+#if CRYPTOPP_SSSE3_AVAILABLE
+	// CTR stays on the table code, which the 8-block SSSE3 kernel did not beat
+	if ((flags & BT_AllowParallel) && !(flags & BT_InBlockIsCounter) && HasSSSE3())
+		return Rijndael_Enc_AdvancedProcessBlocks_SSSE3(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
 
 #if (CRYPTOPP_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
 	if (HasSSE2())
@@ -1311,6 +1366,15 @@ size_t Rijndael::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xo
 
 size_t Rijndael::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const
 {
+#if CRYPTOPP_AVX512_AVAILABLE
+	// Single blocks and serial modes like CBC encryption stay on AES-NI
+	if ((flags & BT_AllowParallel) && length >= 16*BLOCKSIZE && HasAVX512F() && HasVAES())
+		return Rijndael_Dec_AdvancedProcessBlocks_AVX512(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
+#if CRYPTOPP_VAES_AVAILABLE
+	if ((flags & BT_AllowParallel) && length >= 8*BLOCKSIZE && HasVAES())
+		return Rijndael_Dec_AdvancedProcessBlocks_VAES(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
 #if CRYPTOPP_AESNI_AVAILABLE
 	if (HasAESNI())
 		return Rijndael_Dec_AdvancedProcessBlocks_AESNI(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
@@ -1323,6 +1387,15 @@ size_t Rijndael::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xo
 	if (HasAES())
 		return Rijndael_Dec_AdvancedProcessBlocks128_6x1_ALTIVEC(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
 #endif
+#if CRYPTOPP_AVX2_AVAILABLE
+	// Parallel modes without AES-NI use the constant time bitsliced code
+	if ((flags & BT_AllowParallel) && HasAVX2())
+		return Rijndael_Dec_AdvancedProcessBlocks_AVX2(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
+#if CRYPTOPP_SSSE3_AVAILABLE
+	if ((flags & BT_AllowParallel) && HasSSSE3())
+		return Rijndael_Dec_AdvancedProcessBlocks_SSSE3(m_key, m_rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+#endif
 
 	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
 }
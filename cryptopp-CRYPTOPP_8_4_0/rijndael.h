@@ -26,6 +26,9 @@
 
 NAMESPACE_BEGIN(CryptoPP)
 
+class GCM_Base;
+class XTS_ModeBase;
+
 /// \brief Rijndael block cipher information
 /// \details All key sizes are supported. The library only provides Rijndael with 128-bit blocks,
 ///   and not 192-bit or 256-bit blocks
@@ -54,6 +57,11 @@ class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentat
 		unsigned int OptimalDataAlignment() const;
 
 	protected:
+		// GCM_Base and XTS_ModeBase drive the AES-NI subkeys in their
+		// stitched kernels
+		friend class GCM_Base;
+		friend class XTS_ModeBase;
+
 		static void FillEncTable();
 		static void FillDecTable();
 
@@ -0,0 +1,440 @@
+// rijndael_avx.cpp - written and placed in the public domain by
+//                    the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to VAES and
+//    VPCLMULQDQ on 256-bit registers. A separate source file is needed
+//    because additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    VAES performs the AES round on each 128-bit lane of a register, so
+//    a ymm register carries two blocks. Eight blocks are kept in flight,
+//    which is twice the number the AES-NI code in rijndael_simd.cpp
+//    keeps with the same number of registers.
+//
+//    The XTS tweaks are generated in the registers. The tweaks for a
+//    group of eight blocks are multiplied by x^8 with one byte shift and
+//    one carryless multiply per register, instead of doubling each tweak
+//    in turn.
+
+#include "pch.h"
+#include "config.h"
+#include "cryptlib.h"
+#include "misc.h"
+
+#if (CRYPTOPP_VAES_AVAILABLE)
+# include <emmintrin.h>
+# include <smmintrin.h>
+# include <wmmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+#define M256_CAST(x) ((__m256i *)(void *)(x))
+#define CONST_M256_CAST(x) ((const __m256i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char RIJNDAEL_AVX_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_VAES_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Round keys are broadcast to both lanes once per call. AES-256
+// uses 15 round keys.
+typedef __m256i VAES_Keys[15];
+
+inline void VAES_LoadKeys(VAES_Keys rk, const word32 *subkeys, unsigned int rounds)
+{
+    for (unsigned int i=0; i<=rounds; ++i)
+        rk[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128(CONST_M128_CAST(subkeys+4*i)));
+}
+
+inline void VAES_Enc_Block(__m128i &block, const VAES_Keys rk, unsigned int rounds)
+{
+    block = _mm_xor_si128(block, _mm256_castsi256_si128(rk[0]));
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm_aesenc_si128(block, _mm256_castsi256_si128(rk[i]));
+    block = _mm_aesenclast_si128(block, _mm256_castsi256_si128(rk[rounds]));
+}
+
+inline void VAES_Enc_2_Blocks(__m256i &block, const VAES_Keys rk, unsigned int rounds)
+{
+    block = _mm256_xor_si256(block, rk[0]);
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm256_aesenc_epi128(block, rk[i]);
+    block = _mm256_aesenclast_epi128(block, rk[rounds]);
+}
+
+inline void VAES_Enc_8_Blocks(__m256i &block0, __m256i &block1, __m256i &block2,
+                              __m256i &block3, const VAES_Keys rk, unsigned int rounds)
+{
+    // Work on copies so the blocks stay in registers when the
+    // function is not inlined through the function pointer
+    __m256i b0 = block0, b1 = block1, b2 = block2, b3 = block3;
+    __m256i k = rk[0];
+    b0 = _mm256_xor_si256(b0, k);
+    b1 = _mm256_xor_si256(b1, k);
+    b2 = _mm256_xor_si256(b2, k);
+    b3 = _mm256_xor_si256(b3, k);
+    for (unsigned int i=1; i<rounds; ++i)
+    {
+        k = rk[i];
+        b0 = _mm256_aesenc_epi128(b0, k);
+        b1 = _mm256_aesenc_epi128(b1, k);
+        b2 = _mm256_aesenc_epi128(b2, k);
+        b3 = _mm256_aesenc_epi128(b3, k);
+    }
+    k = rk[rounds];
+    b0 = _mm256_aesenclast_epi128(b0, k);
+    b1 = _mm256_aesenclast_epi128(b1, k);
+    b2 = _mm256_aesenclast_epi128(b2, k);
+    b3 = _mm256_aesenclast_epi128(b3, k);
+    block0 = b0; block1 = b1; block2 = b2; block3 = b3;
+}
+
+inline void VAES_Dec_Block(__m128i &block, const VAES_Keys rk, unsigned int rounds)
+{
+    block = _mm_xor_si128(block, _mm256_castsi256_si128(rk[0]));
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm_aesdec_si128(block, _mm256_castsi256_si128(rk[i]));
+    block = _mm_aesdeclast_si128(block, _mm256_castsi256_si128(rk[rounds]));
+}
+
+inline void VAES_Dec_2_Blocks(__m256i &block, const VAES_Keys rk, unsigned int rounds)
+{
+    block = _mm256_xor_si256(block, rk[0]);
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm256_aesdec_epi128(block, rk[i]);
+    block = _mm256_aesdeclast_epi128(block, rk[rounds]);
+}
+
+inline void VAES_Dec_8_Blocks(__m256i &block0, __m256i &block1, __m256i &block2,
+                              __m256i &block3, const VAES_Keys rk, unsigned int rounds)
+{
+    __m256i b0 = block0, b1 = block1, b2 = block2, b3 = block3;
+    __m256i k = rk[0];
+    b0 = _mm256_xor_si256(b0, k);
+    b1 = _mm256_xor_si256(b1, k);
+    b2 = _mm256_xor_si256(b2, k);
+    b3 = _mm256_xor_si256(b3, k);
+    for (unsigned int i=1; i<rounds; ++i)
+    {
+        k = rk[i];
+        b0 = _mm256_aesdec_epi128(b0, k);
+        b1 = _mm256_aesdec_epi128(b1, k);
+        b2 = _mm256_aesdec_epi128(b2, k);
+        b3 = _mm256_aesdec_epi128(b3, k);
+    }
+    k = rk[rounds];
+    b0 = _mm256_aesdeclast_epi128(b0, k);
+    b1 = _mm256_aesdeclast_epi128(b1, k);
+    b2 = _mm256_aesdeclast_epi128(b2, k);
+    b3 = _mm256_aesdeclast_epi128(b3, k);
+    block0 = b0; block1 = b1; block2 = b2; block3 = b3;
+}
+
+// Loads the block at ptr into the low lane and the block at ptr+inc
+// into the high lane. inc is 16, 0-16 or 0 in AdvancedProcessBlocks.
+inline __m256i VAES_LoadBlocks(const byte *ptr, size_t inc)
+{
+    if (inc == 16)
+        return _mm256_loadu_si256(CONST_M256_CAST(ptr));
+    else if (inc == 0-static_cast<size_t>(16))
+        return _mm256_permute4x64_epi64(
+            _mm256_loadu_si256(CONST_M256_CAST(ptr-16)), _MM_SHUFFLE(1,0,3,2));
+    else
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(
+            _mm_loadu_si128(CONST_M128_CAST(ptr))), _mm_loadu_si128(CONST_M128_CAST(ptr+inc)), 1);
+}
+
+// Stores the low lane at ptr and then the high lane at ptr+inc
+inline void VAES_StoreBlocks(byte *ptr, size_t inc, const __m256i &blocks)
+{
+    if (inc == 16)
+        _mm256_storeu_si256(M256_CAST(ptr), blocks);
+    else if (inc == 0-static_cast<size_t>(16))
+        _mm256_storeu_si256(M256_CAST(ptr-16), _mm256_permute4x64_epi64(blocks, _MM_SHUFFLE(1,0,3,2)));
+    else
+    {
+        _mm_storeu_si128(M128_CAST(ptr), _mm256_castsi256_si128(blocks));
+        _mm_storeu_si128(M128_CAST(ptr+inc), _mm256_extracti128_si256(blocks, 1));
+    }
+}
+
+/// \brief AdvancedProcessBlocks for 2 and 1 blocks per ymm register
+/// \details VAES_AdvancedProcessBlocks follows the semantics of
+///  AdvancedProcessBlocks128_4x1_SSE in adv_simd.h. It processes 8 blocks
+///  at a time in 4 ymm registers, then 2 blocks in 1 ymm register, and
+///  finally 1 block in a xmm register.
+template <typename F1, typename F2, typename F8>
+inline size_t VAES_AdvancedProcessBlocks(F1 func1, F2 func2, F8 func8,
+        const word32 *subKeys, size_t rounds, const byte *inBlocks,
+        const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(subKeys);
+    CRYPTOPP_ASSERT(inBlocks);
+    CRYPTOPP_ASSERT(outBlocks);
+    CRYPTOPP_ASSERT(length >= 16);
+
+    const size_t blockSize = 16;
+    const unsigned int r = static_cast<unsigned int>(rounds);
+
+    size_t inIncrement = (flags & (BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_DontIncrementInOutPointers)) ? 0 : blockSize;
+    size_t xorIncrement = (xorBlocks != NULLPTR) ? blockSize : 0;
+    size_t outIncrement = (flags & BlockTransformation::BT_DontIncrementInOutPointers) ? 0 : blockSize;
+
+    // Clang and Coverity are generating findings using xorBlocks as a flag.
+    const bool xorInput = (xorBlocks != NULLPTR) && (flags & BlockTransformation::BT_XorInput);
+    const bool xorOutput = (xorBlocks != NULLPTR) && !(flags & BlockTransformation::BT_XorInput);
+    const bool isCounter = (flags & BlockTransformation::BT_InBlockIsCounter) != 0;
+
+    if (flags & BlockTransformation::BT_ReverseDirection)
+    {
+        inBlocks = PtrAdd(inBlocks, length - blockSize);
+        xorBlocks = PtrAdd(xorBlocks, length - blockSize);
+        outBlocks = PtrAdd(outBlocks, length - blockSize);
+        inIncrement = 0-inIncrement;
+        xorIncrement = 0-xorIncrement;
+        outIncrement = 0-outIncrement;
+    }
+
+    VAES_Keys rk;
+    VAES_LoadKeys(rk, subKeys, r);
+
+    if (flags & BlockTransformation::BT_AllowParallel)
+    {
+        // Increment of 1 in big-endian compatible with the ctr byte array.
+        const __m256i s_one = _mm256_set_epi32(1<<24, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i s_two = _mm256_set_epi32(2<<24, 0, 0, 0, 2<<24, 0, 0, 0);
+
+        while (length >= 8*blockSize)
+        {
+            __m256i block0, block1, block2, block3;
+            if (isCounter)
+            {
+                block0 = _mm256_add_epi32(_mm256_broadcastsi128_si256(
+                    _mm_loadu_si128(CONST_M128_CAST(inBlocks))), s_one);
+                block1 = _mm256_add_epi32(block0, s_two);
+                block2 = _mm256_add_epi32(block1, s_two);
+                block3 = _mm256_add_epi32(block2, s_two);
+                _mm_storeu_si128(M128_CAST(inBlocks), _mm256_castsi256_si128(
+                    _mm256_add_epi32(block3, s_two)));
+            }
+            else
+            {
+                block0 = VAES_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 2*inIncrement);
+                block1 = VAES_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 2*inIncrement);
+                block2 = VAES_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 2*inIncrement);
+                block3 = VAES_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 2*inIncrement);
+            }
+
+            if (xorInput)
+            {
+                block0 = _mm256_xor_si256(block0, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+                block1 = _mm256_xor_si256(block1, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+                block2 = _mm256_xor_si256(block2, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+                block3 = _mm256_xor_si256(block3, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+            }
+
+            func8(block0, block1, block2, block3, rk, r);
+
+            if (xorOutput)
+            {
+                block0 = _mm256_xor_si256(block0, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+                block1 = _mm256_xor_si256(block1, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+                block2 = _mm256_xor_si256(block2, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+                block3 = _mm256_xor_si256(block3, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+            }
+
+            VAES_StoreBlocks(outBlocks, outIncrement, block0);
+            outBlocks = PtrAdd(outBlocks, 2*outIncrement);
+            VAES_StoreBlocks(outBlocks, outIncrement, block1);
+            outBlocks = PtrAdd(outBlocks, 2*outIncrement);
+            VAES_StoreBlocks(outBlocks, outIncrement, block2);
+            outBlocks = PtrAdd(outBlocks, 2*outIncrement);
+            VAES_StoreBlocks(outBlocks, outIncrement, block3);
+            outBlocks = PtrAdd(outBlocks, 2*outIncrement);
+
+            length -= 8*blockSize;
+        }
+
+        while (length >= 2*blockSize)
+        {
+            __m256i block;
+            if (isCounter)
+            {
+                block = _mm256_add_epi32(_mm256_broadcastsi128_si256(
+                    _mm_loadu_si128(CONST_M128_CAST(inBlocks))), s_one);
+                _mm_storeu_si128(M128_CAST(inBlocks), _mm256_castsi256_si128(
+                    _mm256_add_epi32(block, s_two)));
+            }
+            else
+            {
+                block = VAES_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 2*inIncrement);
+            }
+
+            if (xorInput)
+            {
+                block = _mm256_xor_si256(block, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+            }
+
+            func2(block, rk, r);
+
+            if (xorOutput)
+            {
+                block = _mm256_xor_si256(block, VAES_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 2*xorIncrement);
+            }
+
+            VAES_StoreBlocks(outBlocks, outIncrement, block);
+            outBlocks = PtrAdd(outBlocks, 2*outIncrement);
+
+            length -= 2*blockSize;
+        }
+    }
+
+    while (length >= blockSize)
+    {
+        __m128i block = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+
+        if (xorInput)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+
+        if (isCounter)
+            const_cast<byte *>(inBlocks)[15]++;
+
+        func1(block, rk, r);
+
+        if (xorOutput)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+
+        _mm_storeu_si128(M128_CAST(outBlocks), block);
+
+        inBlocks = PtrAdd(inBlocks, inIncrement);
+        outBlocks = PtrAdd(outBlocks, outIncrement);
+        xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+        length -= blockSize;
+    }
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return length;
+}
+
+// Multiplies the tweak by x in GF(2^128), little-endian bit order
+inline __m128i XTS_Double(const __m128i &t)
+{
+    const __m128i poly = _mm_set_epi32(1, 1, 1, 0x87);
+    __m128i m = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), _MM_SHUFFLE(2,1,0,3));
+    return _mm_xor_si128(_mm_add_epi32(t, t), _mm_and_si128(m, poly));
+}
+
+// Multiplies both tweaks by x^8. The byte shifted out of each lane
+// is folded back with one carryless multiply by x^7+x^2+x+1.
+inline __m256i XTS_Multiply8(const __m256i &t, const __m256i &poly)
+{
+    const __m256i c = _mm256_bsrli_epi128(t, 15);
+    return _mm256_xor_si256(_mm256_bslli_epi128(t, 1),
+        _mm256_clmulepi64_epi128(c, poly, 0x00));
+}
+
+template <typename F8>
+inline size_t VAES_XTS_ProcessBlocks(F8 func8, const word32 *subKeys, unsigned int rounds,
+        byte *tweak, const byte *inBlocks, byte *outBlocks, size_t length)
+{
+    const __m256i poly = _mm256_set1_epi64x(0x87);
+
+    VAES_Keys rk;
+    VAES_LoadKeys(rk, subKeys, rounds);
+
+    // Tweaks for blocks 0 through 7 of the group
+    __m128i t0 = _mm_loadu_si128(CONST_M128_CAST(tweak));
+    __m128i t1 = XTS_Double(t0), t2 = XTS_Double(t1), t3 = XTS_Double(t2);
+    __m128i t4 = XTS_Double(t3), t5 = XTS_Double(t4), t6 = XTS_Double(t5);
+    __m128i t7 = XTS_Double(t6);
+
+    __m256i tw0 = _mm256_inserti128_si256(_mm256_castsi128_si256(t0), t1, 1);
+    __m256i tw1 = _mm256_inserti128_si256(_mm256_castsi128_si256(t2), t3, 1);
+    __m256i tw2 = _mm256_inserti128_si256(_mm256_castsi128_si256(t4), t5, 1);
+    __m256i tw3 = _mm256_inserti128_si256(_mm256_castsi128_si256(t6), t7, 1);
+
+    while (length >= 128)
+    {
+        __m256i block0 = _mm256_xor_si256(tw0, _mm256_loadu_si256(CONST_M256_CAST(inBlocks+ 0)));
+        __m256i block1 = _mm256_xor_si256(tw1, _mm256_loadu_si256(CONST_M256_CAST(inBlocks+32)));
+        __m256i block2 = _mm256_xor_si256(tw2, _mm256_loadu_si256(CONST_M256_CAST(inBlocks+64)));
+        __m256i block3 = _mm256_xor_si256(tw3, _mm256_loadu_si256(CONST_M256_CAST(inBlocks+96)));
+
+        func8(block0, block1, block2, block3, rk, rounds);
+
+        _mm256_storeu_si256(M256_CAST(outBlocks+ 0), _mm256_xor_si256(block0, tw0));
+        _mm256_storeu_si256(M256_CAST(outBlocks+32), _mm256_xor_si256(block1, tw1));
+        _mm256_storeu_si256(M256_CAST(outBlocks+64), _mm256_xor_si256(block2, tw2));
+        _mm256_storeu_si256(M256_CAST(outBlocks+96), _mm256_xor_si256(block3, tw3));
+
+        tw0 = XTS_Multiply8(tw0, poly);
+        tw1 = XTS_Multiply8(tw1, poly);
+        tw2 = XTS_Multiply8(tw2, poly);
+        tw3 = XTS_Multiply8(tw3, poly);
+
+        inBlocks += 128;
+        outBlocks += 128;
+        length -= 128;
+    }
+
+    // The low lane of tw0 is the tweak for the next block
+    _mm_storeu_si128(M128_CAST(tweak), _mm256_castsi256_si128(tw0));
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return length;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Rijndael_Enc_AdvancedProcessBlocks_VAES(const word32 *subKeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return VAES_AdvancedProcessBlocks(VAES_Enc_Block, VAES_Enc_2_Blocks, VAES_Enc_8_Blocks,
+                subKeys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Rijndael_Dec_AdvancedProcessBlocks_VAES(const word32 *subKeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return VAES_AdvancedProcessBlocks(VAES_Dec_Block, VAES_Dec_2_Blocks, VAES_Dec_8_Blocks,
+                subKeys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Rijndael_XTS_ProcessBlocks_VAES(const word32 *subKeys, unsigned int rounds, byte *tweak,
+        const byte *inBlocks, byte *outBlocks, size_t length, bool encrypt)
+{
+    if (encrypt)
+        return VAES_XTS_ProcessBlocks(VAES_Enc_8_Blocks, subKeys, rounds, tweak, inBlocks, outBlocks, length);
+    else
+        return VAES_XTS_ProcessBlocks(VAES_Dec_8_Blocks, subKeys, rounds, tweak, inBlocks, outBlocks, length);
+}
+
+#endif  // CRYPTOPP_VAES_AVAILABLE
+
+NAMESPACE_END
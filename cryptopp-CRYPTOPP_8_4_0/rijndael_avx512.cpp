@@ -0,0 +1,460 @@
+// rijndael_avx512.cpp - written and placed in the public domain by
+//                       the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to VAES and
+//    VPCLMULQDQ on 512-bit registers. A separate source file is needed
+//    because additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations. The code is kept
+//    apart from rijndael_avx.cpp because some processors provide VAES
+//    without AVX-512, and the compiler may use AVX-512 encodings for
+//    any code in a source file built with -mavx512f.
+//
+//    A zmm register carries four blocks, and sixteen blocks are kept in
+//    flight. The XTS tweaks for a group are multiplied by x^16 with two
+//    64-bit shifts and one carryless multiply per register.
+
+#include "pch.h"
+#include "config.h"
+#include "cryptlib.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX512_AVAILABLE)
+# include <emmintrin.h>
+# include <smmintrin.h>
+# include <wmmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char RIJNDAEL_AVX512_FNAME[] = __FILE__;
+
+// GCC 12 warns about the undefined pass-through operand __Y in unmasked
+// AVX-512 intrinsics like _mm512_extracti32x4_epi32. The operand is
+// ignored by the instruction.
+#if CRYPTOPP_GCC_DIAGNOSTIC_AVAILABLE && !defined(__clang__)
+# pragma GCC diagnostic ignored "-Wuninitialized"
+# pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX512_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Round keys are broadcast to all four lanes once per call.
+// AES-256 uses 15 round keys.
+typedef __m512i AVX512_Keys[15];
+
+inline void AVX512_LoadKeys(AVX512_Keys rk, const word32 *subkeys, unsigned int rounds)
+{
+    for (unsigned int i=0; i<=rounds; ++i)
+        rk[i] = _mm512_broadcast_i32x4(_mm_loadu_si128(CONST_M128_CAST(subkeys+4*i)));
+}
+
+inline void AVX512_Enc_Block(__m128i &block, const AVX512_Keys rk, unsigned int rounds)
+{
+    block = _mm_xor_si128(block, _mm512_castsi512_si128(rk[0]));
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm_aesenc_si128(block, _mm512_castsi512_si128(rk[i]));
+    block = _mm_aesenclast_si128(block, _mm512_castsi512_si128(rk[rounds]));
+}
+
+inline void AVX512_Enc_4_Blocks(__m512i &block, const AVX512_Keys rk, unsigned int rounds)
+{
+    block = _mm512_xor_si512(block, rk[0]);
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm512_aesenc_epi128(block, rk[i]);
+    block = _mm512_aesenclast_epi128(block, rk[rounds]);
+}
+
+inline void AVX512_Enc_16_Blocks(__m512i &block0, __m512i &block1, __m512i &block2,
+                                 __m512i &block3, const AVX512_Keys rk, unsigned int rounds)
+{
+    // Work on copies so the blocks stay in registers when the
+    // function is not inlined through the function pointer
+    __m512i b0 = block0, b1 = block1, b2 = block2, b3 = block3;
+    __m512i k = rk[0];
+    b0 = _mm512_xor_si512(b0, k);
+    b1 = _mm512_xor_si512(b1, k);
+    b2 = _mm512_xor_si512(b2, k);
+    b3 = _mm512_xor_si512(b3, k);
+    for (unsigned int i=1; i<rounds; ++i)
+    {
+        k = rk[i];
+        b0 = _mm512_aesenc_epi128(b0, k);
+        b1 = _mm512_aesenc_epi128(b1, k);
+        b2 = _mm512_aesenc_epi128(b2, k);
+        b3 = _mm512_aesenc_epi128(b3, k);
+    }
+    k = rk[rounds];
+    b0 = _mm512_aesenclast_epi128(b0, k);
+    b1 = _mm512_aesenclast_epi128(b1, k);
+    b2 = _mm512_aesenclast_epi128(b2, k);
+    b3 = _mm512_aesenclast_epi128(b3, k);
+    block0 = b0; block1 = b1; block2 = b2; block3 = b3;
+}
+
+inline void AVX512_Dec_Block(__m128i &block, const AVX512_Keys rk, unsigned int rounds)
+{
+    block = _mm_xor_si128(block, _mm512_castsi512_si128(rk[0]));
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm_aesdec_si128(block, _mm512_castsi512_si128(rk[i]));
+    block = _mm_aesdeclast_si128(block, _mm512_castsi512_si128(rk[rounds]));
+}
+
+inline void AVX512_Dec_4_Blocks(__m512i &block, const AVX512_Keys rk, unsigned int rounds)
+{
+    block = _mm512_xor_si512(block, rk[0]);
+    for (unsigned int i=1; i<rounds; ++i)
+        block = _mm512_aesdec_epi128(block, rk[i]);
+    block = _mm512_aesdeclast_epi128(block, rk[rounds]);
+}
+
+inline void AVX512_Dec_16_Blocks(__m512i &block0, __m512i &block1, __m512i &block2,
+                                 __m512i &block3, const AVX512_Keys rk, unsigned int rounds)
+{
+    __m512i b0 = block0, b1 = block1, b2 = block2, b3 = block3;
+    __m512i k = rk[0];
+    b0 = _mm512_xor_si512(b0, k);
+    b1 = _mm512_xor_si512(b1, k);
+    b2 = _mm512_xor_si512(b2, k);
+    b3 = _mm512_xor_si512(b3, k);
+    for (unsigned int i=1; i<rounds; ++i)
+    {
+        k = rk[i];
+        b0 = _mm512_aesdec_epi128(b0, k);
+        b1 = _mm512_aesdec_epi128(b1, k);
+        b2 = _mm512_aesdec_epi128(b2, k);
+        b3 = _mm512_aesdec_epi128(b3, k);
+    }
+    k = rk[rounds];
+    b0 = _mm512_aesdeclast_epi128(b0, k);
+    b1 = _mm512_aesdeclast_epi128(b1, k);
+    b2 = _mm512_aesdeclast_epi128(b2, k);
+    b3 = _mm512_aesdeclast_epi128(b3, k);
+    block0 = b0; block1 = b1; block2 = b2; block3 = b3;
+}
+
+// Loads the blocks at ptr, ptr+inc, ptr+2*inc and ptr+3*inc into
+// lanes 0 through 3. inc is 16, 0-16 or 0 in AdvancedProcessBlocks.
+inline __m512i AVX512_LoadBlocks(const byte *ptr, size_t inc)
+{
+    if (inc == 16)
+        return _mm512_loadu_si512(ptr);
+    else if (inc == 0-static_cast<size_t>(16))
+        return _mm512_shuffle_i64x2(_mm512_loadu_si512(ptr-48),
+            _mm512_loadu_si512(ptr-48), _MM_SHUFFLE(0,1,2,3));
+    else
+    {
+        __m512i blocks = _mm512_castsi128_si512(_mm_loadu_si128(CONST_M128_CAST(ptr)));
+        blocks = _mm512_inserti32x4(blocks, _mm_loadu_si128(CONST_M128_CAST(ptr+inc)), 1);
+        blocks = _mm512_inserti32x4(blocks, _mm_loadu_si128(CONST_M128_CAST(ptr+2*inc)), 2);
+        return _mm512_inserti32x4(blocks, _mm_loadu_si128(CONST_M128_CAST(ptr+3*inc)), 3);
+    }
+}
+
+// Stores lanes 0 through 3 at ptr, ptr+inc, ptr+2*inc and ptr+3*inc, in that order
+inline void AVX512_StoreBlocks(byte *ptr, size_t inc, const __m512i &blocks)
+{
+    if (inc == 16)
+        _mm512_storeu_si512(ptr, blocks);
+    else if (inc == 0-static_cast<size_t>(16))
+        _mm512_storeu_si512(ptr-48, _mm512_shuffle_i64x2(blocks, blocks, _MM_SHUFFLE(0,1,2,3)));
+    else
+    {
+        _mm_storeu_si128(M128_CAST(ptr), _mm512_castsi512_si128(blocks));
+        _mm_storeu_si128(M128_CAST(ptr+inc), _mm512_extracti32x4_epi32(blocks, 1));
+        _mm_storeu_si128(M128_CAST(ptr+2*inc), _mm512_extracti32x4_epi32(blocks, 2));
+        _mm_storeu_si128(M128_CAST(ptr+3*inc), _mm512_extracti32x4_epi32(blocks, 3));
+    }
+}
+
+/// \brief AdvancedProcessBlocks for 4 and 1 blocks per zmm register
+/// \details AVX512_AdvancedProcessBlocks follows the semantics of
+///  AdvancedProcessBlocks128_4x1_SSE in adv_simd.h. It processes 16 blocks
+///  at a time in 4 zmm registers, then 4 blocks in 1 zmm register, and
+///  finally 1 block in a xmm register.
+template <typename F1, typename F4, typename F16>
+inline size_t AVX512_AdvancedProcessBlocks(F1 func1, F4 func4, F16 func16,
+        const word32 *subKeys, size_t rounds, const byte *inBlocks,
+        const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(subKeys);
+    CRYPTOPP_ASSERT(inBlocks);
+    CRYPTOPP_ASSERT(outBlocks);
+    CRYPTOPP_ASSERT(length >= 16);
+
+    const size_t blockSize = 16;
+    const unsigned int r = static_cast<unsigned int>(rounds);
+
+    size_t inIncrement = (flags & (BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_DontIncrementInOutPointers)) ? 0 : blockSize;
+    size_t xorIncrement = (xorBlocks != NULLPTR) ? blockSize : 0;
+    size_t outIncrement = (flags & BlockTransformation::BT_DontIncrementInOutPointers) ? 0 : blockSize;
+
+    // Clang and Coverity are generating findings using xorBlocks as a flag.
+    const bool xorInput = (xorBlocks != NULLPTR) && (flags & BlockTransformation::BT_XorInput);
+    const bool xorOutput = (xorBlocks != NULLPTR) && !(flags & BlockTransformation::BT_XorInput);
+    const bool isCounter = (flags & BlockTransformation::BT_InBlockIsCounter) != 0;
+
+    if (flags & BlockTransformation::BT_ReverseDirection)
+    {
+        inBlocks = PtrAdd(inBlocks, length - blockSize);
+        xorBlocks = PtrAdd(xorBlocks, length - blockSize);
+        outBlocks = PtrAdd(outBlocks, length - blockSize);
+        inIncrement = 0-inIncrement;
+        xorIncrement = 0-xorIncrement;
+        outIncrement = 0-outIncrement;
+    }
+
+    AVX512_Keys rk;
+    AVX512_LoadKeys(rk, subKeys, r);
+
+    if (flags & BlockTransformation::BT_AllowParallel)
+    {
+        // Increment of 1 in big-endian compatible with the ctr byte array.
+        const __m512i s_lanes = _mm512_set_epi32(3<<24, 0, 0, 0, 2<<24, 0, 0, 0, 1<<24, 0, 0, 0, 0, 0, 0, 0);
+        const __m512i s_four = _mm512_set_epi32(4<<24, 0, 0, 0, 4<<24, 0, 0, 0, 4<<24, 0, 0, 0, 4<<24, 0, 0, 0);
+
+        while (length >= 16*blockSize)
+        {
+            __m512i block0, block1, block2, block3;
+            if (isCounter)
+            {
+                block0 = _mm512_add_epi32(_mm512_broadcast_i32x4(
+                    _mm_loadu_si128(CONST_M128_CAST(inBlocks))), s_lanes);
+                block1 = _mm512_add_epi32(block0, s_four);
+                block2 = _mm512_add_epi32(block1, s_four);
+                block3 = _mm512_add_epi32(block2, s_four);
+                _mm_storeu_si128(M128_CAST(inBlocks), _mm512_castsi512_si128(
+                    _mm512_add_epi32(block3, s_four)));
+            }
+            else
+            {
+                block0 = AVX512_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 4*inIncrement);
+                block1 = AVX512_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 4*inIncrement);
+                block2 = AVX512_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 4*inIncrement);
+                block3 = AVX512_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 4*inIncrement);
+            }
+
+            if (xorInput)
+            {
+                block0 = _mm512_xor_si512(block0, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+                block1 = _mm512_xor_si512(block1, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+                block2 = _mm512_xor_si512(block2, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+                block3 = _mm512_xor_si512(block3, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+            }
+
+            func16(block0, block1, block2, block3, rk, r);
+
+            if (xorOutput)
+            {
+                block0 = _mm512_xor_si512(block0, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+                block1 = _mm512_xor_si512(block1, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+                block2 = _mm512_xor_si512(block2, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+                block3 = _mm512_xor_si512(block3, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+            }
+
+            AVX512_StoreBlocks(outBlocks, outIncrement, block0);
+            outBlocks = PtrAdd(outBlocks, 4*outIncrement);
+            AVX512_StoreBlocks(outBlocks, outIncrement, block1);
+            outBlocks = PtrAdd(outBlocks, 4*outIncrement);
+            AVX512_StoreBlocks(outBlocks, outIncrement, block2);
+            outBlocks = PtrAdd(outBlocks, 4*outIncrement);
+            AVX512_StoreBlocks(outBlocks, outIncrement, block3);
+            outBlocks = PtrAdd(outBlocks, 4*outIncrement);
+
+            length -= 16*blockSize;
+        }
+
+        while (length >= 4*blockSize)
+        {
+            __m512i block;
+            if (isCounter)
+            {
+                block = _mm512_add_epi32(_mm512_broadcast_i32x4(
+                    _mm_loadu_si128(CONST_M128_CAST(inBlocks))), s_lanes);
+                _mm_storeu_si128(M128_CAST(inBlocks), _mm512_castsi512_si128(
+                    _mm512_add_epi32(block, s_four)));
+            }
+            else
+            {
+                block = AVX512_LoadBlocks(inBlocks, inIncrement);
+                inBlocks = PtrAdd(inBlocks, 4*inIncrement);
+            }
+
+            if (xorInput)
+            {
+                block = _mm512_xor_si512(block, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+            }
+
+            func4(block, rk, r);
+
+            if (xorOutput)
+            {
+                block = _mm512_xor_si512(block, AVX512_LoadBlocks(xorBlocks, xorIncrement));
+                xorBlocks = PtrAdd(xorBlocks, 4*xorIncrement);
+            }
+
+            AVX512_StoreBlocks(outBlocks, outIncrement, block);
+            outBlocks = PtrAdd(outBlocks, 4*outIncrement);
+
+            length -= 4*blockSize;
+        }
+    }
+
+    while (length >= blockSize)
+    {
+        __m128i block = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+
+        if (xorInput)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+
+        if (isCounter)
+            const_cast<byte *>(inBlocks)[15]++;
+
+        func1(block, rk, r);
+
+        if (xorOutput)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+
+        _mm_storeu_si128(M128_CAST(outBlocks), block);
+
+        inBlocks = PtrAdd(inBlocks, inIncrement);
+        outBlocks = PtrAdd(outBlocks, outIncrement);
+        xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+        length -= blockSize;
+    }
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return length;
+}
+
+// Multiplies the tweak by x in GF(2^128), little-endian bit order
+inline __m128i XTS_Double(const __m128i &t)
+{
+    const __m128i poly = _mm_set_epi32(1, 1, 1, 0x87);
+    __m128i m = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), _MM_SHUFFLE(2,1,0,3));
+    return _mm_xor_si128(_mm_add_epi32(t, t), _mm_and_si128(m, poly));
+}
+
+// Multiplies the four tweaks by x^16. The 16 bits shifted out of
+// each lane are folded back with one carryless multiply by
+// x^7+x^2+x+1. AVX-512F lacks the 128-bit byte shifts, so the lane
+// is shifted as two 64-bit words.
+inline __m512i XTS_Multiply16(const __m512i &t, const __m512i &poly)
+{
+    const __m512i c = _mm512_srli_epi64(_mm512_shuffle_epi32(t, _MM_PERM_BADC), 48);
+    const __m512i u = _mm512_xor_si512(_mm512_slli_epi64(t, 16),
+        _mm512_unpackhi_epi64(_mm512_setzero_si512(), c));
+    return _mm512_xor_si512(u, _mm512_clmulepi64_epi128(c, poly, 0x00));
+}
+
+inline __m512i XTS_Combine(const __m128i &t0, const __m128i &t1, const __m128i &t2, const __m128i &t3)
+{
+    __m512i t = _mm512_castsi128_si512(t0);
+    t = _mm512_inserti32x4(t, t1, 1);
+    t = _mm512_inserti32x4(t, t2, 2);
+    return _mm512_inserti32x4(t, t3, 3);
+}
+
+template <typename F16>
+inline size_t AVX512_XTS_ProcessBlocks(F16 func16, const word32 *subKeys, unsigned int rounds,
+        byte *tweak, const byte *inBlocks, byte *outBlocks, size_t length)
+{
+    const __m512i poly = _mm512_set1_epi64(0x87);
+
+    AVX512_Keys rk;
+    AVX512_LoadKeys(rk, subKeys, rounds);
+
+    // Tweaks for blocks 0 through 15 of the group
+    __m128i t[16];
+    t[0] = _mm_loadu_si128(CONST_M128_CAST(tweak));
+    for (unsigned int i=1; i<16; ++i)
+        t[i] = XTS_Double(t[i-1]);
+
+    __m512i tw0 = XTS_Combine(t[ 0], t[ 1], t[ 2], t[ 3]);
+    __m512i tw1 = XTS_Combine(t[ 4], t[ 5], t[ 6], t[ 7]);
+    __m512i tw2 = XTS_Combine(t[ 8], t[ 9], t[10], t[11]);
+    __m512i tw3 = XTS_Combine(t[12], t[13], t[14], t[15]);
+
+    while (length >= 256)
+    {
+        __m512i block0 = _mm512_xor_si512(tw0, _mm512_loadu_si512(inBlocks+  0));
+        __m512i block1 = _mm512_xor_si512(tw1, _mm512_loadu_si512(inBlocks+ 64));
+        __m512i block2 = _mm512_xor_si512(tw2, _mm512_loadu_si512(inBlocks+128));
+        __m512i block3 = _mm512_xor_si512(tw3, _mm512_loadu_si512(inBlocks+192));
+
+        func16(block0, block1, block2, block3, rk, rounds);
+
+        _mm512_storeu_si512(outBlocks+  0, _mm512_xor_si512(block0, tw0));
+        _mm512_storeu_si512(outBlocks+ 64, _mm512_xor_si512(block1, tw1));
+        _mm512_storeu_si512(outBlocks+128, _mm512_xor_si512(block2, tw2));
+        _mm512_storeu_si512(outBlocks+192, _mm512_xor_si512(block3, tw3));
+
+        tw0 = XTS_Multiply16(tw0, poly);
+        tw1 = XTS_Multiply16(tw1, poly);
+        tw2 = XTS_Multiply16(tw2, poly);
+        tw3 = XTS_Multiply16(tw3, poly);
+
+        inBlocks += 256;
+        outBlocks += 256;
+        length -= 256;
+    }
+
+    // Lane 0 of tw0 is the tweak for the next block
+    _mm_storeu_si128(M128_CAST(tweak), _mm512_castsi512_si128(tw0));
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+
+    return length;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Rijndael_Enc_AdvancedProcessBlocks_AVX512(const word32 *subKeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AVX512_AdvancedProcessBlocks(AVX512_Enc_Block, AVX512_Enc_4_Blocks, AVX512_Enc_16_Blocks,
+                subKeys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Rijndael_Dec_AdvancedProcessBlocks_AVX512(const word32 *subKeys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AVX512_AdvancedProcessBlocks(AVX512_Dec_Block, AVX512_Dec_4_Blocks, AVX512_Dec_16_Blocks,
+                subKeys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Rijndael_XTS_ProcessBlocks_AVX512(const word32 *subKeys, unsigned int rounds, byte *tweak,
+        const byte *inBlocks, byte *outBlocks, size_t length, bool encrypt)
+{
+    if (encrypt)
+        return AVX512_XTS_ProcessBlocks(AVX512_Enc_16_Blocks, subKeys, rounds, tweak, inBlocks, outBlocks, length);
+    else
+        return AVX512_XTS_ProcessBlocks(AVX512_Dec_16_Blocks, subKeys, rounds, tweak, inBlocks, outBlocks, length);
+}
+
+#endif  // CRYPTOPP_AVX512_AVAILABLE
+
+NAMESPACE_END
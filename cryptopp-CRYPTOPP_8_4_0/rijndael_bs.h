@@ -0,0 +1,387 @@
+// rijndael_bs.h - written and placed in the public domain by
+//                  the Crypto++ project.
+//
+//    Private header for the bitsliced Rijndael kernels in
+//    rijndael_bs_ssse3.cpp and rijndael_bs_avx2.cpp.
+//
+//    Bitsliced AES after Kasper and Schwabe, "Faster and Timing-Attack
+//    Resistant AES-GCM". Eight registers hold the state of a group of
+//    blocks, register k holds bit k of every byte. SubBytes is the
+//    Boyar-Peralta circuit, ShiftRows and the column rotations in
+//    MixColumns are byte shuffles, and xtime is a permutation of the
+//    registers. There are no table lookups, so the code runs in
+//    constant time. The inverse S-box reuses the forward circuit
+//    between two inverse affine maps.
+//
+//    The templates only need the bitwise operators ^, & and ~ of the
+//    register type V, and the byte permutations ShiftRows,
+//    InvShiftRows, RotateRows1 and RotateRows2 found by argument
+//    dependent lookup.
+
+#ifndef CRYPTOPP_RIJNDAEL_BS_H
+#define CRYPTOPP_RIJNDAEL_BS_H
+
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+
+#include "adv_simd.h"
+#include <emmintrin.h>
+
+NAMESPACE_BEGIN(CryptoPP)
+NAMESPACE_BEGIN(RijndaelBitslice)
+
+// The AES S-box as a circuit of 113 gates, from Boyar and Peralta,
+// "A new combinational logic minimization technique with applications
+// to cryptology". q[0] is the least significant bit.
+template <class V>
+inline void SubBytes(V q[8])
+{
+    const V x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4];
+    const V x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+    // Top linear transformation
+    const V y14 = x3 ^ x5;
+    const V y13 = x0 ^ x6;
+    const V y9 = x0 ^ x3;
+    const V y8 = x0 ^ x5;
+    const V t0 = x1 ^ x2;
+    const V y1 = t0 ^ x7;
+    const V y4 = y1 ^ x3;
+    const V y12 = y13 ^ y14;
+    const V y2 = y1 ^ x0;
+    const V y5 = y1 ^ x6;
+    const V y3 = y5 ^ y8;
+    const V t1 = x4 ^ y12;
+    const V y15 = t1 ^ x5;
+    const V y20 = t1 ^ x1;
+    const V y6 = y15 ^ x7;
+    const V y10 = y15 ^ t0;
+    const V y11 = y20 ^ y9;
+    const V y7 = x7 ^ y11;
+    const V y17 = y10 ^ y11;
+    const V y19 = y10 ^ y8;
+    const V y16 = t0 ^ y11;
+    const V y21 = y13 ^ y16;
+    const V y18 = x0 ^ y16;
+
+    // Non-linear section
+    const V t2 = y12 & y15;
+    const V t3 = y3 & y6;
+    const V t4 = t3 ^ t2;
+    const V t5 = y4 & x7;
+    const V t6 = t5 ^ t2;
+    const V t7 = y13 & y16;
+    const V t8 = y5 & y1;
+    const V t9 = t8 ^ t7;
+    const V t10 = y2 & y7;
+    const V t11 = t10 ^ t7;
+    const V t12 = y9 & y11;
+    const V t13 = y14 & y17;
+    const V t14 = t13 ^ t12;
+    const V t15 = y8 & y10;
+    const V t16 = t15 ^ t12;
+    const V t17 = t4 ^ t14;
+    const V t18 = t6 ^ t16;
+    const V t19 = t9 ^ t14;
+    const V t20 = t11 ^ t16;
+    const V t21 = t17 ^ y20;
+    const V t22 = t18 ^ y19;
+    const V t23 = t19 ^ y21;
+    const V t24 = t20 ^ y18;
+
+    const V t25 = t21 ^ t22;
+    const V t26 = t21 & t23;
+    const V t27 = t24 ^ t26;
+    const V t28 = t25 & t27;
+    const V t29 = t28 ^ t22;
+    const V t30 = t23 ^ t24;
+    const V t31 = t22 ^ t26;
+    const V t32 = t31 & t30;
+    const V t33 = t32 ^ t24;
+    const V t34 = t23 ^ t33;
+    const V t35 = t27 ^ t33;
+    const V t36 = t24 & t35;
+    const V t37 = t36 ^ t34;
+    const V t38 = t27 ^ t36;
+    const V t39 = t29 & t38;
+    const V t40 = t25 ^ t39;
+
+    const V t41 = t40 ^ t37;
+    const V t42 = t29 ^ t33;
+    const V t43 = t29 ^ t40;
+    const V t44 = t33 ^ t37;
+    const V t45 = t42 ^ t41;
+    const V z0 = t44 & y15;
+    const V z1 = t37 & y6;
+    const V z2 = t33 & x7;
+    const V z3 = t43 & y16;
+    const V z4 = t40 & y1;
+    const V z5 = t29 & y7;
+    const V z6 = t42 & y11;
+    const V z7 = t45 & y17;
+    const V z8 = t41 & y10;
+    const V z9 = t44 & y12;
+    const V z10 = t37 & y3;
+    const V z11 = t33 & y4;
+    const V z12 = t43 & y13;
+    const V z13 = t40 & y5;
+    const V z14 = t29 & y2;
+    const V z15 = t42 & y9;
+    const V z16 = t45 & y14;
+    const V z17 = t41 & y8;
+
+    // Bottom linear transformation
+    const V t46 = z15 ^ z16;
+    const V t47 = z10 ^ z11;
+    const V t48 = z5 ^ z13;
+    const V t49 = z9 ^ z10;
+    const V t50 = z2 ^ z12;
+    const V t51 = z2 ^ z5;
+    const V t52 = z7 ^ z8;
+    const V t53 = z0 ^ z3;
+    const V t54 = z6 ^ z7;
+    const V t55 = z16 ^ z17;
+    const V t56 = z12 ^ t48;
+    const V t57 = t50 ^ t53;
+    const V t58 = z4 ^ t46;
+    const V t59 = z3 ^ t54;
+    const V t60 = t46 ^ t57;
+    const V t61 = z14 ^ t57;
+    const V t62 = t52 ^ t58;
+    const V t63 = t49 ^ t58;
+    const V t64 = z4 ^ t59;
+    const V t65 = t61 ^ t62;
+    const V t66 = z1 ^ t63;
+    const V t67 = t64 ^ t65;
+
+    const V s3 = t53 ^ t66;
+    q[7] = t59 ^ t63;
+    q[6] = ~(t64 ^ s3);
+    q[5] = ~(t55 ^ t67);
+    q[4] = s3;
+    q[3] = t51 ^ t66;
+    q[2] = t47 ^ t65;
+    q[1] = ~(t56 ^ t62);
+    q[0] = ~(t48 ^ t60);
+}
+
+// The inverse of the linear part of the AES affine map, followed by
+// the addition of 0x05
+template <class V>
+inline void InvAffine(V q[8])
+{
+    const V x0 = q[0], x1 = q[1], x2 = q[2], x3 = q[3];
+    const V x4 = q[4], x5 = q[5], x6 = q[6], x7 = q[7];
+
+    q[0] = ~(x2 ^ x5 ^ x7);
+    q[1] = x3 ^ x6 ^ x0;
+    q[2] = ~(x4 ^ x7 ^ x1);
+    q[3] = x5 ^ x0 ^ x2;
+    q[4] = x6 ^ x1 ^ x3;
+    q[5] = x7 ^ x2 ^ x4;
+    q[6] = x0 ^ x3 ^ x5;
+    q[7] = x1 ^ x4 ^ x6;
+}
+
+// SubBytes is Affine(Inverse(x)), so InvSubBytes is
+// InvAffine(SubBytes(InvAffine(x)))
+template <class V>
+inline void InvSubBytes(V q[8])
+{
+    InvAffine(q);
+    SubBytes(q);
+    InvAffine(q);
+}
+
+// Each output byte is 2*a[r] + 3*a[r+1] + a[r+2] + a[r+3], which is
+// xtime(a[r] + a[r+1]) + a[r+1] + a[r+2] + a[r+3]. xtime moves bit k to
+// bit k+1 and reduces bit 7 into bits 0, 1, 3 and 4.
+template <class V>
+inline void MixColumns(V q[8])
+{
+    V r[8], t[8];
+    for (unsigned int k=0; k<8; ++k)
+    {
+        r[k] = RotateRows1(q[k]);
+        t[k] = q[k] ^ r[k];
+    }
+
+    q[0] = t[7] ^ r[0] ^ RotateRows2(t[0]);
+    q[1] = t[0] ^ t[7] ^ r[1] ^ RotateRows2(t[1]);
+    q[2] = t[1] ^ r[2] ^ RotateRows2(t[2]);
+    q[3] = t[2] ^ t[7] ^ r[3] ^ RotateRows2(t[3]);
+    q[4] = t[3] ^ t[7] ^ r[4] ^ RotateRows2(t[4]);
+    q[5] = t[4] ^ r[5] ^ RotateRows2(t[5]);
+    q[6] = t[5] ^ r[6] ^ RotateRows2(t[6]);
+    q[7] = t[6] ^ r[7] ^ RotateRows2(t[7]);
+}
+
+// InvMixColumns is MixColumns after multiplying each column by
+// 5 + 4*x^2, that is a[r] + 4*(a[r] + a[r+2])
+template <class V>
+inline void InvMixColumns(V q[8])
+{
+    V u[8];
+    for (unsigned int k=0; k<8; ++k)
+        u[k] = q[k] ^ RotateRows2(q[k]);
+
+    q[0] = q[0] ^ u[6];
+    q[1] = q[1] ^ u[6] ^ u[7];
+    q[2] = q[2] ^ u[0] ^ u[7];
+    q[3] = q[3] ^ u[1] ^ u[6];
+    q[4] = q[4] ^ u[2] ^ u[6] ^ u[7];
+    q[5] = q[5] ^ u[3] ^ u[7];
+    q[6] = q[6] ^ u[4];
+    q[7] = q[7] ^ u[5];
+
+    MixColumns(q);
+}
+
+template <class V>
+inline void AddRoundKey(V q[8], const V *k)
+{
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = q[i] ^ k[i];
+}
+
+// The rounds of the cipher on bitsliced state. ShiftRows, InvShiftRows,
+// RotateRows1 and RotateRows2 are byte permutations of each register
+// provided by the caller for its register type.
+template <class V>
+inline void EncryptBlocks(V q[8], const V *keys, unsigned int rounds)
+{
+    AddRoundKey(q, keys);
+    for (unsigned int r=1; r<rounds; ++r)
+    {
+        SubBytes(q);
+        for (unsigned int i=0; i<8; ++i)
+            q[i] = ShiftRows(q[i]);
+        MixColumns(q);
+        AddRoundKey(q, keys+8*r);
+    }
+
+    SubBytes(q);
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = ShiftRows(q[i]);
+    AddRoundKey(q, keys+8*rounds);
+}
+
+// The equivalent inverse cipher. The decryption key schedule already
+// has InvMixColumns applied to the inner round keys.
+template <class V>
+inline void DecryptBlocks(V q[8], const V *keys, unsigned int rounds)
+{
+    AddRoundKey(q, keys);
+    for (unsigned int r=1; r<rounds; ++r)
+    {
+        InvSubBytes(q);
+        for (unsigned int i=0; i<8; ++i)
+            q[i] = InvShiftRows(q[i]);
+        InvMixColumns(q);
+        AddRoundKey(q, keys+8*r);
+    }
+
+    InvSubBytes(q);
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = InvShiftRows(q[i]);
+    AddRoundKey(q, keys+8*rounds);
+}
+
+// Same flags handling as AdvancedProcessBlocks128_8x1_SSE in adv_simd.h,
+// but funcN processes N blocks and a short tail is processed as one
+// partial group because a single block costs as much as N blocks.
+template <unsigned int N, typename FN, typename V>
+inline size_t AdvancedProcessBlocks128_Bitsliced(FN funcN, const V *keys, size_t rounds,
+        const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(keys);
+    CRYPTOPP_ASSERT(inBlocks);
+    CRYPTOPP_ASSERT(outBlocks);
+    CRYPTOPP_ASSERT(length >= 16);
+
+    const size_t blockSize = 16;
+
+    size_t inIncrement = (flags & (BT_InBlockIsCounter|BT_DontIncrementInOutPointers)) ? 0 : blockSize;
+    size_t xorIncrement = (xorBlocks != NULLPTR) ? blockSize : 0;
+    size_t outIncrement = (flags & BT_DontIncrementInOutPointers) ? 0 : blockSize;
+
+    // Clang and Coverity are generating findings using xorBlocks as a flag.
+    const bool xorInput = (xorBlocks != NULLPTR) && (flags & BT_XorInput);
+    const bool xorOutput = (xorBlocks != NULLPTR) && !(flags & BT_XorInput);
+
+    if (flags & BT_ReverseDirection)
+    {
+        inBlocks = PtrAdd(inBlocks, length - blockSize);
+        xorBlocks = PtrAdd(xorBlocks, length - blockSize);
+        outBlocks = PtrAdd(outBlocks, length - blockSize);
+        inIncrement = 0-inIncrement;
+        xorIncrement = 0-xorIncrement;
+        outIncrement = 0-outIncrement;
+    }
+
+    while (length >= blockSize)
+    {
+        const size_t count = STDMIN<size_t>(N, length/blockSize);
+        __m128i block[N];
+
+        if (flags & BT_InBlockIsCounter)
+        {
+            // Increment of 1 in big-endian compatible with the ctr byte array.
+            const __m128i s_one = _mm_set_epi32(1<<24, 0, 0, 0);
+            block[0] = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+            for (size_t i=1; i<count; ++i)
+                block[i] = _mm_add_epi32(block[i-1], s_one);
+            _mm_storeu_si128(M128_CAST(inBlocks), _mm_add_epi32(block[count-1], s_one));
+        }
+        else
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                block[i] = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+                inBlocks = PtrAdd(inBlocks, inIncrement);
+            }
+        }
+
+        for (size_t i=count; i<N; ++i)
+            block[i] = _mm_setzero_si128();
+
+        if (xorInput)
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                block[i] = _mm_xor_si128(block[i], _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+                xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+            }
+        }
+
+        funcN(block, keys, static_cast<unsigned int>(rounds));
+
+        if (xorOutput)
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                block[i] = _mm_xor_si128(block[i], _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+                xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+            }
+        }
+
+        for (size_t i=0; i<count; ++i)
+        {
+            _mm_storeu_si128(M128_CAST(outBlocks), block[i]);
+            outBlocks = PtrAdd(outBlocks, outIncrement);
+        }
+
+        length -= count*blockSize;
+    }
+
+    return length;
+}
+
+NAMESPACE_END  // RijndaelBitslice
+NAMESPACE_END  // CryptoPP
+
+#endif  // CRYPTOPP_SSSE3_AVAILABLE
+
+#endif  // CRYPTOPP_RIJNDAEL_BS_H
@@ -0,0 +1,216 @@
+// rijndael_bs_avx2.cpp - written and placed in the public domain by
+//                        the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    Bitsliced AES for processors without AES-NI. Sixteen blocks are
+//    transposed into eight ymm registers, eight blocks in each 128-bit
+//    lane. See rijndael_bs.h for the round functions.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+# include "rijndael_bs.h"
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char RIJNDAEL_BS_AVX2_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// One bit of every byte of sixteen blocks
+struct Plane
+{
+    Plane() {}
+    Plane(const __m256i &x) : v(x) {}
+
+    __m256i v;
+};
+
+inline Plane operator^(const Plane &x, const Plane &y)
+{
+    return _mm256_xor_si256(x.v, y.v);
+}
+
+inline Plane operator&(const Plane &x, const Plane &y)
+{
+    return _mm256_and_si256(x.v, y.v);
+}
+
+inline Plane operator~(const Plane &x)
+{
+    return _mm256_xor_si256(x.v, _mm256_set1_epi32(-1));
+}
+
+// Byte permutations of the AES state
+inline Plane ShiftRows(const Plane &x)
+{
+    return _mm256_shuffle_epi8(x.v, _mm256_setr_epi8(
+        0,5,10,15, 4,9,14,3, 8,13,2,7, 12,1,6,11,
+        0,5,10,15, 4,9,14,3, 8,13,2,7, 12,1,6,11));
+}
+
+inline Plane InvShiftRows(const Plane &x)
+{
+    return _mm256_shuffle_epi8(x.v, _mm256_setr_epi8(
+        0,13,10,7, 4,1,14,11, 8,5,2,15, 12,9,6,3,
+        0,13,10,7, 4,1,14,11, 8,5,2,15, 12,9,6,3));
+}
+
+// Row r of each column receives row r+1 or r+2
+inline Plane RotateRows1(const Plane &x)
+{
+    return _mm256_shuffle_epi8(x.v, _mm256_setr_epi8(
+        1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12,
+        1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12));
+}
+
+inline Plane RotateRows2(const Plane &x)
+{
+    return _mm256_shuffle_epi8(x.v, _mm256_setr_epi8(
+        2,3,0,1, 6,7,4,5, 10,11,8,9, 14,15,12,13,
+        2,3,0,1, 6,7,4,5, 10,11,8,9, 14,15,12,13));
+}
+
+template <unsigned int N>
+inline void SwapMove(Plane &a, Plane &b, const __m256i &m)
+{
+    const __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(a.v, N), b.v), m);
+    b.v = _mm256_xor_si256(b.v, t);
+    a.v = _mm256_xor_si256(a.v, _mm256_slli_epi64(t, N));
+}
+
+// Transposes the 8x8 bit matrix formed by byte p of x[0..7], for each
+// p in each lane. Afterwards x[k] holds bit k of byte p of block j in bit j of byte
+// p. Running the steps in reverse order undoes the transpose.
+inline void Bitslice(Plane x[8])
+{
+    const __m256i m1 = _mm256_set1_epi8(0x55);
+    const __m256i m2 = _mm256_set1_epi8(0x33);
+    const __m256i m4 = _mm256_set1_epi8(0x0f);
+
+    SwapMove<1>(x[0], x[1], m1); SwapMove<1>(x[2], x[3], m1);
+    SwapMove<1>(x[4], x[5], m1); SwapMove<1>(x[6], x[7], m1);
+    SwapMove<2>(x[0], x[2], m2); SwapMove<2>(x[1], x[3], m2);
+    SwapMove<2>(x[4], x[6], m2); SwapMove<2>(x[5], x[7], m2);
+    SwapMove<4>(x[0], x[4], m4); SwapMove<4>(x[1], x[5], m4);
+    SwapMove<4>(x[2], x[6], m4); SwapMove<4>(x[3], x[7], m4);
+}
+
+inline void Unbitslice(Plane x[8])
+{
+    const __m256i m1 = _mm256_set1_epi8(0x55);
+    const __m256i m2 = _mm256_set1_epi8(0x33);
+    const __m256i m4 = _mm256_set1_epi8(0x0f);
+
+    SwapMove<4>(x[0], x[4], m4); SwapMove<4>(x[1], x[5], m4);
+    SwapMove<4>(x[2], x[6], m4); SwapMove<4>(x[3], x[7], m4);
+    SwapMove<2>(x[0], x[2], m2); SwapMove<2>(x[1], x[3], m2);
+    SwapMove<2>(x[4], x[6], m2); SwapMove<2>(x[5], x[7], m2);
+    SwapMove<1>(x[0], x[1], m1); SwapMove<1>(x[2], x[3], m1);
+    SwapMove<1>(x[4], x[5], m1); SwapMove<1>(x[6], x[7], m1);
+}
+
+// Round key r is stored in the byte order of the table based code in
+// rijndael.cpp. The first and last round keys are in memory order and
+// the inner round keys are big-endian words. Each round key becomes
+// eight registers of 0x00 and 0xff bytes, one for each bit.
+inline void BitsliceRoundKeys(const word32 *subkeys, unsigned int rounds, Plane *keys)
+{
+    const __m128i swap = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+
+    for (unsigned int r=0; r<=rounds; ++r)
+    {
+        __m128i k = _mm_loadu_si128(CONST_M128_CAST(subkeys+4*r));
+        if (r != 0 && r != rounds)
+            k = _mm_shuffle_epi8(k, swap);
+        const __m256i kk = _mm256_broadcastsi128_si256(k);
+
+        for (unsigned int i=0; i<8; ++i)
+        {
+            const __m256i bit = _mm256_set1_epi8(static_cast<char>(1 << i));
+            keys[8*r+i] = _mm256_cmpeq_epi8(_mm256_and_si256(kk, bit), bit);
+        }
+    }
+}
+
+// Blocks i and i+8 share a register, one in each lane
+inline void Rijndael_Enc_16_Blocks(__m128i block[16], const Plane *keys, unsigned int rounds)
+{
+    Plane q[8];
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(block[i]), block[i+8], 1);
+
+    Bitslice(q);
+    RijndaelBitslice::EncryptBlocks(q, keys, rounds);
+    Unbitslice(q);
+
+    for (unsigned int i=0; i<8; ++i)
+    {
+        block[i] = _mm256_castsi256_si128(q[i].v);
+        block[i+8] = _mm256_extracti128_si256(q[i].v, 1);
+    }
+}
+
+// Blocks i and i+8 share a register, one in each lane
+inline void Rijndael_Dec_16_Blocks(__m128i block[16], const Plane *keys, unsigned int rounds)
+{
+    Plane q[8];
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(block[i]), block[i+8], 1);
+
+    Bitslice(q);
+    RijndaelBitslice::DecryptBlocks(q, keys, rounds);
+    Unbitslice(q);
+
+    for (unsigned int i=0; i<8; ++i)
+    {
+        block[i] = _mm256_castsi256_si128(q[i].v);
+        block[i+8] = _mm256_extracti128_si256(q[i].v, 1);
+    }
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Rijndael_Enc_AdvancedProcessBlocks_AVX2(const word32 *subKeys, size_t rounds,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(rounds <= 14);
+    Plane keys[15*8];
+    BitsliceRoundKeys(subKeys, static_cast<unsigned int>(rounds), keys);
+
+    length = RijndaelBitslice::AdvancedProcessBlocks128_Bitsliced<16>(Rijndael_Enc_16_Blocks,
+        keys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+
+    SecureWipeBuffer(reinterpret_cast<byte*>(keys), sizeof(keys));
+    return length;
+}
+
+size_t Rijndael_Dec_AdvancedProcessBlocks_AVX2(const word32 *subKeys, size_t rounds,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(rounds <= 14);
+    Plane keys[15*8];
+    BitsliceRoundKeys(subKeys, static_cast<unsigned int>(rounds), keys);
+
+    length = RijndaelBitslice::AdvancedProcessBlocks128_Bitsliced<16>(Rijndael_Dec_16_Blocks,
+        keys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+
+    SecureWipeBuffer(reinterpret_cast<byte*>(keys), sizeof(keys));
+    return length;
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END
@@ -0,0 +1,199 @@
+// rijndael_bs_ssse3.cpp - written and placed in the public domain by
+//                         the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to SSSE3
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    Bitsliced AES for processors without AES-NI. Eight blocks are
+//    transposed into eight xmm registers, see rijndael_bs.h for the
+//    round functions.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+# include "rijndael_bs.h"
+# include <emmintrin.h>
+# include <tmmintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char RIJNDAEL_BS_SSSE3_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// One bit of every byte of eight blocks
+struct Plane
+{
+    Plane() {}
+    Plane(const __m128i &x) : v(x) {}
+
+    __m128i v;
+};
+
+inline Plane operator^(const Plane &x, const Plane &y)
+{
+    return _mm_xor_si128(x.v, y.v);
+}
+
+inline Plane operator&(const Plane &x, const Plane &y)
+{
+    return _mm_and_si128(x.v, y.v);
+}
+
+inline Plane operator~(const Plane &x)
+{
+    return _mm_xor_si128(x.v, _mm_set1_epi32(-1));
+}
+
+// Byte permutations of the AES state
+inline Plane ShiftRows(const Plane &x)
+{
+    return _mm_shuffle_epi8(x.v, _mm_setr_epi8(0,5,10,15, 4,9,14,3, 8,13,2,7, 12,1,6,11));
+}
+
+inline Plane InvShiftRows(const Plane &x)
+{
+    return _mm_shuffle_epi8(x.v, _mm_setr_epi8(0,13,10,7, 4,1,14,11, 8,5,2,15, 12,9,6,3));
+}
+
+// Row r of each column receives row r+1 or r+2
+inline Plane RotateRows1(const Plane &x)
+{
+    return _mm_shuffle_epi8(x.v, _mm_setr_epi8(1,2,3,0, 5,6,7,4, 9,10,11,8, 13,14,15,12));
+}
+
+inline Plane RotateRows2(const Plane &x)
+{
+    return _mm_shuffle_epi8(x.v, _mm_setr_epi8(2,3,0,1, 6,7,4,5, 10,11,8,9, 14,15,12,13));
+}
+
+template <unsigned int N>
+inline void SwapMove(Plane &a, Plane &b, const __m128i &m)
+{
+    const __m128i t = _mm_and_si128(_mm_xor_si128(_mm_srli_epi64(a.v, N), b.v), m);
+    b.v = _mm_xor_si128(b.v, t);
+    a.v = _mm_xor_si128(a.v, _mm_slli_epi64(t, N));
+}
+
+// Transposes the 8x8 bit matrix formed by byte p of x[0..7], for each
+// p. Afterwards x[k] holds bit k of byte p of block j in bit j of byte
+// p. Running the steps in reverse order undoes the transpose.
+inline void Bitslice(Plane x[8])
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+
+    SwapMove<1>(x[0], x[1], m1); SwapMove<1>(x[2], x[3], m1);
+    SwapMove<1>(x[4], x[5], m1); SwapMove<1>(x[6], x[7], m1);
+    SwapMove<2>(x[0], x[2], m2); SwapMove<2>(x[1], x[3], m2);
+    SwapMove<2>(x[4], x[6], m2); SwapMove<2>(x[5], x[7], m2);
+    SwapMove<4>(x[0], x[4], m4); SwapMove<4>(x[1], x[5], m4);
+    SwapMove<4>(x[2], x[6], m4); SwapMove<4>(x[3], x[7], m4);
+}
+
+inline void Unbitslice(Plane x[8])
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+
+    SwapMove<4>(x[0], x[4], m4); SwapMove<4>(x[1], x[5], m4);
+    SwapMove<4>(x[2], x[6], m4); SwapMove<4>(x[3], x[7], m4);
+    SwapMove<2>(x[0], x[2], m2); SwapMove<2>(x[1], x[3], m2);
+    SwapMove<2>(x[4], x[6], m2); SwapMove<2>(x[5], x[7], m2);
+    SwapMove<1>(x[0], x[1], m1); SwapMove<1>(x[2], x[3], m1);
+    SwapMove<1>(x[4], x[5], m1); SwapMove<1>(x[6], x[7], m1);
+}
+
+// Round key r is stored in the byte order of the table based code in
+// rijndael.cpp. The first and last round keys are in memory order and
+// the inner round keys are big-endian words. Each round key becomes
+// eight registers of 0x00 and 0xff bytes, one for each bit.
+inline void BitsliceRoundKeys(const word32 *subkeys, unsigned int rounds, Plane *keys)
+{
+    const __m128i swap = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+
+    for (unsigned int r=0; r<=rounds; ++r)
+    {
+        __m128i k = _mm_loadu_si128(CONST_M128_CAST(subkeys+4*r));
+        if (r != 0 && r != rounds)
+            k = _mm_shuffle_epi8(k, swap);
+
+        for (unsigned int i=0; i<8; ++i)
+        {
+            const __m128i bit = _mm_set1_epi8(static_cast<char>(1 << i));
+            keys[8*r+i] = _mm_cmpeq_epi8(_mm_and_si128(k, bit), bit);
+        }
+    }
+}
+
+inline void Rijndael_Enc_8_Blocks(__m128i block[8], const Plane *keys, unsigned int rounds)
+{
+    Plane q[8];
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = block[i];
+
+    Bitslice(q);
+    RijndaelBitslice::EncryptBlocks(q, keys, rounds);
+    Unbitslice(q);
+
+    for (unsigned int i=0; i<8; ++i)
+        block[i] = q[i].v;
+}
+
+inline void Rijndael_Dec_8_Blocks(__m128i block[8], const Plane *keys, unsigned int rounds)
+{
+    Plane q[8];
+    for (unsigned int i=0; i<8; ++i)
+        q[i] = block[i];
+
+    Bitslice(q);
+    RijndaelBitslice::DecryptBlocks(q, keys, rounds);
+    Unbitslice(q);
+
+    for (unsigned int i=0; i<8; ++i)
+        block[i] = q[i].v;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Rijndael_Enc_AdvancedProcessBlocks_SSSE3(const word32 *subKeys, size_t rounds,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(rounds <= 14);
+    Plane keys[15*8];
+    BitsliceRoundKeys(subKeys, static_cast<unsigned int>(rounds), keys);
+
+    length = RijndaelBitslice::AdvancedProcessBlocks128_Bitsliced<8>(Rijndael_Enc_8_Blocks,
+        keys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+
+    SecureWipeBuffer(reinterpret_cast<byte*>(keys), sizeof(keys));
+    return length;
+}
+
+size_t Rijndael_Dec_AdvancedProcessBlocks_SSSE3(const word32 *subKeys, size_t rounds,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    CRYPTOPP_ASSERT(rounds <= 14);
+    Plane keys[15*8];
+    BitsliceRoundKeys(subKeys, static_cast<unsigned int>(rounds), keys);
+
+    length = RijndaelBitslice::AdvancedProcessBlocks128_Bitsliced<8>(Rijndael_Dec_8_Blocks,
+        keys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
+
+    SecureWipeBuffer(reinterpret_cast<byte*>(keys), sizeof(keys));
+    return length;
+}
+
+#endif  // CRYPTOPP_SSSE3_AVAILABLE
+
+NAMESPACE_END
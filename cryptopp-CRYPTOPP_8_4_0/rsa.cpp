@@ -111,6 +111,13 @@ public:
 	Integer m_e;
 };
 
+// Limit the number of primes so each one stays well out of reach of
+// the elliptic curve factoring method. Same limits as OpenSSL.
+static unsigned int RSAMaxPrimeCount(int modulusSize)
+{
+	return modulusSize < 1024 ? 2 : modulusSize < 4096 ? 3 : modulusSize < 8192 ? 4 : 5;
+}
+
 void InvertibleRSAFunction::GenerateRandom(RandomNumberGenerator &rng, const NameValuePairs &alg)
 {
 	int modulusSize = 2048;
@@ -126,18 +133,87 @@ void InvertibleRSAFunction::GenerateRandom(RandomNumberGenerator &rng, const Nam
 	if (m_e < 3 || m_e.IsEven())
 		throw InvalidArgument("InvertibleRSAFunction: invalid public exponent");
 
+	int primeCount = alg.GetIntValueWithDefault(Name::PrimeCount(), 2);
+
+	CRYPTOPP_ASSERT(primeCount >= 2);
+	if (primeCount < 2 || (unsigned int)primeCount > RSAMaxPrimeCount(modulusSize))
+		throw InvalidArgument("InvertibleRSAFunction: invalid number of primes for the modulus size");
+
+	// Threads search for all primes of the same size at once
+	int threadCount = alg.GetIntValueWithDefault(Name::ThreadCount(), 1);
+
+	CRYPTOPP_ASSERT(threadCount >= 0);
+	if (threadCount < 0)
+		throw InvalidArgument("InvertibleRSAFunction: invalid thread count");
+
 	RSAPrimeSelector selector(m_e);
-	AlgorithmParameters primeParam = MakeParametersForTwoPrimesOfEqualSize(modulusSize)
-		(Name::PointerToPrimeSelector(), selector.GetSelectorPointer());
-	m_p.GenerateRandom(rng, primeParam);
-	m_q.GenerateRandom(rng, primeParam);
+	m_otherPrimes.clear();
+
+	if (primeCount == 2)
+	{
+		AlgorithmParameters primeParam = MakeParametersForTwoPrimesOfEqualSize(modulusSize)
+			(Name::PointerToPrimeSelector(), selector.GetSelectorPointer());
+		Integer primes[2];
+		if (!GenerateRandomPrimes(rng, primes, 2, primeParam, threadCount))
+			throw Integer::RandomNumberNotFound();
+
+		m_p = primes[0];
+		m_q = primes[1];
+		m_d = m_e.InverseMod(LCM(m_p-1, m_q-1));
+		CRYPTOPP_ASSERT(m_d.IsPositive());
+
+		m_n = m_p * m_q;
+	}
+	else
+	{
+		// All but the last prime have modulusSize/primeCount bits with the
+		// top bits set. The last prime comes from the range that makes the
+		// modulus exactly modulusSize bits.
+		const unsigned int primeBits = modulusSize / primeCount;
+		AlgorithmParameters primeParam = MakeParameters("RandomNumberType", Integer::PRIME)
+			("Min", Integer(182) << (primeBits-8))("Max", Integer::Power2(primeBits)-1)
+			(Name::PointerToPrimeSelector(), selector.GetSelectorPointer());
+		std::vector<Integer> primes(primeCount);
+		if (!GenerateRandomPrimes(rng, &primes[0], primeCount-1, primeParam, threadCount))
+			throw Integer::RandomNumberNotFound();
+
+		Integer product = Integer::One(), lambda = Integer::One();
+		for (int i=0; i<primeCount-1; ++i)
+		{
+			product *= primes[i];
+			lambda = LCM(lambda, primes[i]-1);
+		}
+
+		const Integer minP = (Integer::Power2(modulusSize-1) + product - 1) / product;
+		const Integer maxP = (Integer::Power2(modulusSize) - 1) / product;
+		AlgorithmParameters lastParam = MakeParameters("RandomNumberType", Integer::PRIME)("Min", minP)("Max", maxP)
+			(Name::PointerToPrimeSelector(), selector.GetSelectorPointer());
+		do
+		{
+			if (!GenerateRandomPrimes(rng, &primes[primeCount-1], 1, lastParam, threadCount))
+				throw Integer::RandomNumberNotFound();
+		}
+		while (std::find(primes.begin(), primes.end()-1, primes.back()) != primes.end()-1);
+
+		product *= primes.back();
+		lambda = LCM(lambda, primes.back()-1);
 
-	m_d = m_e.InverseMod(LCM(m_p-1, m_q-1));
-	CRYPTOPP_ASSERT(m_d.IsPositive());
+		m_p = primes[0];
+		m_q = primes[1];
+		m_d = m_e.InverseMod(lambda);
+		CRYPTOPP_ASSERT(m_d.IsPositive());
+		m_n = product;
+
+		Integer r = m_p * m_q;
+		for (int i=2; i<primeCount; ++i)
+		{
+			m_otherPrimes.push_back(RSAOtherPrimeInfo(primes[i], m_d % (primes[i]-1), r.InverseMod(primes[i])));
+			r *= primes[i];
+		}
+	}
 
 	m_dp = m_d % (m_p-1);
 	m_dq = m_d % (m_q-1);
-	m_n = m_p * m_q;
 	m_u = m_q.InverseMod(m_p);
 
 	if (FIPS_140_2_ComplianceEnabled())
@@ -157,6 +233,12 @@ void InvertibleRSAFunction::Initialize(RandomNumberGenerator &rng, unsigned int
 	GenerateRandom(rng, MakeParameters(Name::ModulusSize(), (int)keybits)(Name::PublicExponent(), e+e.IsEven()));
 }
 
+void InvertibleRSAFunction::Initialize(RandomNumberGenerator &rng, unsigned int keybits, unsigned int primeCount, const Integer &e)
+{
+	GenerateRandom(rng, MakeParameters(Name::ModulusSize(), (int)keybits)(Name::PublicExponent(), e+e.IsEven())
+		(Name::PrimeCount(), (int)primeCount));
+}
+
 void InvertibleRSAFunction::Initialize(const Integer &n, const Integer &e, const Integer &d)
 {
 	if (n.IsEven() || e.IsEven() | d.IsEven())
@@ -165,6 +247,7 @@ void InvertibleRSAFunction::Initialize(const Integer &n, const Integer &e, const
 	m_n = n;
 	m_e = e;
 	m_d = d;
+	m_otherPrimes.clear();
 
 	Integer r = --(d*e);
 	unsigned int s = 0;
@@ -205,7 +288,7 @@ void InvertibleRSAFunction::BERDecodePrivateKey(BufferedTransformation &bt, bool
 {
 	BERSequenceDecoder privateKey(bt);
 		word32 version;
-		BERDecodeUnsigned<word32>(privateKey, version, INTEGER, 0, 0);	// check version
+		BERDecodeUnsigned<word32>(privateKey, version, INTEGER, 0, 1);	// check version
 		m_n.BERDecode(privateKey);
 		m_e.BERDecode(privateKey);
 		m_d.BERDecode(privateKey);
@@ -214,13 +297,30 @@ void InvertibleRSAFunction::BERDecodePrivateKey(BufferedTransformation &bt, bool
 		m_dp.BERDecode(privateKey);
 		m_dq.BERDecode(privateKey);
 		m_u.BERDecode(privateKey);
+		m_otherPrimes.clear();
+		if (version == 1)	// multi-prime, otherPrimeInfos has at least one entry
+		{
+			BERSequenceDecoder otherPrimeInfos(privateKey);
+			do
+			{
+				RSAOtherPrimeInfo info;
+				BERSequenceDecoder otherPrimeInfo(otherPrimeInfos);
+					info.prime.BERDecode(otherPrimeInfo);
+					info.exponent.BERDecode(otherPrimeInfo);
+					info.coefficient.BERDecode(otherPrimeInfo);
+				otherPrimeInfo.MessageEnd();
+				m_otherPrimes.push_back(info);
+			}
+			while (!otherPrimeInfos.EndReached());
+			otherPrimeInfos.MessageEnd();
+		}
 	privateKey.MessageEnd();
 }
 
 void InvertibleRSAFunction::DEREncodePrivateKey(BufferedTransformation &bt) const
 {
 	DERSequenceEncoder privateKey(bt);
-		DEREncodeUnsigned<word32>(privateKey, 0);	// version
+		DEREncodeUnsigned<word32>(privateKey, m_otherPrimes.empty() ? 0 : 1);	// version
 		m_n.DEREncode(privateKey);
 		m_e.DEREncode(privateKey);
 		m_d.DEREncode(privateKey);
@@ -229,29 +329,131 @@ void InvertibleRSAFunction::DEREncodePrivateKey(BufferedTransformation &bt) cons
 		m_dp.DEREncode(privateKey);
 		m_dq.DEREncode(privateKey);
 		m_u.DEREncode(privateKey);
+		if (!m_otherPrimes.empty())
+		{
+			DERSequenceEncoder otherPrimeInfos(privateKey);
+			for (size_t i=0; i<m_otherPrimes.size(); ++i)
+			{
+				DERSequenceEncoder otherPrimeInfo(otherPrimeInfos);
+					m_otherPrimes[i].prime.DEREncode(otherPrimeInfo);
+					m_otherPrimes[i].exponent.DEREncode(otherPrimeInfo);
+					m_otherPrimes[i].coefficient.DEREncode(otherPrimeInfo);
+				otherPrimeInfo.MessageEnd();
+			}
+			otherPrimeInfos.MessageEnd();
+		}
 	privateKey.MessageEnd();
 }
 
+// RFC 8017, Section 5.1.2, step 2.b. The exponentiations are independent
+// and run in parallel when OpenMP is available, like ModularRoot.
+static Integer MultiPrimeModularRoot(const Integer &c, const InvertibleRSAFunction &key)
+{
+	const std::vector<RSAOtherPrimeInfo> &others = key.GetOtherPrimeInfos();
+	const int count = 2 + (int)others.size();
+	std::vector<Integer> m(count);
+
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int i=0; i<count; ++i)
+	{
+		const Integer &r = i == 0 ? key.GetPrime1() : i == 1 ? key.GetPrime2() : others[i-2].prime;
+		const Integer &d = i == 0 ? key.GetModPrime1PrivateExponent() : i == 1 ? key.GetModPrime2PrivateExponent() : others[i-2].exponent;
+		m[i] = ModularExponentiation(c % r, d, r);
+	}
+
+	// u=q inverse mod p, so the order of p and q is reversed as in CalculateInverse
+	Integer y = CRT(m[1], key.GetPrime2(), m[0], key.GetPrime1(), key.GetMultiplicativeInverseOfPrime2ModPrime1());
+	Integer r = key.GetPrime1() * key.GetPrime2();
+	for (size_t i=0; i<others.size(); ++i)
+	{
+		const Integer &ri = others[i].prime;
+		y += r * ((m[i+2] - y % ri) * others[i].coefficient % ri);
+		r *= ri;
+	}
+	return y;
+}
+
 Integer InvertibleRSAFunction::CalculateInverse(RandomNumberGenerator &rng, const Integer &x) const
 {
 	DoQuickSanityCheck();
-	ModularArithmetic modn(m_n);
-	Integer r, rInv;
-	do {	// do this in a loop for people using small numbers for testing
-		r.Randomize(rng, Integer::One(), m_n - Integer::One());
-		rInv = modn.MultiplicativeInverse(r);
-	} while (rInv.IsZero());
-	Integer re = modn.Exponentiate(r, m_e);
-	re = modn.Multiply(re, x);			// blind
+
+	// An unreduced x fails the check below, so fail before the Montgomery
+	// multiplication which needs a reduced operand
+	if (x.IsNegative() || x >= m_n)
+		throw Exception(Exception::OTHER_ERROR, "InvertibleRSAFunction: computational error during private key operation");
+
+	Integer re, rInv;
+	m_blinding.Next(rng, m_n, m_e, re, rInv);
+
+	// The pair is in Montgomery form, so one Montgomery multiplication
+	// gives the product in the normal representation. The multiplication
+	// needs operands no wider than n, and a copy is sized to its value.
+	MontgomeryRepresentation modn(m_n);
+	re = modn.Multiply(re, Integer(x));			// blind
 	// here we follow the notation of PKCS #1 and let u=q inverse mod p
 	// but in ModRoot, u=p inverse mod q, so we reverse the order of p and q
-	Integer y = ModularRoot(re, m_dq, m_dp, m_q, m_p, m_u);
-	y = modn.Multiply(y, rInv);				// unblind
-	if (modn.Exponentiate(y, m_e) != x)		// check
+	Integer y = m_otherPrimes.empty() ? ModularRoot(re, m_dq, m_dp, m_q, m_p, m_u) : MultiPrimeModularRoot(re, *this);
+	y = modn.Multiply(Integer(y), rInv);			// unblind
+	if (a_exp_b_mod_c(y, m_e, m_n) != x)		// check
 		throw Exception(Exception::OTHER_ERROR, "InvertibleRSAFunction: computational error during private key operation");
 	return y;
 }
 
+InvertibleRSAFunction::Blinding& InvertibleRSAFunction::Blinding::operator=(const Blinding &other)
+{
+	CRYPTOPP_UNUSED(other);
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+	m_uses = 0;
+	return *this;
+}
+
+InvertibleRSAFunction::Blinding::~Blinding()
+{
+}
+
+// Squaring the pair gives (r^2)^e and (r^2)^-1, the standard way to
+// refresh blinding without a new inversion. A new r is drawn every
+// 32 uses to bound the life of any one value. Without a mutex the
+// pair is not cached and every call draws a new r.
+void InvertibleRSAFunction::Blinding::Next(RandomNumberGenerator &rng, const Integer &n, const Integer &e, Integer &re, Integer &rInv)
+{
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_uses > 0 && m_n == n && m_e == e)
+		{
+			re = m_re; rInv = m_rInv;
+			m_re = m_mont->Square(m_re);
+			m_rInv = m_mont->Square(m_rInv);
+			m_uses--;
+			return;
+		}
+	}
+#endif
+
+	// The inversion is done without holding the lock
+	member_ptr<MontgomeryRepresentation> mont(new MontgomeryRepresentation(n));
+	Integer r;
+	do {	// do this in a loop for people using small numbers for testing
+		r.Randomize(rng, Integer::One(), n - Integer::One());
+		rInv = mont->MultiplicativeInverse(mont->ConvertIn(r));
+	} while (rInv.IsZero());
+	re = mont->Exponentiate(mont->ConvertIn(r), e);
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_n = n; m_e = e;
+	m_re = mont->Square(re);
+	m_rInv = mont->Square(rInv);
+	m_mont.reset(mont.release());
+	m_uses = 31;
+#endif
+}
+
 bool InvertibleRSAFunction::Validate(RandomNumberGenerator &rng, unsigned int level) const
 {
 	bool pass = RSAFunction::Validate(rng, level);
@@ -268,11 +470,32 @@ bool InvertibleRSAFunction::Validate(RandomNumberGenerator &rng, unsigned int le
 	CRYPTOPP_ASSERT(pass);
 	pass = pass && m_u.IsPositive() && m_u < m_p;
 	CRYPTOPP_ASSERT(pass);
+	for (size_t i=0; pass && i<m_otherPrimes.size(); ++i)
+	{
+		const RSAOtherPrimeInfo &info = m_otherPrimes[i];
+		pass = pass && info.prime > Integer::One() && info.prime.IsOdd() && info.prime < m_n;
+		CRYPTOPP_ASSERT(pass);
+		pass = pass && info.exponent > Integer::One() && info.exponent.IsOdd() && info.exponent < info.prime;
+		CRYPTOPP_ASSERT(pass);
+		pass = pass && info.coefficient.IsPositive() && info.coefficient < info.prime;
+		CRYPTOPP_ASSERT(pass);
+	}
 	if (level >= 1)
 	{
-		pass = pass && m_p * m_q == m_n;
+		Integer product = m_p * m_q, lambda = LCM(m_p-1, m_q-1);
+		for (size_t i=0; pass && i<m_otherPrimes.size(); ++i)
+		{
+			const RSAOtherPrimeInfo &info = m_otherPrimes[i];
+			pass = pass && info.exponent == m_d%(info.prime-1);
+			CRYPTOPP_ASSERT(pass);
+			pass = pass && info.coefficient * product % info.prime == 1;
+			CRYPTOPP_ASSERT(pass);
+			product *= info.prime;
+			lambda = LCM(lambda, info.prime-1);
+		}
+		pass = pass && product == m_n;
 		CRYPTOPP_ASSERT(pass);
-		pass = pass && m_e*m_d % LCM(m_p-1, m_q-1) == 1;
+		pass = pass && m_e*m_d % lambda == 1;
 		CRYPTOPP_ASSERT(pass);
 		pass = pass && m_dp == m_d%(m_p-1) && m_dq == m_d%(m_q-1);
 		CRYPTOPP_ASSERT(pass);
@@ -283,6 +506,9 @@ bool InvertibleRSAFunction::Validate(RandomNumberGenerator &rng, unsigned int le
 	{
 		pass = pass && VerifyPrime(rng, m_p, level-2) && VerifyPrime(rng, m_q, level-2);
 		CRYPTOPP_ASSERT(pass);
+		for (size_t i=0; pass && i<m_otherPrimes.size(); ++i)
+			pass = pass && VerifyPrime(rng, m_otherPrimes[i].prime, level-2);
+		CRYPTOPP_ASSERT(pass);
 	}
 	return pass;
 }
@@ -301,6 +527,11 @@ bool InvertibleRSAFunction::GetVoidValue(const char *name, const std::type_info
 
 void InvertibleRSAFunction::AssignFrom(const NameValuePairs &source)
 {
+	if (source.GetThisObject(*this))
+		return;
+
+	// The named parameters describe a two-prime key
+	m_otherPrimes.clear();
 	AssignFromHelper<RSAFunction>(this, source)
 		CRYPTOPP_SET_FUNCTION_ENTRY(Prime1)
 		CRYPTOPP_SET_FUNCTION_ENTRY(Prime2)
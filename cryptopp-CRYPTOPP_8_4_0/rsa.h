@@ -15,6 +15,7 @@
 #include "oaep.h"
 #include "emsa2.h"
 #include "asn.h"
+#include "smartptr.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -57,7 +58,26 @@ protected:
 	Integer m_n, m_e;
 };
 
+/// \brief Additional prime of a multi-prime RSA key
+/// \details RSAOtherPrimeInfo holds one OtherPrimeInfo entry of a PKCS #1 v2.2
+///   (RFC 8017) private key. For the i-th prime <tt>r_i</tt>, i &gt; 2, the
+///   exponent is <tt>d mod (r_i-1)</tt> and the coefficient is
+///   <tt>(r_1*r_2*...*r_(i-1))^-1 mod r_i</tt>, where <tt>r_1=p</tt> and
+///   <tt>r_2=q</tt>.
+/// \since Crypto++ 8.5
+struct CRYPTOPP_DLL RSAOtherPrimeInfo
+{
+	RSAOtherPrimeInfo() {}
+	RSAOtherPrimeInfo(const Integer &prime, const Integer &exponent, const Integer &coefficient)
+		: prime(prime), exponent(exponent), coefficient(coefficient) {}
+
+	Integer prime, exponent, coefficient;
+};
+
 /// \brief RSA trapdoor function using the private key
+/// \details A private key may have more than two primes. The additional
+///   primes are kept as RFC 8017 OtherPrimeInfo entries, and
+///   CalculateInverse() uses one CRT exponentiation per prime.
 /// \since Crypto++ 1.0
 class CRYPTOPP_DLL InvertibleRSAFunction : public RSAFunction, public TrapdoorFunctionInverse, public PKCS8PrivateKey
 {
@@ -74,6 +94,17 @@ public:
 	///   then use one of the other Initialize() overloads.
 	void Initialize(RandomNumberGenerator &rng, unsigned int modulusBits, const Integer &e = 17);
 
+	/// \brief Create a multi-prime RSA private key
+	/// \param rng a RandomNumberGenerator derived class
+	/// \param modulusBits the size of the modulus, in bits
+	/// \param primeCount the number of primes
+	/// \param e the desired public exponent
+	/// \details The number of primes is limited by the modulus size: 2 below
+	///   1024 bits, 3 below 4096 bits, 4 below 8192 bits and 5 otherwise.
+	///   Initialize() throws InvalidArgument if primeCount exceeds the limit.
+	/// \since Crypto++ 8.5
+	void Initialize(RandomNumberGenerator &rng, unsigned int modulusBits, unsigned int primeCount, const Integer &e);
+
 	/// \brief Initialize a RSA private key
 	/// \param n modulus
 	/// \param e public exponent
@@ -85,7 +116,7 @@ public:
 	/// \param u q<sup>-1</sup> mod p
 	/// \details This Initialize() function overload initializes a private key from existing parameters.
 	void Initialize(const Integer &n, const Integer &e, const Integer &d, const Integer &p, const Integer &q, const Integer &dp, const Integer &dq, const Integer &u)
-		{m_n = n; m_e = e; m_d = d; m_p = p; m_q = q; m_dp = dp; m_dq = dq; m_u = u;}
+		{m_n = n; m_e = e; m_d = d; m_p = p; m_q = q; m_dp = dp; m_dq = dq; m_u = u; m_otherPrimes.clear();}
 
 	/// \brief Initialize a RSA private key
 	/// \param n modulus
@@ -109,11 +140,25 @@ public:
 	void DEREncodePrivateKey(BufferedTransformation &bt) const;
 
 	// TrapdoorFunctionInverse
+	/// \brief Calculates the inverse of an element
+	/// \param rng a RandomNumberGenerator derived class
+	/// \param x the element
+	/// \return the inverse of the element in the group
+	/// \details CalculateInverse() blinds x with a pair <tt>(r^e, r^-1)</tt>.
+	///   When the compiler provides C++11 synchronization, the pair is kept
+	///   with the key under a mutex and squared after each use, so most
+	///   calls need no random number, modular inversion or exponentiation
+	///   besides the two CRT exponentiations and the result check. A fresh
+	///   pair is drawn from rng every 32 uses and whenever n or e changes.
+	/// \details Without C++11 synchronization a fresh pair is drawn from rng
+	///   on every call and nothing is cached, so calls on the same object
+	///   do not share state.
 	Integer CalculateInverse(RandomNumberGenerator &rng, const Integer &x) const;
 
 	// GeneratableCryptoMaterial
 	bool Validate(RandomNumberGenerator &rng, unsigned int level) const;
-	// parameters: (ModulusSize, PublicExponent (default 17))
+	// parameters: (ModulusSize, PublicExponent (default 17), PrimeCount (default 2),
+	//   ThreadCount (default 1, 0 for one per processor))
 	void GenerateRandom(RandomNumberGenerator &rng, const NameValuePairs &alg);
 	bool GetVoidValue(const char *name, const std::type_info &valueType, void *pValue) const;
 	void AssignFrom(const NameValuePairs &source);
@@ -133,8 +178,48 @@ public:
 	void SetModPrime2PrivateExponent(const Integer &dq) {m_dq = dq;}
 	void SetMultiplicativeInverseOfPrime2ModPrime1(const Integer &u) {m_u = u;}
 
+	/// \brief Retrieve the number of primes
+	/// \return the number of prime factors of the modulus
+	/// \since Crypto++ 8.5
+	unsigned int GetPrimeCount() const {return 2 + (unsigned int)m_otherPrimes.size();}
+	/// \brief Retrieve the additional primes
+	/// \return the primes after p and q, empty for a two-prime key
+	/// \since Crypto++ 8.5
+	const std::vector<RSAOtherPrimeInfo>& GetOtherPrimeInfos() const {return m_otherPrimes;}
+	/// \brief Set the additional primes
+	/// \param infos the primes after p and q
+	/// \details The modulus, private exponent and the two-prime parameters
+	///   must be set to match by the caller.
+	/// \since Crypto++ 8.5
+	void SetOtherPrimeInfos(const std::vector<RSAOtherPrimeInfo> &infos) {m_otherPrimes = infos;}
+
 protected:
 	Integer m_d, m_p, m_q, m_dp, m_dq, m_u;
+	std::vector<RSAOtherPrimeInfo> m_otherPrimes;
+
+private:
+	// Blinding pair in Montgomery form. The pair is cached only when a
+	// mutex is available. Copies of the key start empty.
+	class Blinding
+	{
+	public:
+		Blinding() : m_uses(0) {}
+		Blinding(const Blinding &other) : m_uses(0) {CRYPTOPP_UNUSED(other);}
+		Blinding& operator=(const Blinding &other);
+		~Blinding();
+
+		void Next(RandomNumberGenerator &rng, const Integer &n, const Integer &e, Integer &re, Integer &rInv);
+
+	private:
+		member_ptr<MontgomeryRepresentation> m_mont;
+		Integer m_n, m_e, m_re, m_rInv;
+		unsigned int m_uses;
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+		std::mutex m_mutex;
+#endif
+	};
+
+	mutable Blinding m_blinding;
 };
 
 /// \brief RSA trapdoor function using the public key
@@ -40,6 +40,11 @@ ANONYMOUS_NAMESPACE_END
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if (CRYPTOPP_AVX2_AVAILABLE)
+extern void Salsa20_OperateKeystream_AVX2(const word32 *state, const byte* input, byte *output, unsigned int rounds);
+extern void HSalsa20_OperateKeystream_AVX2(const word32 *states, word32 *output, unsigned int rounds);
+#endif
+
 #if defined(CRYPTOPP_DEBUG) && !defined(CRYPTOPP_DOXYGEN_PROCESSING)
 void Salsa20_TestInstantiations()
 {
@@ -115,6 +120,11 @@ void Salsa20_Core(word32* data, unsigned int rounds)
 
 std::string Salsa20_Policy::AlgorithmProvider() const
 {
+#if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+		return "AVX2";
+	else
+#endif
 #if CRYPTOPP_SSE2_ASM_AVAILABLE && !defined(CRYPTOPP_DISABLE_SALSA_ASM)
 	if (HasSSE2())
 		return "SSE2";
@@ -174,6 +184,11 @@ unsigned int Salsa20_Policy::GetAlignment() const
 
 unsigned int Salsa20_Policy::GetOptimalBlockSize() const
 {
+#if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+		return 8*BYTES_PER_ITERATION;
+	else
+#endif
 #if CRYPTOPP_SSE2_ASM_AVAILABLE
 	if (HasSSE2())
 		return 4*BYTES_PER_ITERATION;
@@ -195,6 +210,29 @@ void Salsa20_OperateKeystream(byte *output, const byte *input, size_t iterationC
 
 void Salsa20_Policy::OperateKeystream(KeystreamOperation operation, byte *output, const byte *input, size_t iterationCount)
 {
+#if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+	{
+		while (iterationCount >= 8)
+		{
+			const bool xorInput = (operation & INPUT_NULL) != INPUT_NULL;
+			Salsa20_OperateKeystream_AVX2(m_state, xorInput ? input : NULLPTR, output, m_rounds);
+
+			// 64-bit block counter in m_state[8] and m_state[5]
+			m_state[8] += 8;
+			if (m_state[8] < 8)
+				++m_state[5];
+
+			input += (!!xorInput) * 8 * BYTES_PER_ITERATION;
+			output += 8 * BYTES_PER_ITERATION;
+			iterationCount -= 8;
+		}
+
+		if (iterationCount == 0)
+			return;
+	}
+#endif
+
 #endif	// #ifdef CRYPTOPP_GENERATE_X64_MASM
 
 #ifdef CRYPTOPP_X64_MASM_AVAILABLE
@@ -754,6 +792,88 @@ void XSalsa20_Policy::CipherResynchronize(byte *keystreamBuffer, const byte *IV,
 	m_state[8] = m_state[5] = 0;
 }
 
+void HSalsa20(byte *output, const byte *keys, const byte *nonces, size_t count, unsigned int rounds)
+{
+	CRYPTOPP_ASSERT(output != NULLPTR || count == 0);
+	CRYPTOPP_ASSERT(keys != NULLPTR || count == 0);
+	CRYPTOPP_ASSERT(nonces != NULLPTR || count == 0);
+
+	if (!(rounds == 8 || rounds == 12 || rounds == 20))
+		throw InvalidRounds(XSalsa20::StaticAlgorithmName(), rounds);
+
+	// Salsa20 matrices in the order of the specification
+	FixedSizeAlignedSecBlock<word32, 8*16> states;
+	FixedSizeAlignedSecBlock<word32, 8*8> subkeys;
+
+	while (count)
+	{
+		const size_t n = STDMIN<size_t>(count, 8);
+		for (size_t i=0; i<n; ++i)
+		{
+			word32 *x = states + 16*i;
+			GetBlock<word32, LittleEndian> getKey(keys + 32*i);
+			getKey(x[1])(x[2])(x[3])(x[4])(x[11])(x[12])(x[13])(x[14]);
+			GetBlock<word32, LittleEndian> getNonce(nonces + 16*i);
+			getNonce(x[6])(x[7])(x[8])(x[9]);
+
+			// "expand 32-byte k"
+			x[0] = 0x61707865; x[5] = 0x3320646e;
+			x[10] = 0x79622d32; x[15] = 0x6b206574;
+		}
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+		if (HasAVX2())
+		{
+			// A short group is padded with copies of the first matrix
+			for (size_t i=n; i<8; ++i)
+				std::memcpy(states + 16*i, states, 16*4);
+
+			HSalsa20_OperateKeystream_AVX2(states, subkeys, rounds);
+		}
+		else
+#endif
+		{
+			for (size_t i=0; i<n; ++i)
+			{
+				word32 x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+				const word32 *x = states + 16*i;
+
+				x0 = x[0];		x1 = x[1];		x2 = x[2];		x3 = x[3];
+				x4 = x[4];		x5 = x[5];		x6 = x[6];		x7 = x[7];
+				x8 = x[8];		x9 = x[9];		x10 = x[10];	x11 = x[11];
+				x12 = x[12];	x13 = x[13];	x14 = x[14];	x15 = x[15];
+
+				for (int j=static_cast<int>(rounds); j>0; j-=2)
+				{
+					QUARTER_ROUND(x0, x4, x8, x12)
+					QUARTER_ROUND(x5, x9, x13, x1)
+					QUARTER_ROUND(x10, x14, x2, x6)
+					QUARTER_ROUND(x15, x3, x7, x11)
+
+					QUARTER_ROUND(x0, x1, x2, x3)
+					QUARTER_ROUND(x5, x6, x7, x4)
+					QUARTER_ROUND(x10, x11, x8, x9)
+					QUARTER_ROUND(x15, x12, x13, x14)
+				}
+
+				word32 *y = subkeys + 8*i;
+				y[0] = x0;	y[1] = x5;	y[2] = x10;	y[3] = x15;
+				y[4] = x6;	y[5] = x7;	y[6] = x8;	y[7] = x9;
+			}
+		}
+
+		for (size_t i=0; i<n; ++i)
+		{
+			PutBlock<word32, LittleEndian> put(NULLPTR, output + 32*i);
+			const word32 *y = subkeys + 8*i;
+			put(y[0])(y[1])(y[2])(y[3])(y[4])(y[5])(y[6])(y[7]);
+		}
+
+		output += 32*n; keys += 32*n; nonces += 16*n;
+		count -= n;
+	}
+}
+
 NAMESPACE_END
 
 #endif // #ifndef CRYPTOPP_GENERATE_X64_MASM
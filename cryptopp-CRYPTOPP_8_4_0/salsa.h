@@ -26,6 +26,23 @@ NAMESPACE_BEGIN(CryptoPP)
 ///   Instead Salsa20_Core is provided with customary accelerations.
 void Salsa20_Core(word32* data, unsigned int rounds);
 
+/// \brief HSalsa20 key derivation
+/// \param output the derived keys
+/// \param keys the keys
+/// \param nonces the nonces
+/// \param count the number of keys to derive
+/// \param rounds the number of rounds
+/// \details HSalsa20 derives the XSalsa20 subkey from a 32-byte key and the
+///   first 16 bytes of the 24-byte nonce. XSalsa20 with the key and nonce is
+///   Salsa20 with the subkey and the last 8 bytes of the nonce.
+/// \details HSalsa20() derives count subkeys. keys holds count 32-byte keys,
+///   nonces holds count 16-byte nonces, and output receives count 32-byte
+///   subkeys. On machines with AVX2 eight subkeys are derived at once, which
+///   helps when setting up many XSalsa20 or NaCl secretbox keys.
+/// \throw InvalidRounds if rounds is not 8, 12 or 20
+/// \since Crypto++ 8.5
+void HSalsa20(byte *output, const byte *keys, const byte *nonces, size_t count, unsigned int rounds = 20);
+
 /// \brief Salsa20 stream cipher information
 struct Salsa20_Info : public VariableKeyLength<32, 16, 32, 16, SimpleKeyingInterface::UNIQUE_IV, 8>
 {
@@ -0,0 +1,191 @@
+// salsa_avx.cpp - written and placed in the public domain by
+//                 the Crypto++ project.
+//
+//    This source file uses intrinsics and built-ins to gain access to
+//    AVX2 instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The layout follows chacha_avx.cpp. Each register holds one word
+//    of the Salsa20 matrix from 8 blocks, so the quarter rounds need
+//    no shuffles. The words are transposed back into blocks at the end.
+
+#include "pch.h"
+#include "config.h"
+
+#include "salsa.h"
+#include "misc.h"
+
+#if defined(CRYPTOPP_AVX2_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char SALSA_AVX_FNAME[] = __FILE__;
+
+// The data is aligned, but Clang issues warning based on type
+// and not the actual alignment of the variable and data.
+#if CRYPTOPP_GCC_DIAGNOSTIC_AVAILABLE
+# pragma GCC diagnostic ignored "-Wcast-align"
+#endif
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+template <unsigned int R>
+inline __m256i RotateLeft(const __m256i val)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(val, R), _mm256_srli_epi32(val, 32-R));
+}
+
+// Quarter round on 8 blocks, the same as QUARTER_ROUND in salsa.cpp
+#define SALSA_QUARTER_ROUND_8(a,b,c,d) \
+    b = _mm256_xor_si256(b, RotateLeft< 7>(_mm256_add_epi32(a, d))); \
+    c = _mm256_xor_si256(c, RotateLeft< 9>(_mm256_add_epi32(b, a))); \
+    d = _mm256_xor_si256(d, RotateLeft<13>(_mm256_add_epi32(c, b))); \
+    a = _mm256_xor_si256(a, RotateLeft<18>(_mm256_add_epi32(d, c)));
+
+// x[i] is word i of the Salsa20 matrix in the order of the specification
+inline void SalsaRounds(__m256i x[16], unsigned int rounds)
+{
+    for (int i = static_cast<int>(rounds); i > 0; i -= 2)
+    {
+        SALSA_QUARTER_ROUND_8(x[ 0], x[ 4], x[ 8], x[12]);
+        SALSA_QUARTER_ROUND_8(x[ 5], x[ 9], x[13], x[ 1]);
+        SALSA_QUARTER_ROUND_8(x[10], x[14], x[ 2], x[ 6]);
+        SALSA_QUARTER_ROUND_8(x[15], x[ 3], x[ 7], x[11]);
+
+        SALSA_QUARTER_ROUND_8(x[ 0], x[ 1], x[ 2], x[ 3]);
+        SALSA_QUARTER_ROUND_8(x[ 5], x[ 6], x[ 7], x[ 4]);
+        SALSA_QUARTER_ROUND_8(x[10], x[11], x[ 8], x[ 9]);
+        SALSA_QUARTER_ROUND_8(x[15], x[12], x[13], x[14]);
+    }
+}
+
+// Transposes eight words of 8 blocks. On return x[i] holds the eight
+// words of block i.
+inline void Transpose8(__m256i x[8])
+{
+    const __m256i a0 = _mm256_unpacklo_epi32(x[0], x[1]);
+    const __m256i a1 = _mm256_unpackhi_epi32(x[0], x[1]);
+    const __m256i a2 = _mm256_unpacklo_epi32(x[2], x[3]);
+    const __m256i a3 = _mm256_unpackhi_epi32(x[2], x[3]);
+    const __m256i a4 = _mm256_unpacklo_epi32(x[4], x[5]);
+    const __m256i a5 = _mm256_unpackhi_epi32(x[4], x[5]);
+    const __m256i a6 = _mm256_unpacklo_epi32(x[6], x[7]);
+    const __m256i a7 = _mm256_unpackhi_epi32(x[6], x[7]);
+
+    // Blocks i and i+4 in the low and high lanes
+    const __m256i b0 = _mm256_unpacklo_epi64(a0, a2);
+    const __m256i b1 = _mm256_unpackhi_epi64(a0, a2);
+    const __m256i b2 = _mm256_unpacklo_epi64(a1, a3);
+    const __m256i b3 = _mm256_unpackhi_epi64(a1, a3);
+    const __m256i b4 = _mm256_unpacklo_epi64(a4, a6);
+    const __m256i b5 = _mm256_unpackhi_epi64(a4, a6);
+    const __m256i b6 = _mm256_unpacklo_epi64(a5, a7);
+    const __m256i b7 = _mm256_unpackhi_epi64(a5, a7);
+
+    x[0] = _mm256_permute2x128_si256(b0, b4, 0x20);
+    x[1] = _mm256_permute2x128_si256(b1, b5, 0x20);
+    x[2] = _mm256_permute2x128_si256(b2, b6, 0x20);
+    x[3] = _mm256_permute2x128_si256(b3, b7, 0x20);
+    x[4] = _mm256_permute2x128_si256(b0, b4, 0x31);
+    x[5] = _mm256_permute2x128_si256(b1, b5, 0x31);
+    x[6] = _mm256_permute2x128_si256(b2, b6, 0x31);
+    x[7] = _mm256_permute2x128_si256(b3, b7, 0x31);
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+// Produces 8 consecutive keystream blocks. state is Salsa20_Policy's
+// m_state, which is reordered for the SSE2 code. Word i of the Salsa20
+// matrix is state[order[i]], and the 64-bit block counter is state[8]
+// and state[5]. The caller advances the counter.
+void Salsa20_OperateKeystream_AVX2(const word32 *state, const byte* input, byte *output, unsigned int rounds)
+{
+    const unsigned int order[16] = {0,13,10,7, 4,1,14,11, 8,5,2,15, 12,9,6,3};
+
+    __m256i s[16], x[16];
+    for (unsigned int i=0; i<16; ++i)
+        s[i] = _mm256_set1_epi32(static_cast<int>(state[order[i]]));
+
+    // Add the block index to the low counter word and carry into the
+    // high word. The xor with the sign bit makes the compare unsigned.
+    const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000));
+    const __m256i low = _mm256_add_epi32(s[8], _mm256_set_epi32(7,6,5,4,3,2,1,0));
+    const __m256i carry = _mm256_cmpgt_epi32(
+        _mm256_xor_si256(s[8], sign), _mm256_xor_si256(low, sign));
+    s[9] = _mm256_sub_epi32(s[9], carry);
+    s[8] = low;
+
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = s[i];
+
+    SalsaRounds(x, rounds);
+
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = _mm256_add_epi32(x[i], s[i]);
+
+    Transpose8(x+0);
+    Transpose8(x+8);
+
+    if (input)
+    {
+        for (unsigned int i=0; i<8; ++i)
+        {
+            const __m256i m0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input+i*64+ 0));
+            const __m256i m1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input+i*64+32));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*64+ 0), _mm256_xor_si256(x[i], m0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*64+32), _mm256_xor_si256(x[8+i], m1));
+        }
+    }
+    else
+    {
+        for (unsigned int i=0; i<8; ++i)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*64+ 0), x[i]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*64+32), x[8+i]);
+        }
+    }
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+}
+
+// Runs HSalsa20 on 8 independent matrices. The matrices are consecutive,
+// 16 words each in the order of the specification. The 8 word results
+// are words 0, 5, 10, 15, 6, 7, 8 and 9 of each matrix after the rounds,
+// without the final addition.
+void HSalsa20_OperateKeystream_AVX2(const word32 *states, word32 *output, unsigned int rounds)
+{
+    const __m256i index = _mm256_set_epi32(112,96,80,64, 48,32,16,0);
+    const int* base = reinterpret_cast<const int*>(states);
+
+    __m256i x[16];
+    for (unsigned int i=0; i<16; ++i)
+        x[i] = _mm256_i32gather_epi32(base+i, index, 4);
+
+    SalsaRounds(x, rounds);
+
+    __m256i y[8] = {x[0], x[5], x[10], x[15], x[6], x[7], x[8], x[9]};
+    Transpose8(y);
+
+    for (unsigned int i=0; i<8; ++i)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output+i*8), y[i]);
+
+    // https://software.intel.com/en-us/articles/avoiding-avx-sse-transition-penalties
+    _mm256_zeroupper();
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END
@@ -5,11 +5,22 @@
 #include "serpent.h"
 #include "secblock.h"
 #include "misc.h"
+#include "cpu.h"
 
 #include "serpentp.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS
+# if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t Serpent_Enc_AdvancedProcessBlocks_AVX2(const word32 *subKeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Serpent_Dec_AdvancedProcessBlocks_AVX2(const word32 *subKeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+#endif  // CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS
+
 void Serpent_KeySchedule(word32 *k, unsigned int rounds, const byte *userKey, size_t keylen)
 {
 	FixedSizeSecBlock<word32, 8> k0;
@@ -122,4 +133,28 @@ start:
 	Block::Put(xorBlock, outBlock)(a)(d)(b)(e);
 }
 
+#if CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS
+size_t Serpent::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+		byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+		return Serpent_Enc_AdvancedProcessBlocks_AVX2(m_key,
+			inBlocks, xorBlocks, outBlocks, length, flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Serpent::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+		byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+		return Serpent_Dec_AdvancedProcessBlocks_AVX2(m_key,
+			inBlocks, xorBlocks, outBlocks, length, flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS
+
 NAMESPACE_END
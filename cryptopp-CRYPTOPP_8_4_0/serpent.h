@@ -11,6 +11,10 @@
 #include "seckey.h"
 #include "secblock.h"
 
+#if (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86)
+# define CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS 1
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 /// \brief Serpent block cipher information
@@ -24,6 +28,8 @@ struct Serpent_Info : public FixedBlockSize<16>, public VariableKeyLength<16, 16
 /// \sa <a href="http://www.cryptopp.com/wiki/Serpent">Serpent</a> on the
 ///  Crypto++ wiki, <a href="https://www.cl.cam.ac.uk/~rja14/serpent.html">A
 ///  Candidate Block Cipher for the Advanced Encryption Standard</a>
+/// \details Since Crypto++ 8.5 AdvancedProcessBlocks() processes eight blocks
+///  at a time with a bitsliced AVX2 kernel when the processor supports it.
 /// \since Crypto++ 3.1
 class Serpent : public Serpent_Info, public BlockCipherDocumentation
 {
@@ -47,6 +53,9 @@ class Serpent : public Serpent_Info, public BlockCipherDocumentation
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
 	};
 
 	/// \brief Serpent decryption transformation
@@ -57,6 +66,9 @@ class Serpent : public Serpent_Info, public BlockCipherDocumentation
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_SERPENT_ADVANCED_PROCESS_BLOCKS
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
 	};
 
 public:
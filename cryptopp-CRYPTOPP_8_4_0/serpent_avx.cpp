@@ -0,0 +1,259 @@
+// serpent_avx.cpp - written and placed in the public domain by
+//                   the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    Serpent was designed to be bitsliced. The kernel transposes eight
+//    blocks so that each ymm register holds one word of every block.
+//    The S-box and linear transformation macros in serpentp.h then run
+//    unchanged on Word8, a thin wrapper that provides the bitwise
+//    operators. The same code instantiated with word32 processes a
+//    single block.
+
+#include "pch.h"
+#include "config.h"
+
+#include "serpent.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+# include "adv_simd.h"
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+#include "serpentp.h"
+
+// Squash MS LNK4221 and libtool warnings
+extern const char SERPENT_AVX_FNAME[] = __FILE__;
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+NAMESPACE_BEGIN(CryptoPP)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::rotlConstant;
+using CryptoPP::rotrConstant;
+
+// Word i of eight blocks
+struct Word8
+{
+    Word8() {}
+    Word8(const __m256i &x) : v(x) {}
+
+    Word8& operator^=(const Word8 &x) {v = _mm256_xor_si256(v, x.v); return *this;}
+    Word8& operator&=(const Word8 &x) {v = _mm256_and_si256(v, x.v); return *this;}
+    Word8& operator|=(const Word8 &x) {v = _mm256_or_si256(v, x.v); return *this;}
+
+    // Subkey words are the same for all blocks
+    Word8& operator^=(word32 k)
+    {
+        v = _mm256_xor_si256(v, _mm256_set1_epi32(static_cast<int>(k)));
+        return *this;
+    }
+
+    __m256i v;
+};
+
+inline Word8 operator^(const Word8 &x, const Word8 &y)
+{
+    return _mm256_xor_si256(x.v, y.v);
+}
+
+inline Word8 operator~(const Word8 &x)
+{
+    return _mm256_xor_si256(x.v, _mm256_set1_epi32(-1));
+}
+
+inline Word8 operator<<(const Word8 &x, unsigned int n)
+{
+    return _mm256_slli_epi32(x.v, static_cast<int>(n));
+}
+
+template <unsigned int R>
+inline Word8 rotlConstant(const Word8 &x)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(x.v, R), _mm256_srli_epi32(x.v, 32-R));
+}
+
+template <unsigned int R>
+inline Word8 rotrConstant(const Word8 &x)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(x.v, R), _mm256_slli_epi32(x.v, 32-R));
+}
+
+// The round structure follows Serpent::Enc::ProcessAndXorBlock.
+// The result is in d, e, b, a.
+template <class W>
+inline void Serpent_Encrypt(W &a, W &b, W &c, W &d, W &e, const word32 *k)
+{
+    unsigned int i=1;
+
+    do
+    {
+        beforeS0(KX); beforeS0(S0); afterS0(LT);
+        afterS0(KX); afterS0(S1); afterS1(LT);
+        afterS1(KX); afterS1(S2); afterS2(LT);
+        afterS2(KX); afterS2(S3); afterS3(LT);
+        afterS3(KX); afterS3(S4); afterS4(LT);
+        afterS4(KX); afterS4(S5); afterS5(LT);
+        afterS5(KX); afterS5(S6); afterS6(LT);
+        afterS6(KX); afterS6(S7);
+
+        if (i == 4)
+            break;
+
+        ++i;
+        c = b;
+        b = e;
+        e = d;
+        d = a;
+        a = e;
+        k += 32;
+        beforeS0(LT);
+    }
+    while (true);
+
+    afterS7(KX);
+}
+
+// The round structure follows Serpent::Dec::ProcessAndXorBlock.
+// The result is in a, d, b, e.
+template <class W>
+inline void Serpent_Decrypt(W &a, W &b, W &c, W &d, W &e, const word32 *k)
+{
+    k += 96;
+    unsigned int i=4;
+
+    beforeI7(KX);
+    goto start;
+
+    do
+    {
+        c = b;
+        b = d;
+        d = e;
+        k -= 32;
+        beforeI7(ILT);
+start:
+                    beforeI7(I7); afterI7(KX);
+        afterI7(ILT); afterI7(I6); afterI6(KX);
+        afterI6(ILT); afterI6(I5); afterI5(KX);
+        afterI5(ILT); afterI5(I4); afterI4(KX);
+        afterI4(ILT); afterI4(I3); afterI3(KX);
+        afterI3(ILT); afterI3(I2); afterI2(KX);
+        afterI2(ILT); afterI2(I1); afterI1(KX);
+        afterI1(ILT); afterI1(I0); afterI0(KX);
+    }
+    while (--i != 0);
+}
+
+// Transposes the 4x4 word matrix in each lane. The transpose is its
+// own inverse, so it also turns the words back into blocks.
+inline void Transpose(__m256i &x0, __m256i &x1, __m256i &x2, __m256i &x3)
+{
+    const __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    const __m256i t1 = _mm256_unpackhi_epi32(x0, x1);
+    const __m256i t2 = _mm256_unpacklo_epi32(x2, x3);
+    const __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+
+    x0 = _mm256_unpacklo_epi64(t0, t2);
+    x1 = _mm256_unpackhi_epi64(t0, t2);
+    x2 = _mm256_unpacklo_epi64(t1, t3);
+    x3 = _mm256_unpackhi_epi64(t1, t3);
+}
+
+// Blocks i and i+4 share a register, one in each lane
+inline __m256i Combine(const __m128i &lo, const __m128i &hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+inline void Split(const __m256i &x, __m128i &lo, __m128i &hi)
+{
+    lo = _mm256_castsi256_si128(x);
+    hi = _mm256_extracti128_si256(x, 1);
+}
+
+inline void Serpent_Enc_Block(__m128i &block, const word32 *subkeys, unsigned int /*rounds*/)
+{
+    CRYPTOPP_ALIGN_DATA(16) word32 w[4];
+    _mm_store_si128(M128_CAST(w), block);
+
+    word32 a=w[0], b=w[1], c=w[2], d=w[3], e;
+    Serpent_Encrypt(a, b, c, d, e, subkeys);
+
+    block = _mm_set_epi32(static_cast<int>(a), static_cast<int>(b),
+                          static_cast<int>(e), static_cast<int>(d));
+}
+
+inline void Serpent_Dec_Block(__m128i &block, const word32 *subkeys, unsigned int /*rounds*/)
+{
+    CRYPTOPP_ALIGN_DATA(16) word32 w[4];
+    _mm_store_si128(M128_CAST(w), block);
+
+    word32 a=w[0], b=w[1], c=w[2], d=w[3], e=0;
+    Serpent_Decrypt(a, b, c, d, e, subkeys);
+
+    block = _mm_set_epi32(static_cast<int>(e), static_cast<int>(b),
+                          static_cast<int>(d), static_cast<int>(a));
+}
+
+inline void Serpent_Enc_8_Blocks(__m128i &block0, __m128i &block1, __m128i &block2,
+    __m128i &block3, __m128i &block4, __m128i &block5, __m128i &block6,
+    __m128i &block7, const word32 *subkeys, unsigned int /*rounds*/)
+{
+    __m256i x0 = Combine(block0, block4), x1 = Combine(block1, block5);
+    __m256i x2 = Combine(block2, block6), x3 = Combine(block3, block7);
+    Transpose(x0, x1, x2, x3);
+
+    Word8 a(x0), b(x1), c(x2), d(x3), e;
+    Serpent_Encrypt(a, b, c, d, e, subkeys);
+
+    x0 = d.v; x1 = e.v; x2 = b.v; x3 = a.v;
+    Transpose(x0, x1, x2, x3);
+    Split(x0, block0, block4); Split(x1, block1, block5);
+    Split(x2, block2, block6); Split(x3, block3, block7);
+}
+
+inline void Serpent_Dec_8_Blocks(__m128i &block0, __m128i &block1, __m128i &block2,
+    __m128i &block3, __m128i &block4, __m128i &block5, __m128i &block6,
+    __m128i &block7, const word32 *subkeys, unsigned int /*rounds*/)
+{
+    __m256i x0 = Combine(block0, block4), x1 = Combine(block1, block5);
+    __m256i x2 = Combine(block2, block6), x3 = Combine(block3, block7);
+    Transpose(x0, x1, x2, x3);
+
+    Word8 a(x0), b(x1), c(x2), d(x3), e(x3);
+    Serpent_Decrypt(a, b, c, d, e, subkeys);
+
+    x0 = a.v; x1 = d.v; x2 = b.v; x3 = e.v;
+    Transpose(x0, x1, x2, x3);
+    Split(x0, block0, block4); Split(x1, block1, block5);
+    Split(x2, block2, block6); Split(x3, block3, block7);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Serpent_Enc_AdvancedProcessBlocks_AVX2(const word32 *subKeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks128_8x1_SSE(Serpent_Enc_Block, Serpent_Enc_8_Blocks,
+        subKeys, 32, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Serpent_Dec_AdvancedProcessBlocks_AVX2(const word32 *subKeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks128_8x1_SSE(Serpent_Dec_Block, Serpent_Dec_8_Blocks,
+        subKeys, 32, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
@@ -1030,11 +1030,14 @@ bool Validate(int alg, bool thorough)
 	case 90: result = ValidateHashDRBG(); break;
 	case 91: result = ValidateHmacDRBG(); break;
 	case 92: result = ValidateNaCl(); break;
+	case 93: result = ValidateOCB(); break;
+	case 94: result = ValidateAEGIS(); break;
 
 	case 100: result = ValidateCHAM(); break;
 	case 101: result = ValidateSIMECK(); break;
 	case 102: result = ValidateSIMON(); break;
 	case 103: result = ValidateSPECK(); break;
+	case 104: result = ValidateThreefish(); break;
 
 	case 110: result = ValidateSHA3(); break;
 	case 111: result = ValidateSHAKE(); break;
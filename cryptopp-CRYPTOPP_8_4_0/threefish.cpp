@@ -9,6 +9,7 @@
 #include "misc.h"
 #include "algparam.h"
 #include "argnames.h"
+#include "cpu.h"
 
 ANONYMOUS_NAMESPACE_BEGIN
 
@@ -301,6 +302,47 @@ inline void IG1024(word64& G0, word64& G1, word64& G2, word64& G3, word64& G4, w
     IG1024B< 8, 17, 22, 37>(G8, G9, G10, G11, G12, G13, G14, G15); \
     IKS1024(r - 1);
 
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS)
+// Expands the key schedule for the SIMD kernels. Subkey s starts at
+// subkeys[s*words], and is added after every fourth round.
+void ExpandSubkeys(word64 *subkeys, const word64 *rkey, const word64 *tweak,
+    unsigned int words, unsigned int count)
+{
+    for (unsigned int s=0; s<count; ++s)
+    {
+        word64 *k = subkeys + s*words;
+        for (unsigned int i=0; i<words; ++i)
+            k[i] = rkey[(s + i) % (words + 1)];
+
+        k[words-3] += tweak[s % 3];
+        k[words-2] += tweak[(s + 1) % 3];
+        k[words-1] += s;
+    }
+}
+
+# if (CRYPTOPP_AVX2_AVAILABLE)
+// The AVX2 kernels process whole groups of four blocks. Moves the pointers
+// to the blocks that remain for the scalar code. In reverse the kernels
+// start at the last block, so the remaining blocks are at the front.
+void SkipProcessedBlocks(const CryptoPP::byte *&inBlocks, const CryptoPP::byte *&xorBlocks,
+    CryptoPP::byte *&outBlocks, size_t processed, word32 flags)
+{
+    using CryptoPP::BlockTransformation;
+    using CryptoPP::PtrAdd;
+
+    if (flags & BlockTransformation::BT_ReverseDirection)
+        return;
+
+    if (!(flags & (BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_DontIncrementInOutPointers)))
+        inBlocks = PtrAdd(inBlocks, processed);
+    if (xorBlocks)
+        xorBlocks = PtrAdd(xorBlocks, processed);
+    if (!(flags & BlockTransformation::BT_DontIncrementInOutPointers))
+        outBlocks = PtrAdd(outBlocks, processed);
+}
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+#endif
+
 ANONYMOUS_NAMESPACE_END
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -308,6 +350,28 @@ ANONYMOUS_NAMESPACE_END
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS)
+# if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t Threefish256_Enc_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Threefish256_Dec_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Threefish512_Enc_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Threefish512_Dec_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Threefish1024_Enc_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Threefish1024_Dec_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+#endif  // CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+
 void Threefish256::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLength, const NameValuePairs &params)
 {
     // Blocksize is Keylength for Threefish
@@ -320,6 +384,14 @@ void Threefish256::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLe
     m_rkey[4] = W64LIT(0x1BD11BDAA9FC1A22) ^ m_rkey[0] ^ m_rkey[1] ^ m_rkey[2] ^ m_rkey[3];
 
     SetTweak(params);
+
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS) && (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+    {
+        m_subkeys.New(19*4);
+        ExpandSubkeys(m_subkeys, m_rkey, m_tweak, 4, 19);
+    }
+#endif
 }
 
 void Threefish256::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
@@ -364,6 +436,49 @@ void Threefish256::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorB
     oblk(G0)(G1)(G2)(G3);
 }
 
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS)
+unsigned int Threefish256::Base::OptimalNumberOfParallelBlocks() const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+        return 4;
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return 1;
+}
+
+size_t Threefish256::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+        byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    // Serial modes like CBC encryption stay on the scalar code
+    if ((flags & BT_AllowParallel) && length >= 4*BLOCKSIZE && HasAVX2())
+    {
+        const size_t remaining = Threefish256_Enc_AdvancedProcessBlocks_AVX2(m_subkeys,
+            inBlocks, xorBlocks, outBlocks, length, flags);
+        SkipProcessedBlocks(inBlocks, xorBlocks, outBlocks, length-remaining, flags);
+        length = remaining;
+    }
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish256::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+        byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    // Serial modes like CBC encryption stay on the scalar code
+    if ((flags & BT_AllowParallel) && length >= 4*BLOCKSIZE && HasAVX2())
+    {
+        const size_t remaining = Threefish256_Dec_AdvancedProcessBlocks_AVX2(m_subkeys,
+            inBlocks, xorBlocks, outBlocks, length, flags);
+        SkipProcessedBlocks(inBlocks, xorBlocks, outBlocks, length-remaining, flags);
+        length = remaining;
+    }
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+
 /////////////////////////////////////////////////////////////////
 
 void Threefish512::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLength, const NameValuePairs &params)
@@ -379,6 +494,14 @@ void Threefish512::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLe
         m_rkey[4] ^ m_rkey[5] ^ m_rkey[6] ^ m_rkey[7];
 
     SetTweak(params);
+
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS) && (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+    {
+        m_subkeys.New(19*8);
+        ExpandSubkeys(m_subkeys, m_rkey, m_tweak, 8, 19);
+    }
+#endif
 }
 
 void Threefish512::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
@@ -428,6 +551,49 @@ void Threefish512::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorB
     oblk(G0)(G1)(G2)(G3)(G4)(G5)(G6)(G7);
 }
 
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS)
+unsigned int Threefish512::Base::OptimalNumberOfParallelBlocks() const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+        return 4;
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return 1;
+}
+
+size_t Threefish512::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+        byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    // Serial modes like CBC encryption stay on the scalar code
+    if ((flags & BT_AllowParallel) && length >= 4*BLOCKSIZE && HasAVX2())
+    {
+        const size_t remaining = Threefish512_Enc_AdvancedProcessBlocks_AVX2(m_subkeys,
+            inBlocks, xorBlocks, outBlocks, length, flags);
+        SkipProcessedBlocks(inBlocks, xorBlocks, outBlocks, length-remaining, flags);
+        length = remaining;
+    }
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish512::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+        byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    // Serial modes like CBC encryption stay on the scalar code
+    if ((flags & BT_AllowParallel) && length >= 4*BLOCKSIZE && HasAVX2())
+    {
+        const size_t remaining = Threefish512_Dec_AdvancedProcessBlocks_AVX2(m_subkeys,
+            inBlocks, xorBlocks, outBlocks, length, flags);
+        SkipProcessedBlocks(inBlocks, xorBlocks, outBlocks, length-remaining, flags);
+        length = remaining;
+    }
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+
 /////////////////////////////////////////////////////////////////
 
 void Threefish1024::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLength, const NameValuePairs &params)
@@ -444,6 +610,14 @@ void Threefish1024::Base::UncheckedSetKey(const byte *userKey, unsigned int keyL
         m_rkey[13] ^ m_rkey[14] ^ m_rkey[15];
 
     SetTweak(params);
+
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS) && (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+    {
+        m_subkeys.New(21*16);
+        ExpandSubkeys(m_subkeys, m_rkey, m_tweak, 16, 21);
+    }
+#endif
 }
 
 void Threefish1024::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
@@ -500,4 +674,47 @@ void Threefish1024::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xor
     oblk(G0)(G1)(G2)(G3)(G4)(G5)(G6)(G7)(G8)(G9)(G10)(G11)(G12)(G13)(G14)(G15);
 }
 
+#if (CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS)
+unsigned int Threefish1024::Base::OptimalNumberOfParallelBlocks() const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+        return 4;
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return 1;
+}
+
+size_t Threefish1024::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+        byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    // Serial modes like CBC encryption stay on the scalar code
+    if ((flags & BT_AllowParallel) && length >= 4*BLOCKSIZE && HasAVX2())
+    {
+        const size_t remaining = Threefish1024_Enc_AdvancedProcessBlocks_AVX2(m_subkeys,
+            inBlocks, xorBlocks, outBlocks, length, flags);
+        SkipProcessedBlocks(inBlocks, xorBlocks, outBlocks, length-remaining, flags);
+        length = remaining;
+    }
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish1024::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+        byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+    // Serial modes like CBC encryption stay on the scalar code
+    if ((flags & BT_AllowParallel) && length >= 4*BLOCKSIZE && HasAVX2())
+    {
+        const size_t remaining = Threefish1024_Dec_AdvancedProcessBlocks_AVX2(m_subkeys,
+            inBlocks, xorBlocks, outBlocks, length, flags);
+        SkipProcessedBlocks(inBlocks, xorBlocks, outBlocks, length-remaining, flags);
+        length = remaining;
+    }
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+    return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+
 NAMESPACE_END
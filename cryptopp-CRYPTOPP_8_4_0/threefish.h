@@ -16,6 +16,10 @@
 #include "argnames.h"
 #include "stdcpp.h"
 
+#if (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86)
+# define CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS 1
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 /// \brief Threefish block cipher information
@@ -62,11 +66,14 @@ struct CRYPTOPP_NO_VTABLE Threefish_Base
     mutable AlignedSecBlock64 m_wspace;   // workspace
     AlignedSecBlock64         m_rkey;     // keys
     AlignedSecBlock64         m_tweak;
+    AlignedSecBlock64         m_subkeys;  // expanded subkeys for AdvancedProcessBlocks
 };
 
 /// \brief Threefish 256-bit block cipher
 /// \details Threefish256 provides 256-bit block size. The valid key size is 256-bit.
 /// \note Crypto++ provides a byte oriented implementation
+/// \details Since Crypto++ 8.5 AdvancedProcessBlocks() processes four blocks at a
+///   time with AVX2 when the processor supports it.
 /// \sa Threefish512, Threefish1024, <a href="http://www.cryptopp.com/wiki/Threefish">Threefish</a>
 /// \since Crypto++ 6.0
 class CRYPTOPP_NO_VTABLE Threefish256 : public Threefish_Info<32>, public BlockCipherDocumentation
@@ -77,6 +84,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Base : public Threefish_Base<32>, public BlockCipherImpl<Threefish_Info<32> >
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        unsigned int OptimalNumberOfParallelBlocks() const;
+#endif
+
     protected:
         void UncheckedSetKey(const byte *userKey, unsigned int keyLength, const NameValuePairs &params);
     };
@@ -87,6 +99,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Enc : public Base
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
+
     protected:
         void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
     };
@@ -97,6 +114,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Dec : public Base
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
+
     protected:
         void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
     };
@@ -111,6 +133,8 @@ typedef Threefish256::Decryption Threefish256Decryption;
 /// \brief Threefish 512-bit block cipher
 /// \details Threefish512 provides 512-bit block size. The valid key size is 512-bit.
 /// \note Crypto++ provides a byte oriented implementation
+/// \details Since Crypto++ 8.5 AdvancedProcessBlocks() processes four blocks at a
+///   time with AVX2 when the processor supports it.
 /// \sa Threefish256, Threefish1024, <a href="http://www.cryptopp.com/wiki/Threefish">Threefish</a>
 /// \since Crypto++ 6.0
 class CRYPTOPP_NO_VTABLE Threefish512 : public Threefish_Info<64>, public BlockCipherDocumentation
@@ -121,6 +145,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Base : public Threefish_Base<64>, public BlockCipherImpl<Threefish_Info<64> >
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        unsigned int OptimalNumberOfParallelBlocks() const;
+#endif
+
     protected:
         void UncheckedSetKey(const byte *userKey, unsigned int keyLength, const NameValuePairs &params);
     };
@@ -131,6 +160,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Enc : public Base
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
+
     protected:
         void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
     };
@@ -141,6 +175,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Dec : public Base
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
+
     protected:
         void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
     };
@@ -155,6 +194,8 @@ typedef Threefish512::Decryption Threefish512Decryption;
 /// \brief Threefish 1024-bit block cipher
 /// \details Threefish1024 provides 1024-bit block size. The valid key size is 1024-bit.
 /// \note Crypto++ provides a byte oriented implementation
+/// \details Since Crypto++ 8.5 AdvancedProcessBlocks() processes four blocks at a
+///   time with AVX2 when the processor supports it.
 /// \sa Threefish256, Threefish512, <a href="http://www.cryptopp.com/wiki/Threefish">Threefish</a>
 /// \since Crypto++ 6.0
 class CRYPTOPP_NO_VTABLE Threefish1024 : public Threefish_Info<128>, public BlockCipherDocumentation
@@ -165,6 +206,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Base : public Threefish_Base<128>, public BlockCipherImpl<Threefish_Info<128> >
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        unsigned int OptimalNumberOfParallelBlocks() const;
+#endif
+
     protected:
         void UncheckedSetKey(const byte *userKey, unsigned int keyLength, const NameValuePairs &params);
     };
@@ -175,6 +221,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Enc : public Base
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
+
     protected:
         void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
     };
@@ -185,6 +236,11 @@ public:
     /// \since Crypto++ 6.0
     class CRYPTOPP_NO_VTABLE Dec : public Base
     {
+    public:
+#if CRYPTOPP_THREEFISH_ADVANCED_PROCESS_BLOCKS
+        size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
+
     protected:
         void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
     };
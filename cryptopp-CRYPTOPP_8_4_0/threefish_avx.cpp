@@ -0,0 +1,481 @@
+// threefish_avx.cpp - written and placed in the public domain by
+//                     the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernels process four blocks at a time. Each ymm register holds
+//    one word of the four blocks, so the MIX and permute steps of the
+//    scalar code map one to one onto 64-bit lane operations. Rotates by
+//    a multiple of 8 use a byte shuffle, and the others a pair of shifts.
+//    The subkeys are expanded once at key setup and broadcast from memory.
+
+#include "pch.h"
+#include "config.h"
+
+#include "threefish.h"
+#include "misc.h"
+
+#if defined(CRYPTOPP_AVX2_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char THREEFISH_AVX_FNAME[] = __FILE__;
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M256_CAST(x) ((__m256i *)(void *)(x))
+#define CONST_M256_CAST(x) ((const __m256i *)(const void *)(x))
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word32;
+using CryptoPP::word64;
+
+// Byte shuffle for a rotate left by K bytes within each 64-bit lane.
+// The mask is a compile time constant so the shuffle stays inline.
+template <unsigned int K>
+struct RotateMask
+{
+#define ROTATE_MASK_BYTE(i) (word64(((i) + 8 - K) & 7) << (8*(i)))
+    static const word64 value =
+        ROTATE_MASK_BYTE(0) | ROTATE_MASK_BYTE(1) | ROTATE_MASK_BYTE(2) | ROTATE_MASK_BYTE(3) |
+        ROTATE_MASK_BYTE(4) | ROTATE_MASK_BYTE(5) | ROTATE_MASK_BYTE(6) | ROTATE_MASK_BYTE(7);
+#undef ROTATE_MASK_BYTE
+};
+
+template <unsigned int R>
+inline __m256i RotL64(const __m256i &x)
+{
+    if (R % 8 == 0)
+    {
+        const long long lo = static_cast<long long>(RotateMask<R/8>::value);
+        const long long hi = static_cast<long long>(RotateMask<R/8>::value + W64LIT(0x0808080808080808));
+        return _mm256_shuffle_epi8(x, _mm256_set_epi64x(hi, lo, hi, lo));
+    }
+    return _mm256_or_si256(_mm256_slli_epi64(x, R), _mm256_srli_epi64(x, 64-R));
+}
+
+template <unsigned int R>
+inline __m256i RotR64(const __m256i &x)
+{
+    return RotL64<64-R>(x);
+}
+
+inline __m256i Add(const __m256i &a, const __m256i &b)
+{
+    return _mm256_add_epi64(a, b);
+}
+
+inline __m256i Sub(const __m256i &a, const __m256i &b)
+{
+    return _mm256_sub_epi64(a, b);
+}
+
+inline __m256i Subkey(const word64 *subkeys, unsigned int i)
+{
+    return _mm256_set1_epi64x(static_cast<long long>(subkeys[i]));
+}
+
+// Transposes four words of four blocks. The transpose is its own inverse,
+// so it also turns the words back into blocks.
+inline void Transpose(__m256i &x0, __m256i &x1, __m256i &x2, __m256i &x3)
+{
+    const __m256i t0 = _mm256_unpacklo_epi64(x0, x1);
+    const __m256i t1 = _mm256_unpackhi_epi64(x0, x1);
+    const __m256i t2 = _mm256_unpacklo_epi64(x2, x3);
+    const __m256i t3 = _mm256_unpackhi_epi64(x2, x3);
+
+    x0 = _mm256_permute2x128_si256(t0, t2, 0x20);
+    x1 = _mm256_permute2x128_si256(t1, t3, 0x20);
+    x2 = _mm256_permute2x128_si256(t0, t2, 0x31);
+    x3 = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+// Loads words [4*q, 4*q+4) of four blocks of size BS
+template <unsigned int BS>
+inline void LoadWords(const byte *blocks, unsigned int q, __m256i &x0, __m256i &x1, __m256i &x2, __m256i &x3)
+{
+    x0 = _mm256_loadu_si256(CONST_M256_CAST(blocks+0*BS+32*q));
+    x1 = _mm256_loadu_si256(CONST_M256_CAST(blocks+1*BS+32*q));
+    x2 = _mm256_loadu_si256(CONST_M256_CAST(blocks+2*BS+32*q));
+    x3 = _mm256_loadu_si256(CONST_M256_CAST(blocks+3*BS+32*q));
+    Transpose(x0, x1, x2, x3);
+}
+
+template <unsigned int BS>
+inline void StoreWords(byte *blocks, unsigned int q, __m256i x0, __m256i x1, __m256i x2, __m256i x3)
+{
+    Transpose(x0, x1, x2, x3);
+    _mm256_storeu_si256(M256_CAST(blocks+0*BS+32*q), x0);
+    _mm256_storeu_si256(M256_CAST(blocks+1*BS+32*q), x1);
+    _mm256_storeu_si256(M256_CAST(blocks+2*BS+32*q), x2);
+    _mm256_storeu_si256(M256_CAST(blocks+3*BS+32*q), x3);
+}
+
+template <unsigned int C0>
+inline void MIX(__m256i &G0, __m256i &G1)
+{
+    G0 = Add(G0, G1);
+    G1 = _mm256_xor_si256(RotL64<C0>(G1), G0);
+}
+
+template <unsigned int C0>
+inline void IMIX(__m256i &G0, __m256i &G1)
+{
+    G1 = RotR64<C0>(_mm256_xor_si256(G1, G0));
+    G0 = Sub(G0, G1);
+}
+
+////////////////////////////// Threefish-256 //////////////////////////////
+
+// Macros rather than functions so the state stays in registers. GCC
+// declines to inline the many template instances and spills the state.
+#define G256(C0, C1, G0, G1, G2, G3) \
+    MIX<C0>(G0, G1); MIX<C1>(G2, G3);
+
+#define IG256(C0, C1, G0, G1, G2, G3) \
+    IMIX<C1>(G2, G3); IMIX<C0>(G0, G1);
+
+#define KS256(s) \
+    G0 = Add(G0, Subkey(subkeys, 4*(s)+0)); G1 = Add(G1, Subkey(subkeys, 4*(s)+1)); \
+    G2 = Add(G2, Subkey(subkeys, 4*(s)+2)); G3 = Add(G3, Subkey(subkeys, 4*(s)+3));
+
+#define IKS256(s) \
+    G0 = Sub(G0, Subkey(subkeys, 4*(s)+0)); G1 = Sub(G1, Subkey(subkeys, 4*(s)+1)); \
+    G2 = Sub(G2, Subkey(subkeys, 4*(s)+2)); G3 = Sub(G3, Subkey(subkeys, 4*(s)+3));
+
+#define G256x8(r) \
+    G256(14, 16, G0, G1, G2, G3); \
+    G256(52, 57, G0, G3, G2, G1); \
+    G256(23, 40, G0, G1, G2, G3); \
+    G256( 5, 37, G0, G3, G2, G1); \
+    KS256(r + 1); \
+    G256(25, 33, G0, G1, G2, G3); \
+    G256(46, 12, G0, G3, G2, G1); \
+    G256(58, 22, G0, G1, G2, G3); \
+    G256(32, 32, G0, G3, G2, G1); \
+    KS256(r + 2);
+
+#define IG256x8(r) \
+    IKS256(r + 2); \
+    IG256(32, 32, G0, G3, G2, G1); \
+    IG256(58, 22, G0, G1, G2, G3); \
+    IG256(46, 12, G0, G3, G2, G1); \
+    IG256(25, 33, G0, G1, G2, G3); \
+    IKS256(r + 1); \
+    IG256( 5, 37, G0, G3, G2, G1); \
+    IG256(23, 40, G0, G1, G2, G3); \
+    IG256(52, 57, G0, G3, G2, G1); \
+    IG256(14, 16, G0, G1, G2, G3);
+
+void Threefish256_Enc_4(const word64 *subkeys, byte *blocks)
+{
+    __m256i G0, G1, G2, G3;
+    LoadWords<32>(blocks, 0, G0, G1, G2, G3);
+
+    KS256(0);
+    G256x8(0); G256x8(2); G256x8(4); G256x8(6); G256x8(8);
+    G256x8(10); G256x8(12); G256x8(14); G256x8(16);
+
+    StoreWords<32>(blocks, 0, G0, G1, G2, G3);
+}
+
+void Threefish256_Dec_4(const word64 *subkeys, byte *blocks)
+{
+    __m256i G0, G1, G2, G3;
+    LoadWords<32>(blocks, 0, G0, G1, G2, G3);
+
+    IG256x8(16); IG256x8(14); IG256x8(12); IG256x8(10);
+    IG256x8(8); IG256x8(6); IG256x8(4); IG256x8(2); IG256x8(0);
+    IKS256(0);
+
+    StoreWords<32>(blocks, 0, G0, G1, G2, G3);
+}
+
+////////////////////////////// Threefish-512 //////////////////////////////
+
+#define G512(C0, C1, C2, C3, G0, G1, G2, G3, G4, G5, G6, G7) \
+    MIX<C0>(G0, G1); MIX<C1>(G2, G3); MIX<C2>(G4, G5); MIX<C3>(G6, G7);
+
+#define IG512(C0, C1, C2, C3, G0, G1, G2, G3, G4, G5, G6, G7) \
+    IMIX<C3>(G6, G7); IMIX<C2>(G4, G5); IMIX<C1>(G2, G3); IMIX<C0>(G0, G1);
+
+#define KS512(s) \
+    G0 = Add(G0, Subkey(subkeys, 8*(s)+0)); G1 = Add(G1, Subkey(subkeys, 8*(s)+1)); \
+    G2 = Add(G2, Subkey(subkeys, 8*(s)+2)); G3 = Add(G3, Subkey(subkeys, 8*(s)+3)); \
+    G4 = Add(G4, Subkey(subkeys, 8*(s)+4)); G5 = Add(G5, Subkey(subkeys, 8*(s)+5)); \
+    G6 = Add(G6, Subkey(subkeys, 8*(s)+6)); G7 = Add(G7, Subkey(subkeys, 8*(s)+7));
+
+#define IKS512(s) \
+    G0 = Sub(G0, Subkey(subkeys, 8*(s)+0)); G1 = Sub(G1, Subkey(subkeys, 8*(s)+1)); \
+    G2 = Sub(G2, Subkey(subkeys, 8*(s)+2)); G3 = Sub(G3, Subkey(subkeys, 8*(s)+3)); \
+    G4 = Sub(G4, Subkey(subkeys, 8*(s)+4)); G5 = Sub(G5, Subkey(subkeys, 8*(s)+5)); \
+    G6 = Sub(G6, Subkey(subkeys, 8*(s)+6)); G7 = Sub(G7, Subkey(subkeys, 8*(s)+7));
+
+#define G512x8(r) \
+    G512(46, 36, 19, 37, G0, G1, G2, G3, G4, G5, G6, G7); \
+    G512(33, 27, 14, 42, G2, G1, G4, G7, G6, G5, G0, G3); \
+    G512(17, 49, 36, 39, G4, G1, G6, G3, G0, G5, G2, G7); \
+    G512(44,  9, 54, 56, G6, G1, G0, G7, G2, G5, G4, G3); \
+    KS512(r + 1) \
+    G512(39, 30, 34, 24, G0, G1, G2, G3, G4, G5, G6, G7); \
+    G512(13, 50, 10, 17, G2, G1, G4, G7, G6, G5, G0, G3); \
+    G512(25, 29, 39, 43, G4, G1, G6, G3, G0, G5, G2, G7); \
+    G512( 8, 35, 56, 22, G6, G1, G0, G7, G2, G5, G4, G3); \
+    KS512(r + 2)
+
+#define IG512x8(r) \
+    IKS512(r + 2) \
+    IG512( 8, 35, 56, 22, G6, G1, G0, G7, G2, G5, G4, G3); \
+    IG512(25, 29, 39, 43, G4, G1, G6, G3, G0, G5, G2, G7); \
+    IG512(13, 50, 10, 17, G2, G1, G4, G7, G6, G5, G0, G3); \
+    IG512(39, 30, 34, 24, G0, G1, G2, G3, G4, G5, G6, G7); \
+    IKS512(r + 1) \
+    IG512(44,  9, 54, 56, G6, G1, G0, G7, G2, G5, G4, G3); \
+    IG512(17, 49, 36, 39, G4, G1, G6, G3, G0, G5, G2, G7); \
+    IG512(33, 27, 14, 42, G2, G1, G4, G7, G6, G5, G0, G3); \
+    IG512(46, 36, 19, 37, G0, G1, G2, G3, G4, G5, G6, G7);
+
+void Threefish512_Enc_4(const word64 *subkeys, byte *blocks)
+{
+    __m256i G0, G1, G2, G3, G4, G5, G6, G7;
+    LoadWords<64>(blocks, 0, G0, G1, G2, G3);
+    LoadWords<64>(blocks, 1, G4, G5, G6, G7);
+
+    KS512(0)
+    G512x8(0); G512x8(2); G512x8(4); G512x8(6); G512x8(8);
+    G512x8(10); G512x8(12); G512x8(14); G512x8(16);
+
+    StoreWords<64>(blocks, 0, G0, G1, G2, G3);
+    StoreWords<64>(blocks, 1, G4, G5, G6, G7);
+}
+
+void Threefish512_Dec_4(const word64 *subkeys, byte *blocks)
+{
+    __m256i G0, G1, G2, G3, G4, G5, G6, G7;
+    LoadWords<64>(blocks, 0, G0, G1, G2, G3);
+    LoadWords<64>(blocks, 1, G4, G5, G6, G7);
+
+    IG512x8(16); IG512x8(14); IG512x8(12); IG512x8(10);
+    IG512x8(8); IG512x8(6); IG512x8(4); IG512x8(2); IG512x8(0);
+    IKS512(0)
+
+    StoreWords<64>(blocks, 0, G0, G1, G2, G3);
+    StoreWords<64>(blocks, 1, G4, G5, G6, G7);
+}
+
+////////////////////////////// Threefish-1024 //////////////////////////////
+
+#define KS1024(s) \
+    for (unsigned int i=0; i<16; ++i) \
+        G[i] = Add(G[i], Subkey(subkeys, 16*(s)+i));
+
+#define IKS1024(s) \
+    for (unsigned int i=0; i<16; ++i) \
+        G[i] = Sub(G[i], Subkey(subkeys, 16*(s)+i));
+
+#define G1024x8(r) \
+    G512(24, 13,  8, 47, G[0], G[1], G[2], G[3], G[4], G[5], G[6], G[7]); \
+    G512( 8, 17, 22, 37, G[8], G[9], G[10], G[11], G[12], G[13], G[14], G[15]); \
+    G512(38, 19, 10, 55, G[0], G[9], G[2], G[13], G[6], G[11], G[4], G[15]); \
+    G512(49, 18, 23, 52, G[10], G[7], G[12], G[3], G[14], G[5], G[8], G[1]); \
+    G512(33,  4, 51, 13, G[0], G[7], G[2], G[5], G[4], G[3], G[6], G[1]); \
+    G512(34, 41, 59, 17, G[12], G[15], G[14], G[13], G[8], G[11], G[10], G[9]); \
+    G512( 5, 20, 48, 41, G[0], G[15], G[2], G[11], G[6], G[13], G[4], G[9]); \
+    G512(47, 28, 16, 25, G[14], G[1], G[8], G[5], G[10], G[3], G[12], G[7]); \
+    KS1024(r + 1); \
+    G512(41,  9, 37, 31, G[0], G[1], G[2], G[3], G[4], G[5], G[6], G[7]); \
+    G512(12, 47, 44, 30, G[8], G[9], G[10], G[11], G[12], G[13], G[14], G[15]); \
+    G512(16, 34, 56, 51, G[0], G[9], G[2], G[13], G[6], G[11], G[4], G[15]); \
+    G512( 4, 53, 42, 41, G[10], G[7], G[12], G[3], G[14], G[5], G[8], G[1]); \
+    G512(31, 44, 47, 46, G[0], G[7], G[2], G[5], G[4], G[3], G[6], G[1]); \
+    G512(19, 42, 44, 25, G[12], G[15], G[14], G[13], G[8], G[11], G[10], G[9]); \
+    G512( 9, 48, 35, 52, G[0], G[15], G[2], G[11], G[6], G[13], G[4], G[9]); \
+    G512(23, 31, 37, 20, G[14], G[1], G[8], G[5], G[10], G[3], G[12], G[7]); \
+    KS1024(r + 2);
+
+#define IG1024x8(r) \
+    IKS1024(r + 2); \
+    IG512( 9, 48, 35, 52, G[0], G[15], G[2], G[11], G[6], G[13], G[4], G[9]); \
+    IG512(23, 31, 37, 20, G[14], G[1], G[8], G[5], G[10], G[3], G[12], G[7]); \
+    IG512(31, 44, 47, 46, G[0], G[7], G[2], G[5], G[4], G[3], G[6], G[1]); \
+    IG512(19, 42, 44, 25, G[12], G[15], G[14], G[13], G[8], G[11], G[10], G[9]); \
+    IG512(16, 34, 56, 51, G[0], G[9], G[2], G[13], G[6], G[11], G[4], G[15]); \
+    IG512( 4, 53, 42, 41, G[10], G[7], G[12], G[3], G[14], G[5], G[8], G[1]); \
+    IG512(41,  9, 37, 31, G[0], G[1], G[2], G[3], G[4], G[5], G[6], G[7]); \
+    IG512(12, 47, 44, 30, G[8], G[9], G[10], G[11], G[12], G[13], G[14], G[15]); \
+    IKS1024(r + 1); \
+    IG512( 5, 20, 48, 41, G[0], G[15], G[2], G[11], G[6], G[13], G[4], G[9]); \
+    IG512(47, 28, 16, 25, G[14], G[1], G[8], G[5], G[10], G[3], G[12], G[7]); \
+    IG512(33,  4, 51, 13, G[0], G[7], G[2], G[5], G[4], G[3], G[6], G[1]); \
+    IG512(34, 41, 59, 17, G[12], G[15], G[14], G[13], G[8], G[11], G[10], G[9]); \
+    IG512(38, 19, 10, 55, G[0], G[9], G[2], G[13], G[6], G[11], G[4], G[15]); \
+    IG512(49, 18, 23, 52, G[10], G[7], G[12], G[3], G[14], G[5], G[8], G[1]); \
+    IG512(24, 13,  8, 47, G[0], G[1], G[2], G[3], G[4], G[5], G[6], G[7]); \
+    IG512( 8, 17, 22, 37, G[8], G[9], G[10], G[11], G[12], G[13], G[14], G[15]);
+
+void Threefish1024_Enc_4(const word64 *subkeys, byte *blocks)
+{
+    __m256i G[16];
+    for (unsigned int q=0; q<4; ++q)
+        LoadWords<128>(blocks, q, G[4*q+0], G[4*q+1], G[4*q+2], G[4*q+3]);
+
+    KS1024(0);
+    G1024x8(0); G1024x8(2); G1024x8(4); G1024x8(6); G1024x8(8);
+    G1024x8(10); G1024x8(12); G1024x8(14); G1024x8(16); G1024x8(18);
+
+    for (unsigned int q=0; q<4; ++q)
+        StoreWords<128>(blocks, q, G[4*q+0], G[4*q+1], G[4*q+2], G[4*q+3]);
+}
+
+void Threefish1024_Dec_4(const word64 *subkeys, byte *blocks)
+{
+    __m256i G[16];
+    for (unsigned int q=0; q<4; ++q)
+        LoadWords<128>(blocks, q, G[4*q+0], G[4*q+1], G[4*q+2], G[4*q+3]);
+
+    IG1024x8(18); IG1024x8(16); IG1024x8(14); IG1024x8(12); IG1024x8(10);
+    IG1024x8(8); IG1024x8(6); IG1024x8(4); IG1024x8(2); IG1024x8(0);
+    IKS1024(0);
+
+    for (unsigned int q=0; q<4; ++q)
+        StoreWords<128>(blocks, q, G[4*q+0], G[4*q+1], G[4*q+2], G[4*q+3]);
+}
+
+////////////////////////////// AdvancedProcessBlocks //////////////////////////////
+
+// Gathers four blocks into a buffer, runs the kernel on the buffer and
+// scatters the results. The flags are handled like
+// BlockTransformation::AdvancedProcessBlocks(). The caller only uses the
+// kernel with BT_AllowParallel. Whole groups of four blocks are processed,
+// and the length that remains is returned for the scalar code.
+template <unsigned int BS, typename F>
+size_t AdvancedProcessBlocks_4x1_AVX2(F func, const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    using CryptoPP::BlockTransformation;
+    using CryptoPP::PtrAdd;
+    using CryptoPP::xorbuf;
+
+    CRYPTOPP_ASSERT(inBlocks);
+    CRYPTOPP_ASSERT(outBlocks);
+    CRYPTOPP_ASSERT(length >= 4*BS);
+    CRYPTOPP_ASSERT(flags & BlockTransformation::BT_AllowParallel);
+
+    CRYPTOPP_ALIGN_DATA(32) byte buffer[4*BS];
+
+    size_t inIncrement = (flags & (BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_DontIncrementInOutPointers)) ? 0 : BS;
+    size_t xorIncrement = xorBlocks ? BS : 0;
+    size_t outIncrement = (flags & BlockTransformation::BT_DontIncrementInOutPointers) ? 0 : BS;
+
+    const bool xorInput = xorBlocks && (flags & BlockTransformation::BT_XorInput);
+    const bool xorOutput = xorBlocks && !(flags & BlockTransformation::BT_XorInput);
+
+    if (flags & BlockTransformation::BT_ReverseDirection)
+    {
+        inBlocks = PtrAdd(inBlocks, length - BS);
+        xorBlocks = xorBlocks ? PtrAdd(xorBlocks, length - BS) : NULLPTR;
+        outBlocks = PtrAdd(outBlocks, length - BS);
+        inIncrement = 0-inIncrement;
+        xorIncrement = 0-xorIncrement;
+        outIncrement = 0-outIncrement;
+    }
+
+    while (length >= 4*BS)
+    {
+        for (size_t i=0; i<4; ++i)
+        {
+            if (xorInput)
+            {
+                xorbuf(buffer+i*BS, inBlocks, xorBlocks, BS);
+                xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+            }
+            else
+            {
+                std::memcpy(buffer+i*BS, inBlocks, BS);
+            }
+
+            if (flags & BlockTransformation::BT_InBlockIsCounter)
+                const_cast<byte *>(inBlocks)[BS-1]++;
+            inBlocks = PtrAdd(inBlocks, inIncrement);
+        }
+
+        func(subkeys, buffer);
+
+        for (size_t i=0; i<4; ++i)
+        {
+            if (xorOutput)
+            {
+                xorbuf(outBlocks, buffer+i*BS, xorBlocks, BS);
+                xorBlocks = PtrAdd(xorBlocks, xorIncrement);
+            }
+            else
+            {
+                std::memcpy(outBlocks, buffer+i*BS, BS);
+            }
+            outBlocks = PtrAdd(outBlocks, outIncrement);
+        }
+
+        length -= 4*BS;
+    }
+
+    return length;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+size_t Threefish256_Enc_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks_4x1_AVX2<32>(Threefish256_Enc_4, subkeys,
+        inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish256_Dec_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks_4x1_AVX2<32>(Threefish256_Dec_4, subkeys,
+        inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish512_Enc_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks_4x1_AVX2<64>(Threefish512_Enc_4, subkeys,
+        inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish512_Dec_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks_4x1_AVX2<64>(Threefish512_Dec_4, subkeys,
+        inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish1024_Enc_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks_4x1_AVX2<128>(Threefish1024_Enc_4, subkeys,
+        inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Threefish1024_Dec_AdvancedProcessBlocks_AVX2(const word64 *subkeys,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    return AdvancedProcessBlocks_4x1_AVX2<128>(Threefish1024_Dec_4, subkeys,
+        inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
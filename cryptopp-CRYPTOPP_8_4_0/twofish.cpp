@@ -5,9 +5,20 @@
 #include "twofish.h"
 #include "secblock.h"
 #include "misc.h"
+#include "cpu.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS
+# if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t Twofish_Enc_AdvancedProcessBlocks_AVX2(const word32 *subKeys, const word32 *sboxes,
+	const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+
+extern size_t Twofish_Dec_AdvancedProcessBlocks_AVX2(const word32 *subKeys, const word32 *sboxes,
+	const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+#endif  // CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS
+
 // compute (c * x^4) mod (x^4 + (a + 1/a) * x^3 + a * x^2 + (a + 1/a) * x + 1)
 // over GF(256)
 static inline unsigned int Mod(unsigned int c)
@@ -168,4 +179,28 @@ void Twofish::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock,
 	Block::Put(xorBlock, outBlock)(a)(b)(c)(d);
 }
 
+#if CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS
+size_t Twofish::Enc::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+		byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+		return Twofish_Enc_AdvancedProcessBlocks_AVX2(m_k, m_s,
+			inBlocks, xorBlocks, outBlocks, length, flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Twofish::Dec::AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks,
+		byte *outBlocks, size_t length, word32 flags) const
+{
+# if (CRYPTOPP_AVX2_AVAILABLE)
+	if (HasAVX2())
+		return Twofish_Dec_AdvancedProcessBlocks_AVX2(m_k, m_s,
+			inBlocks, xorBlocks, outBlocks, length, flags);
+# endif  // CRYPTOPP_AVX2_AVAILABLE
+	return BlockTransformation::AdvancedProcessBlocks(inBlocks, xorBlocks, outBlocks, length, flags);
+}
+#endif  // CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS
+
 NAMESPACE_END
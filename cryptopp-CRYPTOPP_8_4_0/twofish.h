@@ -9,6 +9,10 @@
 #include "seckey.h"
 #include "secblock.h"
 
+#if (CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86)
+# define CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS 1
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 /// \brief Twofish block cipher information
@@ -19,6 +23,8 @@ struct Twofish_Info : public FixedBlockSize<16>, public VariableKeyLength<16, 16
 };
 
 /// \brief Twofish block cipher
+/// \details Since Crypto++ 8.5 AdvancedProcessBlocks() processes eight blocks
+///  at a time with AVX2 gathers when the processor supports it.
 /// \sa <a href="http://www.cryptopp.com/wiki/Twofish">Twofish</a>
 /// \since Crypto++ 3.1
 class Twofish : public Twofish_Info, public BlockCipherDocumentation
@@ -43,12 +49,18 @@ class Twofish : public Twofish_Info, public BlockCipherDocumentation
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
 	};
 
 	class CRYPTOPP_NO_VTABLE Dec : public Base
 	{
 	public:
 		void ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const;
+#if CRYPTOPP_TWOFISH_ADVANCED_PROCESS_BLOCKS
+		size_t AdvancedProcessBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags) const;
+#endif
 	};
 
 public:
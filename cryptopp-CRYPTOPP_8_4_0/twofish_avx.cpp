@@ -0,0 +1,272 @@
+// twofish_avx.cpp - written and placed in the public domain by
+//                   the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernel transposes eight blocks so that each ymm register holds
+//    one word of every block. The key dependent S-box tables are read
+//    with VPGATHERDD, eight lookups per instruction. The round code is
+//    a template shared with the single block path, which uses ordinary
+//    table lookups.
+
+#include "pch.h"
+#include "config.h"
+
+#include "twofish.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+# include "adv_simd.h"
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char TWOFISH_AVX_FNAME[] = __FILE__;
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+NAMESPACE_BEGIN(CryptoPP)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::rotlConstant;
+using CryptoPP::rotrConstant;
+
+// Word i of eight blocks
+struct Word8
+{
+    Word8() {}
+    Word8(const __m256i &x) : v(x) {}
+
+    __m256i v;
+};
+
+inline Word8 operator^(const Word8 &x, const Word8 &y)
+{
+    return _mm256_xor_si256(x.v, y.v);
+}
+
+inline Word8 operator+(const Word8 &x, const Word8 &y)
+{
+    return _mm256_add_epi32(x.v, y.v);
+}
+
+// Subkey words are the same for all blocks
+inline Word8 operator^(const Word8 &x, word32 k)
+{
+    return _mm256_xor_si256(x.v, _mm256_set1_epi32(static_cast<int>(k)));
+}
+
+inline Word8 operator+(const Word8 &x, word32 k)
+{
+    return _mm256_add_epi32(x.v, _mm256_set1_epi32(static_cast<int>(k)));
+}
+
+template <unsigned int R>
+inline Word8 rotlConstant(const Word8 &x)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(x.v, R), _mm256_srli_epi32(x.v, 32-R));
+}
+
+template <unsigned int R>
+inline Word8 rotrConstant(const Word8 &x)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(x.v, R), _mm256_slli_epi32(x.v, 32-R));
+}
+
+// s[0][x0] ^ s[1][x1] ^ s[2][x2] ^ s[3][x3] for the bytes x0..x3 of x
+inline word32 G1(word32 x, const word32 *s)
+{
+    return s[0*256+GETBYTE(x,0)] ^ s[1*256+GETBYTE(x,1)] ^
+           s[2*256+GETBYTE(x,2)] ^ s[3*256+GETBYTE(x,3)];
+}
+
+inline word32 G2(word32 x, const word32 *s)
+{
+    return G1(rotlConstant<8>(x), s);
+}
+
+inline Word8 G1(const Word8 &x, const word32 *s)
+{
+    const int *t = reinterpret_cast<const int*>(s);
+    const __m256i m = _mm256_set1_epi32(0xff);
+
+    const __m256i t0 = _mm256_i32gather_epi32(t+0*256, _mm256_and_si256(x.v, m), 4);
+    const __m256i t1 = _mm256_i32gather_epi32(t+1*256, _mm256_and_si256(_mm256_srli_epi32(x.v, 8), m), 4);
+    const __m256i t2 = _mm256_i32gather_epi32(t+2*256, _mm256_and_si256(_mm256_srli_epi32(x.v, 16), m), 4);
+    const __m256i t3 = _mm256_i32gather_epi32(t+3*256, _mm256_srli_epi32(x.v, 24), 4);
+
+    return _mm256_xor_si256(_mm256_xor_si256(t0, t1), _mm256_xor_si256(t2, t3));
+}
+
+inline Word8 G2(const Word8 &x, const word32 *s)
+{
+    // Rotate left by 8 with a byte shuffle
+    const __m256i mask = _mm256_set_epi8(
+        14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3,
+        14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3);
+    return G1(Word8(_mm256_shuffle_epi8(x.v, mask)), s);
+}
+
+// The round structure follows Twofish::Enc::ProcessAndXorBlock.
+// The result is in c, d, a, b.
+template <class W>
+inline void Twofish_Encrypt(W &a, W &b, W &c, W &d, const word32 *k, const word32 *s)
+{
+    a = a ^ k[0]; b = b ^ k[1];
+    c = c ^ k[2]; d = d ^ k[3];
+
+    for (unsigned int n=0; n<16; n+=2)
+    {
+        W x = G1(a, s), y = G2(b, s);
+        x = x + y; y = y + x + k[8+2*n+1];
+        c = rotrConstant<1>(c ^ (x + k[8+2*n]));
+        d = rotlConstant<1>(d) ^ y;
+
+        x = G1(c, s); y = G2(d, s);
+        x = x + y; y = y + x + k[8+2*n+3];
+        a = rotrConstant<1>(a ^ (x + k[8+2*n+2]));
+        b = rotlConstant<1>(b) ^ y;
+    }
+
+    c = c ^ k[4]; d = d ^ k[5];
+    a = a ^ k[6]; b = b ^ k[7];
+}
+
+// The round structure follows Twofish::Dec::ProcessAndXorBlock. The
+// input is in c, d, a, b and the result is in a, b, c, d.
+template <class W>
+inline void Twofish_Decrypt(W &a, W &b, W &c, W &d, const word32 *k, const word32 *s)
+{
+    c = c ^ k[4]; d = d ^ k[5];
+    a = a ^ k[6]; b = b ^ k[7];
+
+    for (unsigned int n=16; n!=0; n-=2)
+    {
+        W x = G1(c, s), y = G2(d, s);
+        x = x + y; y = y + x;
+        b = rotrConstant<1>(b ^ (y + k[8+2*n-1]));
+        a = rotlConstant<1>(a) ^ (x + k[8+2*n-2]);
+
+        x = G1(a, s); y = G2(b, s);
+        x = x + y; y = y + x;
+        d = rotrConstant<1>(d ^ (y + k[8+2*n-3]));
+        c = rotlConstant<1>(c) ^ (x + k[8+2*n-4]);
+    }
+
+    a = a ^ k[0]; b = b ^ k[1];
+    c = c ^ k[2]; d = d ^ k[3];
+}
+
+// Transposes the 4x4 word matrix in each lane. The transpose is its
+// own inverse, so it also turns the words back into blocks.
+inline void Transpose(__m256i &x0, __m256i &x1, __m256i &x2, __m256i &x3)
+{
+    const __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    const __m256i t1 = _mm256_unpackhi_epi32(x0, x1);
+    const __m256i t2 = _mm256_unpacklo_epi32(x2, x3);
+    const __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+
+    x0 = _mm256_unpacklo_epi64(t0, t2);
+    x1 = _mm256_unpackhi_epi64(t0, t2);
+    x2 = _mm256_unpacklo_epi64(t1, t3);
+    x3 = _mm256_unpackhi_epi64(t1, t3);
+}
+
+// Blocks i and i+4 share a register, one in each lane
+inline __m256i Combine(const __m128i &lo, const __m128i &hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+inline void Split(const __m256i &x, __m128i &lo, __m128i &hi)
+{
+    lo = _mm256_castsi256_si128(x);
+    hi = _mm256_extracti128_si256(x, 1);
+}
+
+// subkeys[0] is the round key table and subkeys[1] the S-box table
+inline void Twofish_Enc_Block(__m128i &block, const word32 *const *subkeys, unsigned int /*rounds*/)
+{
+    CRYPTOPP_ALIGN_DATA(16) word32 w[4];
+    _mm_store_si128(M128_CAST(w), block);
+
+    word32 a=w[0], b=w[1], c=w[2], d=w[3];
+    Twofish_Encrypt(a, b, c, d, subkeys[0], subkeys[1]);
+
+    block = _mm_set_epi32(static_cast<int>(b), static_cast<int>(a),
+                          static_cast<int>(d), static_cast<int>(c));
+}
+
+inline void Twofish_Dec_Block(__m128i &block, const word32 *const *subkeys, unsigned int /*rounds*/)
+{
+    CRYPTOPP_ALIGN_DATA(16) word32 w[4];
+    _mm_store_si128(M128_CAST(w), block);
+
+    word32 c=w[0], d=w[1], a=w[2], b=w[3];
+    Twofish_Decrypt(a, b, c, d, subkeys[0], subkeys[1]);
+
+    block = _mm_set_epi32(static_cast<int>(d), static_cast<int>(c),
+                          static_cast<int>(b), static_cast<int>(a));
+}
+
+inline void Twofish_Enc_8_Blocks(__m128i &block0, __m128i &block1, __m128i &block2,
+    __m128i &block3, __m128i &block4, __m128i &block5, __m128i &block6,
+    __m128i &block7, const word32 *const *subkeys, unsigned int /*rounds*/)
+{
+    __m256i x0 = Combine(block0, block4), x1 = Combine(block1, block5);
+    __m256i x2 = Combine(block2, block6), x3 = Combine(block3, block7);
+    Transpose(x0, x1, x2, x3);
+
+    Word8 a(x0), b(x1), c(x2), d(x3);
+    Twofish_Encrypt(a, b, c, d, subkeys[0], subkeys[1]);
+
+    x0 = c.v; x1 = d.v; x2 = a.v; x3 = b.v;
+    Transpose(x0, x1, x2, x3);
+    Split(x0, block0, block4); Split(x1, block1, block5);
+    Split(x2, block2, block6); Split(x3, block3, block7);
+}
+
+inline void Twofish_Dec_8_Blocks(__m128i &block0, __m128i &block1, __m128i &block2,
+    __m128i &block3, __m128i &block4, __m128i &block5, __m128i &block6,
+    __m128i &block7, const word32 *const *subkeys, unsigned int /*rounds*/)
+{
+    __m256i x0 = Combine(block0, block4), x1 = Combine(block1, block5);
+    __m256i x2 = Combine(block2, block6), x3 = Combine(block3, block7);
+    Transpose(x0, x1, x2, x3);
+
+    Word8 c(x0), d(x1), a(x2), b(x3);
+    Twofish_Decrypt(a, b, c, d, subkeys[0], subkeys[1]);
+
+    x0 = a.v; x1 = b.v; x2 = c.v; x3 = d.v;
+    Transpose(x0, x1, x2, x3);
+    Split(x0, block0, block4); Split(x1, block1, block5);
+    Split(x2, block2, block6); Split(x3, block3, block7);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Twofish_Enc_AdvancedProcessBlocks_AVX2(const word32 *subKeys, const word32 *sboxes,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    const word32 *tables[2] = {subKeys, sboxes};
+    return AdvancedProcessBlocks128_8x1_SSE(Twofish_Enc_Block, Twofish_Enc_8_Blocks,
+        tables, 16, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+size_t Twofish_Dec_AdvancedProcessBlocks_AVX2(const word32 *subKeys, const word32 *sboxes,
+    const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags)
+{
+    const word32 *tables[2] = {subKeys, sboxes};
+    return AdvancedProcessBlocks128_8x1_SSE(Twofish_Dec_Block, Twofish_Dec_8_Blocks,
+        tables, 16, inBlocks, xorBlocks, outBlocks, length, flags);
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
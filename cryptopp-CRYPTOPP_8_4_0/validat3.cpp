@@ -164,12 +164,14 @@ bool ValidateAll(bool thorough)
 	pass=ValidateHC128() && pass;
 	pass=ValidateHC256() && pass;
 	pass=RunTestDataFile("TestVectors/seed.txt") && pass;
-	pass=RunTestDataFile("TestVectors/threefish.txt") && pass;
+	pass=ValidateThreefish() && pass;
 	pass=RunTestDataFile("TestVectors/kalyna.txt") && pass;
 	pass=RunTestDataFile("TestVectors/sm4.txt") && pass;
 	pass=ValidateVMAC() && pass;
 	pass=ValidateCCM() && pass;
 	pass=ValidateGCM() && pass;
+	pass=ValidateOCB() && pass;
+	pass=ValidateAEGIS() && pass;
 	pass=ValidateXTS() && pass;
 	pass=ValidateCMAC() && pass;
 	pass=RunTestDataFile("TestVectors/eax.txt") && pass;
@@ -362,6 +364,9 @@ bool TestSettings()
 	bool hasSSE42 = HasSSE42();
 	bool hasAVX = HasAVX();
 	bool hasAVX2 = HasAVX2();
+	bool hasAVX512F = HasAVX512F();
+	bool hasVAES = HasVAES();
+	bool hasVPCLMULQDQ = HasVPCLMULQDQ();
 	bool hasAESNI = HasAESNI();
 	bool hasCLMUL = HasCLMUL();
 	bool hasRDRAND = HasRDRAND();
@@ -372,6 +377,8 @@ bool TestSettings()
 	std::cout << "hasSSE2 == " << hasSSE2 << ", hasSSSE3 == " << hasSSSE3;
 	std::cout << ", hasSSE4.1 == " << hasSSE41 << ", hasSSE4.2 == " << hasSSE42;
 	std::cout << ", hasAVX == " << hasAVX << ", hasAVX2 == " << hasAVX2;
+	std::cout << ", hasAVX512F == " << hasAVX512F << ", hasVAES == " << hasVAES;
+	std::cout << ", hasVPCLMULQDQ == " << hasVPCLMULQDQ;
 	std::cout << ", hasAESNI == " << hasAESNI << ", hasCLMUL == " << hasCLMUL;
 	std::cout << ", hasRDRAND == " << hasRDRAND << ", hasRDSEED == " << hasRDSEED;
 	std::cout << ", hasSHA == " << hasSHA << ", isP4 == " << isP4;
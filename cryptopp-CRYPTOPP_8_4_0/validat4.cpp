@@ -36,14 +36,22 @@
 #include "blowfish.h"
 #include "camellia.h"
 #include "skipjack.h"
+#include "threefish.h"
 
 #include "arc4.h"
 #include "salsa.h"
 #include "chacha.h"
+#include "chachapoly.h"
 #include "rabbit.h"
 #include "sosemanuk.h"
 
 #include "modes.h"
+#include "xts.h"
+#include "ccm.h"
+#include "gcm.h"
+#include "ocb.h"
+#include "aegis.h"
+#include "keycache.h"
 #include "cmac.h"
 #include "dmac.h"
 #include "hmac.h"
@@ -55,6 +63,7 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <vector>
 
 // Aggressive stack checking with VS2005 SP1 and above.
 #if (_MSC_FULL_VER >= 140050727)
@@ -372,6 +381,249 @@ bool TestModeIV(SymmetricCipher &e, SymmetricCipher &d)
 	return true;
 }
 
+// Puts the message to both filters in pieces of various sizes and
+// compares the output. Some pieces are modifiable.
+bool TestParallelFilter(StreamTransformation &c1, StreamTransformation &c2, const SecByteBlock &message,
+	BlockPaddingSchemeDef::BlockPaddingScheme padding = BlockPaddingSchemeDef::DEFAULT_PADDING)
+{
+	const size_t pieces[] = {1, 4099, 70000, 33, 150000};
+	std::string expected, actual;
+
+	StreamTransformationFilter f1(c1, new StringSink(expected), padding);
+	ParallelStreamTransformationFilter f2(c2, new StringSink(actual), padding, 1000);
+
+	SecByteBlock temp(message);
+	for (size_t i=0, offset=0; offset<message.size(); ++i)
+	{
+		const size_t len = STDMIN(pieces[i%COUNTOF(pieces)], message.size()-offset);
+		f1.Put(message+offset, len);
+		if (i%2)
+			f2.PutModifiable(temp+offset, len);
+		else
+			f2.Put(message+offset, len);
+		offset += len;
+	}
+
+	f1.MessageEnd();
+	f2.MessageEnd();
+	return expected == actual;
+}
+
+// Records the length of each ProcessSegments() call
+class SegmentLengthsCTR : public CTR_Mode<AES>::Encryption
+{
+public:
+	SegmentLengthsCTR(const byte *key, size_t length, const byte *iv)
+		: CTR_Mode<AES>::Encryption(key, length, iv) {}
+
+	void ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers=NULLPTR)
+	{
+		m_lengths.push_back(length);
+		CTR_Mode<AES>::Encryption::ProcessSegments(outString, inString, length, segmentSize, workers);
+	}
+
+	std::vector<size_t> m_lengths;
+};
+
+// Puts the message in 1 KiB pieces, as a FileSource does, and checks the
+// filter passes whole buffers of SegmentsPerBuffer segments to the mode
+bool TestParallelFilterBuffering(const SecByteBlock &key, const SecByteBlock &iv, const SecByteBlock &message)
+{
+	const size_t segmentSize = 4096, bufferSize = segmentSize*ParallelStreamTransformationFilter::SegmentsPerBuffer;
+	std::string expected, actual;
+
+	CTR_Mode<AES>::Encryption c1(key, key.size(), iv);
+	SegmentLengthsCTR c2(key, key.size(), iv);
+	StreamTransformationFilter f1(c1, new StringSink(expected));
+	ParallelStreamTransformationFilter f2(c2, new StringSink(actual), BlockPaddingSchemeDef::DEFAULT_PADDING, segmentSize);
+
+	// The second message starts with an empty buffer
+	for (unsigned int m=0; m<2; ++m)
+	{
+		for (size_t offset=0; offset<message.size(); offset+=1024)
+		{
+			f1.Put(message+offset, STDMIN<size_t>(1024, message.size()-offset));
+			f2.Put(message+offset, STDMIN<size_t>(1024, message.size()-offset));
+		}
+		f1.MessageEnd();
+		f2.MessageEnd();
+
+		if (expected != actual || c2.m_lengths.size() != (message.size()+bufferSize-1)/bufferSize)
+			return false;
+		for (size_t i=0; i+1<c2.m_lengths.size(); ++i)
+		{
+			if (c2.m_lengths[i] != bufferSize)
+				return false;
+		}
+		c2.m_lengths.clear();
+	}
+
+	return true;
+}
+
+// One SegmentWorkers runs several calls and modes with more threads than
+// segments, fewer threads than segments, and after the cipher is rekeyed
+bool TestSegmentWorkers(const SecByteBlock &key, const SecByteBlock &iv, const SecByteBlock &message)
+{
+	SegmentWorkers workers(4);
+	SecByteBlock expected(message.size()), actual(message.size());
+	bool fail = false;
+
+	CBC_Mode<AES>::Decryption d1(key, 32, iv), d2(key, 32, iv);
+	d1.ProcessData(expected, message, message.size());
+	d2.ProcessSegments(actual, message, 3*4096, 4096, &workers);
+	d2.ProcessSegments(actual+3*4096, message+3*4096, message.size()-3*4096, 4096, &workers);
+	fail = (expected != actual) || fail;
+
+	d1.SetKeyWithIV(key+16, 32, iv); d2.SetKeyWithIV(key+16, 32, iv);
+	workers.Reset();
+	d1.ProcessData(expected, message, message.size());
+	d2.ProcessSegments(actual, message, message.size(), 4096, &workers);
+	fail = (expected != actual) || fail;
+
+	const size_t sectors = message.size()/512;
+	XTS_Mode<AES>::Encryption e1(key, key.size(), iv), e2(key, key.size(), iv);
+	e1.ProcessSectors(expected, message, sectors*512, 512, 7);
+	e2.ProcessSectors(actual, message, sectors*512, 512, 7, BIG_ENDIAN_ORDER, &workers);
+	fail = std::memcmp(expected, actual, sectors*512) != 0 || fail;
+	return !fail;
+}
+
+// Runs 1 through maxBlocks blocks through ECB, CTR and CBC decryption and
+// compares the output with ProcessBlock() one block at a time. The parallel
+// modes reach the SIMD kernels, and the lengths cover their tails. The
+// counter starts near a carry out of the last byte.
+template <class T>
+bool TestMultiBlockModes(const char *name, unsigned int maxBlocks)
+{
+	const unsigned int bs = T::BLOCKSIZE;
+	bool fail = false;
+
+	SecByteBlock key(T::DEFAULT_KEYLENGTH), iv(bs), ctr(bs);
+	SecByteBlock in(bs*maxBlocks), out(bs*maxBlocks), expected(bs*maxBlocks);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	iv[bs-1] = 0xfa;
+
+	typename T::Encryption enc(key, key.size());
+	typename T::Decryption dec(key, key.size());
+	typename ECB_Mode<T>::Encryption ecbEnc(key, key.size());
+	typename ECB_Mode<T>::Decryption ecbDec(key, key.size());
+	typename CTR_Mode<T>::Encryption ctrEnc(key, key.size(), iv);
+	typename CBC_Mode<T>::Decryption cbcDec(key, key.size(), iv);
+
+	for (unsigned int n=1; n<=maxBlocks; ++n)
+	{
+		const size_t len = n*bs;
+		GlobalRNG().GenerateBlock(in, len);
+
+		for (size_t i=0; i<len; i+=bs)
+			enc.ProcessBlock(in+i, expected+i);
+		ecbEnc.ProcessData(out, in, len);
+		fail = !!memcmp(out, expected, len) || fail;
+
+		for (size_t i=0; i<len; i+=bs)
+			dec.ProcessBlock(in+i, expected+i);
+		ecbDec.ProcessData(out, in, len);
+		fail = !!memcmp(out, expected, len) || fail;
+
+		std::memcpy(ctr, iv, bs);
+		for (size_t i=0; i<len; i+=bs)
+		{
+			enc.ProcessBlock(ctr, expected+i);
+			xorbuf(expected+i, in+i, bs);
+			IncrementCounterByOne(ctr, bs);
+		}
+		ctrEnc.Resynchronize(iv, bs);
+		ctrEnc.ProcessData(out, in, len);
+		fail = !!memcmp(out, expected, len) || fail;
+
+		for (size_t i=0; i<len; i+=bs)
+		{
+			dec.ProcessBlock(in+i, expected+i);
+			xorbuf(expected+i, i ? in+i-bs : iv.begin(), bs);
+		}
+		cbcDec.Resynchronize(iv, bs);
+		cbcDec.ProcessData(out, in, len);
+		fail = !!memcmp(out, expected, len) || fail;
+
+		// In place
+		std::memcpy(out, in, len);
+		cbcDec.Resynchronize(iv, bs);
+		cbcDec.ProcessData(out, out, len);
+		fail = !!memcmp(out, expected, len) || fail;
+	}
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  " << name << " ECB, CTR and CBC decryption, 1 to " << maxBlocks << " blocks\n";
+	return !fail;
+}
+
+// The batch interfaces must agree with EncryptAndAuthenticate for each
+// message, and flag exactly the messages that were tampered with. The
+// lengths cycle through short messages, and the last one takes the
+// single message path.
+bool TestAuthenticatedBatch(AuthenticatedSymmetricCipher &e, AuthenticatedSymmetricCipher &d,
+	const int ivLengths[], size_t ivCount, const char *name)
+{
+	typedef AuthenticatedSymmetricCipher::BatchMessage BatchMessage;
+	const size_t count = 40, macSize = e.DigestSize();
+	std::vector<SecByteBlock> ivs(count), headers(count), messages(count), ciphers(count), macs(count);
+	std::vector<BatchMessage> batch(count);
+	bool fail = false;
+
+	for (size_t i=0; i<count; ++i)
+	{
+		const size_t length = (i == count-1) ? 5000 : (i*37) % 700;
+		ivs[i].New(ivLengths[i%ivCount]);
+		headers[i].New(i%3 ? i*5 : 0);
+		messages[i].New(length);
+		ciphers[i].New(length);
+		macs[i].New(macSize);
+		GlobalRNG().GenerateBlock(ivs[i], ivs[i].size());
+		GlobalRNG().GenerateBlock(headers[i], headers[i].size());
+		GlobalRNG().GenerateBlock(messages[i], messages[i].size());
+
+		batch[i].output = ciphers[i];
+		batch[i].mac = macs[i];
+		batch[i].macSize = macSize;
+		batch[i].iv = ivs[i];
+		// Messages with the cipher's default IV size keep the default ivLength of -1
+		if (ivs[i].size() != e.IVSize())
+			batch[i].ivLength = (int)ivs[i].size();
+		batch[i].header = headers[i];
+		batch[i].headerLength = headers[i].size();
+		batch[i].input = messages[i];
+		batch[i].length = length;
+	}
+
+	e.EncryptAndAuthenticateBatch(&batch[0], count);
+
+	for (size_t i=0; i<count; ++i)
+	{
+		SecByteBlock cipher(messages[i].size()), mac(macSize);
+		e.EncryptAndAuthenticate(cipher, mac, macSize, ivs[i], (int)ivs[i].size(),
+			headers[i], headers[i].size(), messages[i], messages[i].size());
+		fail = (cipher != ciphers[i] || mac != macs[i]) || fail;
+	}
+
+	// Decrypt in place, and tamper with every fourth MAC
+	for (size_t i=0; i<count; ++i)
+	{
+		batch[i].output = ciphers[i];
+		batch[i].input = ciphers[i];
+		if (i%4 == 1)
+			macs[i][0] ^= 1;
+	}
+
+	fail = d.DecryptAndVerifyBatch(&batch[0], count) || fail;
+
+	for (size_t i=0; i<count; ++i)
+		fail = (batch[i].verified != (i%4 != 1) || ciphers[i] != messages[i]) || fail;
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  " << name << " batch interfaces\n";
+	return !fail;
+}
+
 bool ValidateCipherModes()
 {
 	std::cout << "\nTesting DES modes...\n\n";
@@ -644,6 +896,75 @@ bool ValidateCipherModes()
 		std::cout << (fail ? "FAILED   " : "passed   ") << "DMAC" << std::endl;
 	}
 
+	std::cout << "\nTesting AES modes in segments...\n\n";
+	{
+		SecByteBlock aesKey(32), aesIV(16), xtsKey(64), message(300000);
+		GlobalRNG().GenerateBlock(aesKey, aesKey.size());
+		GlobalRNG().GenerateBlock(aesIV, aesIV.size());
+		GlobalRNG().GenerateBlock(xtsKey, xtsKey.size());
+		GlobalRNG().GenerateBlock(message, message.size());
+
+		{
+			ECB_Mode<AES>::Encryption e1(aesKey, aesKey.size()), e2(aesKey, aesKey.size());
+			ECB_Mode<AES>::Decryption d1(aesKey, aesKey.size()), d2(aesKey, aesKey.size());
+			fail = !TestParallelFilter(e1, e2, message) || !TestParallelFilter(d1, d2, message, BlockPaddingSchemeDef::NO_PADDING);
+			pass = pass && !fail;
+			std::cout << (fail ? "FAILED   " : "passed   ") << "ECB ParallelStreamTransformationFilter" << std::endl;
+		}
+		{
+			CBC_Mode<AES>::Encryption e1(aesKey, aesKey.size(), aesIV), e2(aesKey, aesKey.size(), aesIV);
+			CBC_Mode<AES>::Decryption d1(aesKey, aesKey.size(), aesIV), d2(aesKey, aesKey.size(), aesIV);
+			fail = !TestParallelFilter(e1, e2, message) || !TestParallelFilter(d1, d2, message, BlockPaddingSchemeDef::NO_PADDING);
+
+			// In place, and the chaining block carries over to the next call
+			SecByteBlock expected(message.size()), actual(message);
+			d1.Resynchronize(aesIV); d2.Resynchronize(aesIV);
+			d1.ProcessData(expected, message, 160000);
+			d1.ProcessData(expected+160000, message+160000, 140000);
+			d2.ProcessSegments(actual, actual, 160000, 4096);
+			d2.ProcessSegments(actual+160000, actual+160000, 140000, 4096);
+			fail = (expected != actual) || fail;
+
+			pass = pass && !fail;
+			std::cout << (fail ? "FAILED   " : "passed   ") << "CBC ParallelStreamTransformationFilter" << std::endl;
+		}
+		{
+			CTR_Mode<AES>::Encryption e1(aesKey, aesKey.size(), aesIV), e2(aesKey, aesKey.size(), aesIV);
+			fail = !TestParallelFilter(e1, e2, message);
+
+			// Counter near the wrap, with buffered keystream between calls
+			SecByteBlock expected(message.size()), actual(message.size()), counter(16);
+			std::memset(counter, 0xff, counter.size());
+			counter[0] = 0x01;
+			e1.Resynchronize(counter); e2.Resynchronize(counter);
+			e1.ProcessData(expected, message, 5);
+			e1.ProcessData(expected+5, message+5, message.size()-5);
+			e2.ProcessSegments(actual, message, 5, 4096);
+			e2.ProcessSegments(actual+5, message+5, message.size()-5, 4096);
+			fail = (expected != actual) || fail;
+
+			pass = pass && !fail;
+			std::cout << (fail ? "FAILED   " : "passed   ") << "CTR ParallelStreamTransformationFilter" << std::endl;
+		}
+		{
+			XTS_Mode<AES>::Encryption e1(xtsKey, xtsKey.size(), aesIV), e2(xtsKey, xtsKey.size(), aesIV);
+			XTS_Mode<AES>::Decryption d1(xtsKey, xtsKey.size(), aesIV), d2(xtsKey, xtsKey.size(), aesIV);
+			fail = !TestParallelFilter(e1, e2, message, BlockPaddingSchemeDef::NO_PADDING) ||
+			       !TestParallelFilter(d1, d2, message, BlockPaddingSchemeDef::NO_PADDING);
+			pass = pass && !fail;
+			std::cout << (fail ? "FAILED   " : "passed   ") << "XTS ParallelStreamTransformationFilter" << std::endl;
+		}
+		{
+			fail = !TestParallelFilterBuffering(aesKey, aesIV, message);
+			pass = pass && !fail;
+			std::cout << (fail ? "FAILED   " : "passed   ") << "ParallelStreamTransformationFilter buffers" << std::endl;
+
+			fail = !TestSegmentWorkers(xtsKey, aesIV, message);
+			pass = pass && !fail;
+			std::cout << (fail ? "FAILED   " : "passed   ") << "SegmentWorkers" << std::endl;
+		}
+	}
+
 	return pass;
 }
 
@@ -971,6 +1292,59 @@ bool ValidateMARS()
 	return pass1 && pass2 && pass3;
 }
 
+// The bitsliced kernels run for parallel modes on processors without
+// AES-NI. AES-NI and VAES are cleared before keying so the key schedule
+// and ProcessBlock() use the tables. AVX2 is cleared as well to reach the
+// SSSE3 kernel. GCM is compared with an object keyed normally. The flags
+// are restored afterwards.
+bool TestRijndaelBitsliced()
+{
+	bool pass = true;
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	const bool hasAESNI = HasAESNI(), hasVAES = HasVAES(), hasAVX2 = HasAVX2();
+	const char *names[] = {"AES bitsliced AVX2", "AES bitsliced SSSE3"};
+
+	byte key[16], iv[12], header[20], mac[16], mac2[16];
+	SecByteBlock plain(40*16), cipher(plain.size()), cipher2(plain.size());
+	GlobalRNG().GenerateBlock(key, sizeof(key));
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(header, sizeof(header));
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+	GCM<AES>::Encryption r;
+	r.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+
+	for (unsigned int i=0; i<2; ++i)
+	{
+		bool fail = false;
+		g_hasAESNI = g_hasVAES = false;
+		g_hasAVX2 = hasAVX2 && i == 0;
+
+		pass = TestMultiBlockModes<AES>(names[i], 40) && pass;
+
+		GCM<AES>::Encryption e;
+		e.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+
+		for (size_t len=16; len<=plain.size(); len+=16)
+		{
+			g_hasAESNI = g_hasVAES = false;
+			g_hasAVX2 = hasAVX2 && i == 0;
+			e.EncryptAndAuthenticate(cipher, mac, 16, iv, 12, header, sizeof(header), plain, len);
+
+			g_hasAESNI = hasAESNI; g_hasVAES = hasVAES; g_hasAVX2 = hasAVX2;
+			r.EncryptAndAuthenticate(cipher2, mac2, 16, iv, 12, header, sizeof(header), plain, len);
+			fail = !!memcmp(cipher, cipher2, len) || !!memcmp(mac, mac2, sizeof(mac)) || fail;
+		}
+
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED:" : "passed:") << "  " << names[i] << " GCM, 1 to 40 blocks\n";
+	}
+#endif
+
+	return pass;
+}
+
 bool ValidateRijndael()
 {
 	std::cout << "\nRijndael (AES) validation suite running...\n\n";
@@ -1002,13 +1376,16 @@ bool ValidateRijndael()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RijndaelEncryption, RijndaelDecryption>(24), valdata, 3) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RijndaelEncryption, RijndaelDecryption>(32), valdata, 2) && pass3;
 	pass3 = RunTestDataFile("TestVectors/aes.txt") && pass3;
+
+	std::cout << "\n";
+	pass3 = TestRijndaelBitsliced() && pass3;
 	return pass1 && pass2 && pass3;
 }
 
 bool ValidateTwofish()
 {
 	std::cout << "\nTwofish validation suite running...\n\n";
-	bool pass1 = true, pass2 = true, pass3 = true;
+	bool pass1 = true, pass2 = true, pass3 = true, pass4 = true;
 
 	TwofishEncryption enc;
 	pass1 = enc.StaticGetValidKeyLength(8) == 16 && pass1;
@@ -1031,13 +1408,16 @@ bool ValidateTwofish()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<TwofishEncryption, TwofishDecryption>(16), valdata, 4) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<TwofishEncryption, TwofishDecryption>(24), valdata, 3) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<TwofishEncryption, TwofishDecryption>(32), valdata, 2) && pass3;
-	return pass1 && pass2 && pass3;
+
+	std::cout << "\n";
+	pass4 = TestMultiBlockModes<Twofish>("Twofish", 20) && pass4;
+	return pass1 && pass2 && pass3 && pass4;
 }
 
 bool ValidateSerpent()
 {
 	std::cout << "\nSerpent validation suite running...\n\n";
-	bool pass1 = true, pass2 = true, pass3 = true;
+	bool pass1 = true, pass2 = true, pass3 = true, pass4 = true;
 
 	SerpentEncryption enc;
 	pass1 = enc.StaticGetValidKeyLength(8) == 16 && pass1;
@@ -1060,7 +1440,10 @@ bool ValidateSerpent()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<SerpentEncryption, SerpentDecryption>(16), valdata, 5) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<SerpentEncryption, SerpentDecryption>(24), valdata, 4) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<SerpentEncryption, SerpentDecryption>(32), valdata, 3) && pass3;
-	return pass1 && pass2 && pass3;
+
+	std::cout << "\n";
+	pass4 = TestMultiBlockModes<Serpent>("Serpent", 20) && pass4;
+	return pass1 && pass2 && pass3 && pass4;
 }
 
 bool ValidateBlowfish()
@@ -1701,7 +2084,7 @@ bool ValidateSPECK()
 bool ValidateCamellia()
 {
 	std::cout << "\nCamellia validation suite running...\n\n";
-	bool pass1 = true, pass2 = true, pass3 = true;
+	bool pass1 = true, pass2 = true, pass3 = true, pass4 = true;
 
 	CamelliaEncryption enc;
 	pass1 = enc.StaticGetValidKeyLength(8) == 16 && pass1;
@@ -1728,28 +2111,237 @@ bool ValidateCamellia()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<CamelliaEncryption, CamelliaDecryption>(16), valdata, 15) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<CamelliaEncryption, CamelliaDecryption>(24), valdata, 15) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<CamelliaEncryption, CamelliaDecryption>(32), valdata, 15) && pass3;
-	return pass1 && pass2 && pass3;
+
+	std::cout << "\n";
+	pass4 = TestMultiBlockModes<Camellia>("Camellia", 20) && pass4;
+	return pass1 && pass2 && pass3 && pass4;
+}
+
+bool ValidateThreefish()
+{
+	std::cout << "\nThreefish validation suite running...\n";
+	bool pass = RunTestDataFile("TestVectors/threefish.txt");
+
+	std::cout << "\n";
+	pass = TestMultiBlockModes<Threefish256>("Threefish-256", 12) && pass;
+	pass = TestMultiBlockModes<Threefish512>("Threefish-512", 12) && pass;
+	pass = TestMultiBlockModes<Threefish1024>("Threefish-1024", 12) && pass;
+	return pass;
+}
+
+// XSalsa20 with a key and nonce must equal Salsa20 with the HSalsa20
+// subkey and the last 8 bytes of the nonce. The multi-block keystream
+// must also match single blocks across the 32-bit counter wrap.
+bool TestHSalsa20()
+{
+	bool fail = false;
+
+	const unsigned int count = 11;
+	byte keys[count*32], nonces[count*24], subkeys[count*32], subkey[32];
+	byte zero[300], stream1[300], stream2[300];
+	GlobalRNG().GenerateBlock(keys, sizeof(keys));
+	GlobalRNG().GenerateBlock(nonces, sizeof(nonces));
+	std::memset(zero, 0x00, sizeof(zero));
+
+	byte hnonces[count*16];
+	for (unsigned int i=0; i<count; ++i)
+		std::memcpy(hnonces+i*16, nonces+i*24, 16);
+
+	const unsigned int rounds[] = {8, 12, 20};
+	for (unsigned int r=0; r<COUNTOF(rounds); ++r)
+	{
+		HSalsa20(subkeys, keys, hnonces, count, rounds[r]);
+		for (unsigned int i=0; i<count; ++i)
+		{
+			HSalsa20(subkey, keys+i*32, hnonces+i*16, 1, rounds[r]);
+			fail = !!std::memcmp(subkey, subkeys+i*32, 32) || fail;
+
+			const byte *nonce = nonces+i*24;
+			XSalsa20::Encryption x;
+			x.SetKey(keys+i*32, 32, MakeParameters(Name::IV(), ConstByteArrayParameter(nonce, 24))(Name::Rounds(), (int)rounds[r]));
+			x.ProcessString(stream1, zero, sizeof(zero));
+
+			Salsa20::Encryption s;
+			s.SetKey(subkeys+i*32, 32, MakeParameters(Name::IV(), ConstByteArrayParameter(nonce+16, 8))(Name::Rounds(), (int)rounds[r]));
+			s.ProcessString(stream2, zero, sizeof(zero));
+			fail = !!std::memcmp(stream1, stream2, sizeof(zero)) || fail;
+		}
+	}
+
+	byte wrap1[20*64], wrap2[20*64];
+	std::memset(wrap1, 0x00, sizeof(wrap1));
+	std::memset(wrap2, 0x00, sizeof(wrap2));
+
+	Salsa20::Encryption s1, s2;
+	s1.SetKeyWithIV(keys, 32, nonces, 8);
+	s2.SetKeyWithIV(keys, 32, nonces, 8);
+	s1.Seek((W64LIT(0x100000000) - 5) * 64);
+	s2.Seek((W64LIT(0x100000000) - 5) * 64);
+	s1.ProcessString(wrap1, sizeof(wrap1));
+	for (unsigned int i=0; i<20; ++i)
+		s2.ProcessString(wrap2+i*64, 64);
+	fail = !!std::memcmp(wrap1, wrap2, sizeof(wrap1)) || fail;
+
+	try
+	{
+		HSalsa20(subkey, keys, hnonces, 1, 10);
+		fail = true;
+	}
+	catch (const InvalidRounds&) {}
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  HSalsa20 and XSalsa20 subkeys\n";
+	return !fail;
 }
 
 bool ValidateSalsa()
 {
 	std::cout << "\nSalsa validation suite running...\n";
 
-	return RunTestDataFile("TestVectors/salsa.txt");
+	bool pass = RunTestDataFile("TestVectors/salsa.txt");
+	return TestHSalsa20() && pass;
+}
+
+// The AVX-512 kernel runs 16 blocks, or 1024 bytes, per call. A keystream
+// produced in pieces that cross the 1024-byte groups, and after seeks into
+// the middle of a group, must match one produced without AVX-512.
+bool TestChaChaLongKeystream()
+{
+	bool fail = false;
+
+	const size_t len = 5000, pieces[] = {1, 1000, 23, 1024, 1500, 63, len-3611};
+	const lword seeks[] = {320, 1024+3*64+17, 2047, 4096};
+	byte key[32], iv[8];
+	SecByteBlock expected(len), keystream(len);
+	GlobalRNG().GenerateBlock(key, sizeof(key));
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	std::memset(expected, 0x00, len);
+
+	ChaCha::Encryption r;
+#if CRYPTOPP_AVX512_AVAILABLE
+	const bool hasAVX512F = HasAVX512F();
+	g_hasAVX512F = false;
+#endif
+	r.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+	r.ProcessString(expected, len);
+#if CRYPTOPP_AVX512_AVAILABLE
+	g_hasAVX512F = hasAVX512F;
+#endif
+
+	ChaCha::Encryption e;
+	e.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+	std::memset(keystream, 0x00, len);
+	size_t pos = 0;
+	for (unsigned int i=0; i<COUNTOF(pieces); pos+=pieces[i++])
+		e.ProcessString(keystream+pos, pieces[i]);
+	fail = !!memcmp(keystream, expected, len) || fail;
+
+	for (unsigned int i=0; i<COUNTOF(seeks); ++i)
+	{
+		const size_t offset = static_cast<size_t>(seeks[i]);
+		std::memset(keystream, 0x00, len);
+		e.Seek(seeks[i]);
+		e.ProcessString(keystream, len-offset);
+		fail = !!memcmp(keystream, expected+offset, len-offset) || fail;
+	}
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  ChaCha20 keystream in pieces and after seeks\n";
+	return !fail;
 }
 
 bool ValidateChaCha()
 {
 	std::cout << "\nChaCha validation suite running...\n";
 
-	return RunTestDataFile("TestVectors/chacha.txt");
+	bool pass = RunTestDataFile("TestVectors/chacha.txt");
+	return TestChaChaLongKeystream() && pass;
+}
+
+// EncryptAndAuthenticate() and DecryptAndVerify() run ChaCha20 and
+// Poly1305 in one pass, with the stitched AVX2 kernel for 512 bytes or
+// more. They must agree with Update(), ProcessData() and TruncatedFinal()
+// for multi-KiB messages of lengths that are not a multiple of 64, with
+// and without AAD, and with AVX2 cleared. The flag is restored afterwards.
+bool TestChaChaPolyOnePass(AuthenticatedSymmetricCipher &e, AuthenticatedSymmetricCipher &d, const char *name)
+{
+	bool fail = false;
+
+	const size_t lengths[] = {100, 1000, 2049, 4099, 8191, 12345};
+	const size_t aadLengths[] = {0, 37};
+	const int ivLength = (int)e.IVSize();
+	byte iv[24], aad[37], mac[16], mac2[16];
+	SecByteBlock plain(12345), cipher(plain.size()), cipher2(plain.size()), buf(plain.size());
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(aad, sizeof(aad));
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	const bool hasAVX2 = HasAVX2();
+#endif
+
+	for (unsigned int k=0; k<2; ++k)
+	{
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+		g_hasAVX2 = hasAVX2 && k == 0;
+#endif
+		for (unsigned int i=0; i<COUNTOF(lengths); ++i)
+		{
+			for (unsigned int j=0; j<COUNTOF(aadLengths); ++j)
+			{
+				const size_t len = lengths[i], alen = aadLengths[j];
+
+				e.EncryptAndAuthenticate(cipher, mac, 16, iv, ivLength, aad, alen, plain, len);
+
+				e.Resynchronize(iv, ivLength);
+				e.Update(aad, alen);
+				e.ProcessData(cipher2, plain, len);
+				e.TruncatedFinal(mac2, 16);
+				fail = !!memcmp(cipher, cipher2, len) || !!memcmp(mac, mac2, 16) || fail;
+
+				// In place
+				std::memcpy(buf, cipher, len);
+				fail = !d.DecryptAndVerify(buf, mac, 16, iv, ivLength, aad, alen, buf, len) || fail;
+				fail = !!memcmp(buf, plain, len) || fail;
+
+				d.Resynchronize(iv, ivLength);
+				d.Update(aad, alen);
+				d.ProcessData(buf, cipher, len);
+				fail = !d.TruncatedVerify(mac, 16) || !!memcmp(buf, plain, len) || fail;
+			}
+		}
+	}
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	g_hasAVX2 = hasAVX2;
+#endif
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  " << name << " one-pass and incremental interfaces\n";
+	return !fail;
 }
 
 bool ValidateChaChaTLS()
 {
 	std::cout << "\nChaCha-TLS validation suite running...\n";
 
-	return RunTestDataFile("TestVectors/chacha_tls.txt");
+	bool pass = RunTestDataFile("TestVectors/chacha_tls.txt");
+
+	SecByteBlock key(32), iv(24);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+
+	const int ivLengths[] = {12}, xivLengths[] = {24};
+	ChaCha20Poly1305::Encryption e;
+	ChaCha20Poly1305::Decryption d;
+	e.SetKeyWithIV(key, key.size(), iv, 12);
+	d.SetKeyWithIV(key, key.size(), iv, 12);
+	pass = TestAuthenticatedBatch(e, d, ivLengths, COUNTOF(ivLengths), "ChaCha20Poly1305") && pass;
+	pass = TestChaChaPolyOnePass(e, d, "ChaCha20Poly1305") && pass;
+
+	XChaCha20Poly1305::Encryption xe;
+	XChaCha20Poly1305::Decryption xd;
+	xe.SetKeyWithIV(key, key.size(), iv, 24);
+	xd.SetKeyWithIV(key, key.size(), iv, 24);
+	pass = TestAuthenticatedBatch(xe, xd, xivLengths, COUNTOF(xivLengths), "XChaCha20Poly1305") && pass;
+	return TestChaChaPolyOnePass(xe, xd, "XChaCha20Poly1305") && pass;
 }
 
 bool ValidateSosemanuk()
@@ -1785,7 +2377,168 @@ bool ValidateVMAC()
 bool ValidateCCM()
 {
 	std::cout << "\nAES/CCM validation suite running...\n";
-	return RunTestDataFile("TestVectors/ccm.txt");
+	bool pass = RunTestDataFile("TestVectors/ccm.txt");
+
+	const int ivLengths[] = {7, 13, 12, 8};
+	SecByteBlock key(16);
+	GlobalRNG().GenerateBlock(key, key.size());
+
+	CCM<AES, 12>::Encryption e;
+	CCM<AES, 12>::Decryption d;
+	e.SetKeyWithIV(key, key.size(), key, 12);
+	d.SetKeyWithIV(key, key.size(), key, 12);
+	return TestAuthenticatedBatch(e, d, ivLengths, COUNTOF(ivLengths), "CCM") && pass;
+}
+
+// Objects keyed from a cached SharedKey must agree with objects keyed
+// with SetKey, and a key must outlive its eviction while still in use.
+bool TestGCMSharedKeys()
+{
+	typedef ExpandedKeyCache<const GCM_Base::SharedKey> Cache;
+	bool fail = false;
+
+	byte key[3][16], iv[12], header[20], plain[100], cipher[100], mac[16], cipher2[100], mac2[16];
+	GlobalRNG().GenerateBlock(key[0], sizeof(key));
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(header, sizeof(header));
+	GlobalRNG().GenerateBlock(plain, sizeof(plain));
+
+	Cache cache(2);
+	GCM<AES, GCM_64K_Tables>::Encryption proto;
+	const char *ids[] = {"key0", "key1", "key2"};
+	for (unsigned int i=0; i<3; ++i)
+		cache.Insert(ids[i], proto.NewSharedKey(key[i], 16, MakeParameters(Name::TableSize(), (int)(i%2 ? 2048 : 64*1024))));
+
+	Cache::Pointer shared;
+	fail = (cache.Size() != 2 || cache.Find("key0", shared)) || fail;
+	fail = !cache.Find("key1", shared) || fail;
+
+	// key1 outlives the cache. key2 uses the default tables.
+	cache.Clear();
+	fail = (cache.Size() != 0) || fail;
+
+	Cache::Pointer keys[2];
+	keys[0] = shared;
+	keys[1] = proto.NewSharedKey(key[2], 16);
+
+	for (unsigned int i=0; i<2; ++i)
+	{
+		GCM<AES>::Encryption e, e2;
+		GCM<AES, GCM_64K_Tables>::Decryption d;
+		e.SetSharedKey(keys[i]);
+		d.SetSharedKey(keys[i]);
+		e2.SetKeyWithIV(key[i+1], 16, iv, 12);
+
+		e.EncryptAndAuthenticate(cipher, mac, 16, iv, 12, header, sizeof(header), plain, sizeof(plain));
+		e2.EncryptAndAuthenticate(cipher2, mac2, 16, iv, 12, header, sizeof(header), plain, sizeof(plain));
+		fail = !!memcmp(cipher, cipher2, sizeof(cipher)) || !!memcmp(mac, mac2, sizeof(mac)) || fail;
+		fail = !d.DecryptAndVerify(cipher2, mac, 16, iv, 12, header, sizeof(header), cipher, sizeof(cipher)) || fail;
+		fail = !!memcmp(cipher2, plain, sizeof(plain)) || fail;
+	}
+
+	try
+	{
+		GCM<Serpent>::Encryption s;
+		s.SetSharedKey(shared);
+		fail = true;
+	}
+	catch (const InvalidArgument&) {}
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  GCM shared keys and key cache\n";
+	return !fail;
+}
+
+// AES keyed with AES-NI and CLMUL takes a stitched kernel for runs of
+// 8 or more blocks. The VAES kernel is used when VAES and VPCLMULQDQ are
+// available, and the AES-NI kernel otherwise. Both must agree with an
+// object keyed and used without AES-NI, which takes the separate CTR and
+// GHASH passes, for odd lengths, headers, in-place buffers and messages
+// fed in pieces.
+bool TestGCMStitched()
+{
+	bool fail = false;
+
+	byte key[32], iv[12], header[37], mac[16], mac2[16];
+	SecByteBlock plain(600), cipher(600), buf(600);
+	GlobalRNG().GenerateBlock(key, sizeof(key));
+	GlobalRNG().GenerateBlock(iv, sizeof(iv));
+	GlobalRNG().GenerateBlock(header, sizeof(header));
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+#if CRYPTOPP_AESNI_AVAILABLE
+	const bool hasAESNI = HasAESNI();
+#endif
+#if CRYPTOPP_VAES_AVAILABLE
+	const bool hasVAES = HasVAES();
+#endif
+
+	for (unsigned int k=16; k<=32; k+=8)
+	{
+		GCM<AES>::Encryption e, r;
+		GCM<AES>::Decryption d;
+		e.SetKeyWithIV(key, k, iv, 12);
+		d.SetKeyWithIV(key, k, iv, 12);
+
+		for (size_t len=0; len<=plain.size(); len+=37)
+		{
+			const size_t hlen = len % sizeof(header);
+
+			// Rijndael's VAES code also expects AES-NI subkeys
+#if CRYPTOPP_AESNI_AVAILABLE
+			g_hasAESNI = false;
+#endif
+#if CRYPTOPP_VAES_AVAILABLE
+			g_hasVAES = false;
+#endif
+			r.SetKeyWithIV(key, k, iv, 12);
+			r.EncryptAndAuthenticate(cipher, mac, 16, iv, 12, header, hlen, plain, len);
+#if CRYPTOPP_AESNI_AVAILABLE
+			g_hasAESNI = hasAESNI;
+#endif
+
+			// VAES kernel, then the AES-NI kernel
+			for (unsigned int v=0; v<2; ++v)
+			{
+#if CRYPTOPP_VAES_AVAILABLE
+				g_hasVAES = hasVAES && v == 0;
+#endif
+				e.EncryptAndAuthenticate(buf, mac2, 16, iv, 12, header, hlen, plain, len);
+				fail = !!memcmp(buf, cipher, len) || !!memcmp(mac, mac2, sizeof(mac)) || fail;
+
+				std::memcpy(buf, plain, len);
+				e.EncryptAndAuthenticate(buf, mac2, 16, iv, 12, header, hlen, buf, len);
+				fail = !!memcmp(buf, cipher, len) || !!memcmp(mac, mac2, sizeof(mac)) || fail;
+
+				fail = !d.DecryptAndVerify(buf, mac, 16, iv, 12, header, hlen, buf, len) || fail;
+				fail = !!memcmp(buf, plain, len) || fail;
+			}
+#if CRYPTOPP_VAES_AVAILABLE
+			g_hasVAES = hasVAES;
+#endif
+		}
+
+		// The last message, fed after a partial block
+		const size_t len = 37*16, pieces[] = {5, 200, 11, 333, len-549};
+		for (unsigned int v=0; v<2; ++v)
+		{
+#if CRYPTOPP_VAES_AVAILABLE
+			g_hasVAES = hasVAES && v == 0;
+#endif
+			e.Resynchronize(iv, 12);
+			e.Update(header, len % sizeof(header));
+			size_t pos = 0;
+			for (unsigned int i=0; i<COUNTOF(pieces); pos+=pieces[i++])
+				e.ProcessData(buf+pos, plain+pos, pieces[i]);
+			e.TruncatedFinal(mac2, sizeof(mac2));
+			fail = !!memcmp(buf, cipher, len) || !!memcmp(mac, mac2, sizeof(mac)) || fail;
+		}
+#if CRYPTOPP_VAES_AVAILABLE
+		g_hasVAES = hasVAES;
+#endif
+	}
+
+	std::cout << (fail ? "FAILED:" : "passed:") << "  GCM stitched kernels and separate passes\n";
+	return !fail;
 }
 
 bool ValidateGCM()
@@ -1794,13 +2547,327 @@ bool ValidateGCM()
 	std::cout << "\n2K tables:";
 	bool pass = RunTestDataFile("TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)2048));
 	std::cout << "\n64K tables:";
-	return RunTestDataFile("TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)64*1024)) && pass;
+	pass = RunTestDataFile("TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)64*1024)) && pass;
+
+	// 16-byte IVs take the single message path
+	const int ivLengths[] = {12, 12, 12, 16};
+	SecByteBlock key(16);
+	GlobalRNG().GenerateBlock(key, key.size());
+
+	GCM<AES>::Encryption e;
+	GCM<AES>::Decryption d;
+	e.SetKeyWithIV(key, key.size(), key, 12);
+	d.SetKeyWithIV(key, key.size(), key, 12);
+	pass = TestAuthenticatedBatch(e, d, ivLengths, COUNTOF(ivLengths), "GCM") && pass;
+
+	pass = TestGCMStitched() && pass;
+	return TestGCMSharedKeys() && pass;
+}
+
+// RFC 7253, Appendix A. The iterated test covers every header and
+// message length up to 127 bytes.
+bool ValidateOCB()
+{
+	std::cout << "\nAES/OCB validation suite running...\n\n";
+	bool pass = true, fail;
+
+	// nonce, associated data, plaintext, ciphertext || tag
+	static const char *tests[][4] = {
+		{"BBAA99887766554433221100", "", "", "785407BFFFC8AD9EDCC5520AC9111EE6"},
+		{"BBAA99887766554433221101", "0001020304050607", "0001020304050607",
+			"6820B3657B6F615A5725BDA0D3B4EB3A257C9AF1F8F03009"},
+		{"BBAA99887766554433221102", "0001020304050607", "", "81017F8203F081277152FADE694A0A00"},
+		{"BBAA99887766554433221103", "", "0001020304050607",
+			"45DD69F8F5AAE72414054CD1F35D82760B2CD00D2F99BFA9"},
+		{"BBAA99887766554433221104", "000102030405060708090A0B0C0D0E0F", "000102030405060708090A0B0C0D0E0F",
+			"571D535B60B277188BE5147170A9A22C3AD7A4FF3835B8C5701C1CCEC8FC3358"}
+	};
+
+	std::string key;
+	StringSource("000102030405060708090A0B0C0D0E0F", true, new HexDecoder(new StringSink(key)));
+
+	OCB<AES>::Encryption e;
+	OCB<AES>::Decryption d;
+	e.SetKeyWithIV(ConstBytePtr(key), key.size(), ConstBytePtr(key), 12);
+	d.SetKeyWithIV(ConstBytePtr(key), key.size(), ConstBytePtr(key), 12);
+
+	fail = false;
+	for (size_t i=0; i<COUNTOF(tests); ++i)
+	{
+		std::string v[4];
+		for (size_t j=0; j<4; ++j)
+			StringSource(tests[i][j], true, new HexDecoder(new StringSink(v[j])));
+
+		const size_t length = v[2].size();
+		SecByteBlock cipher(length+16), plain(length+1);
+		e.EncryptAndAuthenticate(cipher, cipher+length, 16, ConstBytePtr(v[0]), (int)v[0].size(),
+			ConstBytePtr(v[1]), v[1].size(), ConstBytePtr(v[2]), length);
+		fail = (std::string((const char *)cipher.begin(), cipher.size()) != v[3]) || fail;
+
+		fail = !d.DecryptAndVerify(plain, cipher+length, 16, ConstBytePtr(v[0]), (int)v[0].size(),
+			ConstBytePtr(v[1]), v[1].size(), cipher, length) || fail;
+		fail = (std::memcmp(plain, v[2].data(), length) != 0) || fail;
+
+		cipher[0] ^= 1;
+		fail = d.DecryptAndVerify(plain, cipher+length, 16, ConstBytePtr(v[0]), (int)v[0].size(),
+			ConstBytePtr(v[1]), v[1].size(), cipher, length) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED:" : "passed:") << "  RFC 7253 sample results\n";
+
+	const int tagLengths[] = {16, 12, 8};
+	const char *results[] = {"67E944D23256C5E0B6C61FA22FDF1EA2", "77A3D8E73589158D25D01209", "192C9B7BD90BA06A"};
+
+	fail = false;
+	for (size_t t=0; t<COUNTOF(tagLengths); ++t)
+	{
+		const int tagLength = tagLengths[t];
+		byte k[16], nonce[12], zeros[128], out[128+16];
+		std::memset(k, 0, sizeof(k));
+		std::memset(nonce, 0, sizeof(nonce));
+		std::memset(zeros, 0, sizeof(zeros));
+		k[15] = byte(8*tagLength);
+
+		OCB<AES>::Encryption ei;
+		ei.SetKey(k, sizeof(k), MakeParameters(Name::IV(), ConstByteArrayParameter((const byte *)nonce, sizeof(nonce)))
+			(Name::DigestSize(), tagLength));
+
+		std::string c;
+		for (word32 i=0; i<128; ++i)
+		{
+			for (word32 j=1; j<=3; ++j)
+			{
+				const size_t headerLength = (j == 2) ? 0 : i, length = (j == 3) ? 0 : i;
+				PutWord(false, BIG_ENDIAN_ORDER, nonce+8, word32(3*i+j));
+				ei.EncryptAndAuthenticate(out, out+length, tagLength, nonce, sizeof(nonce),
+					zeros, headerLength, zeros, length);
+				c.append((const char *)out, length+tagLength);
+			}
+		}
+
+		std::string expected, tag;
+		PutWord(false, BIG_ENDIAN_ORDER, nonce+8, word32(385));
+		ei.EncryptAndAuthenticate(out, out, tagLength, nonce, sizeof(nonce), ConstBytePtr(c), c.size(), NULLPTR, 0);
+		StringSource(results[t], true, new HexDecoder(new StringSink(expected)));
+		fail = (std::memcmp(out, expected.data(), tagLength) != 0) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED:" : "passed:") << "  RFC 7253 iterated results\n";
+
+	// The filters hand OCB whole blocks, and then the partial last block
+	fail = false;
+	{
+		const size_t pieces[] = {1, 40, 16, 999, 7};
+		SecByteBlock message(3000+5), header(21), iv(12), cipher(message.size()), mac(16);
+		GlobalRNG().GenerateBlock(message, message.size());
+		GlobalRNG().GenerateBlock(iv, iv.size());
+		GlobalRNG().GenerateBlock(header, header.size());
+
+		e.EncryptAndAuthenticate(cipher, mac, mac.size(), iv, (int)iv.size(), header, header.size(), message, message.size());
+
+		std::string actual, recovered;
+		e.Resynchronize(iv, (int)iv.size());
+		AuthenticatedEncryptionFilter ef(e, new StringSink(actual));
+		ef.ChannelPut(AAD_CHANNEL, header, header.size());
+		ef.ChannelMessageEnd(AAD_CHANNEL);
+		for (size_t i=0, offset=0; offset<message.size(); ++i)
+		{
+			const size_t len = STDMIN(pieces[i%COUNTOF(pieces)], message.size()-offset);
+			ef.Put(message+offset, len);
+			offset += len;
+		}
+		ef.MessageEnd();
+
+		fail = (actual != std::string((const char *)cipher.begin(), cipher.size()) + std::string((const char *)mac.begin(), mac.size()));
+
+		d.Resynchronize(iv, (int)iv.size());
+		AuthenticatedDecryptionFilter df(d, new StringSink(recovered),
+			AuthenticatedDecryptionFilter::MAC_AT_BEGIN | AuthenticatedDecryptionFilter::THROW_EXCEPTION);
+		df.ChannelPut(DEFAULT_CHANNEL, mac, mac.size());
+		df.ChannelPut(AAD_CHANNEL, header, header.size());
+		for (size_t i=0, offset=0; offset<cipher.size(); ++i)
+		{
+			const size_t len = STDMIN(pieces[(i+1)%COUNTOF(pieces)], cipher.size()-offset);
+			df.ChannelPut(DEFAULT_CHANNEL, cipher+offset, len);
+			offset += len;
+		}
+		df.ChannelMessageEnd(AAD_CHANNEL);
+		df.ChannelMessageEnd(DEFAULT_CHANNEL);
+
+		fail = (recovered != std::string((const char *)message.begin(), message.size())) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED:" : "passed:") << "  AuthenticatedEncryptionFilter and AuthenticatedDecryptionFilter\n";
+
+	const int ivLengths[] = {12, 15, 1, 8};
+	return TestAuthenticatedBatch(e, d, ivLengths, COUNTOF(ivLengths), "OCB") && pass;
+}
+
+bool ValidateAEGIS()
+{
+	std::cout << "\nAEGIS validation suite running...\n\n";
+	bool pass = true, fail;
+
+	// variant, key, nonce, associated data, plaintext, ciphertext, tag
+	static const char *tests[][7] = {
+		{"128L", "10010000000000000000000000000000", "10000200000000000000000000000000", "", "00000000000000000000000000000000", "c1c0e58bd913006feba00f4b3cc3594e", "abe0ece80c24868a226a35d16bdae37a"},
+		{"128L", "10010000000000000000000000000000", "10000200000000000000000000000000", "", "00000000000000000000000000000000", "c1c0e58bd913006feba00f4b3cc3594e",
+			"25835bfbb21632176cf03840687cb968cace4617af1bd0f7d064c639a5c79ee4"},
+		{"128L", "10010000000000000000000000000000", "10000200000000000000000000000000", "", "", "", "c2b879a67def9d74e6c14f708bbcc9b4"},
+		{"128L", "10010000000000000000000000000000", "10000200000000000000000000000000", "0001020304050607", "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+			"79d94593d8c2119d7e8fd9b8fc77845c5c077a05b2528b6ac54b563aed8efe84", "cc6f3372f6aa1bb82388d695c3962d9a"},
+		{"128L", "10010000000000000000000000000000", "10000200000000000000000000000000", "0001020304050607", "000102030405060708090a0b0c0d",
+			"79d94593d8c2119d7e8fd9b8fc77", "5c04b3dba849b2701effbe32c7f0fab7"},
+		{"256", "1001000000000000000000000000000000000000000000000000000000000000", "1000020000000000000000000000000000000000000000000000000000000000", "", "00000000000000000000000000000000", "754fc3d8c973246dcc6d741412a4b236", "3fe91994768b332ed7f570a19ec5896e"},
+		{"256", "1001000000000000000000000000000000000000000000000000000000000000", "1000020000000000000000000000000000000000000000000000000000000000", "", "", "", "e3def978a0f054afd1e761d7553afba3"},
+		{"256", "1001000000000000000000000000000000000000000000000000000000000000", "1000020000000000000000000000000000000000000000000000000000000000", "0001020304050607", "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+			"f373079ed84b2709faee373584585d60accd191db310ef5d8b11833df9dec711", "8d86f91ee606e9ff26a01b64ccbdd91d"}
+	};
+
+	AEGIS128L::Encryption e128;
+	AEGIS128L::Decryption d128;
+	AEGIS256::Encryption e256;
+	AEGIS256::Decryption d256;
+
+	fail = false;
+	for (size_t i=0; i<COUNTOF(tests); ++i)
+	{
+		const bool is128 = std::strcmp(tests[i][0], "128L") == 0;
+		AuthenticatedSymmetricCipher &e = is128 ? static_cast<AuthenticatedSymmetricCipher &>(e128) : e256;
+		AuthenticatedSymmetricCipher &d = is128 ? static_cast<AuthenticatedSymmetricCipher &>(d128) : d256;
+
+		std::string v[7];
+		for (size_t j=1; j<7; ++j)
+			StringSource(tests[i][j], true, new HexDecoder(new StringSink(v[j])));
+
+		const size_t length = v[4].size(), tagLength = v[6].size();
+		const AlgorithmParameters params = MakeParameters(Name::IV(), ConstByteArrayParameter(v[2]))
+			(Name::DigestSize(), (int)tagLength);
+		e.SetKey(ConstBytePtr(v[1]), v[1].size(), params);
+		d.SetKey(ConstBytePtr(v[1]), v[1].size(), params);
+
+		SecByteBlock cipher(length+tagLength), plain(length+1);
+		e.EncryptAndAuthenticate(cipher, cipher+length, tagLength, ConstBytePtr(v[2]), (int)v[2].size(),
+			ConstBytePtr(v[3]), v[3].size(), ConstBytePtr(v[4]), length);
+		fail = (std::string((const char *)cipher.begin(), cipher.size()) != v[5] + v[6]) || fail;
+
+		fail = !d.DecryptAndVerify(plain, cipher+length, tagLength, ConstBytePtr(v[2]), (int)v[2].size(),
+			ConstBytePtr(v[3]), v[3].size(), cipher, length) || fail;
+		fail = (std::memcmp(plain, v[4].data(), length) != 0) || fail;
+
+		cipher[0] ^= 1;
+		fail = d.DecryptAndVerify(plain, cipher+length, tagLength, ConstBytePtr(v[2]), (int)v[2].size(),
+			ConstBytePtr(v[3]), v[3].size(), cipher, length) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED:" : "passed:") << "  AEGIS-128L and AEGIS-256 test vectors\n";
+
+	// Partial blocks are carried between calls of Update() and ProcessData()
+	fail = false;
+	for (size_t t=0; t<2; ++t)
+	{
+		AuthenticatedSymmetricCipher &e = t ? static_cast<AuthenticatedSymmetricCipher &>(e256) : e128;
+		AuthenticatedSymmetricCipher &d = t ? static_cast<AuthenticatedSymmetricCipher &>(d256) : d128;
+
+		const size_t pieces[] = {1, 40, 16, 999, 7, 31, 33};
+		SecByteBlock key(e.DefaultKeyLength()), iv(e.IVSize()), header(101), message(3000+5);
+		SecByteBlock cipher(message.size()), mac(16), actual(message.size()), recovered(message.size());
+		GlobalRNG().GenerateBlock(key, key.size());
+		GlobalRNG().GenerateBlock(iv, iv.size());
+		GlobalRNG().GenerateBlock(header, header.size());
+		GlobalRNG().GenerateBlock(message, message.size());
+
+		e.SetKeyWithIV(key, key.size(), iv, iv.size());
+		d.SetKeyWithIV(key, key.size(), iv, iv.size());
+		e.EncryptAndAuthenticate(cipher, mac, mac.size(), iv, (int)iv.size(), header, header.size(), message, message.size());
+
+		e.Resynchronize(iv, (int)iv.size());
+		d.Resynchronize(iv, (int)iv.size());
+		for (size_t i=0, offset=0; offset<header.size(); ++i)
+		{
+			const size_t len = STDMIN(pieces[i%COUNTOF(pieces)], header.size()-offset);
+			e.Update(header+offset, len);
+			d.Update(header+offset, len);
+			offset += len;
+		}
+		for (size_t i=0, offset=0; offset<message.size(); ++i)
+		{
+			const size_t len = STDMIN(pieces[(i+1)%COUNTOF(pieces)], message.size()-offset);
+			e.ProcessData(actual+offset, message+offset, len);
+			d.ProcessData(recovered+offset, cipher+offset, len);
+			offset += len;
+		}
+
+		fail = (actual != cipher || recovered != message) || fail;
+		fail = !e.Verify(mac) || !d.Verify(mac) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED:" : "passed:") << "  AEGIS incremental processing\n";
+
+	const int ivLengths128[] = {16}, ivLengths256[] = {32};
+	pass = TestAuthenticatedBatch(e128, d128, ivLengths128, COUNTOF(ivLengths128), "AEGIS-128L") && pass;
+	return TestAuthenticatedBatch(e256, d256, ivLengths256, COUNTOF(ivLengths256), "AEGIS-256") && pass;
 }
 
 bool ValidateXTS()
 {
 	std::cout << "\nAES/XTS validation suite running...\n";
-	return RunTestDataFile("TestVectors/xts.txt");
+	bool pass = RunTestDataFile("TestVectors/xts.txt");
+
+	// ProcessSectors must agree with Resynchronize and ProcessData for
+	// each sector. 40 sectors span more than one batch of tweaks.
+	const size_t sectorSizes[] = {16, 512, 4096};
+	const ByteOrder orders[] = {BIG_ENDIAN_ORDER, LITTLE_ENDIAN_ORDER};
+	const word64 sector = W64LIT(0xfffffffe);
+	bool fail = false;
+
+	SecByteBlock key(64), iv(16);
+	GlobalRNG().GenerateBlock(key, key.size());
+
+	for (size_t i=0; i<COUNTOF(sectorSizes); ++i)
+	{
+		for (size_t j=0; j<COUNTOF(orders); ++j)
+		{
+			const size_t sectorSize = sectorSizes[i], count = 40;
+			SecByteBlock plain(sectorSize*count), cipher(plain.size()), expected(plain.size());
+			GlobalRNG().GenerateBlock(plain, plain.size());
+
+			XTS_Mode<AES>::Encryption enc;
+			enc.SetKeyWithIV(key, key.size(), iv);
+			for (size_t k=0; k<count; ++k)
+			{
+				enc.Resynchronize(sector+k, orders[j]);
+				enc.ProcessData(expected+k*sectorSize, plain+k*sectorSize, sectorSize);
+			}
+
+			enc.ProcessSectors(cipher, plain, cipher.size(), sectorSize, sector, orders[j]);
+			fail = (cipher != expected) || fail;
+
+			XTS_Mode<AES>::Decryption dec;
+			dec.SetKeyWithIV(key, key.size(), iv);
+			dec.ProcessSectors(cipher, cipher, cipher.size(), sectorSize, sector, orders[j]);
+			fail = (cipher != plain) || fail;
+		}
+	}
+
+	try
+	{
+		XTS_Mode<AES>::Encryption enc;
+		enc.SetKeyWithIV(key, key.size(), iv);
+		enc.ProcessSectors(key, key, 64, 24, 0);
+		fail = true;
+	}
+	catch (const InvalidArgument&) {}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED:" : "passed:") << "  XTS ProcessSectors\n";
+
+	return pass;
 }
 
 bool ValidateCMAC()
@@ -27,6 +27,7 @@
 #include "ripemd.h"
 #include "siphash.h"
 #include "poly1305.h"
+#include "integer.h"
 #include "whrlpool.h"
 
 #include "pssr.h"
@@ -1001,6 +1002,105 @@ struct Poly1305_TestTuples
 	size_t klen, mlen, nlen, dlen;
 };
 
+// Poly1305 from its definition, with Integer arithmetic modulo 2^130-5.
+// The key is r followed by s, as in Poly1305TLS.
+void Poly1305Reference(const byte key[32], const byte *message, size_t length, byte tag[16])
+{
+	byte r[16];
+	std::memcpy(r, key, 16);
+	r[3] &= 15; r[7] &= 15; r[11] &= 15; r[15] &= 15;
+	r[4] &= 252; r[8] &= 252; r[12] &= 252;
+
+	const Integer p = Integer::Power2(130) - 5;
+	const Integer rr(r, 16, Integer::UNSIGNED, LITTLE_ENDIAN_ORDER);
+	Integer acc;
+	for (size_t i=0; i<length; i+=16)
+	{
+		const size_t n = STDMIN(length-i, static_cast<size_t>(16));
+		acc += Integer(message+i, n, Integer::UNSIGNED, LITTLE_ENDIAN_ORDER) + Integer::Power2(8*n);
+		acc = acc * rr % p;
+	}
+
+	acc += Integer(key+16, 16, Integer::UNSIGNED, LITTLE_ENDIAN_ORDER);
+	for (unsigned int i=0; i<16; ++i)
+		tag[i] = acc.GetByte(i);
+}
+
+// Messages of 256 bytes or more take the 4-way AVX2 or SSE2 kernels for
+// their whole 64-byte groups. Tags of long messages with odd lengths must
+// match the definition for the AVX2, SSE2 and scalar code, and a message
+// fed to Update() in uneven pieces must get the same tag as one fed in a
+// single call. The flags are restored afterwards.
+bool TestPoly1305LongMessages()
+{
+	bool pass = true;
+
+	// RFC 8439, Appendix A.3, Test Vector #3
+	const char rfcMessage[] =
+		"Any submission to the IETF intended by the Contributor for publication as all or part "
+		"of an IETF Internet-Draft or RFC and any statement made within the context of an IETF "
+		"activity is considered an \"IETF Contribution\". Such statements include oral statements "
+		"in IETF sessions, as well as written and electronic communications made at any time or "
+		"place, which are addressed to";
+	const byte rfcKey[32] = {
+		0x36,0xe5,0xf6,0xb5,0xc5,0xe0,0x60,0x70,0xf0,0xef,0xca,0x96,0x22,0x7a,0x86,0x3e};
+	const byte rfcTag[16] = {
+		0xf3,0x47,0x7e,0x7c,0xd9,0x54,0x17,0xaf,0x89,0xa6,0xb8,0x79,0x4c,0x31,0x0c,0xf0};
+
+	const size_t lengths[] = {256, 257, 319, 333, 511, 1023, 4097};
+	const size_t pieces[] = {1, 15, 300, 17, 64, 255, 3, 1000, 37};
+	byte key[32], digest[16], expected[16];
+	SecByteBlock message(4097);
+	GlobalRNG().GenerateBlock(key, sizeof(key));
+	GlobalRNG().GenerateBlock(message, message.size());
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	const bool hasSSE2 = HasSSE2(), hasAVX2 = HasAVX2();
+#endif
+	const char *names[] = {"AVX2", "SSE2", "scalar"};
+
+	for (unsigned int k=0; k<COUNTOF(names); ++k)
+	{
+		bool fail = false;
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+		g_hasAVX2 = hasAVX2 && k == 0;
+		g_hasSSE2 = hasSSE2 && k <= 1;
+#endif
+
+		Poly1305TLS rfc(rfcKey, sizeof(rfcKey));
+		rfc.Update((const byte*)rfcMessage, std::strlen(rfcMessage));
+		rfc.Final(digest);
+		fail = (std::strlen(rfcMessage) != 375 || memcmp(digest, rfcTag, 16) != 0) || fail;
+
+		Poly1305TLS poly1305(key, sizeof(key));
+		for (unsigned int i=0; i<COUNTOF(lengths); ++i)
+		{
+			Poly1305Reference(key, message, lengths[i], expected);
+			poly1305.Update(message, lengths[i]);
+			poly1305.Final(digest);
+			fail = memcmp(digest, expected, 16) != 0 || fail;
+
+			size_t pos = 0;
+			for (unsigned int j=0; pos<lengths[i]; ++j)
+			{
+				const size_t n = STDMIN(pieces[j%COUNTOF(pieces)], lengths[i]-pos);
+				poly1305.Update(message+pos, n);
+				pos += n;
+			}
+			poly1305.Final(digest);
+			fail = memcmp(digest, expected, 16) != 0 || fail;
+		}
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << names[k] << " long messages and uneven Update() calls\n";
+		pass = pass && !fail;
+	}
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	g_hasSSE2 = hasSSE2; g_hasAVX2 = hasAVX2;
+#endif
+	return pass;
+}
+
 bool ValidatePoly1305()
 {
 	std::cout << "\nPoly1305 validation suite running...\n\n";
@@ -1116,7 +1216,7 @@ bool ValidatePoly1305()
 
 	std::cout << (!pass ? "FAILED   " : "passed   ") << count << " message authentication codes" << std::endl;
 
-	return pass;
+	return TestPoly1305LongMessages() && pass;
 }
 
 bool ValidateSipHash()
@@ -308,6 +308,97 @@ bool ValidateBBS()
 	return pass;
 }
 
+bool TestECP_P256()
+{
+	std::cout << "\nTesting P-256 backend against generic ECP arithmetic...\n\n";
+	bool pass = true, fail;
+
+	DL_GroupParameters_EC<ECP> params(ASN1::secp256r1());
+	const ECP &ec = params.GetCurve();
+	const ECP::Point &G = params.GetSubgroupGenerator();
+	const Integer &n = params.GetSubgroupOrder();
+
+	// Edge cases followed by random scalars, including some larger than n
+	Integer k[24];
+	k[0] = Integer::Zero(); k[1] = Integer::One(); k[2] = Integer::Two();
+	k[3] = n-1; k[4] = n; k[5] = n+1;
+	k[6] = Integer(15); k[7] = Integer(16); k[8] = Integer(17);
+	for (unsigned int i=9; i<24; ++i)
+		k[i] = Integer(GlobalRNG(), 1, (i % 3 == 0) ? Integer::Power2(256)-1 : n-1);
+
+	fail = false;
+	for (unsigned int i=0; i<24; ++i)
+		fail = !(params.ExponentiateBase(k[i]) == ec.Multiply(k[i], G)) || fail;
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED" : "passed") << "    fixed base multiplication\n";
+
+	// ECP::SimultaneousMultiply does not accept a zero exponent, so k[0] is skipped
+	fail = false;
+	for (unsigned int i=1; i<24; ++i)
+	{
+		const ECP::Point Q = ec.Multiply(Integer(GlobalRNG(), 1, n-1), G);
+		fail = !(params.ExponentiateElement(Q, k[i]) == ec.Multiply(k[i], Q)) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED" : "passed") << "    variable base multiplication\n";
+
+	fail = false;
+	DL_PublicKey_EC<ECP> pub;
+	for (unsigned int i=0; i<24; ++i)
+	{
+		const Integer x(GlobalRNG(), 1, n-1);
+		pub.Initialize(params, ec.Multiply(x, G));
+		const ECP::Point &Q = pub.GetPublicElement();
+
+		// u1*G + u2*Q, including u2 = 0 and a sum at infinity
+		const Integer u1 = k[i], u2 = (i == 0) ? Integer::Zero() :
+			(i == 1) ? (n - u1 * x.InverseMod(n) % n) % n : k[23-i];
+		fail = !(pub.CascadeExponentiateBaseAndPublicElement(u1, u2) == ec.CascadeMultiply(u1, G, u2, Q)) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED" : "passed") << "    double scalar multiplication\n";
+
+	ECDSA<ECP, SHA256>::Signer signer(GlobalRNG(), ASN1::secp256r1());
+	ECDSA<ECP, SHA256>::Verifier verifier(signer);
+
+	const byte message[] = "test message";
+	SecByteBlock signature(signer.MaxSignatureLength());
+	fail = false;
+	for (unsigned int i=0; i<8; ++i)
+	{
+		size_t siglen = signer.SignMessage(GlobalRNG(), message, sizeof(message), signature);
+		fail = !verifier.VerifyMessage(message, sizeof(message), signature, siglen) || fail;
+		signature[i] ^= 1;
+		fail = verifier.VerifyMessage(message, sizeof(message), signature, siglen) || fail;
+	}
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED" : "passed") << "    ECDSA signature and verification\n";
+
+	ECDH<ECP>::Domain ecdh(ASN1::secp256r1());
+	SecByteBlock priv1(ecdh.PrivateKeyLength()), priv2(ecdh.PrivateKeyLength());
+	SecByteBlock pub1(ecdh.PublicKeyLength()), pub2(ecdh.PublicKeyLength());
+	SecByteBlock val1(ecdh.AgreedValueLength()), val2(ecdh.AgreedValueLength());
+	ecdh.GenerateKeyPair(GlobalRNG(), priv1, pub1);
+	ecdh.GenerateKeyPair(GlobalRNG(), priv2, pub2);
+
+	const ECP::Point P1 = ec.Multiply(Integer(priv1, priv1.size()), G);
+	const ECP::Point Z = ec.Multiply(Integer(priv2, priv2.size()), P1);
+	SecByteBlock expected(ecdh.AgreedValueLength());
+	Z.x.Encode(expected, expected.size());
+
+	fail = !ecdh.Agree(val1, priv1, pub2) || !ecdh.Agree(val2, priv2, pub1);
+	fail = fail || val1 != val2 || val1 != expected;
+
+	pass = pass && !fail;
+	std::cout << (fail ? "FAILED" : "passed") << "    ECDH key agreement\n";
+
+	return pass;
+}
+
 bool ValidateECP()
 {
 	// Remove word recommend. Some ECP curves may not be recommended depending
@@ -340,6 +431,7 @@ bool ValidateECP()
 	}
 
 	std::cout << "\nECP validation suite running...\n\n";
+	pass = TestECP_P256() && pass;
 	return ValidateECP_Agreement() && ValidateECP_Encrypt() && ValidateECP_NULLDigest_Encrypt() && ValidateECP_Sign() && pass;
 }
 
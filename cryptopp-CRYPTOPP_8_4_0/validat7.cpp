@@ -55,13 +55,63 @@ bool ValidateDH()
 	return SimpleKeyAgreementValidate(dh);
 }
 
+bool TestX25519Batch()
+{
+	bool fail = false;
+
+	// Two full groups of 4 and a remainder of 3
+	const unsigned int count = 11;
+	x25519 dh;
+	byte priv[count][32], pub[count][32], peer[count][32];
+	byte batch[count][32], single[count][32];
+	bool valid[count];
+
+	for (unsigned int i=0; i<count; ++i)
+	{
+		dh.GeneratePrivateKey(GlobalRNG(), priv[i]);
+		dh.GeneratePrivateKey(GlobalRNG(), peer[i]);
+		dh.GeneratePublicKey(GlobalRNG(), peer[i], pub[i]);
+	}
+
+	fail = !dh.AgreeBatch(batch[0], priv[0], pub[0], count, true, valid) || fail;
+	for (unsigned int i=0; i<count; ++i)
+	{
+		fail = !dh.Agree(single[i], priv[i], pub[i]) || fail;
+		fail = !valid[i] || fail;
+	}
+	fail = std::memcmp(batch, single, sizeof(batch)) != 0 || fail;
+
+	// Arbitrary u-coordinates, including the top bit and values over p.
+	// The scalars are not clamped, so the batch must clamp them.
+	GlobalRNG().GenerateBlock(priv[0], sizeof(priv));
+	GlobalRNG().GenerateBlock(pub[0], sizeof(pub));
+	std::memset(pub[5], 0xff, 32);
+	fail = !dh.AgreeBatch(batch[0], priv[0], pub[0], count, false) || fail;
+	for (unsigned int i=0; i<count; ++i)
+		fail = !dh.Agree(single[i], priv[i], pub[i], false) || fail;
+	fail = std::memcmp(batch, single, sizeof(batch)) != 0 || fail;
+
+	// A small order public key fails only its own entry
+	std::memset(pub[2], 0, 32);
+	fail = dh.AgreeBatch(batch[0], priv[0], pub[0], count, true, valid) || fail;
+	for (unsigned int i=0; i<count; ++i)
+		fail = (valid[i] == (i == 2)) || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "batch key agreement\n";
+
+	return !fail;
+}
+
 bool ValidateX25519()
 {
 	std::cout << "\nx25519 validation suite running...\n\n";
 
 	FileSource f(DataDir("TestData/x25519.dat").c_str(), true, new HexDecoder);
 	x25519 dh(f);
-	return SimpleKeyAgreementValidate(dh);
+	bool pass = SimpleKeyAgreementValidate(dh);
+
+	return TestX25519Batch() && pass;
 }
 
 bool ValidateMQV()
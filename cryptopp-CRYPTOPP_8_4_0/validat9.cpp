@@ -31,6 +31,7 @@
 #include "rabin.h"
 #include "pubkey.h"
 #include "eccrypto.h"
+#include "nbtheory.h"
 
 // Curve25519
 #include "xed25519.h"
@@ -53,6 +54,193 @@
 NAMESPACE_BEGIN(CryptoPP)
 NAMESPACE_BEGIN(Test)
 
+bool TestRSA_CalculateInverse()
+{
+	bool fail = false;
+
+	InvertibleRSAFunction key;
+	key.Initialize(GlobalRNG(), 1024, 65537);
+
+	// More than 32 operations, so the blinding pair is refreshed
+	for (unsigned int i=0; i<70; ++i)
+	{
+		const Integer x(GlobalRNG(), Integer::Zero(), key.GetModulus()-1);
+		const Integer expected = a_exp_b_mod_c(x, key.GetPrivateExponent(), key.GetModulus());
+		fail = (key.CalculateInverse(GlobalRNG(), x) != expected) || fail;
+
+		// A copy starts with its own blinding pair
+		if (i % 10 == 0)
+		{
+			InvertibleRSAFunction copy(key);
+			fail = (copy.CalculateInverse(GlobalRNG(), x) != expected) || fail;
+		}
+	}
+
+	// A new key replaces the blinding pair
+	key.Initialize(GlobalRNG(), 1024, 17);
+	for (unsigned int i=0; i<4; ++i)
+	{
+		const Integer x(GlobalRNG(), Integer::Zero(), key.GetModulus()-1);
+		fail = (key.CalculateInverse(GlobalRNG(), x) != a_exp_b_mod_c(x, key.GetPrivateExponent(), key.GetModulus())) || fail;
+	}
+
+	try
+	{
+		key.CalculateInverse(GlobalRNG(), key.GetModulus());
+		fail = true;
+	}
+	catch (const Exception&) {}
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "private key operation with blinding\n";
+
+	return !fail;
+}
+
+bool TestRSA_MultiPrime()
+{
+	bool pass = true, fail;
+
+	{
+		// RSA-1024 key with three primes in PKCS #1 format, generated by OpenSSL
+		const char keyHex[] =
+		"3082027D02010102818100A502DD56EC84CEAC3A32A953062B64F2033ED4EA41"
+		"26A27D402FBE235481D1BB56369C247FE91E0EBC614E7AC0FF773509208284BE"
+		"6EEBF1FB74FE2ECD6B4A91E242A84D415EB13E3F19DB00A187562CA6A436F6CD"
+		"5E54CE018507D8DE8D77454977ECC3BB80DF33672EF4E1FFCD4B693645DB64D4"
+		"15E5122991EF6B8DC47013020301000102818005DD31327A9B49A0F33C83A9F0"
+		"A930202D9F58FFAE2B0A513B2BB72D183EB8CE5884FE4D89C226104DFF82B78E"
+		"332D45C37C3A4267C9CF4A85B57B4203CE2A07472B1D9E18C9C645C96DCA18A6"
+		"D64B5D600DEC482FE6A102DA059799931DFA1F9AC523E73BD2CC73D65E6B5017"
+		"11F25CD8847AB88407731CC0BDA76D11049909022B3EF9642134C141C1065E7B"
+		"5816165B4B18D5B4DF2EC45200E72944BA6F9A4556A65634A907E5A85AFD9903"
+		"022B189DB6201B74B62D66AF49729A29C752FEC17009C3A562D80209BE02D2BB"
+		"92778E9B892918FEFC27E6DC87022B2955B72498A5154CE6AA5399D0FDA1B4DC"
+		"3B41FA908EEA288F92A5FB1DD00C1D41172A7F9CA060EE40B113022B07D223C9"
+		"33AFF3299D94578B97BB6A5ECE1DFB50BEDE4EF73E3E86263379F0E11768073E"
+		"0D7905F84F7B05022B34FB62465BC8A5C421B5EFA478065B62FB1572BC9D641C"
+		"9E2650383A2E05B958F9C0FCE3D5063AE92098BF30818A308187022B1B4017AE"
+		"2E98BFBFA47E05F534F71BEF6CDB8139EFE9AD59DCDE3FCCBD325F080220FA12"
+		"9E81574A605007022B042D0733F70A0B6057D9C419F67AE3BA0609813D1AA9C9"
+		"99DAC1E82EFCD34A42D4E8AEC9C9A67275005B63022B1796B944E85BA195CA2B"
+		"83BD3F5A6F58A16D665B165AB4B28914B78E96E9E29BF3F1B0B2EF32951B5FC7"
+		"C8";
+
+		std::string der, encoded;
+		StringSource(keyHex, true, new HexDecoder(new StringSink(der)));
+
+		InvertibleRSAFunction key;
+		StringSource source(der, true);
+		key.BERDecodePrivateKey(source, false, 0);
+		StringSink sink(encoded);
+		key.DEREncodePrivateKey(sink);
+
+		fail = key.GetPrimeCount() != 3 || !key.Validate(GlobalRNG(), 3) || encoded != der;
+		pass = pass && !fail;
+
+		std::cout << (fail ? "FAILED    " : "passed    ");
+		std::cout << "multi-prime key decoding and encoding\n";
+
+		fail = false;
+		for (unsigned int i=0; i<8; ++i)
+		{
+			const Integer x(GlobalRNG(), Integer::Zero(), key.GetModulus()-1);
+			fail = (key.CalculateInverse(GlobalRNG(), x) != a_exp_b_mod_c(x, key.GetPrivateExponent(), key.GetModulus())) || fail;
+		}
+		pass = pass && !fail;
+
+		std::cout << (fail ? "FAILED    " : "passed    ");
+		std::cout << "multi-prime private key operation\n";
+
+		InvertibleRSAFunction twoPrime;
+		twoPrime.Initialize(GlobalRNG(), 1024);
+		key.AssignFrom(MakeParameters(Name::Modulus(), twoPrime.GetModulus())
+			(Name::PublicExponent(), twoPrime.GetPublicExponent())
+			(Name::Prime1(), twoPrime.GetPrime1())
+			(Name::Prime2(), twoPrime.GetPrime2())
+			(Name::PrivateExponent(), twoPrime.GetPrivateExponent())
+			(Name::ModPrime1PrivateExponent(), twoPrime.GetModPrime1PrivateExponent())
+			(Name::ModPrime2PrivateExponent(), twoPrime.GetModPrime2PrivateExponent())
+			(Name::MultiplicativeInverseOfPrime2ModPrime1(), twoPrime.GetMultiplicativeInverseOfPrime2ModPrime1()));
+
+		const Integer x(GlobalRNG(), Integer::Zero(), key.GetModulus()-1);
+		fail = key.GetPrimeCount() != 2 || !key.Validate(GlobalRNG(), 3) ||
+			key.CalculateInverse(GlobalRNG(), x) != twoPrime.CalculateInverse(GlobalRNG(), x);
+		pass = pass && !fail;
+
+		std::cout << (fail ? "FAILED    " : "passed    ");
+		std::cout << "two-prime parameters assigned over a multi-prime key\n";
+	}
+	{
+		const char plain[] = "Everyone gets Friday off.";
+
+		RSASS<PSS, SHA256>::Signer rsaPriv;
+		rsaPriv.AccessKey().Initialize(GlobalRNG(), 1536, 3, 65537);
+		RSASS<PSS, SHA256>::Verifier rsaPub(rsaPriv);
+
+		const InvertibleRSAFunction &key = rsaPriv.GetKey();
+		fail = key.GetPrimeCount() != 3 || key.GetModulus().BitCount() != 1536 || !key.Validate(GlobalRNG(), 3);
+
+		SecByteBlock signature(rsaPriv.MaxSignatureLength());
+		size_t signatureLength = rsaPriv.SignMessage(GlobalRNG(), (const byte *)plain, strlen(plain), signature);
+		fail = !rsaPub.VerifyMessage((const byte *)plain, strlen(plain), signature, signatureLength) || fail;
+
+		ByteQueue queue;
+		key.Save(queue);
+		InvertibleRSAFunction loaded;
+		loaded.Load(queue);
+		fail = loaded.GetPrimeCount() != 3 || loaded.GetPrime1() != key.GetPrime1() ||
+			loaded.GetOtherPrimeInfos()[0].prime != key.GetOtherPrimeInfos()[0].prime ||
+			loaded.GetOtherPrimeInfos()[0].coefficient != key.GetOtherPrimeInfos()[0].coefficient || fail;
+		pass = pass && !fail;
+
+		std::cout << (fail ? "FAILED    " : "passed    ");
+		std::cout << "multi-prime key generation and signature\n";
+
+		try
+		{
+			loaded.Initialize(GlobalRNG(), 1024, 4, 17);
+			fail = true;
+		}
+		catch (const InvalidArgument&)
+		{
+			fail = false;
+		}
+		pass = pass && !fail;
+
+		std::cout << (fail ? "FAILED    " : "passed    ");
+		std::cout << "multi-prime key with too many primes\n";
+	}
+
+	return pass;
+}
+
+bool TestRSA_ThreadedGeneration()
+{
+	bool fail = false;
+
+	// Four threads search for all primes of the same size at once
+	for (int primeCount=2; primeCount<=3; ++primeCount)
+	{
+		InvertibleRSAFunction key;
+		key.GenerateRandom(GlobalRNG(), MakeParameters(Name::ModulusSize(), 1024)(Name::PublicExponent(), Integer(65537))
+			(Name::PrimeCount(), primeCount)(Name::ThreadCount(), 4));
+		fail = key.GetPrimeCount() != (unsigned int)primeCount || key.GetModulus().BitCount() != 1024 ||
+			!key.Validate(GlobalRNG(), 3) || fail;
+	}
+
+	// [1000, 1010] holds only one prime, 1009
+	Integer primes[2];
+	fail = GenerateRandomPrimes(GlobalRNG(), primes, 2, MakeParameters("RandomNumberType", Integer::PRIME)("Min", Integer(1000))("Max", Integer(1010)), 4) || fail;
+	fail = !GenerateRandomPrimes(GlobalRNG(), primes, 1, MakeParameters("RandomNumberType", Integer::PRIME)("Min", Integer(1000))("Max", Integer(1010)), 4) ||
+		primes[0] != 1009 || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "key generation with threaded prime search\n";
+
+	return !fail;
+}
+
 bool ValidateRSA_Sign()
 {
 	// Must be large enough for RSA-3072 to test SHA3_256
@@ -136,6 +324,10 @@ bool ValidateRSA_Sign()
 		std::cout << "invalid signature verification\n";
 	}
 
+	pass = TestRSA_CalculateInverse() && pass;
+	pass = TestRSA_MultiPrime() && pass;
+	pass = TestRSA_ThreadedGeneration() && pass;
+
 	return pass;
 }
 
@@ -161,6 +353,51 @@ bool ValidateNR()
 	return pass;
 }
 
+template <class SIGNER, class VERIFIER>
+bool TestVerifyBatch(const SIGNER &signer, const VERIFIER &verifier, const char *name)
+{
+	bool fail = false;
+
+	// More than one group of 32 for the P-256 backend
+	const unsigned int count = 37;
+	const size_t siglen = signer.MaxSignatureLength();
+	byte msgs[count][16];
+	SecByteBlock sigs(count * siglen);
+	const byte *m[count], *s[count];
+	size_t len[count], slen[count];
+	bool valid[count];
+
+	GlobalRNG().GenerateBlock(msgs[0], sizeof(msgs));
+	for (unsigned int i=0; i<count; ++i)
+	{
+		m[i] = msgs[i]; len[i] = sizeof(msgs[i]);
+		s[i] = sigs + i*siglen;
+		slen[i] = signer.SignMessage(GlobalRNG(), m[i], len[i], sigs + i*siglen);
+	}
+
+	fail = !verifier.VerifyBatch(m, len, s, slen, count, valid) || fail;
+	for (unsigned int i=0; i<count; ++i)
+		fail = !valid[i] || fail;
+
+	// Wrong message, modified r and s, and zero r and s
+	msgs[3][0] ^= 1;
+	sigs[5*siglen] ^= 0x40;
+	sigs[7*siglen + siglen - 1] ^= 1;
+	std::memset(sigs + 11*siglen, 0x00, siglen/2);
+	std::memset(sigs + 13*siglen + siglen/2, 0x00, siglen/2);
+	std::memset(sigs + 34*siglen, 0xff, siglen);
+
+	fail = verifier.VerifyBatch(m, len, s, slen, count, valid) || fail;
+	for (unsigned int i=0; i<count; ++i)
+		fail = (valid[i] != verifier.VerifyMessage(m[i], len[i], s[i], slen[i])) || fail;
+	fail = valid[3] || valid[5] || valid[7] || valid[11] || valid[13] || valid[34] || !valid[4] || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << name << " batch verification\n";
+
+	return !fail;
+}
+
 bool ValidateDSA(bool thorough)
 {
 	std::cout << "\nDSA validation suite running...\n\n";
@@ -173,6 +410,7 @@ bool ValidateDSA(bool thorough)
 	DSA::Verifier pub1(fs2);
 	CRYPTOPP_ASSERT(pub.GetKey() == pub1.GetKey());
 	pass = SignatureValidate(priv, pub, thorough) && pass;
+	pass = TestVerifyBatch(priv, pub, "DSA") && pass;
 
 	return pass;
 }
@@ -214,6 +452,56 @@ bool ValidateRW()
 	return SignatureValidate(priv, pub);
 }
 
+template <class PARAMS>
+bool TestPrecomputationTable(PARAMS &params, std::string &table)
+{
+	bool fail = false;
+
+	const Integer k(GlobalRNG(), Integer::One(), params.GetMaxExponent());
+	const typename PARAMS::Element expected = params.ExponentiateBase(k);
+
+	table.clear();
+	StringSink sink(table);
+	params.SavePrecomputationTable(sink);
+
+	try
+	{
+		params.LoadPrecomputationTable(ConstBytePtr(table), table.size() - 1);
+		fail = true;
+	}
+	catch (const InvalidDataFormat&) {}
+
+	params.LoadPrecomputationTable(ConstBytePtr(table), table.size());
+	fail = !(params.ExponentiateBase(k) == expected) || fail;
+
+	// Saving from the table gives the same table
+	std::string again;
+	StringSink sink2(again);
+	params.SavePrecomputationTable(sink2);
+	fail = (again != table) || fail;
+
+	// Copies share the loaded table rather than copying it, so they see
+	// it change
+	std::string temp(table);
+	params.LoadPrecomputationTable(ConstBytePtr(temp), temp.size());
+	PARAMS copy(params), assigned;
+	assigned = copy;
+	fail = !(copy.ExponentiateBase(k) == expected) || !(assigned.ExponentiateBase(k) == expected) || fail;
+
+	std::fill(temp.begin(), temp.end(), '\0');
+	try
+	{
+		fail = (assigned.ExponentiateBase(k) == expected) || fail;
+	}
+	catch (const Exception&) {}
+	params.LoadPrecomputationTable(ConstBytePtr(table), table.size());
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "precomputation table\n";
+
+	return !fail;
+}
+
 bool ValidateECP_Sign()
 {
 	ECDSA<ECP, SHA1>::Signer spriv(GlobalRNG(), ASN1::secp192r1());
@@ -230,7 +518,10 @@ bool ValidateECP_Sign()
 	spriv.AccessKey().SavePrecomputation(queue);
 	spriv.AccessKey().LoadPrecomputation(queue);
 
-	return SignatureValidate(spriv, spub);
+	std::string table;
+	bool pass = TestPrecomputationTable(spriv.AccessKey().AccessGroupParameters(), table);
+
+	return SignatureValidate(spriv, spub) && pass;
 }
 
 bool ValidateEC2N_Sign()
@@ -250,7 +541,10 @@ bool ValidateEC2N_Sign()
 	spriv.AccessKey().SavePrecomputation(queue);
 	spriv.AccessKey().LoadPrecomputation(queue);
 
-	return SignatureValidate(spriv, spub);
+	std::string table;
+	bool pass = TestPrecomputationTable(spriv.AccessKey().AccessGroupParameters(), table);
+
+	return SignatureValidate(spriv, spub) && pass;
 }
 
 bool ValidateECDSA()
@@ -301,6 +595,15 @@ bool ValidateECDSA()
 	pass = pass && !fail;
 
 	pass = SignatureValidate(priv, pub) && pass;
+	pass = TestVerifyBatch(priv, pub, "EC2N") && pass;
+
+	ECDSA<ECP, SHA256>::Signer priv256(GlobalRNG(), ASN1::secp256r1());
+	ECDSA<ECP, SHA256>::Verifier pub256(priv256);
+	pass = TestVerifyBatch(priv256, pub256, "P-256") && pass;
+
+	ECDSA<ECP, SHA384>::Signer priv384(GlobalRNG(), ASN1::secp384r1());
+	ECDSA<ECP, SHA384>::Verifier pub384(priv384);
+	pass = TestVerifyBatch(priv384, pub384, "P-384") && pass;
 
 	return pass;
 }
@@ -672,6 +975,217 @@ bool ValidateESIGN()
 	return pass;
 }
 
+bool TestEd25519Batch()
+{
+	bool fail = false;
+
+	const unsigned int count = 70, keys = 5;
+	ed25519::Signer signers[keys];
+	for (unsigned int i=0; i<keys; ++i)
+		signers[i].AccessPrivateKey().GenerateRandom(GlobalRNG());
+
+	byte msgs[count][40], sigs[count][64], pks[keys][32];
+	const byte *m[count], *s[count], *p[count];
+	size_t len[count];
+	bool valid[count];
+
+	for (unsigned int i=0; i<keys; ++i)
+	{
+		ed25519::Verifier verifier(signers[i]);
+		const ed25519PublicKey& pk = dynamic_cast<const ed25519PublicKey&>(verifier.GetPublicKey());
+		std::memcpy(pks[i], pk.GetPublicKeyBytePtr(), 32);
+	}
+
+	GlobalRNG().GenerateBlock(msgs[0], sizeof(msgs));
+	for (unsigned int i=0; i<count; ++i)
+	{
+		len[i] = i % 41;
+		signers[i % keys].SignMessage(GlobalRNG(), msgs[i], len[i], sigs[i]);
+		m[i] = msgs[i]; s[i] = sigs[i]; p[i] = pks[i % keys];
+	}
+
+	// 70 signatures, more than the minimum batch of 4
+	fail = !ed25519Verifier::VerifyBatch(GlobalRNG(), m, len, p, s, count, valid) || fail;
+	for (unsigned int i=0; i<count; ++i)
+		fail = !valid[i] || fail;
+
+	// Bad signature, bad message and S >= 2^253
+	sigs[3][40] ^= 1; msgs[66][0] ^= 1; sigs[10][63] |= 0x80;
+	fail = ed25519Verifier::VerifyBatch(GlobalRNG(), m, len, p, s, count, valid) || fail;
+	for (unsigned int i=0; i<count; ++i)
+		fail = (valid[i] == (i == 3 || i == 10 || i == 66)) || fail;
+
+	// Wrong public key
+	fail = ed25519Verifier::VerifyBatch(GlobalRNG(), m+20, len+20, p+21, s+20, 10) || fail;
+
+	// One public key, and batches too small for the linear combination
+	ed25519::Verifier verifier(signers[0]);
+	const byte *m0[10], *s0[10];
+	size_t len0[10];
+	for (unsigned int i=0; i<10; ++i)
+	{
+		m0[i] = m[20+i*keys]; s0[i] = s[20+i*keys]; len0[i] = len[20+i*keys];
+	}
+
+	fail = !verifier.VerifyBatch(GlobalRNG(), m0, len0, s0, 10) || fail;
+	fail = !verifier.VerifyBatch(GlobalRNG(), m0, len0, s0, 2) || fail;
+	fail = !verifier.VerifyBatch(GlobalRNG(), m0, len0, s0, 0) || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "batch verification\n";
+
+	return !fail;
+}
+
+bool TestEd25519ph()
+{
+	bool fail = false;
+
+	// RFC 8032, Section 7.3, test vector for Ed25519ph
+	const byte sk[] =
+		"\x83\x3F\xE6\x24\x09\x23\x7B\x9D\x62\xEC\x77\x58\x75\x20\x91\x1E"
+		"\x9A\x75\x9C\xEC\x1D\x19\x75\x5B\x7D\xA9\x01\xB9\x6D\xCA\x3D\x42";
+	const byte pk[] =
+		"\xEC\x17\x2B\x93\xAD\x5E\x56\x3B\xF4\x93\x2C\x70\xE1\x24\x50\x34"
+		"\xC3\x54\x67\xEF\x2E\xFD\x4D\x64\xEB\xF8\x19\x68\x34\x67\xE2\xBF";
+	const byte expected[] =
+		"\x98\xA7\x02\x22\xF0\xB8\x12\x1A\xA9\xD3\x0F\x81\x3D\x68\x3F\x80"
+		"\x9E\x46\x2B\x46\x9C\x7F\xF8\x76\x39\x49\x9B\xB9\x4E\x6D\xAE\x41"
+		"\x31\xF8\x50\x42\x46\x3C\x2A\x35\x5A\x20\x03\xD0\x62\xAD\xF5\xAA"
+		"\xA1\x0B\x8C\x61\xE6\x36\x06\x2A\xAA\xD1\x1C\x2A\x26\x08\x34\x06";
+	const byte msg[] = "abc";
+
+	ed25519ph::Signer signer(pk, sk);
+	ed25519ph::Verifier verifier(signer);
+	byte sig[64];
+
+	signer.SignMessage(GlobalRNG(), msg, 3, sig);
+	fail = std::memcmp(sig, expected, 64) != 0 || fail;
+	fail = !verifier.VerifyMessage(msg, 3, sig, 64) || fail;
+
+	// Not an Ed25519 signature, and the context must match
+	fail = ed25519::Verifier(pk).VerifyMessage(msg, 3, sig, 64) || fail;
+	verifier.SetContext((const byte*)"foo", 3);
+	fail = verifier.VerifyMessage(msg, 3, sig, 64) || fail;
+
+	// A message larger than the accumulator reserve, pumped through a filter
+	std::string message(100000, '\0'), filtered;
+	GlobalRNG().GenerateBlock((byte*)&message[0], message.size());
+	signer.SetContext((const byte*)"foo", 3);
+	StringSource(message, true, new SignerFilter(GlobalRNG(), signer, new StringSink(filtered)));
+
+	std::istringstream stream(message);
+	signer.SignStream(GlobalRNG(), stream, sig);
+	fail = filtered.size() != 64 || std::memcmp(sig, filtered.data(), 64) != 0 || fail;
+
+	std::istringstream stream2(message);
+	fail = !verifier.VerifyStream(stream2, sig, 64) || fail;
+	fail = !verifier.VerifyMessage((const byte*)message.data(), message.size(), sig, 64) || fail;
+	message[message.size()/2] ^= 1;
+	fail = verifier.VerifyMessage((const byte*)message.data(), message.size(), sig, 64) || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "ed25519ph signing and verification\n";
+
+	return !fail;
+}
+
+bool TestEd25519ctx()
+{
+	bool fail = false;
+
+	// RFC 8032, Section 7.2, test vector for Ed25519ctx with context "foo"
+	const byte sk[] =
+		"\x03\x05\x33\x4E\x38\x1A\xF7\x8F\x14\x1C\xB6\x66\xF6\x19\x9F\x57"
+		"\xBC\x34\x95\x33\x5A\x25\x6A\x95\xBD\x2A\x55\xBF\x54\x66\x63\xF6";
+	const byte pk[] =
+		"\xDF\xC9\x42\x5E\x4F\x96\x8F\x7F\x0C\x29\xF0\x25\x9C\xF5\xF9\xAE"
+		"\xD6\x85\x1C\x2B\xB4\xAD\x8B\xFB\x86\x0C\xFE\xE0\xAB\x24\x82\x92";
+	const byte msg[] =
+		"\xF7\x26\x93\x6D\x19\xC8\x00\x49\x4E\x3F\xDA\xFF\x20\xB2\x76\xA8";
+	const byte expected[] =
+		"\x55\xA4\xCC\x2F\x70\xA5\x4E\x04\x28\x8C\x5F\x4C\xD1\xE4\x5A\x7B"
+		"\xB5\x20\xB3\x62\x92\x91\x18\x76\xCA\xDA\x73\x23\x19\x8D\xD8\x7A"
+		"\x8B\x36\x95\x0B\x95\x13\x00\x22\x90\x7A\x7F\xB7\xC4\xE9\xB2\xD5"
+		"\xF6\xCC\xA6\x85\xA5\x87\xB4\xB2\x1F\x4B\x88\x8E\x4E\x7E\xDB\x0D";
+
+	ed25519ctx::Signer signer(pk, sk);
+	byte sig[64];
+
+	// The context is required
+	bool thrown = false;
+	try {
+		signer.SignMessage(GlobalRNG(), msg, 16, sig);
+	} catch (const InvalidArgument&) {
+		thrown = true;
+	}
+	fail = !thrown || fail;
+
+	signer.SetContext((const byte*)"foo", 3);
+	ed25519ctx::Verifier verifier(signer);
+
+	signer.SignMessage(GlobalRNG(), msg, 16, sig);
+	fail = std::memcmp(sig, expected, 64) != 0 || fail;
+	fail = !verifier.VerifyMessage(msg, 16, sig, 64) || fail;
+
+	std::istringstream stream(std::string((const char*)msg, 16));
+	fail = !verifier.VerifyStream(stream, sig, 64) || fail;
+
+	fail = ed25519::Verifier(pk).VerifyMessage(msg, 16, sig, 64) || fail;
+	fail = ed25519ctx::Verifier(pk).VerifyMessage(msg, 16, sig, 64) || fail;
+	verifier.SetContext((const byte*)"bar", 3);
+	fail = verifier.VerifyMessage(msg, 16, sig, 64) || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "ed25519ctx signing and verification\n";
+
+	return !fail;
+}
+
+bool TestEd25519SignBatch()
+{
+	bool fail = false;
+
+	// 70 messages, two full groups of 32 and a partial group
+	const unsigned int count = 70;
+	ed25519::Signer signer(GlobalRNG());
+	ed25519::Verifier verifier(signer);
+
+	byte msgs[count][40], sigs[count][64], expected[64];
+	const byte *m[count], *s[count];
+	byte *out[count];
+	size_t len[count];
+
+	GlobalRNG().GenerateBlock(msgs[0], sizeof(msgs));
+	for (unsigned int i=0; i<count; ++i)
+	{
+		len[i] = i % 41;
+		m[i] = msgs[i]; s[i] = sigs[i]; out[i] = sigs[i];
+	}
+
+	fail = signer.SignBatch(NullRNG(), m, len, out, count) != 64 || fail;
+	for (unsigned int i=0; i<count; ++i)
+	{
+		signer.SignMessage(NullRNG(), m[i], len[i], expected);
+		fail = std::memcmp(sigs[i], expected, 64) != 0 || fail;
+	}
+	fail = !verifier.VerifyBatch(GlobalRNG(), m, len, s, count) || fail;
+
+	// The expanded key follows the private key when it is reloaded
+	ByteQueue queue;
+	ed25519::Signer other(GlobalRNG());
+	signer.GetPrivateKey().Save(queue);
+	other.AccessPrivateKey().Load(queue);
+	other.SignBatch(NullRNG(), m+5, len+5, out+5, 1);
+	signer.SignMessage(NullRNG(), m[5], len[5], expected);
+	fail = std::memcmp(sigs[5], expected, 64) != 0 || fail;
+
+	std::cout << (fail ? "FAILED    " : "passed    ");
+	std::cout << "batch signing\n";
+
+	return !fail;
+}
+
 bool ValidateEd25519()
 {
 	std::cout << "\ned25519 validation suite running...\n\n";
@@ -697,7 +1211,11 @@ bool ValidateEd25519()
 	std::cout << (fail ? "FAILED    " : "passed    ");
 	std::cout << "verification check against test vector\n";
 
-	return pass;
+	pass = TestEd25519ph() && pass;
+	pass = TestEd25519ctx() && pass;
+	pass = TestEd25519SignBatch() && pass;
+
+	return TestEd25519Batch() && pass;
 }
 
 NAMESPACE_END  // Test
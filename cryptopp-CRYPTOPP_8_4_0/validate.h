@@ -105,6 +105,7 @@ bool ValidateLEA();
 bool ValidateSIMON();
 bool ValidateSPECK();
 bool ValidateCamellia();
+bool ValidateThreefish();
 
 bool ValidateHC128();
 bool ValidateHC256();
@@ -117,6 +118,8 @@ bool ValidateSosemanuk();
 bool ValidateVMAC();
 bool ValidateCCM();
 bool ValidateGCM();
+bool ValidateOCB();
+bool ValidateAEGIS();
 bool ValidateXTS();
 bool ValidateCMAC();
 
@@ -12,6 +12,8 @@
 #include "filters.h"
 #include "stdcpp.h"
 
+#include <istream>
+
 #include "xed25519.h"
 #include "donna.h"
 
@@ -65,6 +67,20 @@ bool HasSmallOrder(const byte y[32])
     return (bool)((k >> 8) & 1);
 }
 
+// Feed a stream to an accumulator in blocks, like Donna does for ed25519
+void UpdateFromStream(CryptoPP::HashTransformation& hash, std::istream& stream)
+{
+    CryptoPP::SecByteBlock block(4096);
+    while (stream.read((char*)block.begin(), block.size()))
+        hash.Update(block, block.size());
+
+    std::streamsize rem = stream.gcount();
+    if (rem)
+        hash.Update(block, (size_t)rem);
+
+    block.SetMark(0);
+}
+
 ANONYMOUS_NAMESPACE_END
 
 NAMESPACE_BEGIN(CryptoPP)
@@ -371,6 +387,31 @@ bool x25519::Agree(byte *agreedValue, const byte *privateKey, const byte *otherP
     return Donna::curve25519_mult(agreedValue, privateKey, otherPublicKey) == 0;
 }
 
+bool x25519::AgreeBatch(byte *agreedValues, const byte *privateKeys, const byte *otherPublicKeys, size_t count, bool validateOtherPublicKey, bool *valid) const
+{
+    CRYPTOPP_ASSERT(agreedValues != NULLPTR || count == 0);
+    CRYPTOPP_ASSERT(otherPublicKeys != NULLPTR || count == 0);
+
+    bool result = Donna::curve25519_mult_batch(agreedValues, privateKeys, otherPublicKeys, count) == 0;
+    if (valid)
+        std::fill(valid, valid+count, result);
+
+    if (validateOtherPublicKey)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (IsSmallOrder(otherPublicKeys+i*PUBLIC_KEYLENGTH))
+            {
+                std::memset(agreedValues+i*SHARED_KEYLENGTH, 0, SHARED_KEYLENGTH);
+                if (valid) valid[i] = false;
+                result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
 // ******************** ed25519 Signer ************************* //
 
 void ed25519PrivateKey::SecretToPublicKey(byte y[PUBLIC_KEYLENGTH], const byte x[SECRET_KEYLENGTH]) const
@@ -379,6 +420,12 @@ void ed25519PrivateKey::SecretToPublicKey(byte y[PUBLIC_KEYLENGTH], const byte x
     CRYPTOPP_ASSERT(ret == 0); CRYPTOPP_UNUSED(ret);
 }
 
+void ed25519PrivateKey::ExpandSecretKey()
+{
+    int ret = Donna::ed25519_expand_secret(m_ext, m_sk);
+    CRYPTOPP_ASSERT(ret == 0); CRYPTOPP_UNUSED(ret);
+}
+
 bool ed25519PrivateKey::IsSmallOrder(const byte y[PUBLIC_KEYLENGTH]) const
 {
     return HasSmallOrder(y);
@@ -440,6 +487,7 @@ void ed25519PrivateKey::AssignFrom(const NameValuePairs &source)
     {
         CRYPTOPP_ASSERT(val.size() == SECRET_KEYLENGTH);
         std::memcpy(m_sk, val.begin(), SECRET_KEYLENGTH);
+        ExpandSecretKey();
     }
     if (source.GetValue(Name::PublicElement(), val))
     {
@@ -469,6 +517,7 @@ void ed25519PrivateKey::GenerateRandom(RandomNumberGenerator &rng, const NameVal
     rng.GenerateBlock(m_sk, SECRET_KEYLENGTH);
     int ret = Donna::ed25519_publickey(m_pk, m_sk);
     CRYPTOPP_ASSERT(ret == 0); CRYPTOPP_UNUSED(ret);
+    ExpandSecretKey();
 }
 
 void ed25519PrivateKey::MakePublicKey (PublicKey &pub) const
@@ -577,6 +626,7 @@ void ed25519PrivateKey::BERDecodePrivateKey(BufferedTransformation &bt, bool par
         size_t size = privateKey.Get(m_sk, SECRET_KEYLENGTH);
         if (size != SECRET_KEYLENGTH)
             BERDecodeError();
+        ExpandSecretKey();
 
         // We don't know how to decode them
         if (parametersPresent)
@@ -676,7 +726,7 @@ size_t ed25519Signer::SignAndRestart(RandomNumberGenerator &rng, PK_MessageAccum
 
     ed25519_MessageAccumulator& accum = dynamic_cast<ed25519_MessageAccumulator&>(messageAccumulator);
     const ed25519PrivateKey& pk = dynamic_cast<const ed25519PrivateKey&>(GetPrivateKey());
-    int ret = Donna::ed25519_sign(accum.data(), accum.size(), pk.GetPrivateKeyBytePtr(), pk.GetPublicKeyBytePtr(), signature);
+    int ret = Donna::ed25519_sign_expanded(accum.data(), accum.size(), pk.GetExpandedKeyBytePtr(), pk.GetPublicKeyBytePtr(), signature);
     CRYPTOPP_ASSERT(ret == 0);
 
     if (restart)
@@ -696,6 +746,18 @@ size_t ed25519Signer::SignStream (RandomNumberGenerator &rng, std::istream& stre
     return ret == 0 ? SIGNATURE_LENGTH : 0;
 }
 
+size_t ed25519Signer::SignBatch(RandomNumberGenerator &rng, const byte *const messages[], const size_t messageLengths[],
+                                byte *const signatures[], size_t count) const
+{
+    CRYPTOPP_UNUSED(rng);
+
+    const ed25519PrivateKey& pk = dynamic_cast<const ed25519PrivateKey&>(GetPrivateKey());
+    int ret = Donna::ed25519_sign_batch(messages, messageLengths, pk.GetExpandedKeyBytePtr(), pk.GetPublicKeyBytePtr(), signatures, count);
+    CRYPTOPP_ASSERT(ret == 0);
+
+    return ret == 0 ? SIGNATURE_LENGTH : 0;
+}
+
 // ******************** ed25519 Verifier ************************* //
 
 bool ed25519PublicKey::GetVoidValue(const char *name, const std::type_info &valueType, void *pValue) const
@@ -878,4 +940,157 @@ bool ed25519Verifier::VerifyStream(std::istream& stream, const byte *signature,
     return ret == 0;
 }
 
+bool ed25519Verifier::VerifyBatch(RandomNumberGenerator &rng, const byte *const messages[], const size_t messageLengths[],
+                                  const byte *const signatures[], size_t count, bool valid[]) const
+{
+    const ed25519PublicKey& pk = static_cast<const ed25519PublicKey&>(GetPublicKey());
+    const std::vector<const byte*> publicKeys(count, pk.GetPublicKeyBytePtr());
+
+    return VerifyBatch(rng, messages, messageLengths, count ? &publicKeys[0] : NULLPTR, signatures, count, valid);
+}
+
+bool ed25519Verifier::VerifyBatch(RandomNumberGenerator &rng, const byte *const messages[], const size_t messageLengths[],
+                                  const byte *const publicKeys[], const byte *const signatures[], size_t count, bool valid[])
+{
+    if (count == 0)
+        return true;
+
+    std::vector<int> results(count);
+    int ret = Donna::ed25519_sign_open_batch(rng, messages, messageLengths, publicKeys, signatures, count, &results[0]);
+
+    if (valid)
+    {
+        for (size_t i=0; i<count; ++i)
+            valid[i] = results[i] != 0;
+    }
+
+    return ret == 0;
+}
+
+// ****************** ed25519ph and ed25519ctx ******************* //
+
+void ed25519phSigner::SetContext(const byte *context, size_t length)
+{
+    if (length > MAX_CONTEXT_LENGTH)
+        throw InvalidArgument("ed25519phSigner: context length " + IntToString(length) + " exceeds the maximum of 255");
+    m_context.Assign(context, length);
+}
+
+size_t ed25519phSigner::SignAndRestart(RandomNumberGenerator &rng, PK_MessageAccumulator &messageAccumulator, byte *signature, bool restart) const
+{
+    CRYPTOPP_ASSERT(signature != NULLPTR); CRYPTOPP_UNUSED(rng);
+
+    ed25519ph_MessageAccumulator& accum = dynamic_cast<ed25519ph_MessageAccumulator&>(messageAccumulator);
+    const ed25519PrivateKey& pk = dynamic_cast<const ed25519PrivateKey&>(GetPrivateKey());
+
+    byte prehash[ed25519ph_MessageAccumulator::PREHASH_LENGTH];
+    accum.Prehash(prehash);
+    int ret = Donna::ed25519_sign_dom2(prehash, sizeof(prehash), pk.GetPrivateKeyBytePtr(), pk.GetPublicKeyBytePtr(),
+                                       signature, 1, m_context.begin(), m_context.size());
+    CRYPTOPP_ASSERT(ret == 0);
+
+    if (restart)
+        accum.Restart();
+
+    return ret == 0 ? SIGNATURE_LENGTH : 0;
+}
+
+size_t ed25519phSigner::SignStream (RandomNumberGenerator &rng, std::istream& stream, byte *signature) const
+{
+    ed25519ph_MessageAccumulator accum;
+    UpdateFromStream(accum, stream);
+    return SignAndRestart(rng, accum, signature, false);
+}
+
+void ed25519ctxSigner::SetContext(const byte *context, size_t length)
+{
+    if (length == 0 || length > MAX_CONTEXT_LENGTH)
+        throw InvalidArgument("ed25519ctxSigner: context length " + IntToString(length) + " is not in the range 1 to 255");
+    m_context.Assign(context, length);
+}
+
+size_t ed25519ctxSigner::SignAndRestart(RandomNumberGenerator &rng, PK_MessageAccumulator &messageAccumulator, byte *signature, bool restart) const
+{
+    CRYPTOPP_ASSERT(signature != NULLPTR); CRYPTOPP_UNUSED(rng);
+
+    if (m_context.empty())
+        throw InvalidArgument("ed25519ctxSigner: the context is not set");
+
+    ed25519_MessageAccumulator& accum = dynamic_cast<ed25519_MessageAccumulator&>(messageAccumulator);
+    const ed25519PrivateKey& pk = dynamic_cast<const ed25519PrivateKey&>(GetPrivateKey());
+    int ret = Donna::ed25519_sign_dom2(accum.data(), accum.size(), pk.GetPrivateKeyBytePtr(), pk.GetPublicKeyBytePtr(),
+                                       signature, 0, m_context.begin(), m_context.size());
+    CRYPTOPP_ASSERT(ret == 0);
+
+    if (restart)
+        accum.Restart();
+
+    return ret == 0 ? SIGNATURE_LENGTH : 0;
+}
+
+size_t ed25519ctxSigner::SignStream (RandomNumberGenerator &rng, std::istream& stream, byte *signature) const
+{
+    ed25519_MessageAccumulator accum;
+    UpdateFromStream(accum, stream);
+    return SignAndRestart(rng, accum, signature, false);
+}
+
+void ed25519phVerifier::SetContext(const byte *context, size_t length)
+{
+    if (length > MAX_CONTEXT_LENGTH)
+        throw InvalidArgument("ed25519phVerifier: context length " + IntToString(length) + " exceeds the maximum of 255");
+    m_context.Assign(context, length);
+}
+
+bool ed25519phVerifier::VerifyAndRestart(PK_MessageAccumulator &messageAccumulator) const
+{
+    ed25519ph_MessageAccumulator& accum = static_cast<ed25519ph_MessageAccumulator&>(messageAccumulator);
+    const ed25519PublicKey& pk = dynamic_cast<const ed25519PublicKey&>(GetPublicKey());
+
+    byte prehash[ed25519ph_MessageAccumulator::PREHASH_LENGTH];
+    accum.Prehash(prehash);
+    int ret = Donna::ed25519_sign_open_dom2(prehash, sizeof(prehash), pk.GetPublicKeyBytePtr(), accum.signature(),
+                                            1, m_context.begin(), m_context.size());
+    accum.Restart();
+
+    return ret == 0;
+}
+
+bool ed25519phVerifier::VerifyStream(std::istream& stream, const byte *signature, size_t signatureLen) const
+{
+    ed25519ph_MessageAccumulator accum;
+    InputSignature(accum, signature, signatureLen);
+    UpdateFromStream(accum, stream);
+    return VerifyAndRestart(accum);
+}
+
+void ed25519ctxVerifier::SetContext(const byte *context, size_t length)
+{
+    if (length == 0 || length > MAX_CONTEXT_LENGTH)
+        throw InvalidArgument("ed25519ctxVerifier: context length " + IntToString(length) + " is not in the range 1 to 255");
+    m_context.Assign(context, length);
+}
+
+bool ed25519ctxVerifier::VerifyAndRestart(PK_MessageAccumulator &messageAccumulator) const
+{
+    ed25519_MessageAccumulator& accum = static_cast<ed25519_MessageAccumulator&>(messageAccumulator);
+    const ed25519PublicKey& pk = dynamic_cast<const ed25519PublicKey&>(GetPublicKey());
+
+    int ret = -1;
+    if (!m_context.empty())
+        ret = Donna::ed25519_sign_open_dom2(accum.data(), accum.size(), pk.GetPublicKeyBytePtr(), accum.signature(),
+                                            0, m_context.begin(), m_context.size());
+    accum.Restart();
+
+    return ret == 0;
+}
+
+bool ed25519ctxVerifier::VerifyStream(std::istream& stream, const byte *signature, size_t signatureLen) const
+{
+    ed25519_MessageAccumulator accum;
+    InputSignature(accum, signature, signatureLen);
+    UpdateFromStream(accum, stream);
+    return VerifyAndRestart(accum);
+}
+
 NAMESPACE_END  // CryptoPP
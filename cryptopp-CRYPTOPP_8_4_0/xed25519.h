@@ -40,6 +40,7 @@
 #include "cryptlib.h"
 #include "pubkey.h"
 #include "oids.h"
+#include "sha.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -242,6 +243,24 @@ public:
     void GeneratePublicKey(RandomNumberGenerator &rng, const byte *privateKey, byte *publicKey) const;
     bool Agree(byte *agreedValue, const byte *privateKey, const byte *otherPublicKey, bool validateOtherPublicKey=true) const;
 
+    /// \brief Derive a batch of agreed values
+    /// \param agreedValues a byte buffer for count agreed values
+    /// \param privateKeys a byte buffer with count private keys
+    /// \param otherPublicKeys a byte buffer with count public keys of the other parties
+    /// \param count the number of key agreements
+    /// \param validateOtherPublicKey a flag indicating the public keys should be validated
+    /// \param valid an optional array of count results
+    /// \return true if all the agreements succeeded, false otherwise
+    /// \details AgreeBatch() is Agree() on count entries. The buffers hold
+    ///  consecutive keys and values of PrivateKeyLength(), PublicKeyLength()
+    ///  and AgreedValueLength() bytes. If <tt>valid</tt> is not NULL then
+    ///  <tt>valid[i]</tt> receives the result for entry <tt>i</tt>.
+    /// \details On machines with AVX2 the scalar multiplications run four
+    ///  at a time, which raises throughput for servers that perform many
+    ///  key agreements.
+    /// \since Crypto++ 8.5
+    bool AgreeBatch(byte *agreedValues, const byte *privateKeys, const byte *otherPublicKeys, size_t count, bool validateOtherPublicKey=true, bool *valid=NULLPTR) const;
+
 protected:
     // Create a public key from a private key
     void SecretToPublicKey(byte y[PUBLIC_KEYLENGTH], const byte x[SECRET_KEYLENGTH]) const;
@@ -335,6 +354,51 @@ protected:
     std::vector<byte, AllocatorWithCleanup<byte> > m_msg;
 };
 
+/// \brief Ed25519ph message accumulator
+/// \details ed25519ph_MessageAccumulator hashes the message with SHA-512
+///  as it arrives, so the memory used does not depend on the size of the
+///  message. The first 64 bytes of the base class storage still hold the
+///  signature during verification. Member functions data() and size()
+///  are not meaningful, use Prehash() instead.
+/// \sa ed25519phSigner, ed25519phVerifier
+/// \since Crypto++ 8.5
+struct ed25519ph_MessageAccumulator : public ed25519_MessageAccumulator
+{
+    CRYPTOPP_CONSTANT(PREHASH_LENGTH=64);
+
+    /// \brief Create a message accumulator
+    ed25519ph_MessageAccumulator() {}
+
+    /// \brief Create a message accumulator
+    /// \details ed25519ph does not use a RNG. You can safely use
+    ///  NullRNG() because IsProbablistic returns false.
+    ed25519ph_MessageAccumulator(RandomNumberGenerator &rng)
+        : ed25519_MessageAccumulator(rng) {}
+
+    /// \brief Add data to the accumulator
+    /// \param msg pointer to the data to accumulate
+    /// \param len the size of the data, in bytes
+    void Update(const byte* msg, size_t len) {
+        m_hash.Update(msg, len);
+    }
+
+    /// \brief Reset the accumulator
+    void Restart() {
+        ed25519_MessageAccumulator::Restart();
+        m_hash.Restart();
+    }
+
+    /// \brief Retrieve the prehash of the message
+    /// \param prehash a byte array for the SHA-512 digest of the message
+    /// \details Prehash() finishes the digest and restarts the hash.
+    void Prehash(byte prehash[PREHASH_LENGTH]) {
+        m_hash.Final(prehash);
+    }
+
+protected:
+    SHA512 m_hash;
+};
+
 /// \brief Ed25519 private key
 /// \details ed25519PrivateKey is somewhat of a hack. It needed to
 ///  provide DL_PrivateKey interface to fit into the existing
@@ -365,6 +429,10 @@ struct ed25519PrivateKey : public PKCS8PrivateKey
     ///  ed25519 is a DL-based signature scheme. The signature is the
     ///  concatenation of <tt>r || s</tt>.
     CRYPTOPP_CONSTANT(SIGNATURE_LENGTH = 64);
+    /// \brief Size of the expanded private key
+    /// \details EXPANDED_KEYLENGTH is the size of the SHA-512 expansion of
+    ///  the private key, in bytes.
+    CRYPTOPP_CONSTANT(EXPANDED_KEYLENGTH = 64);
 
     // CryptoMaterial
     bool Validate(RandomNumberGenerator &rng, unsigned int level) const;
@@ -480,13 +548,28 @@ struct ed25519PrivateKey : public PKCS8PrivateKey
         return m_pk.begin();
     }
 
+    /// \brief Retrieve expanded private key byte array
+    /// \return the expanded private key byte array
+    /// \details GetExpandedKeyBytePtr() is used by signing code to call
+    ///  ed25519_sign_expanded. The expanded key is the clamped scalar and the
+    ///  nonce prefix. It is computed when the private key is set, so signing
+    ///  does not hash the private key each time.
+    /// \since Crypto++ 8.5
+    const byte* GetExpandedKeyBytePtr() const {
+        return m_ext.begin();
+    }
+
 protected:
     // Create a public key from a private key
     void SecretToPublicKey(byte y[PUBLIC_KEYLENGTH], const byte x[SECRET_KEYLENGTH]) const;
 
+    // Cache the expanded private key after m_sk changes
+    void ExpandSecretKey();
+
 protected:
     FixedSizeSecBlock<byte, SECRET_KEYLENGTH> m_sk;
     FixedSizeSecBlock<byte, PUBLIC_KEYLENGTH> m_pk;
+    FixedSizeSecBlock<byte, EXPANDED_KEYLENGTH> m_ext;
     OID m_oid;  // preferred OID
     mutable Integer m_x;  // for DL_PrivateKey
 };
@@ -599,6 +682,22 @@ struct ed25519Signer : public PK_Signer
     /// \since Crypto++ 8.1
     size_t SignStream (RandomNumberGenerator &rng, std::istream& stream, byte *signature) const;
 
+    /// \brief Sign a batch of messages
+    /// \param rng a RandomNumberGenerator derived class
+    /// \param messages array of pointers to the messages
+    /// \param messageLengths array of message sizes, in bytes
+    /// \param signatures array of pointers to the signatures, each SIGNATURE_LENGTH bytes
+    /// \param count the number of messages and signatures
+    /// \return actual signature length
+    /// \details SignBatch() makes the same signatures as calling SignMessage()
+    ///  for each message. The nonce points share one field inversion per group
+    ///  of 32 messages, which makes signing many short messages faster.
+    /// \details ed25519 is a deterministic signature scheme. <tt>IsProbabilistic()</tt>
+    ///  returns false and the random number generator can be <tt>NullRNG()</tt>.
+    /// \since Crypto++ 8.5
+    size_t SignBatch(RandomNumberGenerator &rng, const byte *const messages[], const size_t messageLengths[],
+                     byte *const signatures[], size_t count) const;
+
 protected:
     ed25519PrivateKey m_key;
 };
@@ -782,6 +881,45 @@ struct ed25519Verifier : public PK_Verifier
     /// \since Crypto++ 8.1
     bool VerifyStream(std::istream& stream, const byte *signature, size_t signatureLen) const;
 
+    /// \brief Check a batch of signatures made with this object's public key
+    /// \param rng a RandomNumberGenerator derived class
+    /// \param messages array of pointers to the messages
+    /// \param messageLengths array of message sizes, in bytes
+    /// \param signatures array of pointers to the signatures, each SIGNATURE_LENGTH bytes
+    /// \param count the number of messages and signatures
+    /// \param valid optional array of count results, true if the signature is valid
+    /// \return true if all signatures are valid, false otherwise
+    /// \details VerifyBatch() checks up to 128 signatures at once with a random
+    ///  linear combination of the verification equations, which is about twice
+    ///  as fast as calling VerifyMessage() for each signature. If a batch does
+    ///  not verify then its signatures are checked one at a time, and
+    ///  <tt>valid</tt> tells which ones failed.
+    /// \details The <tt>rng</tt> provides the random scalars for the linear
+    ///  combination. It must not be predictable by the signer, so do not use
+    ///  NullRNG().
+    /// \details A signature whose only flaw is a small order component is
+    ///  rejected by VerifyMessage(), and it may be accepted by VerifyBatch().
+    ///  Honestly generated signatures do not have the problem.
+    /// \since Crypto++ 8.5
+    bool VerifyBatch(RandomNumberGenerator &rng, const byte *const messages[], const size_t messageLengths[],
+                     const byte *const signatures[], size_t count, bool valid[] = NULLPTR) const;
+
+    /// \brief Check a batch of signatures made with different public keys
+    /// \param rng a RandomNumberGenerator derived class
+    /// \param messages array of pointers to the messages
+    /// \param messageLengths array of message sizes, in bytes
+    /// \param publicKeys array of pointers to the public keys, each PUBLIC_KEYLENGTH bytes
+    /// \param signatures array of pointers to the signatures, each SIGNATURE_LENGTH bytes
+    /// \param count the number of messages, public keys and signatures
+    /// \param valid optional array of count results, true if the signature is valid
+    /// \return true if all signatures are valid, false otherwise
+    /// \details This VerifyBatch() overload checks signatures from many signers,
+    ///  like records collected from different nodes. See the other overload for
+    ///  the details.
+    /// \since Crypto++ 8.5
+    static bool VerifyBatch(RandomNumberGenerator &rng, const byte *const messages[], const size_t messageLengths[],
+                            const byte *const publicKeys[], const byte *const signatures[], size_t count, bool valid[] = NULLPTR);
+
     DecodingResult RecoverAndRestart(byte *recoveredMessage, PK_MessageAccumulator &messageAccumulator) const {
         CRYPTOPP_UNUSED(recoveredMessage); CRYPTOPP_UNUSED(messageAccumulator);
         throw NotImplemented("ed25519Verifier: this object does not support recoverable messages");
@@ -791,6 +929,262 @@ protected:
     ed25519PublicKey m_key;
 };
 
+// **************** ed25519ph and ed25519ctx ***************** //
+
+/// \brief Ed25519ph signature algorithm
+/// \details ed25519phSigner implements the prehashed variant of RFC 8032.
+///  The message is hashed with SHA-512 as it arrives, and the digest is
+///  signed. The message is read once and memory use does not depend on its
+///  size, so a large file can be signed with a FileSource and a SignerFilter.
+/// \details Ed25519ph signatures are not compatible with Ed25519 signatures.
+///  The optional context is up to 255 bytes and must match during verification.
+/// \sa <A HREF="http://tools.ietf.org/rfc/rfc8032.txt">RFC 8032</A>
+/// \since Crypto++ 8.5
+struct ed25519phSigner : public ed25519Signer
+{
+    /// \brief Maximum size of the context
+    CRYPTOPP_CONSTANT(MAX_CONTEXT_LENGTH = 255);
+
+    virtual ~ed25519phSigner() {}
+
+    /// \brief Create a ed25519phSigner object
+    ed25519phSigner() {}
+
+    /// \brief Create a ed25519phSigner object
+    /// \param y public key
+    /// \param x private key
+    /// \note The public key is not validated.
+    ed25519phSigner(const byte y[PUBLIC_KEYLENGTH], const byte x[SECRET_KEYLENGTH])
+        : ed25519Signer(y, x) {}
+
+    /// \brief Create a ed25519phSigner object
+    /// \param x private key
+    /// \details The public key is calculated from the private key.
+    ed25519phSigner(const byte x[SECRET_KEYLENGTH])
+        : ed25519Signer(x) {}
+
+    /// \brief Create a ed25519phSigner object
+    /// \param rng RandomNumberGenerator derived class
+    ed25519phSigner(RandomNumberGenerator &rng)
+        : ed25519Signer(rng) {}
+
+    /// \brief Create a ed25519phSigner object
+    /// \param params public and private key
+    /// \note The public key is not validated.
+    ed25519phSigner(BufferedTransformation &params)
+        : ed25519Signer(params) {}
+
+    /// \brief Set the context
+    /// \param context byte array with the context
+    /// \param length size of the context, in bytes
+    /// \throw InvalidArgument if <tt>length</tt> is greater than MAX_CONTEXT_LENGTH
+    void SetContext(const byte *context, size_t length);
+
+    /// \brief Retrieve the context
+    /// \return the context, which may be empty
+    const SecByteBlock& GetContext() const { return m_context; }
+
+    ed25519ph_MessageAccumulator* NewSignatureAccumulator(RandomNumberGenerator &rng) const {
+        return new ed25519ph_MessageAccumulator(rng);
+    }
+
+    size_t SignAndRestart(RandomNumberGenerator &rng, PK_MessageAccumulator &messageAccumulator, byte *signature, bool restart) const;
+
+    /// \brief Sign a stream
+    /// \param rng a RandomNumberGenerator derived class
+    /// \param stream an std::istream derived class
+    /// \param signature a block of bytes for the signature
+    /// \return actual signature length
+    /// \details SignStream() reads the stream once in fixed size blocks.
+    size_t SignStream (RandomNumberGenerator &rng, std::istream& stream, byte *signature) const;
+
+protected:
+    SecByteBlock m_context;
+};
+
+/// \brief Ed25519ctx signature algorithm
+/// \details ed25519ctxSigner implements the context variant of RFC 8032.
+///  The context is 1 to 255 bytes and must match during verification.
+///  Ed25519ctx hashes the message twice, so the message is buffered by the
+///  accumulator and by SignStream(). Use ed25519phSigner for large messages.
+/// \sa <A HREF="http://tools.ietf.org/rfc/rfc8032.txt">RFC 8032</A>
+/// \since Crypto++ 8.5
+struct ed25519ctxSigner : public ed25519Signer
+{
+    /// \brief Maximum size of the context
+    CRYPTOPP_CONSTANT(MAX_CONTEXT_LENGTH = 255);
+
+    virtual ~ed25519ctxSigner() {}
+
+    /// \brief Create a ed25519ctxSigner object
+    ed25519ctxSigner() {}
+
+    /// \brief Create a ed25519ctxSigner object
+    /// \param y public key
+    /// \param x private key
+    /// \note The public key is not validated.
+    ed25519ctxSigner(const byte y[PUBLIC_KEYLENGTH], const byte x[SECRET_KEYLENGTH])
+        : ed25519Signer(y, x) {}
+
+    /// \brief Create a ed25519ctxSigner object
+    /// \param x private key
+    /// \details The public key is calculated from the private key.
+    ed25519ctxSigner(const byte x[SECRET_KEYLENGTH])
+        : ed25519Signer(x) {}
+
+    /// \brief Create a ed25519ctxSigner object
+    /// \param rng RandomNumberGenerator derived class
+    ed25519ctxSigner(RandomNumberGenerator &rng)
+        : ed25519Signer(rng) {}
+
+    /// \brief Create a ed25519ctxSigner object
+    /// \param params public and private key
+    /// \note The public key is not validated.
+    ed25519ctxSigner(BufferedTransformation &params)
+        : ed25519Signer(params) {}
+
+    /// \brief Set the context
+    /// \param context byte array with the context
+    /// \param length size of the context, in bytes
+    /// \throw InvalidArgument if <tt>length</tt> is 0 or greater than MAX_CONTEXT_LENGTH
+    void SetContext(const byte *context, size_t length);
+
+    /// \brief Retrieve the context
+    /// \return the context
+    const SecByteBlock& GetContext() const { return m_context; }
+
+    size_t SignAndRestart(RandomNumberGenerator &rng, PK_MessageAccumulator &messageAccumulator, byte *signature, bool restart) const;
+
+    /// \brief Sign a stream
+    /// \param rng a RandomNumberGenerator derived class
+    /// \param stream an std::istream derived class
+    /// \param signature a block of bytes for the signature
+    /// \return actual signature length
+    /// \details SignStream() reads the whole stream into memory.
+    /// \throw InvalidArgument if the context was not set
+    size_t SignStream (RandomNumberGenerator &rng, std::istream& stream, byte *signature) const;
+
+protected:
+    SecByteBlock m_context;
+};
+
+/// \brief Ed25519ph signature verification algorithm
+/// \details ed25519phVerifier hashes the message with SHA-512 as it arrives,
+///  so a large file can be verified with a FileSource and a SignatureVerificationFilter.
+/// \sa ed25519phSigner
+/// \since Crypto++ 8.5
+struct ed25519phVerifier : public ed25519Verifier
+{
+    /// \brief Maximum size of the context
+    CRYPTOPP_CONSTANT(MAX_CONTEXT_LENGTH = 255);
+
+    virtual ~ed25519phVerifier() {}
+
+    /// \brief Create a ed25519phVerifier object
+    ed25519phVerifier() {}
+
+    /// \brief Create a ed25519phVerifier object
+    /// \param y public key
+    /// \note The public key is not validated.
+    ed25519phVerifier(const byte y[PUBLIC_KEYLENGTH])
+        : ed25519Verifier(y) {}
+
+    /// \brief Create a ed25519phVerifier object
+    /// \param params public and private key
+    /// \note The public key is not validated.
+    ed25519phVerifier(BufferedTransformation &params)
+        : ed25519Verifier(params) {}
+
+    /// \brief Create a ed25519phVerifier object
+    /// \param signer ed25519ph signer object
+    /// \details The public key and the context are taken from the signer.
+    ed25519phVerifier(const ed25519phSigner& signer)
+        : ed25519Verifier(signer), m_context(signer.GetContext()) {}
+
+    /// \brief Set the context
+    /// \param context byte array with the context
+    /// \param length size of the context, in bytes
+    /// \throw InvalidArgument if <tt>length</tt> is greater than MAX_CONTEXT_LENGTH
+    void SetContext(const byte *context, size_t length);
+
+    /// \brief Retrieve the context
+    /// \return the context, which may be empty
+    const SecByteBlock& GetContext() const { return m_context; }
+
+    ed25519ph_MessageAccumulator* NewVerificationAccumulator() const {
+        return new ed25519ph_MessageAccumulator;
+    }
+
+    bool VerifyAndRestart(PK_MessageAccumulator &messageAccumulator) const;
+
+    /// \brief Check whether input signature is a valid signature for input message
+    /// \param stream an std::istream derived class
+    /// \param signature a pointer to the signature over the message
+    /// \param signatureLen the size of the signature
+    /// \return true if the signature is valid, false otherwise
+    /// \details VerifyStream() reads the stream once in fixed size blocks.
+    bool VerifyStream(std::istream& stream, const byte *signature, size_t signatureLen) const;
+
+protected:
+    SecByteBlock m_context;
+};
+
+/// \brief Ed25519ctx signature verification algorithm
+/// \details Verification fails if the context is not set.
+/// \sa ed25519ctxSigner
+/// \since Crypto++ 8.5
+struct ed25519ctxVerifier : public ed25519Verifier
+{
+    /// \brief Maximum size of the context
+    CRYPTOPP_CONSTANT(MAX_CONTEXT_LENGTH = 255);
+
+    virtual ~ed25519ctxVerifier() {}
+
+    /// \brief Create a ed25519ctxVerifier object
+    ed25519ctxVerifier() {}
+
+    /// \brief Create a ed25519ctxVerifier object
+    /// \param y public key
+    /// \note The public key is not validated.
+    ed25519ctxVerifier(const byte y[PUBLIC_KEYLENGTH])
+        : ed25519Verifier(y) {}
+
+    /// \brief Create a ed25519ctxVerifier object
+    /// \param params public and private key
+    /// \note The public key is not validated.
+    ed25519ctxVerifier(BufferedTransformation &params)
+        : ed25519Verifier(params) {}
+
+    /// \brief Create a ed25519ctxVerifier object
+    /// \param signer ed25519ctx signer object
+    /// \details The public key and the context are taken from the signer.
+    ed25519ctxVerifier(const ed25519ctxSigner& signer)
+        : ed25519Verifier(signer), m_context(signer.GetContext()) {}
+
+    /// \brief Set the context
+    /// \param context byte array with the context
+    /// \param length size of the context, in bytes
+    /// \throw InvalidArgument if <tt>length</tt> is 0 or greater than MAX_CONTEXT_LENGTH
+    void SetContext(const byte *context, size_t length);
+
+    /// \brief Retrieve the context
+    /// \return the context
+    const SecByteBlock& GetContext() const { return m_context; }
+
+    bool VerifyAndRestart(PK_MessageAccumulator &messageAccumulator) const;
+
+    /// \brief Check whether input signature is a valid signature for input message
+    /// \param stream an std::istream derived class
+    /// \param signature a pointer to the signature over the message
+    /// \param signatureLen the size of the signature
+    /// \return true if the signature is valid, false otherwise
+    /// \details VerifyStream() reads the whole stream into memory.
+    bool VerifyStream(std::istream& stream, const byte *signature, size_t signatureLen) const;
+
+protected:
+    SecByteBlock m_context;
+};
+
 /// \brief Ed25519 signature scheme
 /// \sa <A HREF="http://cryptopp.com/wiki/Ed25519">Ed25519</A> on the Crypto++ wiki.
 /// \since Crypto++ 8.0
@@ -802,6 +1196,30 @@ struct ed25519
     typedef ed25519Verifier Verifier;
 };
 
+/// \brief Ed25519ph signature scheme
+/// \details Ed25519ph is the prehashed variant from RFC 8032.
+/// \sa ed25519phSigner, ed25519phVerifier
+/// \since Crypto++ 8.5
+struct ed25519ph
+{
+    /// \brief ed25519ph Signer
+    typedef ed25519phSigner Signer;
+    /// \brief ed25519ph Verifier
+    typedef ed25519phVerifier Verifier;
+};
+
+/// \brief Ed25519ctx signature scheme
+/// \details Ed25519ctx is the context variant from RFC 8032.
+/// \sa ed25519ctxSigner, ed25519ctxVerifier
+/// \since Crypto++ 8.5
+struct ed25519ctx
+{
+    /// \brief ed25519ctx Signer
+    typedef ed25519ctxSigner Signer;
+    /// \brief ed25519ctx Verifier
+    typedef ed25519ctxVerifier Verifier;
+};
+
 NAMESPACE_END  // CryptoPP
 
 #endif  // CRYPTOPP_XED25519_H
@@ -110,6 +110,7 @@ public:
     IV_Requirement IVRequirement() const {return UNIQUE_IV;}
     void Resynchronize(const byte *iv, int ivLength=-1);
     void ProcessData(byte *outString, const byte *inString, size_t length);
+    void ProcessSegments(byte *outString, const byte *inString, size_t length, size_t segmentSize, SegmentWorkers *workers=NULLPTR);
     size_t ProcessLastBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength);
 
     /// \brief Resynchronize the cipher
@@ -119,9 +120,39 @@ public:
     ///  compatibility with the IEEE P1619 paper.
     void Resynchronize(word64 sector, ByteOrder order=BIG_ENDIAN_ORDER);
 
+    /// \brief Encrypt or decrypt a run of sectors
+    /// \param outString the output byte buffer
+    /// \param inString the input byte buffer
+    /// \param length the size of the input and output byte buffers, in bytes
+    /// \param sectorSize the size of each sector, in bytes
+    /// \param sector the 64-bit sector number of the first sector
+    /// \param order the endian order the sector numbers should be written
+    /// \param workers an optional SegmentWorkers to run the batches of sectors
+    /// \details ProcessSectors() processes <tt>length/sectorSize</tt> data
+    ///  units. Data unit <tt>i</tt> uses the tweak of sector <tt>sector+i</tt>,
+    ///  which is the same tweak Resynchronize(word64, ByteOrder) produces. It
+    ///  is equivalent to calling Resynchronize() and ProcessData() for each
+    ///  sector, but the tweaks for a batch of sectors are encrypted together.
+    /// \details sectorSize must be a multiple of BlockSize(), and length must
+    ///  be a multiple of sectorSize. Ciphertext stealing is not performed.
+    /// \details Batches of sectors are distributed over the threads of workers.
+    ///  If workers is NULL then a SegmentWorkers is created for the call. The
+    ///  state set by Resynchronize() is not used or changed.
+    /// \throw InvalidArgument if sectorSize or length is invalid
+    /// \since Crypto++ 8.5
+    void ProcessSectors(byte *outString, const byte *inString, size_t length,
+        size_t sectorSize, word64 sector, ByteOrder order=BIG_ENDIAN_ORDER, SegmentWorkers *workers=NULLPTR);
+
 protected:
     virtual void ResizeBuffers();
 
+    // Processes whole blocks of one data unit. xregister holds the next
+    // tweak on entry and on exit. ProcessData() passes the block cipher,
+    // m_xregister and m_xworkspace; ProcessSegments() and ProcessSectors()
+    // pass a cipher and buffers for each thread.
+    void ProcessTweakedBlocks(const BlockCipher &cipher, byte *outString, const byte *inString,
+        size_t length, byte *xregister, byte *xworkspace) const;
+
     inline size_t ProcessLastPlainBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength);
     inline size_t ProcessLastCipherBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength);
 
@@ -137,6 +168,10 @@ protected:
     AlignedSecByteBlock m_xregister;
     AlignedSecByteBlock m_xworkspace;
 
+    // AES with VAES processes the data and generates the tweaks in one
+    // kernel. Set in SetKey.
+    bool m_vaes;
+
     // Intel lacks the SSE registers to run 8 or 12 parallel blocks.
     // Do not change this value after compiling. It has no effect.
 #if CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X86
@@ -144,6 +179,9 @@ protected:
 #else
     enum {ParallelBlocks = 12};
 #endif
+
+    // Number of sectors in a segment of ProcessSectors()
+    enum {SectorBatch = 32};
 };
 
 /// \brief XTS block cipher mode of operation implementation